@@ -0,0 +1,116 @@
+#pragma once
+
+#include "netcode/async/event_loop.hpp"
+#include "netcode/async/task.hpp"
+#include "netcode/async/udp_endpoint.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode::async {
+
+class AckTracker;
+
+/**
+ * @brief Awaitable producing whether a sequence was acknowledged before the timeout
+ */
+class AckAwaiter {
+public:
+    AckAwaiter(AckTracker& tracker, uint32_t sequence, std::optional<std::chrono::steady_clock::duration> timeout)
+        : tracker_(tracker), sequence_(sequence), timeout_(timeout) {}
+
+    bool await_ready() const;
+    void await_suspend(std::coroutine_handle<> handle);
+    bool await_resume();
+
+private:
+    AckTracker& tracker_;                                     ///< Tracker receiving the acknowledgements
+    uint32_t sequence_;                                       ///< Sequence to wait for
+    std::optional<std::chrono::steady_clock::duration> timeout_; ///< Give up after this long
+    std::shared_ptr<WaitState> state_;                        ///< The suspended wait
+};
+
+/**
+ * @brief Cumulative acknowledgements of one session's sequence numbers
+ *
+ * The session's receive path reports the highest sequence the peer has
+ * acknowledged; coroutines can await the acknowledgement of any sequence.
+ */
+class AckTracker {
+public:
+    /**
+     * @brief Construct a new AckTracker object
+     *
+     * @param loop Loop resuming the waiting coroutines
+     */
+    explicit AckTracker(EventLoop& loop) : loop_(loop) {}
+
+    /**
+     * @brief Record that the peer has received everything up to a sequence
+     *
+     * @param sequence Highest acknowledged sequence
+     */
+    void acknowledge(uint32_t sequence);
+
+    /**
+     * @brief Check whether a sequence has been acknowledged
+     *
+     * @param sequence The sequence
+     * @return True if it was acknowledged
+     */
+    bool isAcknowledged(uint32_t sequence) const { return sequence <= acknowledged_; }
+
+    /**
+     * @brief Wait until a sequence is acknowledged
+     *
+     * @param sequence The sequence
+     * @param timeout Give up after this long, wait forever if not set
+     * @return Awaitable producing true if acknowledged, false on timeout
+     */
+    AckAwaiter waitForAck(uint32_t sequence, std::optional<std::chrono::steady_clock::duration> timeout = std::nullopt) {
+        return AckAwaiter(*this, sequence, timeout);
+    }
+
+    /**
+     * @brief Get the number of coroutines waiting for an acknowledgement
+     *
+     * @return The waiting coroutine count
+     */
+    size_t getPendingWaitCount() const { return waiters_.size(); }
+
+private:
+    friend class AckAwaiter;
+
+    /**
+     * @brief Drop a wait that timed out before its sequence was acknowledged
+     *
+     * @param sequence The awaited sequence
+     * @param state The wait
+     */
+    void removeWaiter(uint32_t sequence, const std::shared_ptr<WaitState>& state);
+
+    EventLoop& loop_;                                                   ///< Loop resuming waiters
+    uint32_t acknowledged_ = 0;                                         ///< Highest acknowledged sequence
+    std::multimap<uint32_t, std::shared_ptr<WaitState>> waiters_;       ///< Waits by awaited sequence
+};
+
+/**
+ * @brief Send a datagram until the peer acknowledges its sequence
+ *
+ * @param endpoint Endpoint to send from
+ * @param peer Receiver address
+ * @param data Payload, copied into the coroutine
+ * @param acks Acknowledgements of the receiver
+ * @param sequence Sequence the receiver acknowledges the datagram with
+ * @param attempts Most times the datagram is sent
+ * @param retryInterval Time to wait for the acknowledgement before resending
+ * @return Task producing true once acknowledged, false if every attempt went unanswered
+ */
+Task<bool> sendReliable(UdpEndpoint& endpoint, sockaddr_in peer, std::vector<char> data, AckTracker& acks,
+                        uint32_t sequence, int attempts, std::chrono::steady_clock::duration retryInterval);
+
+} // namespace netcode::async
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "netcode/async/task.hpp"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace netcode::async {
+
+class EventLoop;
+
+/**
+ * @brief Shared state of a suspended coroutine waiting for an event or a timeout
+ *
+ * Whichever happens first, the event or the timeout, completes the wait and
+ * resumes the coroutine; the other one finds the wait completed and does nothing.
+ */
+struct WaitState {
+    std::coroutine_handle<> handle; ///< The waiting coroutine
+    bool completed = false;         ///< Whether the coroutine has been scheduled for resumption
+    bool timedOut = false;          ///< Whether the timeout completed the wait
+};
+
+/**
+ * @brief Awaitable suspending the coroutine for a duration
+ */
+class SleepAwaiter {
+public:
+    SleepAwaiter(EventLoop& loop, std::chrono::steady_clock::duration duration) : loop_(loop), duration_(duration) {}
+
+    bool await_ready() const noexcept { return duration_ <= std::chrono::steady_clock::duration::zero(); }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+private:
+    EventLoop& loop_;                           ///< Loop owning the timer
+    std::chrono::steady_clock::duration duration_; ///< How long to sleep
+};
+
+/**
+ * @brief Awaitable suspending the coroutine until the loop's next tick
+ */
+class TickAwaiter {
+public:
+    explicit TickAwaiter(EventLoop& loop) : loop_(loop) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+
+    /**
+     * @brief Number of the tick that resumed the coroutine
+     */
+    uint64_t await_resume() const noexcept;
+
+private:
+    EventLoop& loop_; ///< Loop producing the ticks
+};
+
+/**
+ * @brief Single-threaded event loop driving coroutines
+ *
+ * Runs timers, fixed-rate ticks and socket readiness on one thread with epoll.
+ * Coroutines suspended on an awaitable cost no thread and no polling, so
+ * thousands of sessions, each written as straight-line code, can share one
+ * loop. Resumptions are always deferred to the loop, never run inline from
+ * the code that completed the wait.
+ */
+class EventLoop {
+public:
+    /**
+     * @brief Construct a new EventLoop object
+     *
+     * @param tickRate Ticks per second produced for nextTick()
+     */
+    explicit EventLoop(float tickRate = 60.0f);
+
+    /**
+     * @brief Destroy the EventLoop object and every coroutine still suspended on it
+     */
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Start a task on the loop, the loop owns it until it finishes
+     *
+     * @param task The task to run
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Run until stop() is called or every spawned task has finished
+     */
+    void run();
+
+    /**
+     * @brief Run for a limited time, even if no task is running
+     *
+     * @param duration How long to run
+     */
+    void runFor(std::chrono::steady_clock::duration duration);
+
+    /**
+     * @brief Make run() and runFor() return after the current iteration
+     */
+    void stop();
+
+    /**
+     * @brief Suspend the awaiting coroutine for a duration
+     *
+     * @param duration How long to sleep
+     * @return Awaitable
+     */
+    SleepAwaiter sleepFor(std::chrono::steady_clock::duration duration) { return SleepAwaiter(*this, duration); }
+
+    /**
+     * @brief Suspend the awaiting coroutine until the next tick
+     *
+     * @return Awaitable producing the tick number
+     */
+    TickAwaiter nextTick() { return TickAwaiter(*this); }
+
+    /**
+     * @brief Get the number of ticks produced so far
+     *
+     * @return uint64_t Tick count
+     */
+    uint64_t getTickCount() const { return tickCount_; }
+
+    /**
+     * @brief Get the number of spawned tasks that have not finished yet
+     *
+     * @return size_t Task count
+     */
+    size_t getActiveTaskCount() const { return roots_.size(); }
+
+    /**
+     * @brief Resume a coroutine on the next loop iteration
+     *
+     * @param handle The coroutine to resume
+     */
+    void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    /**
+     * @brief Complete a wait and schedule its coroutine, unless already completed
+     *
+     * @param state The wait to complete
+     * @return True if this call completed the wait
+     */
+    bool complete(const std::shared_ptr<WaitState>& state);
+
+    /**
+     * @brief Complete a wait as timed out at a deadline, unless completed before
+     *
+     * @param deadline When the wait times out
+     * @param state The wait
+     */
+    void addTimer(std::chrono::steady_clock::time_point deadline, std::shared_ptr<WaitState> state);
+
+    /**
+     * @brief Register a wait for the next tick
+     *
+     * @param state The wait
+     */
+    void addTickWaiter(std::shared_ptr<WaitState> state) { tickWaiters_.push_back(std::move(state)); }
+
+    /**
+     * @brief Call a handler whenever a file descriptor becomes readable
+     *
+     * @param fd The file descriptor
+     * @param onReadable Handler run on the loop thread
+     * @return True if the descriptor was registered
+     */
+    bool watch(int fd, std::function<void()> onReadable);
+
+    /**
+     * @brief Stop watching a file descriptor
+     *
+     * @param fd The file descriptor
+     */
+    void unwatch(int fd);
+
+    /**
+     * @brief Forget a spawned task whose coroutine frame was destroyed
+     *
+     * @param address Address of the task's root frame
+     */
+    void forgetTask(void* address);
+
+private:
+    /**
+     * @brief Pending timeout in the timer heap
+     */
+    struct Timer {
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t order; ///< Keeps timers with equal deadlines in insertion order
+        std::shared_ptr<WaitState> state;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : order > other.order;
+        }
+    };
+
+    int epollFd_ = -1;                                        ///< epoll instance for watched sockets
+    std::chrono::steady_clock::duration tickInterval_;        ///< Time between ticks
+    std::chrono::steady_clock::time_point nextTickTime_;      ///< When the next tick is due
+    uint64_t tickCount_ = 0;                                  ///< Ticks produced so far
+    uint64_t timerOrder_ = 0;                                 ///< Insertion counter for timers
+    bool running_ = false;                                    ///< Whether run() or runFor() should go on
+    bool destroying_ = false;                                 ///< Set while the destructor tears down tasks
+
+    std::deque<std::coroutine_handle<>> ready_;               ///< Coroutines to resume
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_; ///< Pending timeouts
+    std::vector<std::shared_ptr<WaitState>> tickWaiters_;     ///< Coroutines waiting for the next tick
+    std::unordered_map<int, std::function<void()>> watchers_; ///< Readable handlers by file descriptor
+    std::unordered_set<void*> roots_;                         ///< Frames of spawned tasks still running
+
+    /**
+     * @brief Run one iteration: ready coroutines, socket events, timers and ticks
+     *
+     * @param maxWait Longest time to block waiting for events
+     */
+    void runOnce(std::chrono::steady_clock::duration maxWait);
+
+    /**
+     * @brief Resume every scheduled coroutine
+     */
+    void resumeReady();
+};
+
+} // namespace netcode::async
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "netcode/async/event_loop.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode::async {
+
+/**
+ * @brief A received UDP datagram
+ */
+struct Datagram {
+    std::vector<char> data; ///< Payload
+    sockaddr_in from{};     ///< Sender address
+};
+
+class UdpEndpoint;
+
+/**
+ * @brief Awaitable producing the next datagram, or nothing on timeout
+ */
+class PacketAwaiter {
+public:
+    /**
+     * @brief Wait state carrying the delivered datagram
+     */
+    struct PacketWait : WaitState {
+        std::optional<Datagram> datagram;
+    };
+
+    PacketAwaiter(UdpEndpoint& endpoint, std::optional<uint64_t> peer,
+                  std::optional<std::chrono::steady_clock::duration> timeout)
+        : endpoint_(endpoint), peer_(peer), timeout_(timeout) {}
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> handle);
+    std::optional<Datagram> await_resume();
+
+private:
+    UdpEndpoint& endpoint_;                                   ///< Endpoint receiving the datagram
+    std::optional<uint64_t> peer_;                            ///< Peer to wait for, none for unclaimed peers
+    std::optional<std::chrono::steady_clock::duration> timeout_; ///< Give up after this long
+    std::optional<Datagram> ready_;                           ///< Datagram that was already queued
+    std::shared_ptr<PacketWait> state_;                       ///< The suspended wait
+};
+
+/**
+ * @brief UDP socket driven by an event loop
+ *
+ * Demultiplexes datagrams by sender. A session awaits nextPacket() for its
+ * peer; datagrams from peers no session has claimed yet go to accept(), so
+ * a server can start one coroutine per new peer. Datagrams arriving while
+ * nobody waits are queued per peer, up to a limit.
+ */
+class UdpEndpoint {
+public:
+    /**
+     * @brief Construct a new UdpEndpoint object
+     *
+     * @param loop Loop driving the endpoint, must outlive it
+     */
+    explicit UdpEndpoint(EventLoop& loop);
+
+    /**
+     * @brief Destroy the UdpEndpoint object and close the socket
+     */
+    ~UdpEndpoint();
+
+    UdpEndpoint(const UdpEndpoint&) = delete;
+    UdpEndpoint& operator=(const UdpEndpoint&) = delete;
+
+    /**
+     * @brief Bind the socket and register it with the loop
+     *
+     * @param port Local port, 0 for any
+     * @return True if the socket is ready
+     */
+    bool bind(int port);
+
+    /**
+     * @brief Get the local port the socket is bound to
+     *
+     * @return int The port, 0 if not bound
+     */
+    int getPort() const { return port_; }
+
+    /**
+     * @brief Send a datagram
+     *
+     * @param peer Receiver address
+     * @param data Payload
+     * @param size Payload size in bytes
+     * @return True if the datagram was sent
+     */
+    bool sendTo(const sockaddr_in& peer, const void* data, size_t size);
+
+    /**
+     * @brief Wait for the next datagram from a peer, claiming the peer for the caller
+     *
+     * @param peer The peer
+     * @param timeout Give up after this long, wait forever if not set
+     * @return Awaitable producing the datagram, or nothing on timeout
+     */
+    PacketAwaiter nextPacket(const sockaddr_in& peer,
+                             std::optional<std::chrono::steady_clock::duration> timeout = std::nullopt);
+
+    /**
+     * @brief Wait for the next datagram from a peer nobody has claimed
+     *
+     * The peer of the returned datagram is claimed for the caller, so its
+     * following datagrams are only produced by nextPacket().
+     *
+     * @param timeout Give up after this long, wait forever if not set
+     * @return Awaitable producing the datagram, or nothing on timeout
+     */
+    PacketAwaiter accept(std::optional<std::chrono::steady_clock::duration> timeout = std::nullopt);
+
+    /**
+     * @brief Release a peer, its future datagrams go to accept() again
+     *
+     * Pending nextPacket() waits for the peer complete without a datagram.
+     *
+     * @param peer The peer
+     */
+    void release(const sockaddr_in& peer);
+
+    /**
+     * @brief Get the number of datagrams dropped because a queue was full
+     *
+     * @return uint64_t Dropped datagram count
+     */
+    uint64_t getDroppedCount() const { return dropped_; }
+
+    /**
+     * @brief Get the number of coroutines waiting for a datagram
+     *
+     * @return size_t The waiting coroutine count
+     */
+    size_t getPendingWaitCount() const;
+
+    /**
+     * @brief Build the demultiplexing key of an address
+     *
+     * @param addr The address
+     * @return uint64_t Key combining address and port
+     */
+    static uint64_t peerKey(const sockaddr_in& addr);
+
+private:
+    friend class PacketAwaiter;
+
+    /**
+     * @brief Queued datagrams and waiting coroutines of one peer, or of all unclaimed peers
+     */
+    struct Inbox {
+        std::deque<Datagram> datagrams;
+        std::deque<std::shared_ptr<PacketAwaiter::PacketWait>> waiters;
+    };
+
+    // Most datagrams queued per claimed peer before new ones are dropped
+    static constexpr size_t MAX_QUEUED_DATAGRAMS = 64;
+    
+    // Most datagrams from new peers waiting for accept(), like a listen backlog
+    static constexpr size_t MAX_PENDING_ACCEPTS = 4096;
+
+    EventLoop& loop_;                          ///< Loop driving the endpoint
+    int socketFd_ = -1;                        ///< The UDP socket
+    int port_ = 0;                             ///< Bound local port
+    std::unordered_map<uint64_t, Inbox> peers_; ///< Inboxes of claimed peers
+    Inbox unclaimed_;                          ///< Inbox for peers nobody has claimed
+    uint64_t dropped_ = 0;                     ///< Datagrams dropped on full queues
+
+    /**
+     * @brief Read every pending datagram and hand it to its inbox
+     */
+    void onReadable();
+
+    /**
+     * @brief Claim a peer, moving its queued unclaimed datagrams to its own inbox
+     *
+     * @param key Peer key
+     */
+    void claim(uint64_t key);
+
+    /**
+     * @brief Get the inbox for a peer, or the unclaimed inbox
+     *
+     * @param peer Peer key, none for the unclaimed inbox
+     * @return The inbox
+     */
+    Inbox& inboxFor(std::optional<uint64_t> peer);
+
+    /**
+     * @brief Drop a wait that timed out before a datagram arrived
+     *
+     * @param peer Peer key, none for the unclaimed inbox
+     * @param state The wait
+     */
+    void removeWaiter(std::optional<uint64_t> peer, const std::shared_ptr<PacketAwaiter::PacketWait>& state);
+};
+
+} // namespace netcode::async
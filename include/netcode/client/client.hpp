@@ -6,7 +6,12 @@
 #include "netcode/prediction/prediction.hpp"
 #include "netcode/prediction/reconciliation.hpp"
 #include "netcode/prediction/interpolation.hpp"
+#include "netcode/prediction/remote_prediction.hpp"
+#include "netcode/prediction/time_dilation.hpp"
 #include "netcode/packets/player_state_packet.hpp"
+#include "netcode/packets/cluster_packets.hpp"
+#include "netcode/packets/session_packets.hpp"
+#include "netcode/trace/input_trace.hpp"
 #include "netcode/settings.hpp"
 #include <thread>
 #include <atomic>
@@ -16,6 +21,8 @@
 #include <memory>
 #include <chrono>
 #include <queue>
+#include <vector>
+#include <functional>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
@@ -77,6 +84,13 @@ public:
      */
     void sendMovementRequest(const netcode::math::MyVec3& movement, bool jumpRequested);
     
+    /**
+     * @brief Record every movement request sent from now on
+     * 
+     * @param recorder Recorder to add the requests to, may be shared between clients, nullptr to stop recording
+     */
+    void setInputRecorder(std::shared_ptr<InputTraceRecorder> recorder);
+    
     /**
      * @brief Set a reference to a networked entity for position updates
      * 
@@ -94,8 +108,10 @@ public:
      * @param z Z coordinate
      * @param isJumping Whether the player is currently jumping
      * @param serverSequence The sequence number of the last input processed by the server
+     * @param velocity The player's velocity on the server (per simulation step)
      */
-    void updatePlayerPosition(uint32_t playerId, float x, float y, float z, bool isJumping, uint32_t serverSequence);
+    void updatePlayerPosition(uint32_t playerId, float x, float y, float z, bool isJumping, uint32_t serverSequence,
+                              const netcode::math::MyVec3& velocity = {});
     
     /**
      * @brief Update all entities using interpolation
@@ -113,6 +129,133 @@ public:
      * @return uint32_t The client ID
      */
     uint32_t getClientId() const { return clientId_; }
+    
+    /**
+     * @brief Configure prediction of remote players
+     * 
+     * When enabled, remote players are simulated forward from their last server
+     * state using the input they are holding, instead of being interpolated.
+     * 
+     * @param config Remote prediction configuration
+     */
+    void setRemotePredictionConfig(const RemotePredictionConfig& config);
+    
+    /**
+     * @brief Get the remote prediction cost and correction counters for a player
+     * 
+     * @param playerId ID of the remote player
+     * @return RemotePredictionStats The counters for this player
+     */
+    RemotePredictionStats getRemotePredictionStats(uint32_t playerId);
+    
+    /**
+     * @brief Configure interpolation of remote players
+     * 
+     * @param config Interpolation configuration
+     */
+    void setInterpolationConfig(const InterpolationConfig& config);
+    
+    /**
+     * @brief Set the distance between the predicted and the server position that triggers a correction
+     * 
+     * @param threshold The threshold in world units
+     */
+    void setReconciliationThreshold(float threshold);
+    
+    /**
+     * @brief Bound the work of correcting the local player, whatever the round trip
+     * 
+     * @param maxInputs Most pending inputs replayed one by one, older ones are merged; 0 for no limit
+     * @param budget Replay time per update, 0 for no limit
+     */
+    void setReplayLimits(uint32_t maxInputs, std::chrono::microseconds budget);
+    
+    /**
+     * @brief Get the correction counters of the local player
+     * 
+     * @return ReconciliationStats The counters
+     */
+    ReconciliationStats getReconciliationStats();
+    
+    /**
+     * @brief Get the interpolation counters of the remote players
+     * 
+     * @return InterpolationStats The counters
+     */
+    InterpolationStats getInterpolationStats();
+    
+    /**
+     * @brief Get the rate the local input clock should run at
+     * 
+     * While the server buffers inputs per tick, the client keeps the buffer
+     * at a small target depth by sending slightly faster or slower: multiply
+     * the input rate by this scale. It stays 1 without input acknowledgements.
+     * 
+     * @return float The time scale, around 1
+     */
+    float getTimeScale();
+    
+    /**
+     * @brief Configure how the input clock follows the server's input buffer
+     * 
+     * @param config Dilation configuration
+     */
+    void setTimeDilationConfig(const TimeDilationConfig& config);
+    
+    /**
+     * @brief Get the input buffer counters reported by the server
+     * 
+     * @return TimeDilationStats The counters
+     */
+    TimeDilationStats getTimeDilationStats();
+    
+    /**
+     * @brief Get the smoothed round trip time measured from input acknowledgements
+     * 
+     * @return std::chrono::microseconds The current round trip time estimate
+     */
+    std::chrono::microseconds getRoundTripTime();
+    
+    /**
+     * @brief Set a callback invoked when the server's world checksum reveals a desync
+     * 
+     * The callback receives the checksum sequence and the IDs of the entities whose
+     * authoritative state differs from the server's. Those entities are requested
+     * again from the server automatically.
+     * 
+     * @param callback Function to call with the diverging entity IDs
+     */
+    void setDesyncCallback(std::function<void(uint32_t, const std::vector<uint32_t>&)> callback);
+    
+    /**
+     * @brief Get the port of the server the client currently sends inputs to
+     * 
+     * Changes when a cluster hands the local player off to another region server.
+     * 
+     * @return int The current server port
+     */
+    int getServerPort();
+    
+    /**
+     * @brief Move the client to a new local port and resume its session
+     * 
+     * Use when the client's address changed, e.g. after a network switch.
+     * The server moves the session to the new address if the grace period
+     * has not run out and sends a catch-up snapshot; prediction history and
+     * input sequence numbers are kept, and inputs the server never processed
+     * are sent again. Without a session the client simply registers again.
+     * 
+     * @param port New local port, 0 for any
+     * @return True if the new socket is open, false leaves the client stopped
+     */
+    bool rebind(int port);
+    
+    /**
+     * @brief Check whether the server has given the client a session token
+     * 
+     * @return True once the client can resume its session
+     */
+    bool hasSession() const { return sessionToken_ != 0; }
 
 private:
     uint32_t clientId_;        ///< Unique identifier for this client
@@ -138,14 +281,85 @@ private:
     
     ///< Queue for delayed packet processing
     std::queue<packets::TimestampedPlayerStatePacket> packetQueue_;
+    ///< Queue for delayed world checksum processing
+    std::queue<packets::TimestampedStateChecksumPacket> checksumQueue_;
+    ///< Queue for delayed input acknowledgement processing
+    std::queue<packets::TimestampedInputAckPacket> inputAckQueue_;
+    ///< Queue for delayed redirect processing
+    std::queue<packets::TimestampedRedirectPacket> redirectQueue_;
     ///< Mutex for protecting packet queue access
     std::mutex queueMutex_;
     
+    /**
+     * @brief The client's own state of an entity at a server state, reduced to its hash
+     */
+    struct ReconstructedState {
+        uint32_t stateSequence = 0; ///< State sequence of the server state
+        uint32_t inputSequence = 0; ///< Last input the server processed for that state
+        uint64_t hash = 0;          ///< Hash of the state the client holds for it
+    };
+    ///< Reconstructed states per entity, used to check the server's world checksum
+    std::map<uint32_t, ReconstructedState> reconstructedStates_;
+    ///< XOR of all reconstructed state hashes, kept in step with reconstructedStates_
+    uint64_t worldChecksum_ = 0;
+    ///< Callback for reporting entities that diverged from the server
+    std::function<void(uint32_t, const std::vector<uint32_t>&)> desyncCallback_;
+    
     // Netcode systems for prediction and reconciliation
     std::unique_ptr<SnapshotManager> snapshotManager_;
     std::unique_ptr<PredictionSystem> predictionSystem_;
     std::unique_ptr<ReconciliationSystem> reconciliationSystem_;
     std::unique_ptr<InterpolationSystem> interpolationSystem_;
+    std::unique_ptr<RemotePredictionSystem> remotePredictionSystem_;
+    
+    ///< Send times of inputs not yet acknowledged by the server, by sequence number
+    std::map<uint32_t, std::chrono::steady_clock::time_point> inputSendTimes_;
+    ///< Smoothed round trip time, guarded by playerMutex_
+    std::chrono::microseconds roundTripTime_{0};
+    ///< Maximum number of unacknowledged inputs to keep send times for
+    static constexpr size_t MAX_TRACKED_INPUTS = 256;
+    
+    ///< Latest state sequence received per entity that still needs to be acknowledged
+    std::map<uint32_t, uint32_t> pendingStateAcks_;
+    ///< When state acknowledgements were last sent
+    std::chrono::steady_clock::time_point lastStateAckTime_;
+    ///< Minimum interval between state acknowledgements (in milliseconds)
+    static constexpr uint32_t STATE_ACK_INTERVAL_MS = 50;
+    ///< Interval of empty acknowledgements keeping an idle session alive (in milliseconds)
+    static constexpr uint32_t KEEPALIVE_INTERVAL_MS = 1000;
+    
+    ///< Token for resuming the session, zero until the server sent one
+    std::atomic<uint64_t> sessionToken_{0};
+    ///< Inputs the server has not processed yet, resent after resuming, guarded by playerMutex_
+    std::map<uint32_t, packets::PlayerMovementRequest> unprocessedInputs_;
+    ///< Recorder for the sent inputs, guarded by playerMutex_
+    std::shared_ptr<InputTraceRecorder> inputRecorder_;
+    ///< Input clock following the server's input buffer, guarded by playerMutex_
+    TimeDilationController timeDilation_;
+    
+    /**
+     * @brief Create the non-blocking UDP socket and bind it to the local port
+     * 
+     * @return True if the socket is ready
+     */
+    bool openSocket();
+    
+    /**
+     * @brief Register with the server by sending a zero movement request
+     */
+    void sendRegistration();
+    
+    /**
+     * @brief Ask the server to move the session to the current socket
+     */
+    void sendResumeRequest();
+    
+    /**
+     * @brief Store the session token, or register again if a resume was rejected
+     * 
+     * @param session The received session packet
+     */
+    void handleSession(const packets::SessionPacket& session);
     
     /**
      * @brief Process incoming network events continuously.
@@ -160,6 +374,61 @@ private:
      * @param packet The received player state packet
      */
     void handleServerUpdate(const packets::PlayerStatePacket& packet);
+    
+    /**
+     * @brief Hash the state the client itself holds for an entity at a server state
+     * 
+     * The local player is hashed from the state the client predicted for the
+     * input the server processed, remote entities from the state their
+     * prediction, interpolation or snap took over. Has to run before a server
+     * state corrects the local prediction.
+     * 
+     * @param packet The server state
+     */
+    void recordReconstructedState(const packets::PlayerStatePacket& packet);
+    
+    /**
+     * @brief Compare the server's world checksum against the client's reconstructed states
+     * 
+     * Only entities for which the client reconstructed the same state sequence
+     * as the server are compared; entities that are behind are still being replicated.
+     * 
+     * @param checksum The received checksum packet
+     */
+    void handleStateChecksum(const packets::StateChecksumPacket& checksum);
+    
+    /**
+     * @brief Adjust the input clock to the reported depth of the server's input buffer
+     * 
+     * @param inputAck The received input acknowledgement
+     */
+    void handleInputAck(const packets::InputAckPacket& inputAck);
+    
+    /**
+     * @brief Switch to the region server that took over the local player
+     * 
+     * The new server already holds this client's session, so inputs simply
+     * go to the new address from now on.
+     * 
+     * @param redirect The received redirect packet
+     */
+    void handleRedirect(const packets::RedirectPacket& redirect);
+    
+    /**
+     * @brief Acknowledge received entity states to the server
+     * 
+     * Batches the states received since the last acknowledgement so the server
+     * can stop replicating entities that have not changed. An idle client sends
+     * an empty acknowledgement now and then so its session does not expire.
+     */
+    void sendStateAcks();
+    
+    /**
+     * @brief Update the round trip time estimate from an acknowledged input
+     * 
+     * @param acknowledgedSequence The last input sequence processed by the server
+     */
+    void updateRoundTripTime(uint32_t acknowledgedSequence);
 };
 
 } // namespace netcode
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/networked_entity.hpp"
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/packets/cluster_packets.hpp"
+#include "netcode/settings.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Part of the world owned by one region server
+ */
+struct RegionConfig {
+    uint32_t regionId = 0;  ///< Unique ID of the region
+    float minX = 0.0f;      ///< Lower X bound of the region
+    float maxX = 0.0f;      ///< Upper X bound of the region
+    float minZ = -1e9f;     ///< Lower Z bound of the region
+    float maxZ = 1e9f;      ///< Upper Z bound of the region
+    int clientPort = 0;     ///< Port clients send inputs to
+    int peerPort = 0;       ///< Port other region servers send cluster messages to
+    bool spawnPlayers = false; ///< Whether unknown players joining through this region are spawned in it
+};
+
+/**
+ * @brief Layout of a cluster of region servers on one host
+ */
+struct ClusterConfig {
+    // All regions of the world, shared by every process of the cluster
+    std::vector<RegionConfig> regions;
+
+    // Host all region servers run on
+    std::string host = "127.0.0.1";
+
+    // Entities closer than this to another region are mirrored there as ghosts
+    float ghostMargin = 5.0f;
+
+    // How far an entity must be inside another region before authority moves
+    float handoffHysteresis = 0.5f;
+
+    // Ticks per second of each region server
+    float tickRate = 60.0f;
+
+    // Ghosts not refreshed for this long are dropped (in milliseconds)
+    uint32_t ghostTimeoutMs = 1000;
+
+    // Interval for resending a handoff that has not been acknowledged (in milliseconds)
+    uint32_t handoffRetryMs = 50;
+};
+
+/**
+ * @brief Server process owning one region of a spatially sharded world
+ *
+ * Each process of the cluster runs one region server. It is authoritative for
+ * the entities inside its region and talks to the other regions over local
+ * UDP. Entities close to a border are mirrored to the neighbouring region as
+ * ghosts so players near the border see each other. When an entity crosses a
+ * border its full state and session are handed off to the new region, and
+ * once that region has acknowledged the handoff the client is redirected to
+ * it. The new region already holds the session, so the client keeps playing
+ * without reconnecting; inputs still arriving at the old region are forwarded.
+ */
+class RegionServer {
+public:
+    /**
+     * @brief Creates entities taken over from another region
+     */
+    using EntityFactory = std::function<std::shared_ptr<NetworkedEntity>(uint32_t)>;
+
+    /**
+     * @brief Construct a new RegionServer object
+     *
+     * @param regionId ID of the region this process owns, must be part of the cluster config
+     * @param config Layout of the cluster
+     * @param settings Settings interface for configuration (optional)
+     */
+    RegionServer(uint32_t regionId, const ClusterConfig& config, std::shared_ptr<ISettings> settings = nullptr);
+
+    /**
+     * @brief Destroy the RegionServer object and clean up resources
+     */
+    ~RegionServer();
+
+    /**
+     * @brief Bind the client and peer sockets and start the region thread
+     */
+    void start();
+
+    /**
+     * @brief Stop the region thread and close the sockets
+     */
+    void stop();
+
+    /**
+     * @brief Set the factory for entities handed off from other regions
+     *
+     * @param factory Function creating an entity for a player ID
+     */
+    void setEntityFactory(EntityFactory factory);
+
+    /**
+     * @brief Spawn a player entity owned by this region
+     *
+     * @param playerId ID of the player
+     * @param player Shared pointer to the networked entity
+     */
+    void setPlayerReference(uint32_t playerId, std::shared_ptr<NetworkedEntity> player);
+
+    /**
+     * @brief Check whether this region currently has authority over an entity
+     *
+     * @param playerId ID of the player
+     * @return True if the entity is owned by this region
+     */
+    bool ownsEntity(uint32_t playerId);
+
+    /**
+     * @brief Check whether this region mirrors an entity of another region
+     *
+     * @param playerId ID of the player
+     * @return True if the entity is known here as a ghost
+     */
+    bool hasGhost(uint32_t playerId);
+
+    /**
+     * @brief Find the region whose bounds contain a position
+     *
+     * @param position Position in the world
+     * @param currentRegion Region to keep if the position is within the hysteresis of a border
+     * @return uint32_t ID of the region that should own the position
+     */
+    uint32_t regionForPosition(const netcode::math::MyVec3& position, uint32_t currentRegion) const;
+
+    /**
+     * @brief Get the ID of the region this process owns
+     *
+     * @return uint32_t The region ID
+     */
+    uint32_t getRegionId() const { return region_.regionId; }
+
+    /**
+     * @brief Get the number of ticks that started after their deadline had already passed
+     *
+     * @return uint64_t The overrun count
+     */
+    uint64_t getTickOverruns() const { return tickOverruns_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Authoritative entity of this region
+     */
+    struct OwnedEntity {
+        std::shared_ptr<NetworkedEntity> entity;
+        uint32_t lastProcessedInputSequence = 0;
+        netcode::math::MyVec3 lastInput;
+        std::chrono::steady_clock::time_point lastInputTime;
+        bool lastWasPredicted = false;
+        packets::PlayerStatePacket lastSent{};
+        bool hasClient = false;
+        sockaddr_in clientAddr{};
+    };
+
+    /**
+     * @brief Entity being handed off, waiting for the new owner's acknowledgement
+     */
+    struct PendingHandoff {
+        packets::ClusterMessage message{};
+        uint32_t targetRegion = 0;
+        std::chrono::steady_clock::time_point lastSendTime;
+    };
+
+    /**
+     * @brief Entity of another region mirrored here
+     */
+    struct Ghost {
+        packets::PlayerStatePacket state{};
+        uint32_t ownerRegion = 0;
+        std::chrono::steady_clock::time_point lastUpdate;
+    };
+
+    RegionConfig region_;                    ///< The region owned by this process
+    ClusterConfig config_;                   ///< Layout of the whole cluster
+    std::shared_ptr<ISettings> settings_;    ///< Settings dependency
+    EntityFactory entityFactory_;            ///< Creates entities taken over from other regions
+
+    int clientSocketFd_ = -1;                ///< Socket facing the clients
+    int peerSocketFd_ = -1;                  ///< Socket for cluster messages
+    std::atomic<bool> running_;              ///< Flag indicating if the region is running
+    std::atomic<uint64_t> tickOverruns_{0};  ///< Late ticks, see getTickOverruns()
+    std::thread regionThread_;               ///< Thread running the region
+
+    std::mutex entityMutex_;                                   ///< Protects all entity and session state
+    std::map<uint32_t, OwnedEntity> owned_;                    ///< Entities this region has authority over
+    std::map<uint32_t, PendingHandoff> pendingHandoffs_;       ///< Handoffs not acknowledged yet
+    std::map<uint32_t, uint32_t> handedOffTo_;                 ///< Region each handed off entity went to
+    std::map<uint32_t, Ghost> ghosts_;                         ///< Entities mirrored from other regions
+    std::unordered_map<uint32_t, sockaddr_in> sessions_;       ///< Clients connected to this region
+    std::vector<packets::TimestampedPlayerMovementRequest> pendingInputs_; ///< Inputs waiting for their delivery time
+
+    /**
+     * @brief Main loop of the region thread
+     */
+    void run();
+
+    /**
+     * @brief Read all pending client datagrams
+     */
+    void receiveClientPackets();
+
+    /**
+     * @brief Read all pending cluster messages
+     */
+    void receivePeerMessages();
+
+    /**
+     * @brief Apply inputs, hand off, mirror ghosts and send states to clients
+     */
+    void tick();
+
+    /**
+     * @brief Apply a client input to an owned entity, or forward it to the new owner
+     *
+     * @param timestampedRequest The input with the client's address
+     */
+    void applyInput(const packets::TimestampedPlayerMovementRequest& timestampedRequest);
+
+    /**
+     * @brief Take over an entity handed off by another region
+     *
+     * @param message The handoff message
+     */
+    void acceptHandoff(const packets::ClusterMessage& message);
+
+    /**
+     * @brief Create a player joining through this region in the middle of it
+     *
+     * @param playerId ID of the player
+     * @return The owned entity, or owned_.end() if the factory created none
+     */
+    std::map<uint32_t, OwnedEntity>::iterator spawnPlayer(uint32_t playerId);
+
+    /**
+     * @brief Send a client the state of every entity this region knows about
+     *
+     * @param clientAddr Address of the client
+     */
+    void sendInitialSnapshot(const sockaddr_in& clientAddr);
+
+    /**
+     * @brief Build the replicated state of an owned entity
+     *
+     * @param playerId ID of the player
+     * @param owned The owned entity
+     * @return The state packet
+     */
+    packets::PlayerStatePacket makeStatePacket(uint32_t playerId, const OwnedEntity& owned) const;
+
+    /**
+     * @brief Send a cluster message to another region
+     *
+     * @param regionId ID of the receiving region
+     * @param message The message to send
+     */
+    void sendToRegion(uint32_t regionId, const packets::ClusterMessage& message);
+
+    /**
+     * @brief Send a state packet to every client of this region
+     *
+     * @param packet The state to send
+     */
+    void sendStateToClients(const packets::PlayerStatePacket& packet);
+
+    /**
+     * @brief Find a region's configuration
+     *
+     * @param regionId ID of the region
+     * @return Pointer to the region, or nullptr if unknown
+     */
+    const RegionConfig* findRegion(uint32_t regionId) const;
+};
+
+} // namespace netcode
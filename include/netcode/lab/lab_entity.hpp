@@ -0,0 +1,57 @@
+#pragma once
+
+#include "netcode/networked_entity.hpp"
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/prediction/error_correction.hpp"
+#include <cstdint>
+
+namespace netcode {
+
+/**
+ * @brief Headless player for running the client and server without a window
+ *
+ * Moves, jumps and falls exactly like the visualization's player, so the
+ * lab measures the same prediction and correction behaviour as the GUI.
+ */
+class LabEntity : public NetworkedEntity {
+public:
+    /**
+     * @brief Construct a new LabEntity object
+     *
+     * @param id Player ID
+     * @param position Initial position
+     */
+    LabEntity(uint32_t id, const netcode::math::MyVec3& position);
+
+    void move(const netcode::math::MyVec3& direction) override;
+    void update() override;
+    void jump() override;
+    void updateRenderPosition(float deltaTime) override;
+    void snapSimulationState(const netcode::math::MyVec3& position, bool isJumping = false,
+                             const netcode::math::MyVec3& velocity = {}) override;
+    void initiateVisualBlend() override;
+
+    netcode::math::MyVec3 getPosition() const override { return position_; }
+    netcode::math::MyVec3 getRenderPosition() const override { return renderPosition_; }
+    void setPosition(const netcode::math::MyVec3& pos) override { position_ = pos; }
+    netcode::math::MyVec3 getVelocity() const override { return velocity_; }
+    bool isJumping() const override { return isJumping_; }
+    uint32_t getId() const override { return id_; }
+    float getMoveSpeed() const override { return MOVE_SPEED; }
+
+private:
+    static constexpr float MOVE_SPEED = 0.2f;
+    static constexpr float JUMP_FORCE = 1.5f;
+    static constexpr float GRAVITY = 0.2f;
+    static constexpr float GROUND_LEVEL = 1.0f;
+
+    uint32_t id_;
+    netcode::math::MyVec3 position_;
+    netcode::math::MyVec3 velocity_;
+    bool isJumping_ = false;
+    bool movedThisStep_ = false;
+    netcode::math::MyVec3 renderPosition_;
+    VisualErrorOffset errorOffset_;
+};
+
+} // namespace netcode
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "netcode/lab/link_emulator.hpp"
+#include "netcode/trace/input_trace.hpp"
+#include <cstdint>
+#include <memory>
+
+namespace netcode {
+
+/**
+ * @brief Network conditions and netcode settings of one lab run
+ */
+struct LabCellConfig {
+    // Conditions of both directions of every client's link
+    LinkConditions link;
+
+    // Remote player interpolation delay (in milliseconds)
+    uint32_t interpolationDelayMs = 50;
+
+    // Distance between predicted and server position that triggers a correction
+    float reconciliationThreshold = 0.5f;
+
+    // Inputs each client sends per second, ignored when a trace drives the players
+    float sendRate = 60.0f;
+
+    // Predict the local player, otherwise it waits for the server
+    bool predictionEnabled = true;
+
+    // Connected clients, each controls one player
+    uint32_t players = 2;
+
+    // Length of the run (in milliseconds)
+    uint32_t durationMs = 3000;
+
+    // Client and server updates per second
+    float tickRate = 60.0f;
+    
+    // Server applies one buffered input per player and tick, clients time their inputs to its buffer depth
+    bool inputBuffering = false;
+
+    // Shard threads of a ShardedServer serving the clients, 0 runs the single-threaded Server
+    uint32_t serverShards = 0;
+
+    // Server port, emulators and clients use the ports above it
+    int basePort = 7600;
+
+    // Recorded inputs to replay, trace players are assigned to the clients in ID order; scripted movement if null
+    std::shared_ptr<const InputTrace> trace;
+};
+
+/**
+ * @brief Quality and cost measured in one lab run
+ */
+struct LabCellResult {
+    double upstreamBytesPerSecond = 0.0;    ///< Client to server traffic per client
+    double downstreamBytesPerSecond = 0.0;  ///< Server to client traffic per client
+    double cpuUsPerTick = 0.0;              ///< Process CPU time per tick without the link emulators (in microseconds)
+    double meanPredictionError = 0.0;       ///< Mean distance a correction moved the local player
+    float maxPredictionError = 0.0f;        ///< Largest distance a correction moved the local player
+    uint64_t corrections = 0;               ///< Corrections of the local players, all clients together
+    double interpolationStarvation = 0.0;   ///< Share of remote player updates that ran out of snapshots
+    uint64_t packetsDropped = 0;            ///< Packets the emulated links lost
+    uint64_t ticks = 0;                     ///< Ticks run
+    uint64_t inputUnderruns = 0;            ///< Player ticks the server's input buffer ran dry, with input buffering
+    uint64_t tickOverruns = 0;              ///< Ticks that ended past the next tick's deadline
+    double tickJitterP99Us = 0.0;           ///< 99th percentile of how late on-time ticks started (in microseconds)
+};
+
+/**
+ * @brief Run the client and server stack over emulated links and measure it
+ *
+ * Starts a server and one client per player on localhost, each client behind
+ * its own LinkEmulator, drives the players with scripted or recorded inputs
+ * for the configured duration and collects traffic, CPU and correction
+ * counters. Runs in real time and blocks until done.
+ *
+ * @param config The conditions and settings
+ * @return LabCellResult The measurements, all zero if the stack could not be started
+ */
+LabCellResult runLabCell(const LabCellConfig& config);
+
+} // namespace netcode
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Conditions of one direction of an emulated link
+ */
+struct LinkConditions {
+    // One-way delay (in milliseconds)
+    uint32_t delayMs = 0;
+
+    // Largest random deviation from the delay in either direction (in milliseconds), reorders packets
+    uint32_t jitterMs = 0;
+
+    // Share of packets dropped (in percent)
+    float lossPercent = 0.0f;
+};
+
+/**
+ * @brief Configuration of a link emulator
+ */
+struct LinkEmulatorConfig {
+    // Port the client sends to instead of the server's
+    int listenPort = 7500;
+
+    // Server the packets are forwarded to
+    std::string serverIp = "127.0.0.1";
+    int serverPort = 7000;
+
+    // Client to server direction
+    LinkConditions upstream;
+
+    // Server to client direction
+    LinkConditions downstream;
+
+    // Seed of the loss and jitter draws, equal seeds give equal runs for equal traffic
+    uint32_t seed = 1;
+};
+
+/**
+ * @brief Traffic counters of a link emulator
+ */
+struct LinkEmulatorStats {
+    uint64_t upstreamPackets = 0;    ///< Packets delivered to the server
+    uint64_t upstreamBytes = 0;      ///< Bytes delivered to the server
+    uint64_t downstreamPackets = 0;  ///< Packets delivered to the client
+    uint64_t downstreamBytes = 0;    ///< Bytes delivered to the client
+    uint64_t packetsDropped = 0;     ///< Packets lost in either direction
+    std::chrono::microseconds cpuTime{0}; ///< CPU time used by the emulator's thread
+};
+
+/**
+ * @brief UDP proxy between one client and the server that delays, jitters and drops packets
+ *
+ * The client is pointed at the emulator's port; the server sees the
+ * emulator's forwarding socket as the client's address. Unlike the delay
+ * settings, which only hold packets back, the emulator also loses and
+ * reorders them, so the whole stack is exercised as on a real network.
+ */
+class LinkEmulator {
+public:
+    /**
+     * @brief Construct a new LinkEmulator object
+     *
+     * @param config Emulator configuration
+     */
+    explicit LinkEmulator(const LinkEmulatorConfig& config);
+
+    /**
+     * @brief Destroy the LinkEmulator object, stopping it
+     */
+    ~LinkEmulator();
+
+    LinkEmulator(const LinkEmulator&) = delete;
+    LinkEmulator& operator=(const LinkEmulator&) = delete;
+
+    /**
+     * @brief Open the sockets and start forwarding
+     *
+     * @return True if the emulator is running
+     */
+    bool start();
+
+    /**
+     * @brief Stop forwarding and close the sockets, packets in flight are lost
+     */
+    void stop();
+
+    /**
+     * @brief Get the traffic counters
+     *
+     * @return LinkEmulatorStats The counters
+     */
+    LinkEmulatorStats getStats() const;
+
+private:
+    /**
+     * @brief Packet held back until its delivery time
+     */
+    struct DelayedPacket {
+        std::chrono::steady_clock::time_point due; ///< Delivery time
+        uint64_t order = 0;                        ///< Arrival order, breaks ties between equal times
+        bool upstream = false;                     ///< Direction
+        std::vector<char> data;                    ///< Datagram
+
+        bool operator>(const DelayedPacket& other) const {
+            return due != other.due ? due > other.due : order > other.order;
+        }
+    };
+
+    LinkEmulatorConfig config_;
+    int clientSocketFd_ = -1;
+    int serverSocketFd_ = -1;
+    sockaddr_in serverAddr_;
+    sockaddr_in clientAddr_;
+    bool clientKnown_ = false;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::mt19937 random_;
+    uint64_t nextOrder_ = 0;
+    std::priority_queue<DelayedPacket, std::vector<DelayedPacket>, std::greater<DelayedPacket>> inFlight_;
+
+    std::atomic<uint64_t> upstreamPackets_{0};
+    std::atomic<uint64_t> upstreamBytes_{0};
+    std::atomic<uint64_t> downstreamPackets_{0};
+    std::atomic<uint64_t> downstreamBytes_{0};
+    std::atomic<uint64_t> packetsDropped_{0};
+    std::atomic<int64_t> cpuTimeUs_{0};
+
+    /**
+     * @brief Forward packets until stopped
+     */
+    void run();
+
+    /**
+     * @brief Take in every datagram waiting on a socket
+     *
+     * @param socketFd The socket
+     * @param upstream True for the socket facing the client
+     * @param now Current time
+     */
+    void receive(int socketFd, bool upstream, std::chrono::steady_clock::time_point now);
+};
+
+} // namespace netcode
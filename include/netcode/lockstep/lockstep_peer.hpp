@@ -0,0 +1,143 @@
+#pragma once
+
+#include "netcode/lockstep/lockstep_session.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Address of another lockstep peer
+ */
+struct LockstepPeerAddress {
+    uint32_t peerId = 0;          ///< The peer
+    std::string ip = "127.0.0.1"; ///< IPv4 address
+    int port = 0;                 ///< UDP port
+};
+
+/**
+ * @brief Configuration of the UDP transport of a lockstep peer
+ */
+struct LockstepTransportConfig {
+    // Local UDP port
+    int port = 7300;
+
+    // Every other peer that may take part, late joiners included
+    std::vector<LockstepPeerAddress> peers;
+
+    // Turns simulated per second while in step with the other peers
+    float turnRate = 10.0f;
+
+    // Most turns simulated per update while catching up
+    uint32_t maxCatchUpTurns = 64;
+
+    // Time without progress before asking the other peers for missing commands (in milliseconds)
+    uint32_t resendIntervalMs = 100;
+};
+
+/**
+ * @brief Lockstep peer exchanging turns with the other peers over UDP
+ *
+ * Not threaded: call update() from the game loop, the simulation is stepped
+ * on the calling thread. Commands are sent to every configured peer as soon
+ * as their turn closes, so bandwidth only depends on the number of peers and
+ * commands, never on the number of simulated units.
+ */
+class LockstepPeer {
+public:
+    /**
+     * @brief Construct a new LockstepPeer object
+     *
+     * @param config Session configuration
+     * @param transportConfig Transport configuration
+     * @param simulation Simulation to drive, must outlive the peer
+     */
+    LockstepPeer(const LockstepConfig& config, const LockstepTransportConfig& transportConfig,
+                 ILockstepSimulation& simulation);
+
+    /**
+     * @brief Destroy the LockstepPeer object and close the socket
+     */
+    ~LockstepPeer();
+
+    LockstepPeer(const LockstepPeer&) = delete;
+    LockstepPeer& operator=(const LockstepPeer&) = delete;
+
+    /**
+     * @brief Open the socket, a late joiner also asks the host to admit it
+     *
+     * @return True if the socket is ready
+     */
+    bool start();
+
+    /**
+     * @brief Close the socket
+     */
+    void stop();
+
+    /**
+     * @brief Queue a command for the next turn this peer closes
+     *
+     * @param command The command
+     */
+    void submitCommand(const packets::PlayerMovementRequest& command);
+
+    /**
+     * @brief Receive turns, simulate the due ones and send our own
+     *
+     * Simulates at most one turn per turn interval while in step, and up to
+     * maxCatchUpTurns per call while behind the other peers.
+     *
+     * @return size_t Number of turns simulated
+     */
+    size_t update();
+
+    /**
+     * @brief Get the protocol state
+     *
+     * @return LockstepSession& The session
+     */
+    LockstepSession& getSession() { return session_; }
+
+    /**
+     * @brief Get the session and transport statistics
+     *
+     * @return LockstepStats The statistics
+     */
+    LockstepStats getStats() const;
+
+private:
+    LockstepConfig config_;
+    LockstepTransportConfig transportConfig_;
+    LockstepSession session_;
+    int socketFd_ = -1;
+    std::vector<sockaddr_in> peerAddresses_;
+    std::chrono::steady_clock::duration turnInterval_;
+    std::chrono::steady_clock::time_point nextTurnTime_;
+    std::chrono::steady_clock::time_point lastProgressTime_;
+    std::chrono::steady_clock::time_point lastRequestTime_;
+    uint64_t stalledUpdates_ = 0;
+    uint64_t fastForwardTurns_ = 0;
+    uint64_t packetsSent_ = 0;
+    uint64_t bytesSent_ = 0;
+
+    /**
+     * @brief Send a packet, trimmed to the commands it carries
+     *
+     * @param addr Receiver address
+     * @param packet The packet
+     */
+    void send(const sockaddr_in& addr, const packets::LockstepPacket& packet);
+
+    /**
+     * @brief Send a packet to every configured peer
+     *
+     * @param packet The packet
+     */
+    void broadcast(const packets::LockstepPacket& packet);
+};
+
+} // namespace netcode
@@ -0,0 +1,356 @@
+#pragma once
+
+#include "netcode/packets/lockstep_packets.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace netcode {
+
+/**
+ * @brief Deterministic simulation driven by a lockstep session
+ *
+ * Every peer runs its own instance. Given the same commands in the same
+ * turns, all instances must end up in bit-identical states; use integer or
+ * fixed-point math and iterate in a defined order.
+ */
+class ILockstepSimulation {
+public:
+    virtual ~ILockstepSimulation() = default;
+
+    /**
+     * @brief Advance the simulation by one turn
+     *
+     * @param turn The turn, starting at 1
+     * @param commands Commands of all peers for the turn, ordered by peer ID
+     */
+    virtual void step(uint32_t turn, const std::vector<packets::PlayerMovementRequest>& commands) = 0;
+
+    /**
+     * @brief Hash the complete simulation state
+     *
+     * @return uint64_t Checksum compared between peers to detect desyncs
+     */
+    virtual uint64_t checksum() const = 0;
+
+    /**
+     * @brief Serialize the complete simulation state
+     *
+     * @return std::vector<uint8_t> State a late joiner starts from instead of replaying the match
+     */
+    virtual std::vector<uint8_t> saveState() const = 0;
+
+    /**
+     * @brief Replace the simulation state with one serialized by another peer
+     *
+     * @param state State returned by saveState()
+     * @return True if the state could be read
+     */
+    virtual bool loadState(const std::vector<uint8_t>& state) = 0;
+};
+
+/**
+ * @brief Configuration of a lockstep session
+ */
+struct LockstepConfig {
+    // This peer
+    uint32_t peerId = 1;
+
+    // Peers playing from turn 1, a late joiner is not among them
+    std::vector<uint32_t> founders;
+
+    // Founder that admits late joiners
+    uint32_t hostId = 1;
+
+    // Turns between issuing a command and executing it, hides the round trip
+    uint32_t inputDelayTurns = 2;
+
+    // Turns between simulation checksums exchanged to detect desyncs
+    uint32_t checksumInterval = 10;
+
+    // Most turns answered per resend or join request
+    uint32_t maxResendTurns = 32;
+
+    // Turns between checkpoints of the simulation state, 0 keeps the commands of the whole match
+    uint32_t checkpointInterval = 100;
+};
+
+/**
+ * @brief Statistics of a lockstep session
+ */
+struct LockstepStats {
+    uint32_t executedTurn = 0;       ///< Last turn simulated
+    uint64_t checksumsCompared = 0;  ///< Checksums of other peers compared against ours
+    uint64_t desyncs = 0;            ///< Checksums that did not match
+    uint32_t firstDesyncTurn = 0;    ///< Earliest turn a mismatch was found at, 0 if none
+    uint64_t stalledUpdates = 0;     ///< Updates that could not execute a due turn
+    uint64_t fastForwardTurns = 0;   ///< Turns executed to catch up, beyond the regular turn rate
+    uint64_t packetsSent = 0;        ///< Datagrams sent
+    uint64_t bytesSent = 0;          ///< Bytes sent
+};
+
+/**
+ * @brief Lockstep protocol state of one peer, independent of the transport
+ *
+ * Peers exchange only their commands per turn; a turn is simulated once the
+ * commands of every member for it are known, so all peers execute the same
+ * inputs in the same turns. Each time a turn is simulated, the peer closes
+ * the turn inputDelayTurns + 1 ahead and sends the commands queued since,
+ * which gives them time to reach the other peers. Every checksumInterval
+ * turns the peers compare simulation checksums.
+ *
+ * Every checkpointInterval turns the peers note a checkpoint, and the host
+ * keeps a serialized copy of its simulation and the members at that turn.
+ * Commands are dropped once every member simulated them and they lie before
+ * the latest checkpoint, so memory stays bounded however long the match runs.
+ * A late joiner is sent the checkpoint and fast-forwards through the turns
+ * after it. The host admits a joiner by announcing it in one of its own turns; every peer, the joiner included, then expects the
+ * joiner's commands from a fixed later turn on, so membership changes are as
+ * deterministic as the simulation.
+ */
+class LockstepSession {
+public:
+    /**
+     * @brief Construct a new LockstepSession object
+     *
+     * @param config Session configuration
+     * @param simulation Simulation to drive, must outlive the session
+     */
+    LockstepSession(const LockstepConfig& config, ILockstepSimulation& simulation);
+
+    /**
+     * @brief Queue a command for the next turn this peer closes
+     *
+     * @param command The command, its input sequence number is set to the turn
+     */
+    void submitCommand(const packets::PlayerMovementRequest& command);
+
+    /**
+     * @brief Handle a message from another peer
+     *
+     * @param packet The message
+     * @return Packets to send back to the sender only
+     */
+    std::vector<packets::LockstepPacket> receive(const packets::LockstepPacket& packet);
+
+    /**
+     * @brief Simulate the next turns whose commands are complete
+     *
+     * @param maxTurns Most turns to simulate
+     * @return size_t Number of turns simulated
+     */
+    size_t advance(size_t maxTurns = 1);
+
+    /**
+     * @brief Take the packets to send to every other peer
+     *
+     * @return Packets queued since the last call
+     */
+    std::vector<packets::LockstepPacket> takeOutgoing();
+
+    /**
+     * @brief Build a request for the commands of the first turn that is not complete
+     *
+     * @return The request
+     */
+    packets::LockstepPacket makeResendRequest() const;
+
+    /**
+     * @brief Build a late joiner's request to be admitted by the host
+     *
+     * @return The request
+     */
+    packets::LockstepPacket makeJoinRequest() const;
+
+    /**
+     * @brief Check whether this peer takes part in the match
+     *
+     * @return True for founders, and for joiners once their admission was simulated
+     */
+    bool isMember() const { return firstOwnTurn_ != 0; }
+
+    /**
+     * @brief Check whether other peers are more than a turn ahead
+     *
+     * @return True if the peer should simulate faster than the turn rate
+     */
+    bool isBehind() const;
+
+    /**
+     * @brief Get the last simulated turn
+     *
+     * @return uint32_t The turn, 0 before the first
+     */
+    uint32_t getExecutedTurn() const { return stats_.executedTurn; }
+
+    /**
+     * @brief Get the number of turns whose commands are still held
+     *
+     * @return size_t The turn count
+     */
+    size_t getStoredTurnCount() const { return turns_.size(); }
+
+    /**
+     * @brief Get the turn of the latest checkpoint
+     *
+     * @return uint32_t The turn, 0 before the first checkpoint
+     */
+    uint32_t getCheckpointTurn() const { return checkpointTurn_; }
+
+    /**
+     * @brief Get the session statistics
+     *
+     * Transport counters are filled in by the transport.
+     *
+     * @return LockstepStats The statistics
+     */
+    LockstepStats getStats() const { return stats_; }
+
+    /**
+     * @brief Set a callback invoked when another peer's checksum differs from ours
+     *
+     * @param callback Function called with the turn and the other peer's ID
+     */
+    void setDesyncCallback(std::function<void(uint32_t, uint32_t)> callback);
+
+private:
+    /**
+     * @brief Commands of one peer for one turn
+     */
+    struct TurnInput {
+        std::vector<packets::PlayerMovementRequest> commands; ///< The commands
+        uint32_t joiningPeer = 0;                             ///< Peer admitted by the host with the turn
+    };
+
+    /**
+     * @brief Checkpoint a late joiner is receiving
+     */
+    struct IncomingCheckpoint {
+        uint32_t turn = 0;          ///< Turn the checkpoint was taken after
+        uint64_t checksum = 0;      ///< Simulation checksum at the checkpoint
+        std::vector<uint8_t> data;  ///< Bytes received so far
+        std::vector<bool> chunks;   ///< Packets received so far, by position
+        size_t missing = 0;         ///< Packets still missing
+    };
+
+    LockstepConfig config_;
+    ILockstepSimulation& simulation_;
+    LockstepStats stats_;
+
+    // Peers and the first turn their commands are needed for
+    std::map<uint32_t, uint32_t> members_;
+
+    // Commands per turn and peer, from the first turn not every member simulated
+    std::map<uint32_t, std::map<uint32_t, TurnInput>> turns_;
+
+    // Newest turn each other peer is known to have simulated
+    std::map<uint32_t, uint32_t> confirmedTurns_;
+
+    // Turn of the latest checkpoint
+    uint32_t checkpointTurn_ = 0;
+
+    // Members and simulation state serialized after checkpointTurn_, kept by the host only
+    std::vector<uint8_t> checkpoint_;
+
+    // Simulation checksum at checkpointTurn_
+    uint64_t checkpointChecksum_ = 0;
+
+    // Commands up to this turn were dropped
+    uint32_t prunedTurn_ = 0;
+
+    // Checkpoint being received while joining
+    IncomingCheckpoint incoming_;
+
+    // Commands waiting for the next turn this peer closes
+    std::vector<packets::PlayerMovementRequest> pendingCommands_;
+
+    // Late joiners the host announces with its next turns
+    std::vector<uint32_t> pendingJoins_;
+
+    // First turn this peer sends commands for, 0 while not admitted
+    uint32_t firstOwnTurn_ = 0;
+
+    // Next turn this peer closes
+    uint32_t nextOwnTurn_ = 0;
+
+    // Newest turn another peer sent commands for
+    uint32_t newestRemoteTurn_ = 0;
+
+    // Our checksums by turn
+    std::map<uint32_t, uint64_t> checksums_;
+
+    // Checksums of other peers for turns we have not simulated yet, by turn
+    std::multimap<uint32_t, std::pair<uint32_t, uint64_t>> remoteChecksums_;
+
+    // Packets for every other peer
+    std::vector<packets::LockstepPacket> outgoing_;
+
+    // Callback for reporting desyncs
+    std::function<void(uint32_t, uint32_t)> desyncCallback_;
+
+    /**
+     * @brief Close every own turn the input delay allows, sending its commands
+     */
+    void closeDueTurns();
+
+    /**
+     * @brief Check whether every member's commands for a turn are known
+     *
+     * @param turn The turn
+     * @return True if the turn can be simulated
+     */
+    bool isComplete(uint32_t turn) const;
+
+    /**
+     * @brief Compare another peer's checksum against ours
+     *
+     * @param turn Turn the checksum was taken after
+     * @param peerId The other peer
+     * @param checksum The other peer's checksum
+     */
+    void compareChecksum(uint32_t turn, uint32_t peerId, uint64_t checksum);
+
+    /**
+     * @brief Build a turn packet from stored commands
+     *
+     * @param peerId Peer the commands belong to
+     * @param turn The turn
+     * @param input The commands
+     * @return The packet
+     */
+    packets::LockstepPacket makeTurnPacket(uint32_t peerId, uint32_t turn, const TurnInput& input) const;
+
+    /**
+     * @brief Note a checkpoint after the turn just simulated, the host also serializes it
+     */
+    void takeCheckpoint();
+
+    /**
+     * @brief Split the latest checkpoint into packets
+     *
+     * @return The packets
+     */
+    std::vector<packets::LockstepPacket> makeCheckpointPackets() const;
+
+    /**
+     * @brief Store a part of a checkpoint, loading it once complete
+     *
+     * @param packet The part
+     */
+    void receiveCheckpoint(const packets::LockstepPacket& packet);
+
+    /**
+     * @brief Restore members and simulation from a complete checkpoint
+     *
+     * @return True if the checkpoint was loaded
+     */
+    bool loadCheckpoint();
+
+    /**
+     * @brief Drop the commands and checksums of turns every member simulated, up to the latest checkpoint
+     */
+    void prune();
+};
+
+} // namespace netcode
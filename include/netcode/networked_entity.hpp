@@ -42,15 +42,19 @@ public:
      * @brief Snap the entity's simulation state to match server data
      * @param position The authoritative position from the server
      * @param isJumping The jumping state from the server
-     * @param velocityY The Y velocity component from the server (optional)
+     * @param velocity The velocity from the server (optional)
      */
     virtual void snapSimulationState(
         const netcode::math::MyVec3& position, 
         bool isJumping = false, 
-        float velocityY = 0.0f) = 0;
+        const netcode::math::MyVec3& velocity = {}) = 0;
     
     /**
      * @brief Initiate a visual blend from current render position to simulation position
+     * 
+     * Called after the simulation state was corrected. Implementations should keep
+     * the render position where it was and let it converge on the simulation
+     * position, e.g. with a VisualErrorOffset.
      */
     virtual void initiateVisualBlend() = 0;
 
@@ -80,6 +84,12 @@ public:
      */
     virtual netcode::math::MyVec3 getVelocity() const = 0;
 
+    /**
+     * @brief Check if the entity is in the middle of a jump
+     * @return True if the entity is airborne
+     */
+    virtual bool isJumping() const = 0;
+
     // Identity methods
 
     /**
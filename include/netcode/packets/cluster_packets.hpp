@@ -0,0 +1,54 @@
+#pragma once
+#include "netcode/packets/player_state_packet.hpp"
+#include <cstdint>
+#include <chrono>
+#include <netinet/in.h> // For sockaddr_in
+
+namespace netcode::packets {
+
+    /**
+     * @enum ClusterMessageType
+     * @brief Kinds of messages exchanged between region servers of a cluster
+     */
+    enum class ClusterMessageType : uint32_t {
+        GHOST_STATE = 1,     ///< State of an entity near the sender's border, for display only
+        HANDOFF = 2,         ///< Authority over an entity moves to the receiver
+        HANDOFF_ACK = 3,     ///< The receiver has taken over the entity
+        FORWARDED_INPUT = 4  ///< Input that reached the previous owner after a handoff
+    };
+
+    /**
+     * @struct ClusterMessage
+     * @brief Message between region servers over the local peer channel
+     * @details Fixed size so it can be sent as a single datagram; the type selects which fields are used.
+     */
+    struct ClusterMessage {
+        ClusterMessageType type;              ///< Kind of message
+        uint32_t from_region;                 ///< Region that sent the message
+        PlayerStatePacket state;              ///< Entity state (ghost state and handoff)
+        sockaddr_in client_addr;              ///< Address of the entity's client (handoff)
+        bool has_client;                      ///< Whether client_addr is valid (handoff)
+        TimestampedPlayerMovementRequest input; ///< The forwarded input (forwarded input)
+    };
+
+    /**
+     * @struct RedirectPacket
+     * @brief Tells a client to send its inputs to another region server
+     * @details The new region already holds the client's session, so no reconnect is needed
+     */
+    struct RedirectPacket {
+        uint32_t player_id;   ///< Player whose authority moved
+        uint32_t region_id;   ///< Region that now owns the player
+        uint32_t server_ip;   ///< IPv4 address of the new region server, network byte order
+        uint16_t server_port; ///< Client-facing port of the new region server, host byte order
+    };
+
+    /**
+     * @struct TimestampedRedirectPacket
+     * @brief Redirect with timestamp for network delay simulation
+     */
+    struct TimestampedRedirectPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the redirect should be processed
+        RedirectPacket redirect;                         ///< The redirect data
+    };
+}
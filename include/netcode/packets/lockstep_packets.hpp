@@ -0,0 +1,45 @@
+#pragma once
+#include "netcode/packets/player_state_packet.hpp"
+#include <cstdint>
+
+namespace netcode::packets {
+
+    /// Maximum number of commands a peer issues for a single turn
+    constexpr uint32_t MAX_LOCKSTEP_COMMANDS = 8;
+
+    /// Most checkpoint bytes carried by a single packet
+    constexpr uint32_t MAX_LOCKSTEP_CHECKPOINT_BYTES = MAX_LOCKSTEP_COMMANDS * sizeof(PlayerMovementRequest);
+
+    /**
+     * @enum LockstepMessageType
+     * @brief Kinds of messages exchanged between lockstep peers
+     */
+    enum class LockstepMessageType : uint32_t {
+        TURN = 1,           ///< A peer's commands for one turn
+        RESEND_REQUEST = 2, ///< Asks for every peer's commands from a turn on
+        JOIN_REQUEST = 3,   ///< A late joiner asks the host to admit it
+        CHECKPOINT = 4      ///< Part of the host's latest checkpoint, sent to a late joiner
+    };
+
+    /**
+     * @struct LockstepPacket
+     * @brief Message between lockstep peers
+     * @details Peers only exchange inputs; every peer runs the same deterministic
+     * simulation, so the packet size does not depend on the number of units.
+     */
+    struct LockstepPacket {
+        LockstepMessageType type;   ///< Kind of message
+        uint32_t peer_id;           ///< Peer whose commands these are, or the requesting peer
+        uint32_t turn;              ///< Turn the commands execute on, the first turn requested, or the checkpoint turn
+        uint32_t joining_peer;      ///< Peer the host admits with this turn, 0 for none
+        uint32_t checksum_turn;     ///< Turn the checksum was taken after, 0 for none
+        uint64_t checksum;          ///< Simulation checksum of the sender after checksum_turn, or of the checkpoint
+        uint32_t count;             ///< Number of valid commands, or of checkpoint bytes
+        uint32_t offset;            ///< Position of the bytes in the checkpoint, CHECKPOINT only
+        uint32_t total_size;        ///< Size of the whole checkpoint in bytes, CHECKPOINT only
+        union {
+            PlayerMovementRequest commands[MAX_LOCKSTEP_COMMANDS]; ///< The commands, input_sequence_number is the turn
+            uint8_t data[MAX_LOCKSTEP_CHECKPOINT_BYTES];           ///< Checkpoint bytes
+        };
+    };
+}
@@ -8,19 +8,51 @@ namespace netcode::packets {
     /**
      * @struct PlayerStatePacket
      * @brief Represents a player's current state including position and movement
-     * @details Used by server to broadcast player states to all clients
+     * @details Used by server to broadcast player states to all clients. Carries the
+     * full kinematic state so clients can continue a jump arc or extrapolate, and
+     * the input the player is holding so clients can predict remote players.
      */
     struct PlayerStatePacket {
         uint32_t player_id;    ///< Unique identifier for the player
         float x;               ///< X coordinate position
         float y;               ///< Y coordinate position
         float z;               ///< Z coordinate position
+        float velocity_x;      ///< Current velocity along X (per simulation step)
         float velocity_y;      ///< Current vertical velocity (for jumping/falling)
-        bool is_jumping;       ///< Whether player is currently jumping
+        float velocity_z;      ///< Current velocity along Z (per simulation step)
+        bool is_jumping;       ///< Whether player is currently in the air
+        float input_x;         ///< X component of the last movement input applied for this player
+        float input_y;         ///< Y component of the last movement input applied for this player
+        float input_z;         ///< Z component of the last movement input applied for this player
         uint32_t last_processed_input_sequence; ///< Sequence number of the last input that was processed
+        uint32_t state_sequence; ///< Per-entity replication sequence, increases whenever the state changes
         bool wasPredicted;     ///< Whether this state update corresponds to a predicted action
     };
 
+    /// Maximum number of entity acknowledgements carried in a single ack packet
+    constexpr uint32_t MAX_STATE_ACKS = 16;
+
+    /**
+     * @struct StateAck
+     * @brief Acknowledges that a client has received an entity's state
+     * @details A state sequence of zero asks the server to resend the entity
+     */
+    struct StateAck {
+        uint32_t entity_id;      ///< Entity whose state was received
+        uint32_t state_sequence; ///< Latest state sequence received for that entity
+    };
+
+    /**
+     * @struct StateAckPacket
+     * @brief Batch of state acknowledgements from a client
+     * @details Lets the server stop replicating entities the client already has the latest state of
+     */
+    struct StateAckPacket {
+        uint32_t player_id;                ///< Client sending the acknowledgements
+        uint32_t count;                    ///< Number of valid entries
+        StateAck entries[MAX_STATE_ACKS];  ///< The acknowledged entity states
+    };
+
     /**
      * @struct PlayerMovementRequest
      * @brief Represents a player's movement input request
@@ -37,6 +69,31 @@ namespace netcode::packets {
         bool wasPredicted;     ///< Whether this input was predicted on the client side
     };
 
+    /**
+     * @struct InputAckPacket
+     * @brief Tells a client how its inputs are doing in the server's input buffer
+     * @details Sent to each client every server tick while the server buffers inputs. The
+     * client speeds up or slows down its input clock to keep buffer_depth at a small target.
+     */
+    struct InputAckPacket {
+        uint32_t player_id;      ///< Player the buffer belongs to
+        uint32_t server_tick;    ///< Server tick the buffer depth was measured at
+        uint32_t last_processed_input_sequence; ///< Last input the server applied for the player
+        uint32_t buffer_depth;   ///< Inputs waiting in the buffer after this tick
+        uint32_t underruns;      ///< Ticks the buffer ran dry while the client was sending
+        uint32_t catch_up_inputs; ///< Inputs applied early since the player joined because the buffer was too deep
+        uint32_t max_depth;      ///< Depth beyond which inputs are applied early
+    };
+
+    /**
+     * @struct TimestampedInputAckPacket
+     * @brief Input acknowledgement with timestamp for network delay simulation
+     */
+    struct TimestampedInputAckPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the acknowledgement should be processed
+        InputAckPacket input_ack;                        ///< The acknowledgement data
+    };
+
     /**
      * @struct TimestampedPlayerStatePacket
      * @brief Player state packet with timestamp for network delay simulation
@@ -47,6 +104,52 @@ namespace netcode::packets {
         PlayerStatePacket player_state;                  ///< The player state data
     };
 
+    /// Maximum number of entity hashes carried in a single checksum packet
+    constexpr uint32_t MAX_CHECKSUM_ENTRIES = 32;
+
+    /**
+     * @struct EntityChecksum
+     * @brief Hash of one entity's authoritative state at a given state sequence
+     */
+    struct EntityChecksum {
+        uint32_t entity_id;      ///< Entity the hash belongs to
+        uint32_t state_sequence; ///< State sequence the hash was computed for
+        uint64_t hash;           ///< Hash of the entity's state
+    };
+
+    /**
+     * @struct StateChecksumPacket
+     * @brief Periodic checksum of the authoritative world state
+     * @details Sent by the server so clients can detect entities whose state diverged.
+     * Worlds with more entities than fit in one packet are split over several packets
+     * that share the same checksum sequence.
+     */
+    struct StateChecksumPacket {
+        uint32_t checksum_sequence;                    ///< Increases with every checksum round
+        uint32_t entity_count;                         ///< Number of entities in the whole world
+        uint64_t world_checksum;                       ///< XOR of all entity hashes
+        uint32_t count;                                ///< Number of valid entries in this packet
+        EntityChecksum entries[MAX_CHECKSUM_ENTRIES];  ///< Per-entity hashes
+    };
+
+    /**
+     * @struct TimestampedStateChecksumPacket
+     * @brief World checksum with timestamp for network delay simulation
+     */
+    struct TimestampedStateChecksumPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the checksum should be processed
+        StateChecksumPacket checksum;                    ///< The checksum data
+    };
+
+    /**
+     * @struct TimestampedStateAckPacket
+     * @brief State acknowledgements with timestamp for network delay simulation
+     */
+    struct TimestampedStateAckPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the acknowledgements should be processed
+        StateAckPacket state_ack;                        ///< The acknowledgement data
+    };
+
     /**
      * @struct TimestampedPlayerMovementRequest
      * @brief Movement request with timestamp for network delay simulation
@@ -0,0 +1,21 @@
+#pragma once
+#include "netcode/packets/player_state_packet.hpp"
+#include <cstdint>
+
+namespace netcode::packets {
+
+    /// Maximum number of client inputs batched into one relay uplink packet
+    constexpr uint32_t MAX_RELAY_BATCH = 16;
+
+    /**
+     * @struct RelayUplinkPacket
+     * @brief Batch of client inputs forwarded by a relay to the server
+     * @details The relay terminates the client sessions, so the server sees the
+     * relay as a single peer. Each input keeps its original delivery timestamp.
+     */
+    struct RelayUplinkPacket {
+        uint32_t relay_id;                                         ///< Identifies the sending relay
+        uint32_t count;                                            ///< Number of valid inputs
+        TimestampedPlayerMovementRequest inputs[MAX_RELAY_BATCH];  ///< The forwarded inputs
+    };
+}
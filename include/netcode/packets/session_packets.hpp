@@ -0,0 +1,76 @@
+#pragma once
+#include "netcode/packets/player_state_packet.hpp"
+#include <cstdint>
+#include <chrono>
+#include <netinet/in.h> // For sockaddr_in
+
+namespace netcode::packets {
+
+    /**
+     * @struct SessionPacket
+     * @brief Tells a client the token that lets it resume its session from another address
+     * @details Sent on registration and as the answer to a resume request. A rejected
+     * resume carries a zero token, the client then registers again.
+     */
+    struct SessionPacket {
+        uint32_t player_id;       ///< Player owning the session
+        uint32_t grace_period_ms; ///< How long the session survives without hearing from the client
+        uint64_t token;           ///< Secret the client presents to resume, zero if rejected
+        uint32_t last_processed_input_sequence; ///< Last input the server processed for the player
+        bool resumed;             ///< Whether this answers an accepted resume request
+    };
+
+    /**
+     * @struct TimestampedSessionPacket
+     * @brief Session packet with timestamp for network delay simulation
+     */
+    struct TimestampedSessionPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the packet should be processed
+        SessionPacket session;                           ///< The session data
+    };
+
+    /**
+     * @struct ResumeRequestPacket
+     * @brief Asks the server to move a session to the address the request came from
+     */
+    struct ResumeRequestPacket {
+        uint32_t player_id;  ///< Player owning the session
+        uint64_t token;      ///< Token received with the session
+        uint32_t last_input_sequence; ///< Last input sequence the client sent
+    };
+
+    /**
+     * @struct TimestampedResumeRequestPacket
+     * @brief Resume request with timestamp for network delay simulation
+     */
+    struct TimestampedResumeRequestPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the request should be processed
+        ResumeRequestPacket resume_request;              ///< The request data
+        sockaddr_in clientAddr;                          ///< The new address of the client
+    };
+
+    /// Maximum number of entity states carried in one catch-up packet
+    constexpr uint32_t MAX_CATCH_UP_ENTRIES = 16;
+
+    /**
+     * @struct CatchUpPacket
+     * @brief Latest state of every entity, sent to a client that resumed its session
+     * @details Split into parts when the world does not fit into one datagram
+     */
+    struct CatchUpPacket {
+        uint32_t player_id;                          ///< Player that resumed
+        uint32_t part;                               ///< Index of this part
+        uint32_t part_count;                         ///< Number of parts in the snapshot
+        uint32_t count;                              ///< Number of valid entries
+        PlayerStatePacket entries[MAX_CATCH_UP_ENTRIES]; ///< The entity states
+    };
+
+    /**
+     * @struct TimestampedCatchUpPacket
+     * @brief Catch-up snapshot part with timestamp for network delay simulation
+     */
+    struct TimestampedCatchUpPacket {
+        std::chrono::steady_clock::time_point timestamp; ///< When the snapshot should be processed
+        CatchUpPacket catch_up;                          ///< The snapshot part
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+
+namespace netcode::packets {
+
+    /// Maximum number of entity states carried in a single spectator frame packet
+    constexpr uint32_t MAX_SPECTATOR_ENTITIES = 24;
+
+    /// Marks a datagram as a spectator subscription
+    constexpr uint32_t SPECTATOR_SUBSCRIBE_MAGIC = 0x53504543; // "SPEC"
+
+    /**
+     * @struct SpectatorEntityState
+     * @brief Compact entity state for spectators
+     * @details Spectators only render, so input and acknowledgement fields are left out
+     */
+    struct SpectatorEntityState {
+        uint32_t player_id;      ///< Entity the state belongs to
+        float x;                 ///< X coordinate position
+        float y;                 ///< Y coordinate position
+        float z;                 ///< Z coordinate position
+        float velocity_x;        ///< Current velocity along X (per simulation step)
+        float velocity_y;        ///< Current vertical velocity
+        float velocity_z;        ///< Current velocity along Z (per simulation step)
+        uint32_t state_sequence; ///< Replication sequence of the state on the server
+        bool is_jumping;         ///< Whether the entity is in the air
+    };
+
+    /**
+     * @struct SpectatorFramePacket
+     * @brief Part of a delayed spectator stream frame
+     * @details A keyframe carries every entity, a delta frame only the entities
+     * that changed since base_frame. Frames with more entities than fit into one
+     * datagram are split into parts sharing the frame number. The packet is
+     * encoded once and sent unchanged to every spectator and relay.
+     */
+    struct SpectatorFramePacket {
+        uint32_t frame_number;    ///< Frame this part belongs to
+        uint32_t base_frame;      ///< Frame a delta applies to, equal to frame_number for keyframes
+        uint32_t capture_time_ms; ///< When the frame was captured, in milliseconds since the stream started
+        uint16_t part;            ///< Index of this part within the frame
+        uint16_t part_count;      ///< Number of parts the frame was split into
+        uint32_t count;           ///< Number of valid entity states in this part
+        bool keyframe;            ///< Whether the frame carries the full world
+        SpectatorEntityState entities[MAX_SPECTATOR_ENTITIES]; ///< The entity states
+    };
+
+    /**
+     * @struct SpectatorSubscribePacket
+     * @brief Subscribes to, or keeps alive, a spectator stream
+     * @details Sent periodically by spectators and relays; subscriptions that
+     * are not refreshed expire.
+     */
+    struct SpectatorSubscribePacket {
+        uint32_t magic;        ///< Always SPECTATOR_SUBSCRIBE_MAGIC
+        uint32_t spectator_id; ///< Identifies the spectator, for logging only
+        bool unsubscribe;      ///< Whether the spectator leaves the stream
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "netcode/networked_entity.hpp"
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/prediction/error_correction.hpp"
+#include <cstdint>
+
+namespace netcode {
+
+/**
+ * @brief Physical properties of a prop
+ *
+ * Velocities and gravity are per simulation step, like the player's.
+ */
+struct PropConfig {
+    // Radius of the prop's bounding sphere
+    float radius = 0.5f;
+
+    // Mass, used to split collision impulses between props
+    float mass = 1.0f;
+
+    // Fraction of the vertical speed kept when bouncing off the ground
+    float restitution = 0.4f;
+
+    // Fraction of the horizontal speed lost per step while on the ground
+    float friction = 0.08f;
+
+    // Downwards acceleration per step
+    float gravity = 0.02f;
+
+    // Height of the ground the prop rests on
+    float groundLevel = 0.0f;
+
+    // Props slower than this per step count as resting
+    float sleepSpeed = 0.002f;
+
+    // Steps a prop has to rest before it falls asleep
+    uint32_t sleepSteps = 30;
+};
+
+/**
+ * @brief Server-simulated rigid body such as a box or a ball
+ *
+ * Props integrate gravity, bounce and slide on the ground and fall asleep
+ * once they have rested for a while. A sleeping prop is not simulated and its
+ * state does not change, so it is not replicated until something wakes it.
+ * On clients the same class is only driven by server states.
+ */
+class Prop : public NetworkedEntity {
+public:
+    /**
+     * @brief Construct a new Prop object
+     *
+     * @param id Entity ID of the prop, must not collide with player IDs
+     * @param position Initial position
+     * @param config Physical properties
+     */
+    Prop(uint32_t id, const netcode::math::MyVec3& position, const PropConfig& config = PropConfig());
+
+    /**
+     * @brief Push the prop, waking it up
+     * @param direction Velocity change per step
+     */
+    void move(const netcode::math::MyVec3& direction) override { applyImpulse(direction); }
+
+    /**
+     * @brief Advance the prop by one simulation step
+     */
+    void update() override;
+
+    /**
+     * @brief Throw the prop upwards
+     */
+    void jump() override;
+
+    void updateRenderPosition(float deltaTime) override;
+    void snapSimulationState(const netcode::math::MyVec3& position, bool isJumping = false,
+                             const netcode::math::MyVec3& velocity = {}) override;
+    void initiateVisualBlend() override;
+
+    netcode::math::MyVec3 getPosition() const override { return position_; }
+    netcode::math::MyVec3 getRenderPosition() const override { return renderPosition_; }
+    void setPosition(const netcode::math::MyVec3& pos) override;
+    netcode::math::MyVec3 getVelocity() const override { return velocity_; }
+    bool isJumping() const override { return !onGround_; }
+    uint32_t getId() const override { return id_; }
+    float getMoveSpeed() const override { return 0.0f; }
+
+    /**
+     * @brief Change the prop's velocity and wake it up
+     * @param impulse Velocity change per step
+     */
+    void applyImpulse(const netcode::math::MyVec3& impulse);
+
+    /**
+     * @brief Set the prop's velocity without waking it
+     * @param velocity New velocity per step
+     */
+    void setVelocity(const netcode::math::MyVec3& velocity) { velocity_ = velocity; }
+
+    /**
+     * @brief Wake the prop up so it is simulated again
+     */
+    void wake();
+
+    /**
+     * @brief Check whether the prop is asleep
+     * @return True if the prop is resting and not simulated
+     */
+    bool isSleeping() const { return sleeping_; }
+
+    /**
+     * @brief Get the prop's physical properties
+     * @return The prop configuration
+     */
+    const PropConfig& getConfig() const { return config_; }
+
+private:
+    uint32_t id_;                          ///< Entity ID of the prop
+    PropConfig config_;                    ///< Physical properties
+    netcode::math::MyVec3 position_;       ///< Simulation position
+    netcode::math::MyVec3 renderPosition_; ///< Position shown on screen
+    netcode::math::MyVec3 velocity_;       ///< Velocity per step
+    VisualErrorOffset errorOffset_;        ///< Remaining visual correction error
+    bool onGround_ = false;                ///< Whether the prop touches the ground
+    bool sleeping_ = false;                ///< Whether the prop is asleep
+    uint32_t restingSteps_ = 0;            ///< Consecutive steps spent resting
+};
+
+} // namespace netcode
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "netcode/physics/prop.hpp"
+#include "netcode/math/my_vec3.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace netcode {
+
+/**
+ * @brief Configuration of the server's prop simulation and replication
+ */
+struct PropWorldConfig {
+    // Simulation steps per second
+    float stepRate = 60.0f;
+
+    // Most props replicated per server tick, the rest wait by priority
+    uint32_t maxUpdatesPerTick = 32;
+
+    // Radius of a player for pushing props
+    float playerRadius = 0.5f;
+
+    // Velocity per step given to a prop a player walks into
+    float pushImpulse = 0.1f;
+
+    // Upper bound on steps per call, so a long frame does not stall the server
+    uint32_t maxStepsPerUpdate = 8;
+};
+
+/**
+ * @brief Statistics of the prop simulation
+ */
+struct PropWorldStats {
+    size_t propCount = 0;        ///< Props in the world
+    size_t awakeCount = 0;       ///< Props currently simulated
+    size_t pendingUpdates = 0;   ///< Changed props waiting for replication
+    uint64_t stepsSimulated = 0; ///< Simulation steps run
+};
+
+/**
+ * @brief Simulates props and decides which of them to replicate
+ *
+ * Only awake props are simulated and collide; sleeping props are woken by
+ * players walking into them or by awake props hitting them. Props that moved
+ * are queued for replication and sent in order of an accumulated priority
+ * that grows with waiting time and speed, within a per-tick budget, so
+ * hundreds of props share a fixed bandwidth and none of them starves.
+ */
+class PropWorld {
+public:
+    /**
+     * @brief Construct a new PropWorld object
+     *
+     * @param config Simulation and replication configuration
+     */
+    explicit PropWorld(const PropWorldConfig& config = PropWorldConfig());
+
+    /**
+     * @brief Change the simulation and replication configuration
+     *
+     * @param config The new configuration
+     */
+    void setConfig(const PropWorldConfig& config) { config_ = config; }
+
+    /**
+     * @brief Add a prop to the world
+     *
+     * @param prop The prop, its ID must be unique among props and players
+     */
+    void addProp(std::shared_ptr<Prop> prop);
+
+    /**
+     * @brief Find a prop
+     *
+     * @param propId ID of the prop
+     * @return The prop, or nullptr if unknown
+     */
+    std::shared_ptr<Prop> getProp(uint32_t propId) const;
+
+    /**
+     * @brief Advance the simulation by a frame's worth of fixed steps
+     *
+     * @param deltaTime Time since the last call in seconds
+     * @param playerPositions Positions of all players, for pushing props
+     * @return Number of steps simulated
+     */
+    uint32_t update(float deltaTime, const std::vector<netcode::math::MyVec3>& playerPositions);
+
+    /**
+     * @brief Take the changed props to replicate this tick
+     *
+     * @return Up to maxUpdatesPerTick props, highest priority first
+     */
+    std::vector<std::shared_ptr<Prop>> selectForReplication();
+
+    /**
+     * @brief Update every prop's render position
+     *
+     * @param deltaTime Time since the last call in seconds
+     */
+    void updateRenderPositions(float deltaTime);
+
+    /**
+     * @brief Get the simulation statistics
+     *
+     * @return PropWorldStats Current statistics
+     */
+    PropWorldStats getStats() const;
+
+private:
+    /**
+     * @brief Simulation and replication bookkeeping of a prop
+     */
+    struct PropEntry {
+        std::shared_ptr<Prop> prop;
+        bool dirty = true;     ///< Whether the prop changed since it was last replicated
+        float priority = 0.0f; ///< Grows while the prop waits for replication
+    };
+
+    PropWorldConfig config_;               ///< Simulation and replication configuration
+    std::map<uint32_t, PropEntry> props_;  ///< All props by ID
+    float accumulator_ = 0.0f;             ///< Simulation time not yet stepped, in seconds
+    uint64_t stepsSimulated_ = 0;          ///< Simulation steps run
+
+    /**
+     * @brief Run a single simulation step
+     *
+     * @param playerPositions Positions of all players
+     */
+    void step(const std::vector<netcode::math::MyVec3>& playerPositions);
+
+    /**
+     * @brief Separate two overlapping props and exchange their momentum
+     *
+     * @param a First prop
+     * @param b Second prop
+     */
+    void resolveCollision(Prop& a, Prop& b);
+};
+
+} // namespace netcode
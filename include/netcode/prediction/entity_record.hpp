@@ -0,0 +1,163 @@
+#pragma once
+
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/networked_entity.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace netcode {
+
+/**
+ * @brief Represents a snapshot of an entity's state at a point in time
+ */
+struct EntitySnapshot {
+    uint32_t entityId;
+    netcode::math::MyVec3 position;
+    netcode::math::MyVec3 velocity;
+    bool isJumping;
+    std::chrono::steady_clock::time_point timestamp;
+    uint32_t sequenceNumber; // Used for reconciliation
+
+    // Comparison operator for sorting
+    bool operator<(const EntitySnapshot& other) const {
+        return sequenceNumber < other.sequenceNumber;
+    }
+};
+
+/**
+ * @brief Input state for a player at a point in time
+ */
+struct InputSnapshot {
+    uint32_t playerId;
+    netcode::math::MyVec3 movement;
+    bool isJumping;
+    std::chrono::steady_clock::time_point timestamp;
+    uint32_t sequenceNumber;
+
+    bool operator<(const InputSnapshot& other) const {
+        return sequenceNumber < other.sequenceNumber;
+    }
+};
+
+/**
+ * @brief Non-owning, generation-checked reference to an entity's record
+ *
+ * A handle stays cheap to copy and never keeps the entity alive. Once the
+ * entity is released its slot's generation moves on, so an old handle
+ * resolves to nothing instead of to whichever entity reuses the slot.
+ */
+struct EntityHandle {
+    uint32_t index = UINT32_MAX;  ///< Slot in the record table
+    uint32_t generation = 0;      ///< Generation of the slot the handle was issued for
+
+    bool operator==(const EntityHandle& other) const = default;
+};
+
+/// Handle that refers to no record
+constexpr EntityHandle INVALID_ENTITY_HANDLE{};
+
+/**
+ * @brief Server state a pending correction rewinds the entity to
+ */
+struct PendingCorrection {
+    netcode::math::MyVec3 position;  ///< Server position
+    netcode::math::MyVec3 velocity;  ///< Server velocity
+    uint32_t serverSequence = 0;     ///< Last input the server processed
+    bool isJumping = false;          ///< Server jumping state
+    bool active = false;             ///< Whether the correction still has to be applied
+};
+
+/**
+ * @brief Everything the client-side netcode keeps about one entity
+ *
+ * Snapshots, inputs, interpolation clock and pending correction live
+ * together, so updating an entity touches one record instead of a lookup
+ * per subsystem.
+ */
+struct EntityRecord {
+    uint32_t entityId = 0;                              ///< ID of the entity
+    uint32_t generation = 0;                            ///< Bumped every time the slot is released
+    std::shared_ptr<NetworkedEntity> entity;            ///< The entity, held from registration until release
+    std::vector<EntitySnapshot> snapshots;              ///< State history, ordered by sequence number
+    std::vector<InputSnapshot> inputs;                  ///< Input history, ordered by sequence number
+    std::chrono::steady_clock::time_point renderTime;   ///< Interpolation clock, behind real time by the interpolation delay
+    bool renderTimeStarted = false;                     ///< Whether renderTime has been started
+    PendingCorrection correction;                       ///< Reconciliation waiting for the next update
+};
+
+/**
+ * @brief Dense table of entity records shared by the prediction subsystems
+ *
+ * Records are stored contiguously and addressed by handle; an entity ID is
+ * turned into a handle with one hash lookup. Released slots are reused for
+ * new entities under a new generation. References to records are
+ * invalidated when a new entity is added, handles are not.
+ */
+class EntityRecordTable {
+public:
+    /**
+     * @brief Get the handle of an entity's record, adding the record if needed
+     * @param entityId The entity ID
+     * @return The handle
+     */
+    EntityHandle acquire(uint32_t entityId);
+
+    /**
+     * @brief Get the handle of an entity's record
+     * @param entityId The entity ID
+     * @return The handle, INVALID_ENTITY_HANDLE if the entity has no record
+     */
+    EntityHandle find(uint32_t entityId) const;
+
+    /**
+     * @brief Release an entity's record, its handles stop resolving
+     * @param entityId The entity ID
+     * @return True if the entity had a record
+     */
+    bool release(uint32_t entityId);
+
+    /**
+     * @brief Get a record by handle
+     * @param handle A handle returned by acquire() or find()
+     * @return The record, nullptr for an invalid or released handle
+     */
+    EntityRecord* get(EntityHandle handle);
+    const EntityRecord* get(EntityHandle handle) const;
+
+    /**
+     * @brief Get an entity's record, adding it if needed
+     * @param entityId The entity ID
+     * @return The record
+     */
+    EntityRecord& record(uint32_t entityId) { return records_[acquire(entityId).index]; }
+
+    /**
+     * @brief Get an entity's record without adding it
+     * @param entityId The entity ID
+     * @return The record, nullptr if the entity has no record
+     */
+    const EntityRecord* findRecord(uint32_t entityId) const { return get(find(entityId)); }
+    EntityRecord* findRecord(uint32_t entityId) { return get(find(entityId)); }
+
+    /**
+     * @brief Get the number of entities with a record
+     * @return The record count
+     */
+    size_t size() const { return handles_.size(); }
+
+    // Iteration also visits released slots, they hold no entity and no state
+    std::vector<EntityRecord>::iterator begin() { return records_.begin(); }
+    std::vector<EntityRecord>::iterator end() { return records_.end(); }
+    std::vector<EntityRecord>::const_iterator begin() const { return records_.begin(); }
+    std::vector<EntityRecord>::const_iterator end() const { return records_.end(); }
+
+private:
+    std::vector<EntityRecord> records_;
+    std::unordered_map<uint32_t, EntityHandle> handles_;
+    std::vector<uint32_t> freeSlots_;
+};
+
+} // namespace netcode
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "netcode/math/my_vec3.hpp"
+
+namespace netcode {
+
+/**
+ * @brief Configuration for smoothing visual corrections
+ */
+struct ErrorCorrectionConfig {
+    // Time in seconds for a visual error to decay to half its size
+    float halfLife = 0.08f;
+
+    // Errors larger than this distance are snapped instead of smoothed
+    float snapDistance = 3.0f;
+
+    // Errors smaller than this distance are treated as fully converged
+    float convergenceDistance = 0.001f;
+};
+
+/**
+ * @brief Decaying render-space error offset for a single entity
+ *
+ * When the simulation state of an entity is corrected, the simulation jumps to
+ * the corrected state immediately and the difference to what was on screen is
+ * stored as an offset. The render position is the simulation position plus this
+ * offset, and the offset decays exponentially towards zero. Corrections are
+ * therefore cheap and never produce visible pops, no matter how often they occur.
+ */
+class VisualErrorOffset {
+public:
+    /**
+     * @brief Constructor
+     * @param config Configuration for the error correction
+     */
+    explicit VisualErrorOffset(const ErrorCorrectionConfig& config = ErrorCorrectionConfig());
+
+    /**
+     * @brief Capture the difference between the displayed and the simulated position
+     *
+     * Should be called after the simulation state has been corrected. Errors
+     * larger than the snap distance are discarded so the entity snaps.
+     *
+     * @param renderPosition The position currently shown on screen
+     * @param simulationPosition The corrected simulation position
+     */
+    void capture(const netcode::math::MyVec3& renderPosition, const netcode::math::MyVec3& simulationPosition);
+
+    /**
+     * @brief Let the offset converge towards zero
+     * @param deltaTime Time since last update in seconds
+     */
+    void decay(float deltaTime);
+
+    /**
+     * @brief Get the current offset to add to the simulation position
+     * @return The current render-space offset
+     */
+    const netcode::math::MyVec3& get() const { return offset_; }
+
+    /**
+     * @brief Check if there is an error left to hide
+     * @return True if the offset is non-zero
+     */
+    bool isActive() const { return active_; }
+
+    /**
+     * @brief Drop any remaining offset
+     */
+    void reset();
+
+    /**
+     * @brief Set the error correction configuration
+     * @param config New configuration
+     */
+    void setConfig(const ErrorCorrectionConfig& config) { config_ = config; }
+
+    /**
+     * @brief Get the current error correction configuration
+     * @return The current configuration
+     */
+    const ErrorCorrectionConfig& getConfig() const { return config_; }
+
+private:
+    ErrorCorrectionConfig config_;
+    netcode::math::MyVec3 offset_;
+    bool active_ = false;
+};
+
+} // namespace netcode
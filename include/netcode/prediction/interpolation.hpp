@@ -4,7 +4,6 @@
 #include "netcode/networked_entity.hpp"
 #include "snapshot.hpp"
 #include <memory>
-#include <map>
 #include <chrono>
 
 namespace netcode {
@@ -21,6 +20,20 @@ struct InterpolationConfig {
     
     // Maximum allowed position jump before snapping instead of interpolating
     float maxInterpolationDistance = 5.0f;
+    
+    // Maximum time in milliseconds to extrapolate past the newest snapshot (0 disables)
+    uint32_t maxExtrapolationMs = 0;
+    
+    // Simulation steps per second, used to turn per-step velocities into distances
+    float simulationRate = 60.0f;
+};
+
+/**
+ * @brief Counters of the interpolation of remote entities
+ */
+struct InterpolationStats {
+    uint64_t updates = 0;         ///< Entity updates that found snapshots to interpolate
+    uint64_t starvedUpdates = 0;  ///< Updates whose render time was past the newest snapshot
 };
 
 /**
@@ -46,6 +59,16 @@ public:
      */
     void updateEntity(std::shared_ptr<NetworkedEntity> entity, float deltaTime);
     
+    /**
+     * @brief Update an entity's position using interpolation, without taking a reference to it
+     * 
+     * The entity only has to stay alive for the duration of the call.
+     * 
+     * @param entity The entity to update
+     * @param deltaTime Time since last update in seconds
+     */
+    void updateEntity(NetworkedEntity& entity, float deltaTime);
+    
     /**
      * @brief Record a new position for an entity for future interpolation
      * 
@@ -59,6 +82,23 @@ public:
         std::chrono::steady_clock::time_point timestamp
     );
     
+    /**
+     * @brief Record a new kinematic state for an entity for future interpolation
+     * 
+     * @param entityId ID of the entity
+     * @param position New position
+     * @param velocity Velocity at this state (per simulation step)
+     * @param isJumping Whether the entity is airborne at this state
+     * @param timestamp Time when this state was valid
+     */
+    void recordEntityState(
+        uint32_t entityId,
+        const netcode::math::MyVec3& position,
+        const netcode::math::MyVec3& velocity,
+        bool isJumping,
+        std::chrono::steady_clock::time_point timestamp
+    );
+    
     /**
      * @brief Set the interpolation configuration
      * @param config New configuration
@@ -71,6 +111,17 @@ public:
      */
     const InterpolationConfig& getConfig() const;
     
+    /**
+     * @brief Get the interpolation counters
+     * 
+     * A starved update had no newer snapshot to move towards, so the entity
+     * was held or extrapolated; the interpolation delay is too short for the
+     * network's delay and jitter.
+     * 
+     * @return InterpolationStats The counters
+     */
+    const InterpolationStats& getStats() const { return stats_; }
+    
     /**
      * @brief Reset the interpolation system's state
      */
@@ -79,17 +130,12 @@ public:
 private:
     SnapshotManager& snapshotManager_;
     InterpolationConfig config_;
-    
-    // Maps entity ID -> render time (offset from actual time)
-    std::map<uint32_t, std::chrono::steady_clock::time_point> renderTimes_;
-    
-    // Maps entity ID -> current interpolation target
-    std::map<uint32_t, EntitySnapshot> interpolationTargets_;
+    InterpolationStats stats_;
     
     /**
      * @brief Find the appropriate snapshots to interpolate between
      * 
-     * @param entityId ID of the entity
+     * @param record The entity's record
      * @param renderTime The time to find snapshots for
      * @param out_start Output parameter for the starting snapshot
      * @param out_end Output parameter for the ending snapshot
@@ -97,7 +143,7 @@ private:
      * @return True if snapshots were found, false otherwise
      */
     bool findInterpolationSnapshots(
-        uint32_t entityId,
+        const EntityRecord& record,
         std::chrono::steady_clock::time_point renderTime,
         EntitySnapshot& out_start,
         EntitySnapshot& out_end,
@@ -4,7 +4,6 @@
 #include "netcode/networked_entity.hpp"
 #include "snapshot.hpp"
 #include <memory>
-#include <map>
 
 namespace netcode {
 
@@ -39,6 +38,22 @@ public:
         bool isJumping
     );
     
+    /**
+     * @brief Apply input prediction for an entity without taking a reference to it
+     * 
+     * The entity only has to stay alive for the duration of the call.
+     * 
+     * @param entity The entity to apply prediction to
+     * @param input The movement input
+     * @param isJumping Whether the player is jumping
+     * @return The sequence number assigned to this input
+     */
+    uint32_t applyInputPrediction(
+        NetworkedEntity& entity,
+        const netcode::math::MyVec3& input,
+        bool isJumping
+    );
+    
     /**
      * @brief Update sequence counter for next prediction
      * @return The next sequence number
@@ -65,7 +80,6 @@ public:
 private:
     SnapshotManager& snapshotManager_;
     uint32_t currentSequence_ = 0;
-    std::map<uint32_t, std::shared_ptr<NetworkedEntity>> entities_;
 };
 
 } // namespace netcode 
\ No newline at end of file
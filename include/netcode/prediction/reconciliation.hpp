@@ -6,11 +6,26 @@
 #include "prediction.hpp"
 #include <memory>
 #include <functional>
-#include <map>
 #include <chrono>
+#include <vector>
 
 namespace netcode {
 
+/**
+ * @brief Correction counters of the local player's reconciliation
+ */
+struct ReconciliationStats {
+    uint64_t serverUpdates = 0;    ///< Server states checked against the prediction
+    uint64_t corrections = 0;      ///< Corrections applied, each one rewinds and replays inputs
+    uint64_t inputsReplayed = 0;   ///< Inputs replayed one by one after corrections
+    double totalError = 0.0;       ///< Sum of the distances the corrections moved the entity
+    float maxError = 0.0f;         ///< Largest distance a correction moved the entity
+    uint64_t horizonCaps = 0;      ///< Corrections with more pending inputs than the prediction horizon
+    uint64_t budgetOverruns = 0;   ///< Corrections that ran out of replay budget partway
+    uint64_t inputsMerged = 0;     ///< Inputs replayed merged into a single step instead of one by one
+    uint64_t deferredCorrections = 0; ///< Times a correction waited for the next frame's budget
+};
+
 /**
  * @brief Handles client-server state reconciliation
  * 
@@ -29,13 +44,16 @@ public:
      * @brief Process a server update for reconciliation
      * 
      * This method reconciles local state with server authority, then
-     * reapplies any pending inputs to maintain responsiveness
+     * reapplies any pending inputs to maintain responsiveness. There is no
+     * cooldown: the entity hides the correction with a decaying visual
+     * offset, so every server update can be applied.
      * 
      * @param entity The entity to apply reconciliation to
      * @param serverPosition The position from the server
      * @param serverSequence The sequence number from the server
      * @param serverTimestamp When the server generated this update
      * @param serverIsJumping The jumping state from the server
+     * @param serverVelocity The velocity from the server
      * @return True if reconciliation was needed, false if states already matched
      */
     bool reconcileState(
@@ -43,7 +61,32 @@ public:
         const netcode::math::MyVec3& serverPosition,
         uint32_t serverSequence,
         std::chrono::steady_clock::time_point serverTimestamp,
-        bool serverIsJumping = false
+        bool serverIsJumping = false,
+        const netcode::math::MyVec3& serverVelocity = {}
+    );
+    
+    /**
+     * @brief Process a server update for reconciliation, without taking a reference to the entity
+     * 
+     * The entity only has to stay alive for the duration of the call; the
+     * correction is applied on update() to the entity registered under the
+     * same ID with the snapshot manager.
+     * 
+     * @param entity The entity to apply reconciliation to
+     * @param serverPosition The position from the server
+     * @param serverSequence The sequence number from the server
+     * @param serverTimestamp When the server generated this update
+     * @param serverIsJumping The jumping state from the server
+     * @param serverVelocity The velocity from the server
+     * @return True if reconciliation was needed, false if states already matched
+     */
+    bool reconcileState(
+        const NetworkedEntity& entity,
+        const netcode::math::MyVec3& serverPosition,
+        uint32_t serverSequence,
+        std::chrono::steady_clock::time_point serverTimestamp,
+        bool serverIsJumping = false,
+        const netcode::math::MyVec3& serverVelocity = {}
     );
     
     /**
@@ -71,35 +114,54 @@ public:
     void setReconciliationCallback(std::function<void(uint32_t, const netcode::math::MyVec3&, const netcode::math::MyVec3&)> callback);
     
     /**
-     * @brief Set the smoothing factor for reconciliation
-     * @param smoothFactor Value between 0 and 1, higher values mean faster correction
+     * @brief Set the prediction horizon, the most inputs a correction replays one by one
+     * 
+     * Older pending inputs beyond the horizon are merged into as few steps
+     * as their jumps allow, so the cost of a correction stays about the same
+     * however long the round trip.
+     * 
+     * @param maxInputs The horizon in inputs, 0 replays every input
+     */
+    void setPredictionHorizon(uint32_t maxInputs);
+    
+    /**
+     * @brief Set the time corrections may spend replaying inputs per update
+     * 
+     * A correction that runs out of budget merges its remaining inputs, and
+     * corrections of other entities wait for the next update.
+     * 
+     * @param budget The budget, 0 for no limit
+     */
+    void setReplayBudget(std::chrono::microseconds budget);
+    
+    /**
+     * @brief Get the correction counters
+     * 
+     * The error of a correction is how far rewinding to the server state and
+     * replaying the pending inputs moved the entity, i.e. how wrong the
+     * prediction was.
+     * 
+     * @return ReconciliationStats The counters
      */
-    void setSmoothingFactor(float smoothFactor);
+    const ReconciliationStats& getStats() const { return stats_; }
     
     /**
      * @brief Reset the reconciliation system's state
      */
     void reset();
     
+    // Default prediction horizon, a second of input at 60 Hz
+    static constexpr uint32_t DEFAULT_PREDICTION_HORIZON = 60;
+    
+    // Default replay time per update (in microseconds), an eighth of a 60 Hz frame
+    static constexpr int64_t DEFAULT_REPLAY_BUDGET_US = 2000;
+    
 private:
-    struct ReconciliationState {
-        netcode::math::MyVec3 targetPosition;
-        netcode::math::MyVec3 startPosition;
-        bool reconciling = false;
-        uint32_t serverSequence = 0; // Server sequence number for this reconciliation
-        bool serverIsJumping = false; // Server's jumping state for this reconciliation
-    };
-
     PredictionSystem& predictionSystem_;
     float reconciliationThreshold_ = 0.5f; // Minimum difference to trigger reconciliation
-    float smoothingFactor_ = 10.0f; // Controls how quickly to blend to correct position
-    std::map<uint32_t, ReconciliationState> reconciliationStates_;
-    
-    // Map of entity IDs to their last reconciliation time for cooldown
-    std::map<uint32_t, std::chrono::steady_clock::time_point> lastReconciliationTimes_;
-    
-    // Minimum interval between reconciliations (in milliseconds)
-    static constexpr uint32_t MIN_RECONCILIATION_INTERVAL_MS = 33; // ~30 FPS max reconciliation rate
+    uint32_t predictionHorizon_ = DEFAULT_PREDICTION_HORIZON; // Most inputs replayed one by one, 0 for all
+    std::chrono::microseconds replayBudget_{DEFAULT_REPLAY_BUDGET_US}; // Replay time per update, 0 for no limit
+    ReconciliationStats stats_;
     
     // Callback for when reconciliation happens (entityId, serverPos, clientPos)
     std::function<void(uint32_t, const netcode::math::MyVec3&, const netcode::math::MyVec3&)> reconciliationCallback_;
@@ -108,12 +170,42 @@ private:
      * @brief Reapply inputs after a server correction
      * @param entity The entity to reapply inputs for
      * @param serverSequence The sequence number from the server
-     * @param targetPosition The position to reapply from
+     * @param deadline When the update's replay budget runs out
      */
     void reapplyInputs(
-        std::shared_ptr<NetworkedEntity> entity,
+        NetworkedEntity& entity,
         uint32_t serverSequence,
-        const netcode::math::MyVec3& targetPosition
+        std::chrono::steady_clock::time_point deadline
+    );
+    
+    /**
+     * @brief Replay a run of inputs in fewer steps
+     * 
+     * Only stretches on the ground are merged: their movements add up, so
+     * one step covers all but the last input, which is replayed on its own
+     * to leave the entity with its velocity. Jumps and steps in the air
+     * depend on the number of steps and are replayed one by one.
+     * 
+     * @param entity The entity to replay the inputs on
+     * @param inputs The pending inputs
+     * @param first Index of the first input of the run
+     * @param last Index past the last input of the run
+     */
+    void replayMerged(
+        NetworkedEntity& entity,
+        const std::vector<InputSnapshot>& inputs,
+        size_t first,
+        size_t last
+    );
+    
+    /**
+     * @brief Simulate one step and record the predicted state it ends in
+     */
+    void replayStep(
+        NetworkedEntity& entity,
+        const netcode::math::MyVec3& movement,
+        bool jump,
+        uint32_t sequenceNumber
     );
 };
 
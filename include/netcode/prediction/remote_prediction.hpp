@@ -0,0 +1,148 @@
+#pragma once
+
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/networked_entity.hpp"
+#include "netcode/prediction/entity_record.hpp"
+#include <memory>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+namespace netcode {
+
+/**
+ * @brief Configuration for predicting remote entities
+ */
+struct RemotePredictionConfig {
+    // Predict remote entities to the present instead of interpolating them in the past
+    bool enabled = false;
+
+    // Simulation steps per second used to advance remote entities
+    float simulationRate = 60.0f;
+
+    // Maximum time in milliseconds to predict ahead of the last server state
+    uint32_t maxPredictionMs = 250;
+};
+
+/**
+ * @brief Cost and correction counters for a single remote entity
+ */
+struct RemotePredictionStats {
+    uint64_t serverUpdates = 0;                   ///< Server states received
+    uint64_t resimulations = 0;                   ///< Times the entity was rewound to a server state
+    uint64_t stepsSimulated = 0;                  ///< Simulation steps run for this entity
+    std::chrono::nanoseconds simulationTime{0};   ///< Time spent simulating this entity
+};
+
+/**
+ * @brief Predicts remote entities forward to the present using their inputs
+ *
+ * The server sends the input it last applied for each player along with its
+ * state. Instead of showing remote players an interpolation delay in the past,
+ * this system takes the latest server state and simulates the held input
+ * forward by the time that passed since the state was produced. When a newer
+ * server state arrives the entity is rewound and re-simulated, and the entity
+ * hides the correction with its visual error offset.
+ */
+class RemotePredictionSystem {
+public:
+    /**
+     * @brief Constructor
+     * @param config Configuration for remote prediction
+     */
+    explicit RemotePredictionSystem(const RemotePredictionConfig& config = RemotePredictionConfig());
+
+    /**
+     * @brief Record an authoritative state and the input held by the remote player
+     *
+     * @param entityId ID of the entity
+     * @param position Position from the server
+     * @param velocity Velocity from the server
+     * @param isJumping Jumping state from the server
+     * @param heldInput The last movement input the server applied for this entity
+     * @param receiveTime When the state was received
+     */
+    void recordServerState(
+        uint32_t entityId,
+        const netcode::math::MyVec3& position,
+        const netcode::math::MyVec3& velocity,
+        bool isJumping,
+        const netcode::math::MyVec3& heldInput,
+        std::chrono::steady_clock::time_point receiveTime
+    );
+
+    /**
+     * @brief Advance an entity's predicted state to the present
+     *
+     * @param entity The entity to update
+     */
+    void updateEntity(std::shared_ptr<NetworkedEntity> entity);
+
+    /**
+     * @brief Get the last server state recorded for an entity
+     *
+     * @param entityId ID of the entity
+     * @param out Receives the state the entity is predicted from
+     * @return False if no state was recorded for the entity
+     */
+    bool getServerState(uint32_t entityId, EntitySnapshot& out) const;
+
+    /**
+     * @brief Set the current round trip time estimate
+     *
+     * The server state is roughly half a round trip old when it arrives, and the
+     * local player is predicted half a round trip ahead of the server, so remote
+     * entities are advanced by the full round trip.
+     *
+     * @param roundTripTime Estimated round trip time to the server
+     */
+    void setLatencyEstimate(std::chrono::microseconds roundTripTime);
+
+    /**
+     * @brief Get the cost and correction counters for an entity
+     * @param entityId ID of the entity
+     * @return The counters, zeroed if the entity is unknown
+     */
+    RemotePredictionStats getStats(uint32_t entityId) const;
+
+    /**
+     * @brief Set the remote prediction configuration
+     * @param config New configuration
+     */
+    void setConfig(const RemotePredictionConfig& config);
+
+    /**
+     * @brief Get the current remote prediction configuration
+     * @return The current configuration
+     */
+    const RemotePredictionConfig& getConfig() const;
+
+    /**
+     * @brief Check if remote prediction is enabled
+     * @return True if remote entities should be predicted
+     */
+    bool isEnabled() const { return config_.enabled; }
+
+    /**
+     * @brief Reset the remote prediction system's state
+     */
+    void reset();
+
+private:
+    struct RemoteEntityState {
+        netcode::math::MyVec3 serverPosition;
+        netcode::math::MyVec3 serverVelocity;
+        bool serverIsJumping = false;
+        netcode::math::MyVec3 heldInput;
+        std::chrono::steady_clock::time_point receiveTime;
+        bool needsResimulation = false; // A new server state has not been applied yet
+        uint32_t simulatedSteps = 0;    // Steps simulated on top of the server state
+        RemotePredictionStats stats;
+    };
+
+    RemotePredictionConfig config_;
+    std::chrono::microseconds latencyEstimate_{0};
+    std::map<uint32_t, RemoteEntityState> states_;
+};
+
+} // namespace netcode
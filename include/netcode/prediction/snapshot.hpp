@@ -1,47 +1,13 @@
 #pragma once
 
-#include "netcode/math/my_vec3.hpp"
-#include "netcode/networked_entity.hpp"
+#include "netcode/prediction/entity_record.hpp"
 #include <chrono>
 #include <cstdint>
 #include <vector>
-#include <map>
 #include <memory>
 
 namespace netcode {
 
-/**
- * @brief Represents a snapshot of an entity's state at a point in time
- */
-struct EntitySnapshot {
-    uint32_t entityId;
-    netcode::math::MyVec3 position;
-    netcode::math::MyVec3 velocity;
-    bool isJumping;
-    std::chrono::steady_clock::time_point timestamp;
-    uint32_t sequenceNumber; // Used for reconciliation
-    
-    // Comparison operator for sorting
-    bool operator<(const EntitySnapshot& other) const {
-        return sequenceNumber < other.sequenceNumber;
-    }
-};
-
-/**
- * @brief Input state for a player at a point in time
- */
-struct InputSnapshot {
-    uint32_t playerId;
-    netcode::math::MyVec3 movement;
-    bool isJumping;
-    std::chrono::steady_clock::time_point timestamp;
-    uint32_t sequenceNumber;
-    
-    bool operator<(const InputSnapshot& other) const {
-        return sequenceNumber < other.sequenceNumber;
-    }
-};
-
 /**
  * @brief Class to manage state snapshots for entities
  */
@@ -90,11 +56,44 @@ public:
     std::shared_ptr<NetworkedEntity> getEntity(uint32_t entityId) const;
     
     /**
-     * @brief Register an entity with the snapshot manager
+     * @brief Resolve a handle to its entity without touching reference counts
+     * 
+     * The pointer stays valid until the entity is unregistered, so it must
+     * not be kept across a despawn; keep the handle and resolve it again.
+     * 
+     * @param handle Handle returned by registerEntity() or getHandle()
+     * @return The entity, nullptr if the handle is stale or has no entity
+     */
+    NetworkedEntity* resolveEntity(EntityHandle handle) const;
+    
+    /**
+     * @brief Get the handle of an entity
+     * @param entityId The entity ID
+     * @return The handle, INVALID_ENTITY_HANDLE if the entity is unknown
+     */
+    EntityHandle getHandle(uint32_t entityId) const { return records_.find(entityId); }
+    
+    /**
+     * @brief Register an entity with the snapshot manager when it spawns
+     * 
+     * The manager holds the entity until it is unregistered, which is what
+     * lets the prediction systems work on plain references in between.
+     * 
      * @param entityId The entity ID
      * @param entity The entity to register
+     * @return Handle of the entity, INVALID_ENTITY_HANDLE if the entity is null
      */
-    void registerEntity(uint32_t entityId, std::shared_ptr<NetworkedEntity> entity);
+    EntityHandle registerEntity(uint32_t entityId, std::shared_ptr<NetworkedEntity> entity);
+    
+    /**
+     * @brief Unregister an entity when it despawns
+     * 
+     * Drops the entity with its snapshots, inputs and pending state; handles
+     * to it stop resolving.
+     * 
+     * @param entityId The entity ID
+     */
+    void unregisterEntity(uint32_t entityId);
     
     /**
      * @brief Remove old snapshots to prevent memory growth
@@ -102,15 +101,16 @@ public:
      */
     void pruneOldSnapshots(uint64_t maxAge);
     
-private:
-    // Maps entity ID to a vector of snapshots
-    std::map<uint32_t, std::vector<EntitySnapshot>> entitySnapshots_;
-    
-    // Maps player ID to a vector of input snapshots
-    std::map<uint32_t, std::vector<InputSnapshot>> inputSnapshots_;
+    /**
+     * @brief Get the per-entity records shared by the prediction subsystems
+     * @return The record table
+     */
+    EntityRecordTable& getRecords() { return records_; }
+    const EntityRecordTable& getRecords() const { return records_; }
     
-    // Maps entity ID to entity instances (weak references to avoid ownership issues)
-    mutable std::map<uint32_t, std::weak_ptr<NetworkedEntity>> entities_;
+private:
+    // One record per entity: snapshots, inputs and the subsystems' per-entity state
+    EntityRecordTable records_;
 };
 
 } // namespace netcode 
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace netcode {
+
+/**
+ * @brief Configuration of the client's input clock dilation
+ */
+struct TimeDilationConfig {
+    // Adjust the input clock to the server's input buffer, otherwise the time scale stays 1
+    bool enabled = true;
+
+    // Inputs that should wait in the server's buffer when the next tick starts
+    float targetDepth = 2.0f;
+
+    // Largest speed up or slow down of the input clock, 0.05 runs between 95% and 105%
+    float maxDilation = 0.05f;
+
+    // Dilation per input of difference between the target and the smoothed depth
+    float gain = 0.025f;
+
+    // Weight of a new depth sample in the smoothed depth, lower ignores more jitter
+    float smoothing = 0.1f;
+};
+
+/**
+ * @brief Counters of the input clock dilation
+ */
+struct TimeDilationStats {
+    uint64_t acks = 0;           ///< Input acknowledgements taken into account
+    uint64_t underruns = 0;      ///< Server ticks that found the buffer empty while inputs were due
+    uint64_t catchUpInputs = 0;  ///< Inputs the server applied early because the buffer was too deep
+    float smoothedDepth = 0.0f;  ///< Current smoothed buffer depth
+    float timeScale = 1.0f;      ///< Current time scale
+};
+
+/**
+ * @brief Keeps the server's input buffer for the local player at a small target depth
+ *
+ * The server applies one buffered input per tick and reports the depth left
+ * in every input acknowledgement. Too deep a buffer adds input latency, an
+ * empty one makes the server skip the player's tick. The controller speeds up
+ * the client's input clock slightly while the buffer is too shallow and slows
+ * it down while it is too deep, so each client settles on sending inputs just
+ * early enough for its own round trip and jitter.
+ */
+class TimeDilationController {
+public:
+    /**
+     * @brief Constructor
+     * @param config Configuration for the dilation
+     */
+    explicit TimeDilationController(const TimeDilationConfig& config = TimeDilationConfig());
+
+    /**
+     * @brief Take an input acknowledgement into account
+     *
+     * Acknowledgements older than the newest one seen are ignored. An underrun
+     * since the previous acknowledgement counts as a depth below zero, so the
+     * clock speeds up faster after the buffer ran dry.
+     *
+     * @param serverTick Server tick the depth was measured at
+     * @param bufferDepth Inputs waiting in the server's buffer
+     * @param underruns Total underruns reported by the server
+     * @param catchUpInputs Total inputs the server applied early
+     */
+    void onInputAck(uint32_t serverTick, uint32_t bufferDepth, uint32_t underruns, uint32_t catchUpInputs);
+
+    /**
+     * @brief Get the rate the input clock should run at
+     *
+     * Multiply the input rate, or divide the input interval, by it.
+     *
+     * @return The time scale, 1 when the depth is on target
+     */
+    float getTimeScale() const { return timeScale_; }
+
+    /**
+     * @brief Set the configuration, the smoothed depth is kept
+     * @param config Configuration for the dilation
+     */
+    void setConfig(const TimeDilationConfig& config);
+
+    /**
+     * @brief Get the dilation counters
+     * @return TimeDilationStats The counters
+     */
+    TimeDilationStats getStats() const;
+
+    /**
+     * @brief Forget the measured depth, e.g. after moving to another server
+     */
+    void reset();
+
+private:
+    TimeDilationConfig config_;
+    float smoothedDepth_ = 0.0f;
+    float timeScale_ = 1.0f;
+    bool hasSample_ = false;
+    uint32_t lastServerTick_ = 0;
+    uint32_t lastUnderruns_ = 0;
+    uint32_t lastCatchUpInputs_ = 0;
+    uint64_t acks_ = 0;
+    uint64_t underruns_ = 0;
+    uint64_t catchUpInputs_ = 0;
+};
+
+/**
+ * @brief Paces inputs sampled once per frame at the dilated input rate
+ *
+ * Applications sample input every frame, at whatever rate they render, and
+ * only while a key is held. The clock turns those frames into the number of
+ * inputs to send: the input rate times the time scale while input is held,
+ * regardless of the frame rate. A held input is sent right away; while
+ * nothing is held the clock is stopped, so idle time is never owed.
+ */
+class InputClock {
+public:
+    /**
+     * @brief Constructor
+     * @param inputRate Inputs per second at a time scale of 1
+     */
+    explicit InputClock(float inputRate = 60.0f);
+
+    /**
+     * @brief Advance to the current frame while input is held
+     * @param now Current time
+     * @param timeScale The client's time scale, see TimeDilationController::getTimeScale()
+     * @return Number of inputs to send this frame, 0 if the next one is not due yet
+     */
+    uint32_t advance(std::chrono::steady_clock::time_point now, float timeScale);
+
+    /**
+     * @brief Stop the clock because no input is held anymore
+     */
+    void stop() { running_ = false; }
+
+    // Most inputs sent in one frame, e.g. after a hitch; the rest of the backlog is dropped
+    static constexpr uint32_t MAX_INPUTS_PER_FRAME = 3;
+
+private:
+    float inputRate_;
+    double pendingInputs_ = 0.0;
+    std::chrono::steady_clock::time_point lastAdvance_;
+    bool running_ = false;
+};
+
+} // namespace netcode
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/packets/relay_packets.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Configuration for a connection relay
+ */
+struct RelayConfig {
+    // Identifies this relay to the server, useful when running several relays
+    uint32_t relayId = 1;
+
+    // Port clients connect to
+    int clientPort = 7100;
+
+    // Address of the simulation server
+    std::string serverIp = "127.0.0.1";
+    int serverPort = 7000;
+
+    // Sustained packets per second accepted from a single client
+    float maxPacketsPerSecond = 120.0f;
+
+    // Packets a client may send in a burst above the sustained rate
+    float burstPackets = 30.0f;
+
+    // Clients silent for this long are disconnected (in milliseconds). Once the server has
+    // opened a session for a client, the server closes it; this then only adds to the server's
+    // grace period in case its notice is lost
+    uint32_t sessionTimeoutMs = 5000;
+
+    // Longest time an input waits for more inputs to batch with (in milliseconds)
+    uint32_t maxBatchDelayMs = 1;
+};
+
+/**
+ * @brief Counters for a running relay
+ */
+struct RelayStats {
+    uint64_t inputsForwarded = 0;   ///< Client inputs sent to the server
+    uint64_t uplinkPackets = 0;     ///< Batched packets sent to the server
+    uint64_t packetsFannedOut = 0;  ///< Server packets sent on to clients
+    uint64_t packetsDropped = 0;    ///< Client packets dropped by the rate limiter
+    uint64_t sessionsOpened = 0;    ///< Client sessions started
+    uint64_t sessionsClosed = 0;    ///< Client sessions timed out or expired by the server
+    size_t activeSessions = 0;      ///< Client sessions currently open
+};
+
+/**
+ * @brief Gateway that terminates client sessions on behalf of the server
+ *
+ * Clients send to the relay exactly as they would to the server. The relay
+ * handles session lifecycle and per-client rate limiting, batches inputs into
+ * a single flow to the server, and fans every packet the server sends out to
+ * its clients. The server therefore only ever sees one peer per relay and
+ * sends each update once, no matter how many clients are behind the relay.
+ * Packets meant for a single player, such as its session token or a resume
+ * catch-up, are routed to that player's client only.
+ * Several relays can run side by side to spread the fan-out over processes.
+ */
+class Relay {
+public:
+    /**
+     * @brief Construct a new Relay object
+     *
+     * @param config Ports, server address and limits
+     */
+    explicit Relay(const RelayConfig& config = RelayConfig());
+
+    /**
+     * @brief Destroy the Relay object and clean up resources
+     */
+    ~Relay();
+
+    /**
+     * @brief Bind the sockets and start the relay thread
+     *
+     * @return True if the relay started
+     */
+    bool start();
+
+    /**
+     * @brief Stop the relay thread and close the sockets
+     */
+    void stop();
+
+    /**
+     * @brief Get the relay's counters
+     *
+     * @return RelayStats Snapshot of the counters
+     */
+    RelayStats getStats();
+
+private:
+    /**
+     * @brief Connection state of one client behind the relay
+     */
+    struct Session {
+        sockaddr_in addr{};
+        std::chrono::steady_clock::time_point lastSeen;
+        float tokens = 0.0f;                                 ///< Token bucket for rate limiting
+        std::chrono::steady_clock::time_point lastRefill;
+        uint32_t serverGracePeriodMs = 0;                    ///< Grace period the server announced, 0 until it opened the session
+    };
+
+    RelayConfig config_;            ///< Relay configuration
+    int clientSocketFd_ = -1;       ///< Socket facing the clients
+    int serverSocketFd_ = -1;       ///< Socket for the multiplexed flow to the server
+    sockaddr_in serverAddr_{};      ///< Server address
+    std::atomic<bool> running_;     ///< Flag indicating if the relay is running
+    std::thread relayThread_;       ///< Thread running the relay
+
+    std::unordered_map<uint32_t, Session> sessions_;  ///< Client sessions by player ID
+    std::unordered_map<uint32_t, sockaddr_in> pendingResumes_; ///< New addresses of clients waiting for the server to accept their resume
+    packets::RelayUplinkPacket uplink_{};             ///< Inputs waiting to be sent to the server
+    std::chrono::steady_clock::time_point uplinkStarted_; ///< When the first pending input was queued
+
+    std::mutex statsMutex_;         ///< Protects stats_
+    RelayStats stats_;              ///< Relay counters
+
+    /**
+     * @brief Main loop of the relay thread
+     */
+    void run();
+
+    /**
+     * @brief Handle all pending datagrams from clients
+     */
+    void receiveFromClients();
+
+    /**
+     * @brief Fan all pending datagrams from the server out to the clients
+     */
+    void receiveFromServer();
+
+    /**
+     * @brief Track a client session and check its rate limit
+     *
+     * A new session is bound to addr; an existing one keeps its address until
+     * the server accepts a resume from another one.
+     *
+     * @param playerId ID of the client's player
+     * @param addr The client's address
+     * @return True if the packet may be forwarded
+     */
+    bool admit(uint32_t playerId, const sockaddr_in& addr);
+
+    /**
+     * @brief Send a server packet to the client of one player
+     *
+     * @param playerId The player
+     * @param data The packet
+     * @param size Size of the packet
+     * @return Number of datagrams sent
+     */
+    uint64_t sendToPlayer(uint32_t playerId, const char* data, size_t size);
+
+    /**
+     * @brief Send the pending input batch to the server
+     */
+    void flushUplink();
+
+    /**
+     * @brief Close sessions that have been silent for too long
+     */
+    void expireSessions();
+
+    /**
+     * @brief Close a client session
+     *
+     * @param it The session
+     * @param reason Why the session is closed, for the log
+     * @return Iterator to the next session
+     */
+    std::unordered_map<uint32_t, Session>::iterator closeSession(std::unordered_map<uint32_t, Session>::iterator it,
+                                                                 const std::string& reason);
+};
+
+} // namespace netcode
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "netcode/packets/player_state_packet.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Configuration of the server's outbound pacing
+ */
+struct OutboundPacerConfig {
+    // Time the states queued for a client are spread over (in milliseconds), 0 sends them all at once
+    uint32_t pacingWindowMs = 16;
+};
+
+/**
+ * @brief Counters of the server's outbound pacing, all clients together
+ */
+struct OutboundPacerStats {
+    uint64_t queued = 0;     ///< States handed to the pacer
+    uint64_t sent = 0;       ///< States released to the socket
+    uint64_t coalesced = 0;  ///< Queued states replaced by a newer state of the same entity before being sent
+    size_t maxBacklog = 0;   ///< Most states waiting for a single client at once
+};
+
+/**
+ * @brief Per-client outbound queues that spread entity states over time
+ *
+ * Sending every client's states in one burst per tick overflows socket
+ * buffers and switch queues. The pacer keeps a queue per destination and
+ * releases it evenly so that everything queued goes out within one pacing
+ * window of being queued. Entity states are unreliable and only the newest
+ * one matters: a state queued for an entity that already waits is replaced
+ * in place, so a backlog never sends superseded positions.
+ *
+ * Not thread-safe, the server guards it with its player mutex.
+ */
+class OutboundPacer {
+public:
+    /**
+     * @brief A state released for sending
+     */
+    struct Outgoing {
+        sockaddr_in destination;           ///< Client or relay address
+        packets::PlayerStatePacket state;  ///< The state to send
+    };
+
+    /**
+     * @brief Construct a new Outbound Pacer object
+     *
+     * @param config Pacing configuration
+     */
+    explicit OutboundPacer(const OutboundPacerConfig& config = OutboundPacerConfig());
+
+    /**
+     * @brief Change the pacing configuration, queued states are kept
+     *
+     * @param config Pacing configuration
+     */
+    void setConfig(const OutboundPacerConfig& config);
+
+    /**
+     * @brief Queue a state for a destination, replacing a queued state of the same entity
+     *
+     * @param destination Client or relay address
+     * @param state The state to send
+     * @param now Current time
+     */
+    void enqueue(const sockaddr_in& destination, const packets::PlayerStatePacket& state,
+                 std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Take the states that are due for sending
+     *
+     * Call this frequently, at least every few milliseconds; each call
+     * releases each destination's share of its backlog for the time passed.
+     *
+     * @param now Current time
+     * @return States to send, in queue order per destination
+     */
+    std::vector<Outgoing> release(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Take every state queued for a destination, e.g. before a packet that has to follow them
+     *
+     * @param destination Client or relay address
+     * @return States to send, in queue order
+     */
+    std::vector<Outgoing> releaseAll(const sockaddr_in& destination);
+
+    /**
+     * @brief Get the number of states waiting, all destinations together
+     *
+     * @return size_t Backlog
+     */
+    size_t getBacklog() const;
+
+    /**
+     * @brief Get the pacing counters
+     *
+     * @return OutboundPacerStats Current counters
+     */
+    OutboundPacerStats getStats() const { return stats_; }
+
+private:
+    /**
+     * @brief States waiting for one destination
+     */
+    struct DestinationQueue {
+        sockaddr_in destination{};
+        std::deque<std::pair<uint32_t, std::chrono::steady_clock::time_point>> order;  ///< Entity IDs with the time they were first queued
+        std::unordered_map<uint32_t, packets::PlayerStatePacket> latest;              ///< Newest state per queued entity
+        std::chrono::steady_clock::time_point lastRelease;                             ///< When the queue was last released from
+    };
+
+    OutboundPacerConfig config_;
+    OutboundPacerStats stats_;
+    std::unordered_map<uint64_t, DestinationQueue> queues_;
+
+    // Take the first count states of a queue
+    void take(DestinationQueue& queue, size_t count, std::vector<Outgoing>& out);
+};
+
+} // namespace netcode
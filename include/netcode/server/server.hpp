@@ -3,7 +3,13 @@
 #include "netcode/math/my_vec3.hpp"
 #include "netcode/networked_entity.hpp"
 #include "netcode/packets/player_state_packet.hpp"
+#include "netcode/packets/session_packets.hpp"
 #include "netcode/settings.hpp"
+#include "netcode/server/outbound_pacer.hpp"
+#include "netcode/server/state_replicator.hpp"
+#include "netcode/spectator/spectator_stream.hpp"
+#include "netcode/physics/prop_world.hpp"
+#include "netcode/utils/event_bus.hpp"
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -13,11 +19,34 @@
 #include <queue>
 #include <unordered_map>
 #include <map>
+#include <vector>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 
 namespace netcode {
 
+/**
+ * @brief Configuration of the server's per-tick input buffering
+ */
+struct InputBufferConfig {
+    // Buffer inputs and apply one per player each tick, otherwise inputs are applied as they arrive
+    bool enabled = false;
+    
+    // Most inputs waiting per player, beyond it the oldest are applied right away to catch up
+    uint32_t maxDepth = 8;
+};
+
+/**
+ * @brief Counters of the server's input buffering, all players together
+ */
+struct InputBufferStats {
+    uint64_t ticks = 0;          ///< Ticks that applied buffered inputs
+    uint64_t inputsBuffered = 0; ///< Inputs taken into the buffers
+    uint64_t inputsApplied = 0;  ///< Inputs applied from the buffers
+    uint64_t underruns = 0;      ///< Player ticks that found the buffer empty while the client was sending
+    uint64_t catchUpInputs = 0;  ///< Inputs applied early because a buffer was too deep
+};
+
 /**
  * @brief Server class for handling network communication with game clients
  * 
@@ -89,15 +118,132 @@ public:
     void setPlayerPosition(uint32_t playerId, float x, float y, float z, bool isJumping);
     
     /**
-     * @brief Update all entities' render positions
+     * @brief Update all entities' render positions and simulate props
      * 
      * Call this method in your game loop to update the render positions
-     * of all server entities 
+     * of all server entities. Props are stepped and the changed ones are
+     * replicated within the prop update budget.
      * 
      * @param deltaTime Time elapsed since last update in seconds
      */
     void updateEntities(float deltaTime);
     
+    /**
+     * @brief Serve a delayed, low-rate stream of the match to spectators
+     * 
+     * Must be called before start(). Spectators and spectator relays subscribe
+     * on the stream's port; they never join the simulation, and every frame is
+     * encoded once no matter how many of them watch.
+     * 
+     * @param config Stream configuration
+     */
+    void enableSpectatorStream(const SpectatorStreamConfig& config);
+    
+    /**
+     * @brief Add a server-simulated prop to the world
+     * 
+     * Props are replicated like players, but sleeping props are not sent at
+     * all, not even as heartbeats.
+     * 
+     * @param prop The prop, its ID must not collide with a player ID
+     */
+    void addProp(std::shared_ptr<Prop> prop);
+    
+    /**
+     * @brief Configure prop simulation and the prop update budget
+     * 
+     * @param config Prop world configuration
+     */
+    void setPropWorldConfig(const PropWorldConfig& config);
+    
+    /**
+     * @brief Get statistics of the prop simulation
+     * 
+     * @return PropWorldStats Current statistics
+     */
+    PropWorldStats getPropStats();
+    
+    /**
+     * @brief Get the number of spectators and relays subscribed directly to the server
+     * 
+     * @return size_t Subscriber count
+     */
+    size_t getSpectatorCount();
+    
+    /**
+     * @brief Set how long a silent client keeps its session
+     * 
+     * Within the grace period a client whose address changed can resume its
+     * session with its token instead of registering again. After it, the
+     * client is dropped and no longer receives state.
+     * 
+     * @param gracePeriodMs Grace period in milliseconds
+     */
+    void setSessionGracePeriod(uint32_t gracePeriodMs);
+    
+    /**
+     * @brief Get the number of clients with an open session
+     * 
+     * @return size_t Session count
+     */
+    size_t getSessionCount();
+    
+    /**
+     * @brief Subscribe to the entity state changes the server replicates
+     * 
+     * Every changed entity state is published once, stamped with its state
+     * sequence. Subscribers read at their own pace on their own threads, e.g.
+     * for match recording, metrics or checkpointing; the simulation never
+     * waits for them, a subscriber that falls too far behind loses the
+     * oldest changes and can see how many through lost().
+     * 
+     * @return Subscriber reading the changes published from now on
+     */
+    utils::EventBus<packets::PlayerStatePacket>::Subscriber subscribeStateChanges() const;
+    
+    /**
+     * @brief Configure how entity states are paced out to clients
+     * 
+     * States are queued per client and spread over the pacing window instead
+     * of leaving in one burst per tick; a state still waiting is replaced by
+     * a newer state of the same entity.
+     * 
+     * @param config Pacing configuration
+     */
+    void setOutboundPacing(const OutboundPacerConfig& config);
+    
+    /**
+     * @brief Get the outbound pacing counters
+     * 
+     * @return OutboundPacerStats Current counters
+     */
+    OutboundPacerStats getOutboundStats();
+    
+    /**
+     * @brief Buffer inputs and apply them one per player per tick
+     * 
+     * With buffering enabled, updateEntities() is the server tick: it applies
+     * the oldest buffered input of every player and sends each client an
+     * input acknowledgement with the depth of its buffer, which the client
+     * uses to time its inputs so they arrive just early enough.
+     * 
+     * @param config Buffering configuration
+     */
+    void setInputBuffering(const InputBufferConfig& config);
+    
+    /**
+     * @brief Get the input buffering counters
+     * 
+     * @return InputBufferStats Current counters
+     */
+    InputBufferStats getInputBufferStats();
+    
+    // Number of state changes kept for slow subscribers
+    static constexpr size_t STATE_EVENT_CAPACITY = 4096;
+    
+    // Default time a session survives without hearing from its client (in milliseconds)
+    static constexpr uint32_t SESSION_GRACE_PERIOD_MS = 10000;
+    
 private:
     int port_;                 ///< Port number to listen on
     int socketFd_;             ///< UDP socket file descriptor
@@ -118,18 +264,88 @@ private:
     // Map of player IDs to their last processed input sequence number
     std::map<uint32_t, uint32_t> lastProcessedInputSequence_;
     
+    // Map of player IDs to the last movement input applied, replicated for remote prediction
+    std::map<uint32_t, netcode::math::MyVec3> lastInputMovement_;
+    
+    // Map of player IDs to when their last input was applied
+    std::map<uint32_t, std::chrono::steady_clock::time_point> lastInputTime_;
+    
     // Map of player IDs to their client addresses
     std::unordered_map<uint32_t, sockaddr_in> clientAddresses_;
     
-    // Map of player IDs to their last broadcast time for throttling
-    std::map<uint32_t, std::chrono::steady_clock::time_point> lastBroadcastTimes_;
+    // Distinct client addresses; several players share one when connected through a relay
+    std::vector<sockaddr_in> destinations_;
+    
+    /**
+     * @brief A client's resumable session
+     */
+    struct Session {
+        uint64_t token = 0;                              ///< Secret the client resumes with
+        std::chrono::steady_clock::time_point lastHeard; ///< When the client last sent anything
+    };
+    
+    // Map of player IDs to their sessions, guarded by playerMutex_
+    std::unordered_map<uint32_t, Session> sessions_;
+    
+    // Time a session survives without hearing from its client (in milliseconds)
+    std::atomic<uint32_t> sessionGracePeriodMs_{SESSION_GRACE_PERIOD_MS};
+    
+    // Replication of the entities to the clients, guarded by playerMutex_
+    StateReplicator replicator_;
+    
+    // Changed entity states for consumers besides the clients, published under playerMutex_
+    utils::EventBus<packets::PlayerStatePacket> stateEvents_{STATE_EVENT_CAPACITY};
+    
+    /**
+     * @brief Inputs of one player waiting for their tick
+     */
+    struct InputBuffer {
+        std::map<uint32_t, packets::PlayerMovementRequest> inputs; ///< Waiting inputs by sequence number
+        uint32_t underruns = 0;      ///< Ticks the buffer ran dry while the client was sending
+        uint32_t dryTicks = 0;       ///< Ticks run dry since the last input, underruns if the stream goes on
+        std::chrono::steady_clock::time_point lastArrival; ///< When the last input was buffered
+        uint32_t catchUpInputs = 0;  ///< Inputs applied early since the first input
+    };
+    
+    // Map of player IDs to their input buffers, guarded by playerMutex_
+    std::map<uint32_t, InputBuffer> inputBuffers_;
+    
+    // Input buffering configuration, guarded by playerMutex_
+    InputBufferConfig inputBufferConfig_;
+    
+    // Input buffering counters, guarded by playerMutex_
+    InputBufferStats inputBufferStats_;
+    
+    // Ticks run with input buffering, stamps the input acknowledgements
+    uint32_t serverTick_ = 0;
+    
+    // Per-client queues entity states leave through, guarded by playerMutex_
+    OutboundPacer outboundPacer_;
+    
+    // Server-simulated props
+    PropWorld props_;
+    
+    // Spectator stream, null unless enabled
+    std::unique_ptr<SpectatorStream> spectatorStream_;
+    
+    // Spectators and relays subscribed to the stream
+    std::unique_ptr<SpectatorFanout> spectatorFanout_;
+    
+    // Configuration of the spectator stream
+    SpectatorStreamConfig spectatorConfig_;
     
-    // Minimum interval between broadcasts (in milliseconds)
-    static constexpr uint32_t MIN_BROADCAST_INTERVAL_MS = 16; // ~60 FPS
+    // Socket spectators subscribe on
+    int spectatorSocketFd_ = -1;
     
     // Queue for delayed packet processing
     std::queue<packets::TimestampedPlayerMovementRequest> packetQueue_;
     
+    // Queue for delayed state acknowledgements
+    std::queue<packets::TimestampedStateAckPacket> ackQueue_;
+    
+    // Queue for delayed session resume requests
+    std::queue<packets::TimestampedResumeRequestPacket> resumeQueue_;
+    
     // Mutex for protecting packet queue access
     std::mutex queueMutex_;
     
@@ -148,18 +364,164 @@ private:
      */
     void handleClientRequest(const sockaddr_in& clientAddr, const packets::PlayerMovementRequest& request);
     
+    /**
+     * @brief Apply a movement input to its player and broadcast the result
+     * 
+     * Expects playerMutex_ to be held. Inputs not newer than the last one
+     * applied for the player are ignored.
+     * 
+     * @param request Player movement request packet
+     */
+    void applyInput(const packets::PlayerMovementRequest& request);
+    
+    /**
+     * @brief Keep an input until the tick that applies it
+     * 
+     * Expects playerMutex_ to be held.
+     * 
+     * @param request Player movement request packet
+     */
+    void bufferInput(const packets::PlayerMovementRequest& request);
+    
+    /**
+     * @brief Apply the next buffered input of every player and acknowledge the buffer depths
+     * 
+     * Expects playerMutex_ to be held.
+     */
+    void applyBufferedInputs();
+    
+    /**
+     * @brief Mark a player that sent no input as stopped and broadcast it
+     * 
+     * Clears the held input replicated for remote prediction and the
+     * horizontal velocity, so other clients stop extrapolating the player's
+     * last step. Expects playerMutex_ to be held.
+     * 
+     * @param playerId ID of the player
+     * @param player The player
+     */
+    void releaseHeldInput(uint32_t playerId, NetworkedEntity& player);
+    
+    /**
+     * @brief Record which entity states a client has received
+     * 
+     * @param ack The client's state acknowledgements
+     */
+    void handleStateAck(const packets::StateAckPacket& ack);
+    
+    /**
+     * @brief Open a session for a newly registered client and send it its token
+     * 
+     * Expects playerMutex_ to be held.
+     * 
+     * @param playerId ID of the registered player
+     * @param clientAddr The client's address
+     */
+    void openSession(uint32_t playerId, const sockaddr_in& clientAddr);
+    
+    /**
+     * @brief Move a session to the address a resume request came from
+     * 
+     * A valid token within the grace period rebinds the player to the new
+     * address and sends a catch-up snapshot; otherwise the request is
+     * rejected and the client has to register again.
+     * 
+     * @param request The resume request
+     * @param clientAddr The client's new address
+     */
+    void handleResumeRequest(const packets::ResumeRequestPacket& request, const sockaddr_in& clientAddr);
+    
+    /**
+     * @brief Send the latest state of every entity to a client that resumed
+     * 
+     * Expects playerMutex_ to be held.
+     * 
+     * @param playerId ID of the resumed player
+     * @param clientAddr The client's new address
+     */
+    void sendCatchUp(uint32_t playerId, const sockaddr_in& clientAddr);
+    
+    /**
+     * @brief Drop clients that have been silent for longer than the grace period
+     */
+    void expireSessions();
+    
+    /**
+     * @brief Rebuild the distinct destinations from the client addresses
+     * 
+     * Expects playerMutex_ to be held.
+     */
+    void rebuildDestinations();
+    
+    /**
+     * @brief Send pending entity states, resends and heartbeats
+     * 
+     * Changed entities are sent right away (subject to the broadcast throttle),
+     * unacknowledged states are resent to the clients missing them, and dormant
+     * entities are only sent as periodic heartbeats.
+     */
+    void flushReplication();
+    
+    /**
+     * @brief Periodically send the world checksum to all clients
+     * 
+     * Lets clients compare their authoritative states against the server's and
+     * detect entities that diverged, without sending full state dumps.
+     */
+    void sendStateChecksums();
+    
+    /**
+     * @brief Handle spectator subscriptions, capture due frames and send released ones
+     */
+    void updateSpectatorStream();
+    
+    /**
+     * @brief Queue a state packet for a single client
+     * 
+     * Expects playerMutex_ to be held. The packet leaves with the client's
+     * paced queue, see sendPacedStates().
+     * 
+     * @param clientAddr The client's address
+     * @param packet The state to send
+     */
+    void sendStatePacket(const sockaddr_in& clientAddr, const packets::PlayerStatePacket& packet);
+    
+    /**
+     * @brief Send the queued states that are due
+     */
+    void sendPacedStates();
+    
+    /**
+     * @brief Send a state packet to a single client right away
+     * 
+     * @param clientAddr The client's address
+     * @param packet The state to send
+     */
+    void writeStatePacket(const sockaddr_in& clientAddr, const packets::PlayerStatePacket& packet);
+    
+    /**
+     * @brief Build a state packet from a player's full kinematic state
+     * 
+     * @param playerId ID of the player
+     * @param player The player's networked entity
+     * @param sequenceNumber The sequence number of the last processed input
+     * @param wasPredicted Whether this state corresponds to a predicted action
+     * @return The filled in state packet
+     */
+    packets::PlayerStatePacket makeStatePacket(uint32_t playerId, const NetworkedEntity& player, uint32_t sequenceNumber, bool wasPredicted) const;
+    
     /**
      * @brief Broadcast a player's state to all connected clients
      * 
+     * Nothing is sent if the state has not changed since it was last replicated;
+     * unchanged entities are handled by flushReplication().
+     * 
      * @param playerId ID of the player whose state to broadcast
-     * @param x X coordinate
-     * @param y Y coordinate
-     * @param z Z coordinate
-     * @param isJumping Whether the player is currently jumping
+     * @param player The player's networked entity, providing position, velocity and jump state
      * @param sequenceNumber The sequence number of the last processed input
      * @param wasPredicted Whether this state corresponds to a predicted action
      */
-    void broadcastPlayerState(uint32_t playerId, float x, float y, float z, bool isJumping, uint32_t sequenceNumber, bool wasPredicted = false);
+    void broadcastPlayerState(uint32_t playerId, const NetworkedEntity& player, uint32_t sequenceNumber, bool wasPredicted = false);
 };
 
 } // namespace netcode
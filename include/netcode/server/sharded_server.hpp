@@ -0,0 +1,186 @@
+#pragma once
+
+#include "netcode/networked_entity.hpp"
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/server/outbound_pacer.hpp"
+#include "netcode/settings.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace netcode {
+
+/**
+ * @brief Configuration for the sharded server
+ */
+struct ShardedServerConfig {
+    // Number of shard threads, each with its own socket, sessions and entities
+    uint32_t shardCount = 4;
+
+    // Ticks per second at which shards send state and exchange entity visibility
+    float tickRate = 60.0f;
+
+    // Capacity of each mailbox between two shards
+    size_t mailboxCapacity = 1024;
+
+    // Time a session survives without an input or acknowledgement from its client (in milliseconds)
+    uint32_t sessionTimeoutMs = 10000;
+
+    // Outbound pacing of every shard's states
+    OutboundPacerConfig pacing;
+};
+
+/**
+ * @brief Packet and tick counters for a single shard
+ */
+struct ShardStats {
+    uint64_t packetsReceived = 0;   ///< Packets read from this shard's socket
+    uint64_t packetsForwarded = 0;  ///< Packets that belonged to another shard's session
+    uint64_t inputsProcessed = 0;   ///< Movement requests applied to owned entities
+    uint64_t ticks = 0;             ///< Ticks run by this shard
+    uint64_t sessionsExpired = 0;   ///< Sessions dropped after their client went silent
+    uint64_t tickOverruns = 0;      ///< Ticks that started after their deadline had already passed
+};
+
+/**
+ * @brief Thread-per-core server where each thread owns a slice of the sessions
+ *
+ * Every shard binds its own SO_REUSEPORT socket to the same port and owns the
+ * sessions and entities whose player ID maps to it. On Linux a reuseport BPF
+ * program steers datagrams by player ID, so each packet arrives at the owning
+ * shard and no locks are shared between threads. Packets that still end up on
+ * another shard (e.g. where the kernel steering is unavailable) are forwarded
+ * through a lock-free mailbox. Once per tick every shard publishes the entities
+ * that changed to all other shards, which send them on to their own clients.
+ * Each shard replicates like Server does, with its own StateReplicator and
+ * OutboundPacer: clients acknowledge states, acknowledged entities go dormant,
+ * world checksums are sent periodically and silent sessions expire.
+ *
+ * Player references must be set before start(); afterwards the entities are
+ * only touched by their owning shard's thread.
+ */
+class ShardedServer {
+public:
+    /**
+     * @brief Construct a new ShardedServer object
+     *
+     * @param port Port number all shards listen on (default: 7000)
+     * @param config Shard count, tick rate and mailbox sizing
+     * @param settings Settings interface for configuration (optional)
+     */
+    explicit ShardedServer(int port = 7000, const ShardedServerConfig& config = ShardedServerConfig(),
+                           std::shared_ptr<ISettings> settings = nullptr);
+
+    /**
+     * @brief Destroy the ShardedServer object and stop all shards
+     */
+    ~ShardedServer();
+
+    /**
+     * @brief Create the shard sockets and start one thread per shard
+     */
+    void start();
+
+    /**
+     * @brief Stop all shard threads and close their sockets
+     */
+    void stop();
+
+    /**
+     * @brief Assign a player entity to the shard that owns its session
+     *
+     * @param playerId ID of the player
+     * @param player Shared pointer to the networked entity
+     */
+    void setPlayerReference(uint32_t playerId, std::shared_ptr<NetworkedEntity> player);
+
+    /**
+     * @brief Get the shard that owns a player's session and entity
+     *
+     * @param playerId ID of the player
+     * @return uint32_t Index of the owning shard
+     */
+    uint32_t shardForPlayer(uint32_t playerId) const { return playerId % config_.shardCount; }
+
+    /**
+     * @brief Get the counters of a shard
+     *
+     * @param shardIndex Index of the shard
+     * @return ShardStats Snapshot of the shard's counters
+     */
+    ShardStats getShardStats(uint32_t shardIndex) const;
+
+    /**
+     * @brief Check whether datagrams are steered to shards by the kernel
+     *
+     * @return True if the reuseport steering program was attached
+     */
+    bool isKernelSteeringActive() const { return kernelSteering_; }
+
+private:
+    struct Shard;
+
+    int port_;                                   ///< Port number shared by all shards
+    ShardedServerConfig config_;                 ///< Shard configuration
+    std::shared_ptr<ISettings> settings_;        ///< Settings dependency
+    std::atomic<bool> running_;                  ///< Flag indicating if the shards are running
+    bool kernelSteering_ = false;                ///< Whether the reuseport program is attached
+    std::vector<std::unique_ptr<Shard>> shards_; ///< The shards, indexed by shard number
+
+    /**
+     * @brief Attach a reuseport program that selects the socket by player ID
+     *
+     * @param socketFd Any socket of the reuseport group
+     * @return True if the program was attached
+     */
+    bool attachSteeringProgram(int socketFd);
+
+    /**
+     * @brief Main loop of a shard thread
+     *
+     * @param shard The shard run by this thread
+     */
+    void runShard(Shard& shard);
+
+    /**
+     * @brief Read all pending datagrams from a shard's socket
+     *
+     * @param shard The shard to receive for
+     */
+    void receivePackets(Shard& shard);
+
+    /**
+     * @brief Apply ready inputs and acknowledgements, publish changes and replicate to the shard's clients
+     *
+     * @param shard The shard to tick
+     */
+    void tickShard(Shard& shard);
+
+    /**
+     * @brief Drop the sessions whose clients have been silent for longer than the session timeout
+     *
+     * @param shard The shard owning the sessions
+     * @param now Current time
+     */
+    void expireSessions(Shard& shard, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Send the states a shard's pacer releases
+     *
+     * @param shard The sending shard
+     */
+    void sendPacedStates(Shard& shard);
+
+    /**
+     * @brief Send a state packet from a shard to one of its clients
+     *
+     * @param shard The sending shard
+     * @param clientAddr The client's address
+     * @param packet The state to send
+     */
+    void sendState(Shard& shard, const sockaddr_in& clientAddr, const packets::PlayerStatePacket& packet);
+};
+
+} // namespace netcode
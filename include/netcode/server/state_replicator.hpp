@@ -0,0 +1,229 @@
+#pragma once
+
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/networked_entity.hpp"
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/server/outbound_pacer.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Replication bookkeeping of a server's entities towards its clients
+ *
+ * Stamps every change of an entity's state with a new state sequence, tracks
+ * which state sequence each client acknowledged and decides what has to be
+ * sent: changes (at most every MIN_BROADCAST_INTERVAL_MS per entity), resends
+ * to clients that have not acknowledged the latest state, and low-rate
+ * heartbeats of dormant entities every client already has. It also keeps the
+ * world checksum clients compare their states against.
+ *
+ * States leave through the caller's OutboundPacer. Not thread-safe, the
+ * owner guards it together with its client list.
+ */
+class StateReplicator {
+public:
+    // Minimum interval between two sends of an entity's changes (in milliseconds)
+    static constexpr uint32_t MIN_BROADCAST_INTERVAL_MS = 16; // ~60 FPS
+
+    // Interval for resending a state a client has not acknowledged yet (in milliseconds)
+    static constexpr uint32_t STATE_RESEND_INTERVAL_MS = 100;
+
+    // Interval for heartbeats of dormant entities (in milliseconds)
+    static constexpr uint32_t DORMANT_HEARTBEAT_INTERVAL_MS = 1000;
+
+    // Interval between world checksums sent to clients (in milliseconds)
+    static constexpr uint32_t CHECKSUM_INTERVAL_MS = 1000;
+
+    // Time without input after which a player counts as stopped (in milliseconds); clients only
+    // send inputs while keys are held, so silence is how a player releases them
+    static constexpr uint32_t INPUT_RELEASE_MS = 100;
+
+    /**
+     * @brief Fill in a state packet from an entity's simulation state
+     *
+     * The state sequence is left at zero, update() stamps it.
+     *
+     * @param entityId ID of the entity
+     * @param entity The entity, providing position, velocity and jump state
+     * @param input The movement input the entity is driven by, replicated for remote prediction
+     * @param inputSequence The sequence number of the last processed input
+     * @param wasPredicted Whether this state corresponds to a predicted action
+     * @return The filled in state packet
+     */
+    static packets::PlayerStatePacket makeStatePacket(uint32_t entityId, const NetworkedEntity& entity,
+                                                      const netcode::math::MyVec3& input,
+                                                      uint32_t inputSequence, bool wasPredicted);
+
+    /**
+     * @brief Check whether a player has been silent for long enough to count as stopped
+     *
+     * @param lastInputTime When the player's last input arrived
+     * @param now Current time
+     * @return True if no input arrived for INPUT_RELEASE_MS
+     */
+    static bool isInputReleased(std::chrono::steady_clock::time_point lastInputTime,
+                                std::chrono::steady_clock::time_point now) {
+        return now - lastInputTime >= std::chrono::milliseconds(INPUT_RELEASE_MS);
+    }
+
+    /**
+     * @brief Stop a player whose keys were released
+     *
+     * Clears the held input replicated for remote prediction and the
+     * horizontal velocity, so other clients stop extrapolating the player's
+     * last step. The position and any jump in progress are kept.
+     *
+     * @param player The player
+     * @param heldInput The player's held input, cleared
+     * @return True if the player was still holding an input
+     */
+    static bool releaseHeldInput(NetworkedEntity& player, netcode::math::MyVec3& heldInput);
+
+    /**
+     * @brief Take an entity's current state
+     *
+     * A changed state gets the next state sequence and has to be replicated;
+     * an unchanged one only refreshes the acknowledgement fields resends and
+     * heartbeats carry.
+     *
+     * @param packet The entity's state, its state sequence is set to the entity's latest
+     * @return True if the state changed
+     */
+    bool update(packets::PlayerStatePacket& packet);
+
+    /**
+     * @brief Take a state already stamped with its state sequence, e.g. by the shard owning the entity
+     *
+     * @param packet The entity's state
+     * @return True if the state sequence is newer than the latest known one
+     */
+    bool adopt(const packets::PlayerStatePacket& packet);
+
+    /**
+     * @brief Send an entity's changed state to all destinations
+     *
+     * Nothing is sent if the entity was sent less than MIN_BROADCAST_INTERVAL_MS
+     * ago, flush() sends the change once the interval has passed.
+     *
+     * @param entityId ID of the entity
+     * @param now Current time
+     * @param destinations Distinct client addresses
+     * @param pacer Queues the states leave through
+     */
+    void sendChange(uint32_t entityId, std::chrono::steady_clock::time_point now,
+                    const std::vector<sockaddr_in>& destinations, OutboundPacer& pacer);
+
+    /**
+     * @brief Send held back changes, resends and heartbeats that are due
+     *
+     * @param now Current time
+     * @param clients Map of client IDs to their addresses, acknowledgements are tracked per client ID
+     * @param destinations Distinct client addresses
+     * @param pacer Queues the states leave through
+     */
+    void flush(std::chrono::steady_clock::time_point now,
+               const std::unordered_map<uint32_t, sockaddr_in>& clients,
+               const std::vector<sockaddr_in>& destinations, OutboundPacer& pacer);
+
+    /**
+     * @brief Build the world checksum packets if a checksum round is due
+     *
+     * @param now Current time
+     * @return One packet per MAX_CHECKSUM_ENTRIES entities, empty if no round is due
+     */
+    std::vector<packets::StateChecksumPacket> takeChecksums(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Apply a client's state acknowledgements
+     *
+     * A zero state sequence asks for the entity again, e.g. after a desync.
+     *
+     * @param ack The client's state acknowledgements
+     */
+    void acknowledge(const packets::StateAckPacket& ack);
+
+    /**
+     * @brief Drop a client's acknowledgements, it gets every entity resent until it acknowledges again
+     *
+     * @param clientId ID of the client
+     */
+    void forgetClient(uint32_t clientId);
+
+    /**
+     * @brief Mark an entity as sleeping, dormant sleeping entities send no heartbeats
+     *
+     * @param entityId ID of the entity
+     * @param sleeping Whether the entity sleeps
+     */
+    void setSleeping(uint32_t entityId, bool sleeping);
+
+    /**
+     * @brief Check whether an entity has been replicated
+     *
+     * @param entityId ID of the entity
+     * @return True if update() or adopt() took a state of the entity
+     */
+    bool contains(uint32_t entityId) const { return entities_.count(entityId) > 0; }
+
+    /**
+     * @brief Get an entity's latest state sequence
+     *
+     * @param entityId ID of the entity
+     * @return The state sequence, 0 if the entity has not been replicated
+     */
+    uint32_t getStateSequence(uint32_t entityId) const;
+
+    /**
+     * @brief Get the latest state of every replicated entity
+     *
+     * @return The states, ordered by entity ID
+     */
+    std::vector<packets::PlayerStatePacket> getLatestStates() const;
+
+    /**
+     * @brief Get the number of replicated entities
+     *
+     * @return size_t Entity count
+     */
+    size_t size() const { return entities_.size(); }
+
+private:
+    /**
+     * @brief Replication bookkeeping for a single entity
+     *
+     * An entity whose latest state has been acknowledged by every client is
+     * dormant: it is only sent as a low-rate heartbeat until its state changes.
+     */
+    struct EntityState {
+        packets::PlayerStatePacket latest{};                       ///< Latest state, stamped with its state sequence
+        uint32_t sentSequence = 0;                                 ///< State sequence last sent to all clients
+        std::unordered_map<uint32_t, uint32_t> ackedSequences;     ///< Latest state sequence acknowledged per client
+        std::chrono::steady_clock::time_point lastSendTime;        ///< When the entity was last sent
+        bool dormant = false;                                      ///< Whether every client has the latest state
+        uint64_t hash = 0;                                         ///< Hash of the latest state
+        bool sleeping = false;                                     ///< Sleeping prop, no heartbeats needed
+    };
+
+    // Map of entity IDs to their replication state, ordered for stable checksum packets
+    std::map<uint32_t, EntityState> entities_;
+
+    // XOR of all entity state hashes, updated incrementally whenever an entity changes
+    uint64_t worldChecksum_ = 0;
+
+    // Sequence number of the last checksum round
+    uint32_t checksumSequence_ = 0;
+
+    // When the last checksum round was built
+    std::chrono::steady_clock::time_point lastChecksumTime_;
+
+    // Take a new latest state of an entity and swap its hash in the world checksum
+    void replaceLatest(EntityState& entity, const packets::PlayerStatePacket& packet);
+};
+
+} // namespace netcode
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "netcode/packets/spectator_packets.hpp"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Configuration of a spectator client
+ */
+struct SpectatorClientConfig {
+    uint32_t spectatorId = 0;          ///< Identifies the spectator in logs
+    int port = 0;                      ///< Local port, 0 for any
+    std::string streamIp = "127.0.0.1"; ///< Address of the game server or a spectator relay
+    int streamPort = 7200;             ///< Spectator port of the game server or relay
+    uint32_t keepaliveMs = 1000;       ///< Interval for refreshing the subscription
+};
+
+/**
+ * @brief Statistics of a spectator client
+ */
+struct SpectatorClientStats {
+    uint32_t lastFrame = 0;       ///< Last frame applied
+    uint32_t lastCaptureTimeMs = 0; ///< Capture time of the last frame applied
+    uint64_t keyframesApplied = 0; ///< Keyframes applied
+    uint64_t deltasApplied = 0;   ///< Delta frames applied
+    uint64_t framesSkipped = 0;   ///< Frames dropped while waiting for a keyframe
+};
+
+/**
+ * @brief Watches a spectator stream without joining the game
+ *
+ * Rebuilds the world from keyframes and deltas. A delta is only applied on
+ * top of the frame it was encoded against; after a lost packet the client
+ * waits for the next keyframe instead of showing a wrong world.
+ */
+class SpectatorClient {
+public:
+    /**
+     * @brief Construct a new SpectatorClient object
+     *
+     * @param config Client configuration
+     */
+    explicit SpectatorClient(const SpectatorClientConfig& config);
+
+    /**
+     * @brief Destroy the SpectatorClient object and clean up resources
+     */
+    ~SpectatorClient();
+
+    /**
+     * @brief Subscribe to the stream and start the receive thread
+     *
+     * @return True if the client started
+     */
+    bool start();
+
+    /**
+     * @brief Unsubscribe, stop the receive thread and close the socket
+     */
+    void stop();
+
+    /**
+     * @brief Get the world as of the last applied frame
+     *
+     * @return Map of entity IDs to their states
+     */
+    std::map<uint32_t, packets::SpectatorEntityState> getEntityStates();
+
+    /**
+     * @brief Check whether the client has a consistent world to show
+     *
+     * @return True once a keyframe has been applied and no frame was lost since
+     */
+    bool isSynchronized();
+
+    /**
+     * @brief Get the client's statistics
+     *
+     * @return SpectatorClientStats Current statistics
+     */
+    SpectatorClientStats getStats();
+
+    /**
+     * @brief Apply a received frame part
+     *
+     * @param packet The frame part
+     */
+    void handleFrame(const packets::SpectatorFramePacket& packet);
+
+private:
+    /**
+     * @brief Frame whose parts have not all arrived yet
+     */
+    struct PendingFrame {
+        bool keyframe = false;
+        uint32_t baseFrame = 0;
+        uint32_t captureTimeMs = 0;
+        uint16_t partCount = 0;
+        uint16_t partsReceived = 0;
+        std::map<uint32_t, packets::SpectatorEntityState> entities;
+    };
+
+    SpectatorClientConfig config_;     ///< Client configuration
+    sockaddr_in streamAddr_{};         ///< Address of the stream
+    int socketFd_ = -1;                ///< Socket receiving the stream
+    std::atomic<bool> running_;        ///< Flag indicating if the client is running
+    std::thread receiveThread_;        ///< Thread receiving frames
+
+    std::mutex stateMutex_;                                   ///< Protects the world and statistics
+    std::map<uint32_t, packets::SpectatorEntityState> world_; ///< World as of the last applied frame
+    std::map<uint32_t, PendingFrame> pendingFrames_;          ///< Frames still missing parts
+    bool synchronized_ = false;                               ///< Whether world_ is consistent
+    SpectatorClientStats stats_;                              ///< Client statistics
+
+    /**
+     * @brief Main loop of the receive thread
+     */
+    void run();
+
+    /**
+     * @brief Subscribe to, refresh or leave the stream
+     *
+     * @param unsubscribe Whether to leave the stream
+     */
+    void sendSubscription(bool unsubscribe);
+
+    /**
+     * @brief Apply a frame whose parts have all arrived
+     *
+     * @param frameNumber Number of the frame
+     * @param frame The assembled frame
+     */
+    void applyFrame(uint32_t frameNumber, const PendingFrame& frame);
+};
+
+} // namespace netcode
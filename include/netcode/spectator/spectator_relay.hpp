@@ -0,0 +1,99 @@
+#pragma once
+
+#include "netcode/spectator/spectator_stream.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Configuration of a spectator relay
+ */
+struct SpectatorRelayConfig {
+    uint32_t relayId = 0;              ///< Identifies the relay to its upstream
+    int port = 7300;                   ///< Port spectators subscribe on
+    std::string upstreamIp = "127.0.0.1"; ///< Address of the game server or parent relay
+    int upstreamPort = 7200;           ///< Spectator port of the game server or parent relay
+    uint32_t keepaliveMs = 1000;       ///< Interval for refreshing the upstream subscription
+    uint32_t subscriberTimeoutMs = 5000; ///< Subscriptions not refreshed for this long are dropped
+};
+
+/**
+ * @brief Re-fans-out a spectator stream to its own subscribers
+ *
+ * The relay subscribes upstream like a single spectator and forwards every
+ * frame unchanged to its subscribers. It keeps the latest keyframe and the
+ * deltas after it so new spectators can start watching right away. Relays can
+ * subscribe to other relays, so the audience of a match can grow into a tree
+ * without adding load on the game server.
+ */
+class SpectatorRelay {
+public:
+    /**
+     * @brief Construct a new SpectatorRelay object
+     *
+     * @param config Relay configuration
+     */
+    explicit SpectatorRelay(const SpectatorRelayConfig& config);
+
+    /**
+     * @brief Destroy the SpectatorRelay object and clean up resources
+     */
+    ~SpectatorRelay();
+
+    /**
+     * @brief Bind the socket and start the relay thread
+     *
+     * @return True if the relay started
+     */
+    bool start();
+
+    /**
+     * @brief Unsubscribe upstream, stop the relay thread and close the socket
+     */
+    void stop();
+
+    /**
+     * @brief Get the number of spectators subscribed to this relay
+     *
+     * @return size_t Subscriber count
+     */
+    size_t getSubscriberCount();
+
+    /**
+     * @brief Get the number of packets sent to subscribers so far
+     *
+     * @return uint64_t Packet count
+     */
+    uint64_t getPacketsSent();
+
+private:
+    SpectatorRelayConfig config_;      ///< Relay configuration
+    sockaddr_in upstreamAddr_{};       ///< Address of the upstream stream
+    int socketFd_ = -1;                ///< Socket for upstream and subscribers
+    std::atomic<bool> running_;        ///< Flag indicating if the relay is running
+    std::thread relayThread_;          ///< Thread running the relay
+
+    std::mutex fanoutMutex_;           ///< Protects the fanout
+    SpectatorFanout fanout_;           ///< Subscribers of this relay
+    std::vector<packets::SpectatorFramePacket> catchUp_; ///< Latest keyframe and following deltas
+
+    /**
+     * @brief Main loop of the relay thread
+     */
+    void run();
+
+    /**
+     * @brief Subscribe to, refresh or leave the upstream stream
+     *
+     * @param unsubscribe Whether to leave the stream
+     */
+    void sendUpstreamSubscription(bool unsubscribe);
+};
+
+} // namespace netcode
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/packets/spectator_packets.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode {
+
+/**
+ * @brief Configuration of a spectator stream
+ */
+struct SpectatorStreamConfig {
+    // Port spectators and relays subscribe on
+    int port = 7200;
+
+    // How far the stream lags behind the game (in milliseconds)
+    uint32_t delayMs = 2000;
+
+    // Frames captured per second, well below the game's tick rate
+    float frameRate = 10.0f;
+
+    // A keyframe is sent every this many frames, deltas in between
+    uint32_t keyframeInterval = 20;
+
+    // Subscriptions not refreshed for this long are dropped (in milliseconds)
+    uint32_t subscriberTimeoutMs = 5000;
+};
+
+/**
+ * @brief Encodes the world into a delayed stream of keyframes and deltas
+ *
+ * Frames are captured at the stream's frame rate and encoded once, right when
+ * they are captured. They are held back until the configured delay has passed
+ * and then released for sending; the same packets go to every spectator, so
+ * the encode cost does not grow with the audience.
+ */
+class SpectatorStream {
+public:
+    /**
+     * @brief Construct a new SpectatorStream object
+     *
+     * @param config Stream configuration
+     */
+    explicit SpectatorStream(const SpectatorStreamConfig& config);
+
+    /**
+     * @brief Check whether the next frame is due
+     *
+     * @param now Current time
+     * @return True if a frame should be captured
+     */
+    bool isCaptureDue(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief Encode a frame of the world and hold it back until its delay has passed
+     *
+     * @param states Current state of every entity
+     * @param now Current time
+     */
+    void capture(const std::vector<packets::PlayerStatePacket>& states, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Take the encoded frames whose delay has passed
+     *
+     * @param now Current time
+     * @return Packets to send to every subscriber, in frame order
+     */
+    std::vector<packets::SpectatorFramePacket> releaseFrames(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Get the packets a late joiner needs to catch up
+     *
+     * @return The last released keyframe followed by all deltas released since
+     */
+    const std::vector<packets::SpectatorFramePacket>& getCatchUpFrames() const { return catchUp_; }
+
+    /**
+     * @brief Get the number of frames captured so far
+     *
+     * @return uint32_t Frame count
+     */
+    uint32_t getFrameCount() const { return frameNumber_; }
+
+private:
+    /**
+     * @brief Frame waiting for its delay to pass
+     */
+    struct DelayedFrame {
+        std::chrono::steady_clock::time_point releaseTime;
+        std::vector<packets::SpectatorFramePacket> parts;
+    };
+
+    SpectatorStreamConfig config_;                          ///< Stream configuration
+    std::chrono::steady_clock::time_point streamStart_;     ///< When the stream was created
+    std::chrono::steady_clock::time_point lastCaptureTime_; ///< When the last frame was captured
+    uint32_t frameNumber_ = 0;                              ///< Number of the last captured frame
+    uint32_t framesSinceKeyframe_ = 0;                      ///< Frames captured since the last keyframe
+    std::map<uint32_t, uint32_t> capturedSequences_;        ///< State sequence of each entity in the last frame
+    std::deque<DelayedFrame> delayed_;                      ///< Encoded frames not released yet
+    std::vector<packets::SpectatorFramePacket> catchUp_;    ///< Released keyframe and following deltas
+};
+
+/**
+ * @brief Subscribers of a spectator stream
+ *
+ * Tracks who is watching and sends encoded frames to all of them. Used by the
+ * game server and by spectator relays alike.
+ */
+class SpectatorFanout {
+public:
+    /**
+     * @brief Construct a new SpectatorFanout object
+     *
+     * @param subscriberTimeoutMs Subscriptions not refreshed for this long are dropped
+     */
+    explicit SpectatorFanout(uint32_t subscriberTimeoutMs);
+
+    /**
+     * @brief Handle a subscription, refresh or unsubscription
+     *
+     * @param addr Address of the subscriber
+     * @param packet The subscription packet
+     * @return True if the address is a new subscriber that needs to catch up
+     */
+    bool handleSubscription(const sockaddr_in& addr, const packets::SpectatorSubscribePacket& packet);
+
+    /**
+     * @brief Drop subscriptions that have not been refreshed
+     */
+    void expireSubscribers();
+
+    /**
+     * @brief Send packets to every subscriber
+     *
+     * @param socketFd Socket to send from
+     * @param frames The encoded packets
+     */
+    void send(int socketFd, const std::vector<packets::SpectatorFramePacket>& frames);
+
+    /**
+     * @brief Send packets to a single subscriber
+     *
+     * @param socketFd Socket to send from
+     * @param addr Address of the subscriber
+     * @param frames The encoded packets
+     */
+    void sendTo(int socketFd, const sockaddr_in& addr, const std::vector<packets::SpectatorFramePacket>& frames);
+
+    /**
+     * @brief Get the number of current subscribers
+     *
+     * @return size_t Subscriber count
+     */
+    size_t getSubscriberCount() const { return subscribers_.size(); }
+
+    /**
+     * @brief Get the number of packets sent to subscribers so far
+     *
+     * @return uint64_t Packet count
+     */
+    uint64_t getPacketsSent() const { return packetsSent_; }
+
+private:
+    /**
+     * @brief A spectator or relay watching the stream
+     */
+    struct Subscriber {
+        sockaddr_in addr;
+        std::chrono::steady_clock::time_point lastSeen;
+    };
+
+    uint32_t subscriberTimeoutMs_;        ///< Subscription lifetime without refresh
+    std::vector<Subscriber> subscribers_; ///< Current subscribers
+    uint64_t packetsSent_ = 0;            ///< Packets sent to subscribers
+};
+
+} // namespace netcode
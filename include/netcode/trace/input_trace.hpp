@@ -0,0 +1,201 @@
+#pragma once
+
+#include "netcode/packets/player_state_packet.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace netcode {
+
+/**
+ * @brief One recorded input of a player
+ */
+struct InputTraceEvent {
+    uint64_t timeUs = 0;                    ///< Time since the start of the trace (in microseconds)
+    packets::PlayerMovementRequest input{}; ///< The input as the client sent it
+};
+
+/**
+ * @brief Input streams of one or more players, ordered by time
+ *
+ * Stored as a small header followed by one fixed-size record per event,
+ * written field by field so the file does not depend on struct padding.
+ */
+class InputTrace {
+public:
+    /**
+     * @brief Append an event, keeping the events ordered by time
+     *
+     * @param event The event
+     */
+    void add(const InputTraceEvent& event);
+
+    /**
+     * @brief Get the events
+     *
+     * @return Events ordered by time, events at the same time in insertion order
+     */
+    const std::vector<InputTraceEvent>& getEvents() const { return events_; }
+
+    /**
+     * @brief Get the time of the last event
+     *
+     * @return uint64_t Duration of the trace (in microseconds)
+     */
+    uint64_t getDurationUs() const { return events_.empty() ? 0 : events_.back().timeUs; }
+
+    /**
+     * @brief Get the players that have inputs in the trace
+     *
+     * @return Player IDs in ascending order
+     */
+    std::vector<uint32_t> getPlayerIds() const;
+
+    /**
+     * @brief Write the trace to a file
+     *
+     * @param path File to write
+     * @return True if the whole trace was written
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Replace the trace with the contents of a file
+     *
+     * @param path File to read
+     * @return True if the file is a valid trace, the trace is left empty otherwise
+     */
+    bool load(const std::string& path);
+
+private:
+    std::vector<InputTraceEvent> events_;
+};
+
+/**
+ * @brief Records the inputs clients send, timed from the first input
+ *
+ * Thread-safe, so several clients can share one recorder to capture a whole
+ * session of real players.
+ */
+class InputTraceRecorder {
+public:
+    /**
+     * @brief Record an input at the current time
+     *
+     * @param input The input
+     */
+    void record(const packets::PlayerMovementRequest& input);
+
+    /**
+     * @brief Get a copy of everything recorded so far
+     *
+     * @return InputTrace The recorded trace
+     */
+    InputTrace getTrace() const;
+
+    /**
+     * @brief Drop the recorded inputs, the next input starts a new trace
+     */
+    void clear();
+
+private:
+    mutable std::mutex mutex_;
+    InputTrace trace_;
+    std::chrono::steady_clock::time_point startTime_;
+    bool started_ = false;
+};
+
+/**
+ * @brief How a trace is turned into bot input
+ */
+struct TraceTransform {
+    // Playback speed factor, 2 replays the trace twice as fast
+    float timeScale = 1.0f;
+
+    // Delay before the first input (in microseconds), staggers mixed copies
+    uint64_t startOffsetUs = 0;
+
+    // Added to every player ID, so copies of a trace do not share players
+    uint32_t playerIdOffset = 0;
+
+    // Negate the movement along X and Z, so a copy moves through the opposite side of the map
+    bool mirrorX = false;
+    bool mirrorZ = false;
+};
+
+/**
+ * @brief Apply a transform to every event of a trace
+ *
+ * @param trace The source trace
+ * @param transform The transform
+ * @return InputTrace The transformed trace
+ */
+InputTrace transformTrace(const InputTrace& trace, const TraceTransform& transform);
+
+/**
+ * @brief Merge traces into one, ordered by time
+ *
+ * Events at the same time keep the order of the traces they come from.
+ *
+ * @param traces The traces, usually transformed so their players are distinct
+ * @return InputTrace The merged trace
+ */
+InputTrace mixTraces(const std::vector<InputTrace>& traces);
+
+/**
+ * @brief Plays a trace back against any clock
+ *
+ * The caller passes the elapsed time, so the same trace drives a real-time
+ * load generator as well as a simulation stepped on a virtual clock.
+ */
+class TraceReplayer {
+public:
+    /**
+     * @brief Construct a new TraceReplayer object
+     *
+     * @param trace The trace to play
+     */
+    explicit TraceReplayer(InputTrace trace);
+
+    /**
+     * @brief Take the inputs that are due
+     *
+     * @param elapsedUs Time since the start of playback (in microseconds)
+     * @return Events at or before the elapsed time that were not taken yet
+     */
+    std::vector<InputTraceEvent> advanceTo(uint64_t elapsedUs);
+
+    /**
+     * @brief Get the time of the next input
+     *
+     * @return uint64_t Time of the next event (in microseconds), the trace duration once finished
+     */
+    uint64_t getNextEventTimeUs() const;
+
+    /**
+     * @brief Check whether every input was taken
+     *
+     * @return True once playback is finished
+     */
+    bool isFinished() const { return next_ >= trace_.getEvents().size(); }
+
+    /**
+     * @brief Restart playback from the first input
+     */
+    void reset() { next_ = 0; }
+
+    /**
+     * @brief Get the trace being played
+     *
+     * @return const InputTrace& The trace
+     */
+    const InputTrace& getTrace() const { return trace_; }
+
+private:
+    InputTrace trace_;
+    size_t next_ = 0;
+};
+
+} // namespace netcode
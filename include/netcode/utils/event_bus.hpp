@@ -0,0 +1,200 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Lock-free single-producer multi-consumer event bus
+     *
+     * A sequenced ring buffer: the producer publishes each event once and every
+     * subscriber reads all events at its own pace from its own thread. The
+     * producer never waits for subscribers; a subscriber that falls more than a
+     * ring behind skips to the oldest event still held and counts the ones it
+     * lost. Each slot is a seqlock, so a read that races with the producer
+     * overwriting the slot is detected and retried instead of returning a torn
+     * event.
+     *
+     * @tparam T Event type, must be trivially copyable
+     */
+    template <typename T>
+    class EventBus {
+        static_assert(std::is_trivially_copyable_v<T>, "EventBus events are copied word by word");
+
+        static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        /**
+         * @brief One ring slot, the event stored as atomic words behind a version
+         */
+        struct Slot {
+            std::atomic<uint64_t> version{0};           ///< Odd while written, 2 * sequence once published
+            std::atomic<uint64_t> words[WORD_COUNT]{};  ///< The event
+        };
+
+    public:
+        /**
+         * @brief Reading position of one consumer
+         *
+         * Used from a single consumer thread; several subscribers may read the
+         * same bus concurrently.
+         */
+        class Subscriber {
+        public:
+            /**
+             * @brief Reads the next event
+             * @param event Receives the event
+             * @return False if the subscriber has read everything published
+             */
+            bool try_read(T& event) {
+                return bus_->read(next_, lost_, event);
+            }
+
+            /**
+             * @brief Hands every pending event to a handler
+             * @param handler Called with each event in publishing order
+             * @param max_events Most events to handle in this call
+             * @return Number of events handled
+             */
+            template <typename Handler>
+            size_t poll(Handler&& handler, size_t max_events = SIZE_MAX) {
+                size_t handled = 0;
+                T event;
+                while (handled < max_events && try_read(event)) {
+                    handler(event);
+                    ++handled;
+                }
+                return handled;
+            }
+
+            /**
+             * @brief Gets the number of events skipped because the producer lapped the subscriber
+             * @return Lost event count
+             */
+            uint64_t lost() const { return lost_; }
+
+            /**
+             * @brief Gets the number of events published but not read yet
+             * @return Backlog, may exceed the ring size for a lapped subscriber
+             */
+            uint64_t backlog() const {
+                uint64_t published = bus_->published();
+                return published >= next_ ? published - next_ + 1 : 0;
+            }
+
+        private:
+            friend class EventBus;
+
+            Subscriber(const EventBus* bus, uint64_t next) : bus_(bus), next_(next) {}
+
+            const EventBus* bus_;
+            uint64_t next_;     ///< Sequence of the next event to read
+            uint64_t lost_ = 0; ///< Events skipped so far
+        };
+
+        /**
+         * @brief Constructs the bus
+         * @param capacity Number of events kept for slow subscribers, rounded up to a power of two
+         */
+        explicit EventBus(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            mask_ = size - 1;
+            slots_ = std::make_unique<Slot[]>(size);
+        }
+
+        EventBus(const EventBus&) = delete;
+        EventBus& operator=(const EventBus&) = delete;
+
+        /**
+         * @brief Publishes an event, called from the producer only
+         * @param event The event
+         * @return Sequence of the event, starting at 1
+         */
+        uint64_t publish(const T& event) {
+            uint64_t sequence = published_.load(std::memory_order_relaxed) + 1;
+            Slot& slot = slots_[sequence & mask_];
+
+            uint64_t words[WORD_COUNT] = {};
+            std::memcpy(words, &event, sizeof(T));
+
+            slot.version.store(2 * sequence - 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORD_COUNT; ++i) {
+                slot.words[i].store(words[i], std::memory_order_relaxed);
+            }
+            slot.version.store(2 * sequence, std::memory_order_release);
+            published_.store(sequence, std::memory_order_release);
+            return sequence;
+        }
+
+        /**
+         * @brief Creates a subscriber that reads the events published from now on
+         * @return The subscriber
+         */
+        Subscriber subscribe() const {
+            return Subscriber(this, published() + 1);
+        }
+
+        /**
+         * @brief Gets the sequence of the latest published event
+         * @return The sequence, 0 if nothing was published
+         */
+        uint64_t published() const { return published_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Gets the number of events kept for slow subscribers
+         * @return The capacity of the ring
+         */
+        size_t capacity() const { return mask_ + 1; }
+
+    private:
+        // Reads the event with sequence next, skipping ahead if it was overwritten
+        bool read(uint64_t& next, uint64_t& lost, T& event) const {
+            while (true) {
+                uint64_t published = published_.load(std::memory_order_acquire);
+                if (next > published) {
+                    return false;
+                }
+                if (published - next >= capacity()) {
+                    // Lapped, continue at the oldest event still in the ring
+                    uint64_t oldest = published - capacity() + 1;
+                    lost += oldest - next;
+                    next = oldest;
+                }
+
+                const Slot& slot = slots_[next & mask_];
+                uint64_t version = slot.version.load(std::memory_order_acquire);
+                if (version != 2 * next) {
+                    // The producer is already overwriting the slot
+                    continue;
+                }
+                uint64_t words[WORD_COUNT];
+                for (size_t i = 0; i < WORD_COUNT; ++i) {
+                    words[i] = slot.words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) != version) {
+                    continue;
+                }
+
+                std::memcpy(&event, words, sizeof(T));
+                ++next;
+                return true;
+            }
+        }
+
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        // The producer's sequence is polled by every subscriber, keep it off the slot lines
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> published_{0};
+        alignas(CACHE_LINE_SIZE) size_t mask_ = 0;
+        std::unique_ptr<Slot[]> slots_;
+    };
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Configuration of a rotating log file
+     */
+    struct LogFileConfig {
+        // Path of the active log file, rotated files are kept next to it as <path>.YYYYMMDD-HHMMSS[.N][.gz]
+        std::string path;
+
+        // Rotate once the active file reaches this size (in bytes), 0 disables size rotation
+        uint64_t max_file_bytes = 16 * 1024 * 1024;
+
+        // Rotate once the active file has been open this long (in seconds), 0 disables time rotation
+        uint32_t max_file_age_s = 24 * 60 * 60;
+
+        // Space the active and rotated files may take together (in bytes), the oldest rotated files go first; 0 keeps everything
+        uint64_t disk_budget_bytes = 256 * 1024 * 1024;
+
+        // Gzip rotated files; needs the library to be built with zlib, otherwise they stay uncompressed
+        bool compress = true;
+
+        // Lines that may wait for the writer thread, further lines are dropped until it catches up
+        size_t max_queued_lines = 64 * 1024;
+    };
+
+    /**
+     * @brief Counters of a log writer
+     */
+    struct LogWriterStats {
+        uint64_t lines_written = 0;   ///< Lines written to the file
+        uint64_t lines_dropped = 0;   ///< Lines dropped because the queue was full
+        uint64_t bytes_written = 0;   ///< Bytes written to the file
+        uint64_t rotations = 0;       ///< Times the active file was rotated
+        uint64_t files_deleted = 0;   ///< Rotated files deleted to stay within the disk budget
+    };
+
+    /**
+     * @brief Writes log lines to a rotating file on a background thread
+     *
+     * Logging threads only append to an in-memory queue. Writing, flushing
+     * and rotation happen on the writer thread, so a slow disk never stalls a
+     * network thread; when the writer falls too far behind, new lines are
+     * dropped and counted instead. Compressing rotated files and enforcing
+     * the disk budget happen on a separate housekeeping thread, so the
+     * writer keeps writing into the new file meanwhile.
+     */
+    class LogWriter {
+    public:
+        /**
+         * @brief Constructor
+         * @param config Configuration of the log file
+         */
+        explicit LogWriter(const LogFileConfig& config);
+
+        /**
+         * @brief Destructor writing the remaining lines
+         */
+        ~LogWriter();
+
+        LogWriter(const LogWriter&) = delete;
+        LogWriter& operator=(const LogWriter&) = delete;
+
+        /**
+         * @brief Opens the active file in append mode and starts the writer thread
+         * @return true if the file was opened successfully, false otherwise
+         */
+        bool open();
+
+        /**
+         * @brief Queues a line, a newline is appended when it is written
+         * @param line The line to write
+         */
+        void write(std::string line);
+
+        /**
+         * @brief Waits until every line queued so far is written and flushed
+         *
+         * Also waits for the housekeeping of the files rotated meanwhile.
+         */
+        void flush();
+
+        /**
+         * @brief Writes the remaining lines, stops the threads and closes the file
+         */
+        void close();
+
+        /**
+         * @brief Gets the writer counters
+         * @return The counters
+         */
+        LogWriterStats stats() const;
+
+    private:
+        LogFileConfig config_;
+        std::filesystem::path path_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable drained_;
+        std::vector<std::string> queue_;
+        bool stopping_ = false;
+        bool writing_ = false;
+        LogWriterStats stats_;
+
+        // Rotated files waiting for compression and the disk budget, an empty path only enforces the budget
+        std::condition_variable housekeeping_wake_;
+        std::vector<std::filesystem::path> rotated_files_;
+        bool housekeeper_stopping_ = false;
+        bool housekeeping_ = false;
+        std::thread housekeeper_;
+
+        // Only used by the writer thread once it runs
+        std::ofstream file_;
+        uint64_t file_bytes_ = 0;
+        std::chrono::steady_clock::time_point file_opened_;
+        std::thread thread_;
+
+        void run();
+        void run_housekeeping();
+        bool open_file();
+        bool rotation_due() const;
+        void rotate();
+        void compress(const std::filesystem::path& rotated);
+        bool is_rotated_file(const std::string& file_name) const;
+        void enforce_budget();
+    };
+
+}
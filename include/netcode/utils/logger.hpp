@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <fstream>
 #include <iostream>
 #include <mutex>
@@ -8,12 +11,13 @@
 #include <iomanip>
 #include <sstream>
 #include <functional>
+#include "netcode/utils/log_writer.hpp"
 
 /**
  *@file logger.hpp
  *@brief Simple logging system for the netcode library
  *
- * Supports different log levels, file output, and custom callbacks.
+ * Supports different log levels, per-category levels, rotating file output, and custom callbacks.
  */
 
 namespace netcode::utils {
@@ -29,6 +33,49 @@ enum class LogLevel {
     NONE
 };
 
+/**
+ * @brief Interned log category with its own minimum level
+ *
+ * There is one category per component name for the lifetime of the logger,
+ * so call sites can keep a reference to theirs. The level is read atomically,
+ * which lets a disabled message be skipped before it is formatted.
+ */
+class LogCategory {
+public:
+    /**
+     * @brief Constructor
+     * @param name The component name
+     * @param level The initial minimum level
+     */
+    LogCategory(std::string name, LogLevel level) : name_(std::move(name)), level_(level) {}
+
+    /**
+     * @brief Gets the component name
+     * @return The name
+     */
+    const std::string& name() const { return name_; }
+
+    /**
+     * @brief Gets the minimum level of the category
+     * @return The level
+     */
+    LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Checks whether messages of a level are logged for this category
+     * @param level The level of the message
+     * @return true if the message would be logged
+     */
+    bool enabled(LogLevel level) const { return level >= level_.load(std::memory_order_relaxed); }
+
+private:
+    friend class Logger;
+
+    std::string name_;              /**< Component name */
+    std::atomic<LogLevel> level_;   /**< Minimum level, the global level unless overridden */
+    bool overridden_ = false;       /**< Whether the level was set for this category, guarded by the logger */
+};
+
 /**
  * @brief Thread-safe logging class that works as a singleton.
  */
@@ -53,18 +100,71 @@ public:
 
     /**
      * @brief Sets the minimum level for log messages to be processed
+     *
+     * Categories with a level of their own keep it.
+     *
      * @param level The new minimum level for logging
      */
 
     void set_level(LogLevel level);
 
     /**
-     * @brief Sets up a file for log output
+     * @brief Gets the interned category for a component, creating it if needed
+     * @param name The component name
+     * @return The category, valid for the lifetime of the logger
+     */
+    LogCategory& category(const std::string& name);
+
+    /**
+     * @brief Sets the minimum level of one category, e.g. DEBUG for a single component
+     * @param name The component name
+     * @param level The minimum level for the category
+     */
+    void set_category_level(const std::string& name, LogLevel level);
+
+    /**
+     * @brief Makes a category follow the global level again
+     * @param name The component name
+     */
+    void clear_category_level(const std::string& name);
+
+    /**
+     * @brief Sets category levels from a list like "ReconciliationSystem=DEBUG,Server=WARNING"
+     * @param spec Comma separated name=LEVEL pairs
+     * @return true if every pair was valid, invalid pairs are skipped
+     */
+    bool set_category_levels(const std::string& spec);
+
+    /**
+     * @brief Parses a level name such as "DEBUG" or "warning"
+     * @param name The level name
+     * @param level Receives the level
+     * @return true if the name is a known level
+     */
+    static bool parse_level(const std::string& name, LogLevel& level);
+
+    /**
+     * @brief Sets up a file for log output, rotated with the default LogFileConfig limits
      * @param filename The path to the file to use for log output
      * @return true if the file was opened successfully, false otherwise
      */
     bool set_log_file(const std::string& filename);
 
+    /**
+     * @brief Sets up a rotating file for log output
+     *
+     * Lines are written, rotated and compressed on a background thread.
+     *
+     * @param config Path, rotation limits and disk budget of the log file
+     * @return true if the file was opened successfully, false otherwise
+     */
+    bool set_log_file(const LogFileConfig& config);
+
+    /**
+     * @brief Waits until every line logged so far is in the log file
+     */
+    void flush_log_file();
+
     /**
      * @brief Closes the open log file if one exists
      */
@@ -113,10 +213,20 @@ public:
      */
     void log(LogLevel level, const std::string& message, const std::string& component = "General");
 
+    /**
+     * @brief Logs a message for a category without checking its level again
+     * @param level The log level for the message
+     * @param message The message to log
+     * @param category The category the message belongs to
+     */
+    void log(LogLevel level, const std::string& message, const LogCategory& category);
+
 private:
     std::mutex log_mutex_;           /**< Mutex for thread safety */
-    LogLevel current_level_;         /**< Current minimum log level */
-    std::ofstream log_file_;         /**< Output file stream for the log file */
+    std::atomic<LogLevel> current_level_; /**< Current minimum log level */
+    std::mutex category_mutex_;      /**< Guards the category table and the overrides */
+    std::unordered_map<std::string, std::unique_ptr<LogCategory>> categories_; /**< Interned categories by name */
+    std::shared_ptr<LogWriter> log_writer_; /**< Background writer of the log file, shared with a running flush */
     std::vector<std::function<void(LogLevel, const std::string&)>> callbacks_; /**< Registered callback functions */
 
     /**
@@ -133,32 +243,51 @@ private:
     static std::string level_to_string(LogLevel level);
 };
 
+    /**
+     * @brief Logs through the call site's category, formatting the message only if it is enabled
+     *
+     * The category is looked up once per call site. The component must be a
+     * string literal, so that it is the same on every call.
+     *
+     * @param level The log level
+     * @param msg The message to log
+     * @param component The component the message belongs to
+     */
+#define NETCODE_LOG(level, msg, component)                                                      \
+    do {                                                                                        \
+        static netcode::utils::LogCategory& netcode_log_category_ =                             \
+            netcode::utils::Logger::get_instance().category("" component);                      \
+        if (netcode_log_category_.enabled(level)) {                                             \
+            netcode::utils::Logger::get_instance().log(level, msg, netcode_log_category_);      \
+        }                                                                                       \
+    } while (0)
+
     /**
      * @brief Macro for DEBUG level logging with component name
      * @param msg The message to log
      * @param component The component the message belongs to
      */
-#define LOG_DEBUG(msg, component) netcode::utils::Logger::get_instance().debug(msg, component)
+#define LOG_DEBUG(msg, component) NETCODE_LOG(netcode::utils::LogLevel::DEBUG, msg, component)
 
     /**
      * @brief Macro for INFO level logging with component name
      * @param msg The message to log
      * @param component The component the message belongs to
      */
-#define LOG_INFO(msg, component) netcode::utils::Logger::get_instance().info(msg, component)
+#define LOG_INFO(msg, component) NETCODE_LOG(netcode::utils::LogLevel::INFO, msg, component)
 
     /**
      * @brief Macro for WARNING level logging with component name
      * @param msg The message to log
      * @param component The component the message belongs to
      */
-#define LOG_WARNING(msg, component) netcode::utils::Logger::get_instance().warning(msg, component)
+#define LOG_WARNING(msg, component) NETCODE_LOG(netcode::utils::LogLevel::WARNING, msg, component)
 
     /**
      * @brief Macro for ERROR level logging with component name
      * @param msg The message to log
      * @param component The component the message belongs to
      */
-#define LOG_ERROR(msg, component) netcode::utils::Logger::get_instance().error(msg, component)
+#define LOG_ERROR(msg, component) NETCODE_LOG(netcode::utils::LogLevel::ERROR, msg, component)
 
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Fills a buffer from the operating system's CSPRNG
+     *
+     * Uses getrandom(2) and falls back to /dev/urandom where it is not
+     * available. Suitable for secrets such as session tokens, unlike the
+     * generators in <random>, whose output reveals their state.
+     *
+     * @param data Buffer to fill
+     * @param size Number of bytes to fill
+     * @return true if the whole buffer was filled, false otherwise
+     */
+    bool fill_secure_random(void* data, size_t size);
+
+    /**
+     * @brief Compares two secrets in time independent of where they differ
+     *
+     * @param a First secret
+     * @param b Second secret
+     * @param size Number of bytes to compare
+     * @return true if the secrets are equal
+     */
+    bool constant_time_equals(const void* a, const void* b, size_t size);
+
+}
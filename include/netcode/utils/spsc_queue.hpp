@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Bounded lock-free single-producer single-consumer queue
+     *
+     * A ring buffer where exactly one thread pushes and exactly one thread pops.
+     * Used as a mailbox between threads that otherwise share nothing, so neither
+     * side ever blocks or takes a lock.
+     *
+     * @tparam T Element type, must be default constructible and move assignable
+     */
+    template <typename T>
+    class SpscQueue {
+    public:
+        /**
+         * @brief Constructs the queue
+         * @param capacity Maximum number of queued elements, rounded up to a power of two
+         */
+        explicit SpscQueue(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity + 1) {
+                size <<= 1;
+            }
+            mask_ = size - 1;
+            buffer_ = std::make_unique<T[]>(size);
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /**
+         * @brief Pushes an element, called from the producer thread only
+         * @param value The element to push
+         * @return False if the queue is full, in which case value is left untouched
+         */
+        bool try_push(T&& value) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            size_t next = (tail + 1) & mask_;
+            if (next == head_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            buffer_[tail] = std::move(value);
+            tail_.store(next, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Pushes a copy of an element, called from the producer thread only
+         * @param value The element to push
+         * @return False if the queue is full
+         */
+        bool try_push(const T& value) {
+            T copy = value;
+            return try_push(std::move(copy));
+        }
+
+        /**
+         * @brief Pops the oldest element, called from the consumer thread only
+         * @param value Receives the popped element
+         * @return False if the queue is empty
+         */
+        bool try_pop(T& value) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = std::move(buffer_[head]);
+            head_.store((head + 1) & mask_, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Checks if the queue is empty, exact only on the consumer thread
+         * @return True if there is nothing to pop
+         */
+        bool empty() const {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Gets the maximum number of queued elements
+         * @return The capacity of the queue
+         */
+        size_t capacity() const { return mask_; }
+
+    private:
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        // Producer and consumer indices live on separate cache lines to avoid false sharing
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+        alignas(CACHE_LINE_SIZE) size_t mask_ = 0;
+        std::unique_ptr<T[]> buffer_;
+    };
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "netcode/math/my_vec3.hpp"
+#include "netcode/packets/player_state_packet.hpp"
+#include <cstdint>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Hashes the replicated state of a single entity
+     *
+     * Covers the entity ID and its kinematic state, but not acknowledgement
+     * fields such as input or state sequence numbers. Per-entity hashes are
+     * XORed together into a world checksum, so a change to one entity can be
+     * applied by XORing out its old hash and XORing in the new one.
+     *
+     * @param state The entity state as sent by the server
+     * @return 64-bit FNV-1a hash of the state
+     */
+    uint64_t hash_entity_state(const packets::PlayerStatePacket& state);
+
+    /**
+     * @brief Hashes an entity's kinematic state the same way as its replicated state
+     *
+     * Lets a client hash the state it reconstructed itself, so the result can
+     * be compared against the hash of the server's state.
+     *
+     * @param entity_id ID of the entity
+     * @param position Position of the entity
+     * @param velocity Velocity of the entity
+     * @param is_jumping Whether the entity is jumping
+     * @return 64-bit FNV-1a hash of the state
+     */
+    uint64_t hash_entity_state(uint32_t entity_id, const math::MyVec3& position,
+                               const math::MyVec3& velocity, bool is_jumping);
+
+    /**
+     * @brief Checks whether two states of an entity differ in anything a client renders or simulates
+     *
+     * Compares the kinematic state and the held input; sequence numbers are
+     * ignored, so a state that only acknowledges another input is unchanged.
+     *
+     * @param previous The state sent before
+     * @param current The current state
+     * @return true if the states differ
+     */
+    bool has_state_changed(const packets::PlayerStatePacket& previous, const packets::PlayerStatePacket& current);
+
+}
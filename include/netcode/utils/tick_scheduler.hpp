@@ -0,0 +1,167 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Histogram of durations in power-of-two microsecond buckets
+     *
+     * Bucket 0 counts durations below 1 us, bucket i durations from 2^(i-1) us
+     * up to 2^i us; the last bucket also takes everything longer.
+     */
+    class DurationHistogram {
+    public:
+        static constexpr size_t BUCKET_COUNT = 24;
+
+        /**
+         * @brief Counts a duration
+         * @param duration The duration, negative durations count as zero
+         */
+        void record(std::chrono::nanoseconds duration);
+
+        /**
+         * @brief Gets an upper bound of a percentile
+         * @param percentile Between 0 and 100
+         * @return Upper edge of the bucket holding the percentile, zero if nothing was recorded
+         */
+        std::chrono::microseconds percentile(double percentile) const;
+
+        /**
+         * @brief Gets the number of durations in a bucket
+         * @param bucket Bucket index below BUCKET_COUNT
+         * @return The count
+         */
+        uint64_t bucket(size_t bucket) const { return buckets_[bucket]; }
+
+        /**
+         * @brief Gets the number of recorded durations
+         * @return The count
+         */
+        uint64_t count() const { return count_; }
+
+        /**
+         * @brief Gets the longest recorded duration
+         * @return The maximum
+         */
+        std::chrono::nanoseconds max() const { return max_; }
+
+        /**
+         * @brief Gets the mean of the recorded durations
+         * @return The mean, zero if nothing was recorded
+         */
+        std::chrono::nanoseconds mean() const;
+
+    private:
+        std::array<uint64_t, BUCKET_COUNT> buckets_{};
+        uint64_t count_ = 0;
+        std::chrono::nanoseconds total_{0};
+        std::chrono::nanoseconds max_{0};
+    };
+
+    /**
+     * @brief What a tick scheduler does with deadlines that passed while a tick was still running
+     */
+    enum class OverrunPolicy {
+        CATCH_UP, ///< Run the missed ticks back to back, up to max_catch_up_ticks
+        SKIP      ///< Run one tick and drop the missed ones
+    };
+
+    /**
+     * @brief Configuration of a tick scheduler
+     */
+    struct TickSchedulerConfig {
+        // Ticks per second
+        double tick_rate = 60.0;
+
+        // Busy-wait the last part of every wait instead of sleeping (in microseconds), 0 only sleeps
+        uint32_t spin_us = 0;
+
+        // Handling of deadlines missed because a tick ran long
+        OverrunPolicy overrun_policy = OverrunPolicy::CATCH_UP;
+
+        // Most ticks run back to back after an overrun, further missed ticks are dropped
+        uint32_t max_catch_up_ticks = 4;
+    };
+
+    /**
+     * @brief Timing of the ticks a scheduler released
+     */
+    struct TickStats {
+        uint64_t ticks = 0;          ///< Ticks the caller was told to run
+        uint64_t overruns = 0;       ///< Waits that started after the deadline had already passed
+        uint64_t skipped_ticks = 0;  ///< Deadlines dropped instead of run
+        DurationHistogram jitter;    ///< How late the scheduler woke up for on-time ticks
+        DurationHistogram overrun;   ///< How far past the deadline overrunning ticks ended
+    };
+
+    /**
+     * @brief Fixed-rate tick loop pacing with absolute deadlines
+     *
+     * Deadlines lie on a fixed grid from the start time, so oversleeping one
+     * tick never shifts the following ones and the loop does not drift.
+     * Waits use clock_nanosleep on CLOCK_MONOTONIC, the clock behind
+     * std::chrono::steady_clock, with an absolute deadline; an optional spin
+     * covers the last microseconds the kernel's wake-up latency would miss.
+     * What happens after an overrun only depends on how many deadlines were
+     * missed, never on how the sleep went.
+     */
+    class TickScheduler {
+    public:
+        /**
+         * @brief Constructs the scheduler
+         * @param config The configuration
+         */
+        explicit TickScheduler(const TickSchedulerConfig& config = TickSchedulerConfig());
+
+        /**
+         * @brief Starts the deadline grid now, the first tick is due one interval later
+         */
+        void start();
+
+        /**
+         * @brief Waits for the next deadline
+         *
+         * Starts the grid on the first call if start() was not called.
+         *
+         * @return Number of ticks to run now: 1 when on time, more while catching up
+         */
+        uint32_t wait_next_tick();
+
+        /**
+         * @brief Gets the deadline of the next tick
+         * @return The deadline
+         */
+        std::chrono::steady_clock::time_point next_deadline() const;
+
+        /**
+         * @brief Gets the time between ticks
+         * @return The tick interval
+         */
+        std::chrono::nanoseconds interval() const { return interval_; }
+
+        /**
+         * @brief Gets the timing statistics
+         * @return The statistics
+         */
+        const TickStats& stats() const { return stats_; }
+
+        /**
+         * @brief Clears the timing statistics, the deadline grid is kept
+         */
+        void reset_stats() { stats_ = TickStats(); }
+
+    private:
+        TickSchedulerConfig config_;
+        std::chrono::nanoseconds interval_;
+        std::chrono::steady_clock::time_point start_;
+        uint64_t deadline_index_ = 0; ///< Deadlines passed since the start, run or dropped
+        bool started_ = false;
+        TickStats stats_;
+
+        // Sleeps until shortly before the deadline and spins for the rest
+        void sleep_until(std::chrono::steady_clock::time_point deadline) const;
+    };
+
+}
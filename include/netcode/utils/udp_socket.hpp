@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+#include <netinet/in.h>
+
+namespace netcode::utils {
+
+    /**
+     * @brief Opens a non-blocking UDP socket bound to a local port on every interface
+     *
+     * @param port Port to bind, 0 lets the system pick one
+     * @return The socket, or -1 if it could not be created or bound (errno is set)
+     */
+    int open_bound_socket(int port);
+
+    /**
+     * @brief Checks whether an address is already in a list of destinations
+     *
+     * @param addresses The destinations
+     * @param addr The address to look for
+     * @return True if an entry has the same IP address and port
+     */
+    bool contains_address(const std::vector<sockaddr_in>& addresses, const sockaddr_in& addr);
+
+}
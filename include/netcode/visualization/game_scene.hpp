@@ -3,6 +3,7 @@
 #include "raylib.h"
 #include "netcode/visualization/player.hpp"
 #include "netcode/math/my_vec3.hpp"
+#include <array>
 #include <memory>
 
 namespace netcode {
@@ -65,6 +66,13 @@ public:
      * @details Draws all objects, players, and textures in the scene.
      */
     void render();
+    /**
+     * @brief Checks whether anything drawn by the scene changed since the last render.
+     * @details Compares the camera, both players' drawn poses and the ground mode
+     * with the values the last render() used.
+     * @return True if rendering again would produce a different image.
+     */
+    bool needsRender() const;
     /**
      * @brief Processes input for the game scene.
      * @details Handles player movement, camera control, and other input events.
@@ -117,6 +125,15 @@ public:
     bool getUseTexture() const { return USE_TEXTURE; }
 
 private:
+    // Everything render() draws depends on: camera, player poses and ground mode
+    using RenderSignature = std::array<float, 21>;
+
+    /**
+     * @brief Collects the values the next render would depend on.
+     * @return The current render signature.
+     */
+    RenderSignature renderSignature() const;
+
     Rectangle bounds_;
     const char* label_;
     Camera3D camera_;
@@ -134,6 +151,10 @@ private:
     Model groundModel_;
     bool groundTextureLoaded_ = false;
     
+    // Signature of the last render, compared by needsRender()
+    RenderSignature lastRenderSignature_{};
+    bool rendered_ = false;
+
     // Movement direction vectors
     Vector3 redMoveDir_ = {0.0f, 0.0f, 0.0f};
     Vector3 blueMoveDir_ = {0.0f, 0.0f, 0.0f};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <queue>
 #include <string>
@@ -73,6 +75,36 @@ private:
 
     void createScenes(int width, int height);
 
+    /**
+     * @brief Render bookkeeping and timing of one viewport
+     */
+    struct ViewportRender {
+        GameScene* scene = nullptr;
+        RenderTexture2D* target = nullptr;
+        double lastRenderTime = 0.0;    ///< GetTime() of the last render
+        double lastRenderMs = 0.0;      ///< Time the last render took
+        double averageRenderMs = 0.0;   ///< Smoothed render time
+        uint64_t frames = 0;            ///< Frames since the counters were created
+        uint64_t renders = 0;           ///< Frames the viewport was rendered in
+        uint64_t skippedUnchanged = 0;  ///< Frames skipped because nothing in the viewport changed
+        uint64_t skippedThrottled = 0;  ///< Frames skipped because the viewport is not focused
+    };
+
+    /**
+     * @brief Renders a viewport into its texture unless adaptive rendering skips it
+     * @param viewport The viewport
+     * @param focused Whether the viewport has camera focus
+     * @param now Current time from GetTime()
+     */
+    void renderViewport(ViewportRender& viewport, bool focused, double now);
+
+    /**
+     * @brief Draws a viewport's render timing in its bottom left corner
+     * @param viewport The viewport
+     * @param x Left edge of the viewport on screen
+     */
+    void drawViewportTiming(const ViewportRender& viewport, int x) const;
+
     bool running_;  ///< Flag indicating if the game loop should continue running
     
     std::unique_ptr<GameScene> scene1_;
@@ -84,6 +116,15 @@ private:
     std::unique_ptr<NetworkUtility> network_;
     std::unique_ptr<ControlPanel> controlPanel_;
 
+    // Viewports in screen order, rendered by renderViewport
+    std::array<ViewportRender, 3> viewports_;
+
+    // Skip unchanged viewports and throttle unfocused ones, toggled with F4
+    bool adaptiveRendering_ = true;
+
+    // Highest rate unfocused viewports are rendered at, in renders per second
+    static constexpr double UNFOCUSED_RENDER_RATE = 15.0;
+
     // Camera control variables
     GameScene* activeSceneForCamera_; // Currently active scene for camera control
     int activeSceneIndex_; // Index of active scene (1, 2, or 3)
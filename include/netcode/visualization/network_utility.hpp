@@ -78,12 +78,15 @@ public:
     NetworkUtility(Mode mode = Mode::TEST);
     ~NetworkUtility();
 
-    // Client to Server communication
+    // Client to Server communication, called every frame input is held; inputs leave at the client's dilated input rate
     void clientToServerUpdate(std::shared_ptr<Player> clientPlayer, 
                             std::shared_ptr<Player> serverPlayer,
                             const Vector3& movement,
                             bool jumpRequested = false);
 
+    // Called on frames without held input, stops the client's input clock
+    void clientInputReleased(std::shared_ptr<Player> clientPlayer);
+
     // Server to Clients communication
     void serverToClientsUpdate(std::shared_ptr<Player> serverPlayer,
                              std::shared_ptr<Player> client1Player,
@@ -122,6 +125,19 @@ private:
     std::unique_ptr<Client> client1_;       // Client 1
     std::unique_ptr<Client> client2_;       // Client 2
     
+    /**
+     * Input clock of one client, it sends at the rate that keeps the server's input buffer at its target depth
+     */
+    struct PacedInput {
+        InputClock clock{INPUT_RATE};
+        bool jumpPending = false;  ///< Jump requested on a frame no input was due, sent with the next one
+    };
+    PacedInput client1Input_;
+    PacedInput client2Input_;
+
+    // Inputs per second each client sends while a key is held, before time dilation
+    static constexpr float INPUT_RATE = 60.0f;
+
     // Player references for network updates
     std::shared_ptr<Player> serverPlayerRef_;
     std::shared_ptr<Player> client1PlayerRef_;
@@ -149,6 +165,9 @@ private:
     // Process networking events
     void processNetworkEvents();
     
+    // Send the inputs due on the client's input clock
+    void sendPacedInputs(Client& client, PacedInput& input, const Vector3& movement, bool jumpRequested);
+    
     // Send player state from client to server
     void sendPlayerStateToServer(uint32_t playerId, const Vector3& position, bool isJumping, Client* client);
 };
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include "netcode/networked_entity.hpp"
 #include "netcode/math/my_vec3.hpp"
+#include "netcode/prediction/error_correction.hpp"
 
 namespace netcode {
 namespace visualization {
@@ -26,6 +27,9 @@ public:
 
     /**
      * @brief Update the player's position and velocity
+     *
+     * Ends a simulation step. Horizontal velocity drops to zero on a step
+     * without move(), so a player that stopped is not replicated as walking.
      */
     void update() override;
 
@@ -49,12 +53,12 @@ public:
      * @brief Snap the entity's simulation state to match server data
      * @param position The authoritative position from the server
      * @param isJumping The jumping state from the server
-     * @param velocityY The Y velocity component from the server (optional)
+     * @param velocity The velocity from the server (optional)
      */
     void snapSimulationState(
         const netcode::math::MyVec3& position, 
         bool isJumping = false, 
-        float velocityY = 0.0f) override;
+        const netcode::math::MyVec3& velocity = {}) override;
     
     /**
      * @brief Initiate a visual blend from current render position to simulation position
@@ -73,6 +77,12 @@ public:
      */
     netcode::math::MyVec3 getRenderPosition() const override { return renderPosition_; }
 
+    /**
+     * @brief Get the angle the model is drawn at around the up axis
+     * @return The rotation angle in degrees
+     */
+    float getRotationAngle() const { return rotationAngle_; }
+
     /**
      * @brief Set the player's simulation position
      * @param pos The new position
@@ -85,6 +95,18 @@ public:
      */
     netcode::math::MyVec3 getVelocity() const override { return velocity_; }
 
+    /**
+     * @brief Check if the player is in the middle of a jump
+     * @return True if the player is airborne
+     */
+    bool isJumping() const override { return isJumping_; }
+
+    /**
+     * @brief Set how corrections of the simulation state are smoothed on screen
+     * @param config Half-life and snap threshold for the visual error offset
+     */
+    void setErrorCorrectionConfig(const ErrorCorrectionConfig& config) { errorOffset_.setConfig(config); }
+
     /**
      * @brief Load the player's model
      * @param useCubes Whether to use cubes instead of the default model
@@ -115,12 +137,11 @@ private:
     netcode::math::MyVec3 position_;
     netcode::math::MyVec3 velocity_;
     bool isJumping_ = false;
+    bool movedThisStep_ = false;
     
     // Rendering state (visual display only)
     netcode::math::MyVec3 renderPosition_;
-    bool isVisuallyBlending_ = false;
-    float visualBlendProgress_ = 0.0f;
-    const float VISUAL_BLEND_SPEED = 10.0f;
+    VisualErrorOffset errorOffset_;
     
     Color color_;
     Model model_;
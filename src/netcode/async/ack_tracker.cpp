@@ -0,0 +1,62 @@
+#include "netcode/async/ack_tracker.hpp"
+
+namespace netcode::async {
+
+bool AckAwaiter::await_ready() const {
+    return tracker_.isAcknowledged(sequence_);
+}
+
+void AckAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    state_ = std::make_shared<WaitState>();
+    state_->handle = handle;
+    tracker_.waiters_.emplace(sequence_, state_);
+    if (timeout_) {
+        tracker_.loop_.addTimer(std::chrono::steady_clock::now() + *timeout_, state_);
+    }
+}
+
+bool AckAwaiter::await_resume() {
+    if (state_ && state_->timedOut) {
+        // A sequence that is never acknowledged would otherwise keep the wait forever
+        tracker_.removeWaiter(sequence_, state_);
+        return false;
+    }
+    return true;
+}
+
+void AckTracker::acknowledge(uint32_t sequence) {
+    if (sequence <= acknowledged_) {
+        return;
+    }
+    acknowledged_ = sequence;
+
+    // Everything up to the sequence is acknowledged
+    auto last = waiters_.upper_bound(sequence);
+    for (auto it = waiters_.begin(); it != last; ++it) {
+        loop_.complete(it->second);
+    }
+    waiters_.erase(waiters_.begin(), last);
+}
+
+void AckTracker::removeWaiter(uint32_t sequence, const std::shared_ptr<WaitState>& state) {
+    auto [first, last] = waiters_.equal_range(sequence);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == state) {
+            waiters_.erase(it);
+            return;
+        }
+    }
+}
+
+Task<bool> sendReliable(UdpEndpoint& endpoint, sockaddr_in peer, std::vector<char> data, AckTracker& acks,
+                        uint32_t sequence, int attempts, std::chrono::steady_clock::duration retryInterval) {
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+        endpoint.sendTo(peer, data.data(), data.size());
+        if (co_await acks.waitForAck(sequence, retryInterval)) {
+            co_return true;
+        }
+    }
+    co_return false;
+}
+
+} // namespace netcode::async
@@ -0,0 +1,219 @@
+#include "netcode/async/event_loop.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace netcode::async {
+
+namespace {
+
+/**
+ * @brief Coroutine owning a spawned task, destroys itself when the task is done
+ */
+struct RootTask {
+    struct promise_type {
+        EventLoop* loop = nullptr;
+
+        ~promise_type() {
+            if (loop) {
+                loop->forgetTask(std::coroutine_handle<promise_type>::from_promise(*this).address());
+            }
+        }
+
+        RootTask get_return_object() { return RootTask{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+RootTask runRoot(Task<void> task) {
+    co_await task;
+}
+
+} // namespace
+
+void SleepAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    auto state = std::make_shared<WaitState>();
+    state->handle = handle;
+    loop_.addTimer(std::chrono::steady_clock::now() + duration_, std::move(state));
+}
+
+void TickAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    auto state = std::make_shared<WaitState>();
+    state->handle = handle;
+    loop_.addTickWaiter(std::move(state));
+}
+
+uint64_t TickAwaiter::await_resume() const noexcept {
+    return loop_.getTickCount();
+}
+
+EventLoop::EventLoop(float tickRate)
+    : tickInterval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<float>(1.0f / std::max(tickRate, 0.001f)))),
+      nextTickTime_(std::chrono::steady_clock::now() + tickInterval_) {
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        LOG_ERROR("Failed to create epoll instance: " + std::string(strerror(errno)), "EventLoop");
+    }
+}
+
+EventLoop::~EventLoop() {
+    // Destroying a root frame destroys the tasks it awaits, all the way down
+    destroying_ = true;
+    std::vector<void*> roots(roots_.begin(), roots_.end());
+    for (void* address : roots) {
+        std::coroutine_handle<>::from_address(address).destroy();
+    }
+    roots_.clear();
+
+    if (epollFd_ != -1) {
+        close(epollFd_);
+    }
+}
+
+void EventLoop::spawn(Task<void> task) {
+    RootTask root = runRoot(std::move(task));
+    root.handle.promise().loop = this;
+    roots_.insert(root.handle.address());
+    schedule(root.handle);
+}
+
+void EventLoop::forgetTask(void* address) {
+    if (!destroying_) {
+        roots_.erase(address);
+    }
+}
+
+void EventLoop::run() {
+    running_ = true;
+    while (running_ && !roots_.empty()) {
+        runOnce(std::chrono::milliseconds(100));
+    }
+    running_ = false;
+}
+
+void EventLoop::runFor(std::chrono::steady_clock::duration duration) {
+    running_ = true;
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    while (running_) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            break;
+        }
+        runOnce(deadline - now);
+    }
+    running_ = false;
+}
+
+void EventLoop::stop() {
+    running_ = false;
+}
+
+bool EventLoop::complete(const std::shared_ptr<WaitState>& state) {
+    if (state->completed) {
+        return false;
+    }
+    state->completed = true;
+    schedule(state->handle);
+    return true;
+}
+
+void EventLoop::addTimer(std::chrono::steady_clock::time_point deadline, std::shared_ptr<WaitState> state) {
+    timers_.push({deadline, timerOrder_++, std::move(state)});
+}
+
+bool EventLoop::watch(int fd, std::function<void()> onReadable) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        LOG_ERROR("Failed to watch descriptor: " + std::string(strerror(errno)), "EventLoop");
+        return false;
+    }
+    watchers_[fd] = std::move(onReadable);
+    return true;
+}
+
+void EventLoop::unwatch(int fd) {
+    if (watchers_.erase(fd) > 0) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+void EventLoop::runOnce(std::chrono::steady_clock::duration maxWait) {
+    resumeReady();
+
+    // Block until the next timer or tick is due, or a socket becomes readable
+    auto now = std::chrono::steady_clock::now();
+    auto wakeTime = now + maxWait;
+    if (!tickWaiters_.empty()) {
+        wakeTime = std::min(wakeTime, nextTickTime_);
+    }
+    if (!timers_.empty()) {
+        wakeTime = std::min(wakeTime, timers_.top().deadline);
+    }
+    int timeoutMs = 0;
+    if (ready_.empty() && wakeTime > now) {
+        // Round up, waking early would only spin
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(wakeTime - now);
+        timeoutMs = static_cast<int>(wait.count());
+    }
+
+    constexpr int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+    int eventCount = epoll_wait(epollFd_, events, MAX_EVENTS, timeoutMs);
+    if (eventCount < 0 && errno != EINTR) {
+        LOG_ERROR("epoll_wait failed: " + std::string(strerror(errno)), "EventLoop");
+    }
+    for (int i = 0; i < eventCount; ++i) {
+        auto watcher = watchers_.find(events[i].data.fd);
+        if (watcher != watchers_.end()) {
+            watcher->second();
+        }
+    }
+
+    // Fire due timers, a wait completed by its event in the meantime is skipped
+    now = std::chrono::steady_clock::now();
+    while (!timers_.empty() && timers_.top().deadline <= now) {
+        auto state = timers_.top().state;
+        timers_.pop();
+        if (complete(state)) {
+            state->timedOut = true;
+        }
+    }
+
+    // Produce a tick, skipping missed ones instead of bursting to catch up
+    if (now >= nextTickTime_) {
+        tickCount_++;
+        nextTickTime_ += tickInterval_;
+        if (nextTickTime_ <= now) {
+            nextTickTime_ = now + tickInterval_;
+        }
+        std::vector<std::shared_ptr<WaitState>> waiters;
+        waiters.swap(tickWaiters_);
+        for (const auto& state : waiters) {
+            complete(state);
+        }
+    }
+
+    resumeReady();
+}
+
+void EventLoop::resumeReady() {
+    while (!ready_.empty()) {
+        auto handle = ready_.front();
+        ready_.pop_front();
+        handle.resume();
+    }
+}
+
+} // namespace netcode::async
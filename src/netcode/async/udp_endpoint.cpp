@@ -0,0 +1,209 @@
+#include "netcode/async/udp_endpoint.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace netcode::async {
+
+bool PacketAwaiter::await_ready() {
+    auto& inbox = endpoint_.inboxFor(peer_);
+    if (inbox.datagrams.empty()) {
+        return false;
+    }
+    ready_ = std::move(inbox.datagrams.front());
+    inbox.datagrams.pop_front();
+    if (!peer_) {
+        endpoint_.claim(UdpEndpoint::peerKey(ready_->from));
+    }
+    return true;
+}
+
+void PacketAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    state_ = std::make_shared<PacketWait>();
+    state_->handle = handle;
+    endpoint_.inboxFor(peer_).waiters.push_back(state_);
+    if (timeout_) {
+        endpoint_.loop_.addTimer(std::chrono::steady_clock::now() + *timeout_, state_);
+    }
+}
+
+std::optional<Datagram> PacketAwaiter::await_resume() {
+    if (ready_) {
+        return std::move(ready_);
+    }
+    if (state_->timedOut) {
+        // A silent peer would otherwise collect one wait per timed out receive
+        endpoint_.removeWaiter(peer_, state_);
+    }
+    return std::move(state_->datagram);
+}
+
+UdpEndpoint::UdpEndpoint(EventLoop& loop) : loop_(loop) {
+}
+
+UdpEndpoint::~UdpEndpoint() {
+    if (socketFd_ != -1) {
+        loop_.unwatch(socketFd_);
+        close(socketFd_);
+    }
+}
+
+bool UdpEndpoint::bind(int port) {
+    socketFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd_ < 0) {
+        LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "UdpEndpoint");
+        return false;
+    }
+
+    int flags = fcntl(socketFd_, F_GETFL, 0);
+    fcntl(socketFd_, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (::bind(socketFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind socket: " + std::string(strerror(errno)), "UdpEndpoint");
+        close(socketFd_);
+        socketFd_ = -1;
+        return false;
+    }
+
+    socklen_t addrLen = sizeof(addr);
+    getsockname(socketFd_, (struct sockaddr*)&addr, &addrLen);
+    port_ = ntohs(addr.sin_port);
+
+    return loop_.watch(socketFd_, [this]() { onReadable(); });
+}
+
+bool UdpEndpoint::sendTo(const sockaddr_in& peer, const void* data, size_t size) {
+    ssize_t bytesSent = sendto(socketFd_, data, size, 0, (const struct sockaddr*)&peer, sizeof(peer));
+    if (bytesSent < 0) {
+        LOG_ERROR("Failed to send datagram: " + std::string(strerror(errno)), "UdpEndpoint");
+        return false;
+    }
+    return true;
+}
+
+PacketAwaiter UdpEndpoint::nextPacket(const sockaddr_in& peer, std::optional<std::chrono::steady_clock::duration> timeout) {
+    uint64_t key = peerKey(peer);
+    peers_.try_emplace(key);
+    return PacketAwaiter(*this, key, timeout);
+}
+
+PacketAwaiter UdpEndpoint::accept(std::optional<std::chrono::steady_clock::duration> timeout) {
+    return PacketAwaiter(*this, std::nullopt, timeout);
+}
+
+void UdpEndpoint::release(const sockaddr_in& peer) {
+    auto it = peers_.find(peerKey(peer));
+    if (it == peers_.end()) {
+        return;
+    }
+    for (const auto& waiter : it->second.waiters) {
+        loop_.complete(waiter);
+    }
+    peers_.erase(it);
+}
+
+void UdpEndpoint::claim(uint64_t key) {
+    auto [it, inserted] = peers_.try_emplace(key);
+    if (!inserted) {
+        return;
+    }
+
+    // Datagrams the peer sent before it was accepted belong to it as well
+    auto& queued = unclaimed_.datagrams;
+    for (auto datagram = queued.begin(); datagram != queued.end();) {
+        if (peerKey(datagram->from) == key) {
+            it->second.datagrams.push_back(std::move(*datagram));
+            datagram = queued.erase(datagram);
+        } else {
+            ++datagram;
+        }
+    }
+}
+
+uint64_t UdpEndpoint::peerKey(const sockaddr_in& addr) {
+    return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+}
+
+UdpEndpoint::Inbox& UdpEndpoint::inboxFor(std::optional<uint64_t> peer) {
+    if (!peer) {
+        return unclaimed_;
+    }
+    return peers_[*peer];
+}
+
+void UdpEndpoint::removeWaiter(std::optional<uint64_t> peer, const std::shared_ptr<PacketAwaiter::PacketWait>& state) {
+    // A released peer's inbox is gone, looking it up must not claim the peer again
+    Inbox* inbox = &unclaimed_;
+    if (peer) {
+        auto it = peers_.find(*peer);
+        if (it == peers_.end()) {
+            return;
+        }
+        inbox = &it->second;
+    }
+    auto& waiters = inbox->waiters;
+    auto it = std::find(waiters.begin(), waiters.end(), state);
+    if (it != waiters.end()) {
+        waiters.erase(it);
+    }
+}
+
+size_t UdpEndpoint::getPendingWaitCount() const {
+    size_t count = unclaimed_.waiters.size();
+    for (const auto& [key, inbox] : peers_) {
+        count += inbox.waiters.size();
+    }
+    return count;
+}
+
+void UdpEndpoint::onReadable() {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+
+    while (true) {
+        Datagram datagram;
+        socklen_t fromLen = sizeof(datagram.from);
+        ssize_t bytesReceived = recvfrom(socketFd_, buffer, BUFFER_SIZE, 0, (struct sockaddr*)&datagram.from, &fromLen);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "UdpEndpoint");
+            }
+            return;
+        }
+        datagram.data.assign(buffer, buffer + bytesReceived);
+
+        auto claimed = peers_.find(peerKey(datagram.from));
+        Inbox& inbox = claimed != peers_.end() ? claimed->second : unclaimed_;
+
+        // Hand the datagram to the first waiter whose wait has not timed out
+        while (!inbox.waiters.empty() && inbox.waiters.front()->completed) {
+            inbox.waiters.pop_front();
+        }
+        if (!inbox.waiters.empty()) {
+            auto waiter = inbox.waiters.front();
+            inbox.waiters.pop_front();
+            if (&inbox == &unclaimed_) {
+                // The accepting coroutine owns the peer from now on
+                claim(peerKey(datagram.from));
+            }
+            waiter->datagram = std::move(datagram);
+            loop_.complete(waiter);
+        } else if (inbox.datagrams.size() < (&inbox == &unclaimed_ ? MAX_PENDING_ACCEPTS : MAX_QUEUED_DATAGRAMS)) {
+            inbox.datagrams.push_back(std::move(datagram));
+        } else {
+            dropped_++;
+        }
+    }
+}
+
+} // namespace netcode::async
@@ -4,11 +4,14 @@
 #include "netcode/prediction/prediction.hpp"
 #include "netcode/prediction/reconciliation.hpp"
 #include "netcode/prediction/interpolation.hpp"
+#include "netcode/prediction/remote_prediction.hpp"
+#include "netcode/utils/state_hash.hpp"
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
 #include <fcntl.h>
 #include <queue>
+#include <algorithm>
 
 namespace netcode {
 
@@ -33,6 +36,9 @@ Client::Client(uint32_t clientId, int port, const std::string& serverIp, int ser
     interpolationConfig.maxInterpolationDistance = 3.0f; // Set a reasonable threshold for snapping
     interpolationSystem_ = std::make_unique<InterpolationSystem>(*snapshotManager_, interpolationConfig);
     
+    // Remote prediction is opt-in, remote players are interpolated by default
+    remotePredictionSystem_ = std::make_unique<RemotePredictionSystem>();
+    
     // Configure reconciliation
     reconciliationSystem_->setReconciliationThreshold(0.5f);
     
@@ -60,11 +66,26 @@ void Client::start() {
         return;
     }
     
+    if (!openSocket()) {
+        return;
+    }
+    
+    LOG_INFO("Client " + std::to_string(clientId_) + " started on port " + std::to_string(port_), "Client");
+    
+    // Send initial registration packet to server
+    sendRegistration();
+    
+    // Start network processing thread
+    running_ = true;
+    clientThread_ = std::thread(&Client::processNetworkEvents, this);
+}
+
+bool Client::openSocket() {
     // Create UDP socket
     socketFd_ = socket(AF_INET, SOCK_DGRAM, 0);
     if (socketFd_ < 0) {
         LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "Client");
-        return;
+        return false;
     }
     
     // Set non-blocking mode
@@ -82,12 +103,13 @@ void Client::start() {
     if (bind(socketFd_, (struct sockaddr*)&clientAddr, sizeof(clientAddr)) < 0) {
         LOG_ERROR("Failed to bind socket: " + std::string(strerror(errno)), "Client");
         close(socketFd_);
-        return;
+        socketFd_ = -1;
+        return false;
     }
-    
-    LOG_INFO("Client " + std::to_string(clientId_) + " started on port " + std::to_string(port_), "Client");
-    
-    // Send initial registration packet to server
+    return true;
+}
+
+void Client::sendRegistration() {
     packets::PlayerMovementRequest initialRequest;
     initialRequest.player_id = clientId_;
     initialRequest.movement_x = 0.0f;
@@ -96,6 +118,7 @@ void Client::start() {
     initialRequest.velocity_y = 0.0f;
     initialRequest.is_jumping = false;
     initialRequest.input_sequence_number = 0; // Initial sequence
+    initialRequest.wasPredicted = false;
     
     // Create timestamped request with immediate processing
     packets::TimestampedPlayerMovementRequest timestampedRequest;
@@ -111,10 +134,56 @@ void Client::start() {
     } else {
         LOG_INFO("Client " + std::to_string(clientId_) + " sent initial registration to server", "Client");
     }
+}
+
+void Client::sendResumeRequest() {
+    packets::TimestampedResumeRequestPacket timestampedResume{};
+    timestampedResume.timestamp = std::chrono::steady_clock::now() + 
+        std::chrono::milliseconds(settings_ ? settings_->getClientToServerDelay() : 10);
+    timestampedResume.resume_request.player_id = clientId_;
+    timestampedResume.resume_request.token = sessionToken_;
+    timestampedResume.resume_request.last_input_sequence =
+        unprocessedInputs_.empty() ? 0 : unprocessedInputs_.rbegin()->first;
+    
+    ssize_t bytesSent = sendto(socketFd_, &timestampedResume, sizeof(timestampedResume), 0,
+                            (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+    if (bytesSent < 0) {
+        LOG_ERROR("Failed to send resume request: " + std::string(strerror(errno)), "Client");
+    }
+}
+
+bool Client::rebind(int port) {
+    if (!running_) {
+        LOG_WARNING("Client must be running to rebind", "Client");
+        return false;
+    }
+    
+    running_ = false;
+    if (clientThread_.joinable()) {
+        clientThread_.join();
+    }
+    
+    {
+        // Movement requests send on the socket while holding the player lock
+        std::lock_guard<std::mutex> lock(playerMutex_);
+        close(socketFd_);
+        port_ = port;
+        if (!openSocket()) {
+            return false;
+        }
+        
+        if (sessionToken_ != 0) {
+            sendResumeRequest();
+        } else {
+            sendRegistration();
+        }
+    }
+    
+    LOG_INFO("Client " + std::to_string(clientId_) + " moved to port " + std::to_string(port_), "Client");
     
-    // Start network processing thread
     running_ = true;
     clientThread_ = std::thread(&Client::processNetworkEvents, this);
+    return true;
 }
 
 void Client::stop() {
@@ -157,9 +226,15 @@ void Client::updateEntities(float deltaTime) {
         // Update render positions for all entities including local player
         player->updateRenderPosition(deltaTime);
         
-        // Only update remote players with interpolation for simulation state
-        if (playerId != clientId_ && settings_ && settings_->isInterpolationEnabled()) {
-            interpolationSystem_->updateEntity(player, deltaTime);
+        if (playerId == clientId_) {
+            continue;
+        }
+        
+        // Remote players are either predicted to the present or interpolated in the past
+        if (remotePredictionSystem_->isEnabled()) {
+            remotePredictionSystem_->updateEntity(player);
+        } else if (settings_ && settings_->isInterpolationEnabled()) {
+            interpolationSystem_->updateEntity(*player, deltaTime);
         }
     }
 }
@@ -179,7 +254,7 @@ void Client::sendMovementRequest(const netcode::math::MyVec3& movement, bool jum
     
     // Apply prediction to local player immediately only if prediction is enabled
     if (settings_ && settings_->isPredictionEnabled()) {
-        sequenceNumber = predictionSystem_->applyInputPrediction(it->second, movement, jumpRequested);
+        sequenceNumber = predictionSystem_->applyInputPrediction(*it->second, movement, jumpRequested);
         predictionApplied = true;
     } else {
         // If prediction is disabled, just get the next sequence number without applying prediction
@@ -198,6 +273,22 @@ void Client::sendMovementRequest(const netcode::math::MyVec3& movement, bool jum
     request.input_sequence_number = sequenceNumber; // Include the sequence number
     request.wasPredicted = predictionApplied; // Track if this input was predicted
     
+    // Remember when this input left so its acknowledgement yields a round trip sample
+    inputSendTimes_[sequenceNumber] = std::chrono::steady_clock::now();
+    if (inputSendTimes_.size() > MAX_TRACKED_INPUTS) {
+        inputSendTimes_.erase(inputSendTimes_.begin());
+    }
+    
+    // Keep the input until the server processed it, it is sent again after resuming the session
+    unprocessedInputs_[sequenceNumber] = request;
+    if (unprocessedInputs_.size() > MAX_TRACKED_INPUTS) {
+        unprocessedInputs_.erase(unprocessedInputs_.begin());
+    }
+    
+    if (inputRecorder_) {
+        inputRecorder_->record(request);
+    }
+    
     // Create timestamped request
     packets::TimestampedPlayerMovementRequest timestampedRequest;
     timestampedRequest.timestamp = std::chrono::steady_clock::now() + 
@@ -220,7 +311,13 @@ void Client::sendMovementRequest(const netcode::math::MyVec3& movement, bool jum
     }
 }
 
-void Client::updatePlayerPosition(uint32_t playerId, float x, float y, float z, bool isJumping, uint32_t serverSequence) {
+void Client::setInputRecorder(std::shared_ptr<InputTraceRecorder> recorder) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    inputRecorder_ = recorder;
+}
+
+void Client::updatePlayerPosition(uint32_t playerId, float x, float y, float z, bool isJumping, uint32_t serverSequence,
+                                  const netcode::math::MyVec3& velocity) {
     std::lock_guard<std::mutex> lock(playerMutex_);
     
     auto it = players_.find(playerId);
@@ -238,30 +335,33 @@ void Client::updatePlayerPosition(uint32_t playerId, float x, float y, float z,
         if (settings_ && settings_->isPredictionEnabled()) {
             // Apply reconciliation with the server's sequence number and jumping state
             reconciliationSystem_->reconcileState(
-                it->second, 
+                *it->second, 
                 serverPosition, 
                 serverSequence, 
                 serverTimestamp,
-                isJumping  // Pass server's jumping state
+                isJumping,  // Pass server's jumping state
+                velocity
             );
         } else {
-            // If prediction is disabled, directly update the position
-            it->second->setPosition(serverPosition);
+            // If prediction is disabled, directly take over the server state
+            it->second->snapSimulationState(serverPosition, isJumping, velocity);
         }
     } else {
         // For remote players
         if (settings_ && settings_->isInterpolationEnabled()) {
-            // Record the position for interpolation only if interpolation is enabled
-            interpolationSystem_->recordEntityPosition(
+            // Record the state for interpolation only if interpolation is enabled
+            interpolationSystem_->recordEntityState(
                 playerId,
                 serverPosition,
+                velocity,
+                isJumping,
                 serverTimestamp
             );
             // Note: Don't directly set position here, let interpolation handle it
             // The interpolationSystem will set positions during updateEntities() calls
         } else {
-            // If interpolation is disabled, directly update the position
-            it->second->setPosition(serverPosition);
+            // If interpolation is disabled, directly take over the server state
+            it->second->snapSimulationState(serverPosition, isJumping, velocity);
         }
     }
     
@@ -295,7 +395,44 @@ void Client::processNetworkEvents() {
                 }
             }
             packetQueue_ = std::move(remainingPackets);
+            
+            // Checksums are delayed like state packets so they are compared against the same states
+            std::queue<packets::TimestampedStateChecksumPacket> remainingChecksums;
+            while (!checksumQueue_.empty()) {
+                if (currentTime >= checksumQueue_.front().timestamp) {
+                    handleStateChecksum(checksumQueue_.front().checksum);
+                } else {
+                    remainingChecksums.push(checksumQueue_.front());
+                }
+                checksumQueue_.pop();
+            }
+            checksumQueue_ = std::move(remainingChecksums);
+            
+            std::queue<packets::TimestampedInputAckPacket> remainingInputAcks;
+            while (!inputAckQueue_.empty()) {
+                if (currentTime >= inputAckQueue_.front().timestamp) {
+                    handleInputAck(inputAckQueue_.front().input_ack);
+                } else {
+                    remainingInputAcks.push(inputAckQueue_.front());
+                }
+                inputAckQueue_.pop();
+            }
+            inputAckQueue_ = std::move(remainingInputAcks);
+            
+            // Switching servers is delayed too, states sent before the redirect are applied first
+            std::queue<packets::TimestampedRedirectPacket> remainingRedirects;
+            while (!redirectQueue_.empty()) {
+                if (currentTime >= redirectQueue_.front().timestamp) {
+                    handleRedirect(redirectQueue_.front().redirect);
+                } else {
+                    remainingRedirects.push(redirectQueue_.front());
+                }
+                redirectQueue_.pop();
+            }
+            redirectQueue_ = std::move(remainingRedirects);
         }
+        
+        sendStateAcks();
 
         // Receive new data from server
         memset(buffer, 0, BUFFER_SIZE);
@@ -303,7 +440,39 @@ void Client::processNetworkEvents() {
                                      (struct sockaddr*)&serverAddr, &serverLen);
                                      
         if (bytesReceived > 0) {
-            if (bytesReceived >= sizeof(packets::TimestampedPlayerStatePacket)) {
+            if (bytesReceived == sizeof(packets::TimestampedSessionPacket)) {
+                packets::TimestampedSessionPacket timestampedSession;
+                memcpy(&timestampedSession, buffer, sizeof(timestampedSession));
+                handleSession(timestampedSession.session);
+            } else if (bytesReceived == sizeof(packets::TimestampedCatchUpPacket)) {
+                packets::TimestampedCatchUpPacket timestampedCatchUp;
+                memcpy(&timestampedCatchUp, buffer, sizeof(timestampedCatchUp));
+                
+                // The snapshot is applied like the individual states it carries
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                uint32_t count = std::min(timestampedCatchUp.catch_up.count, packets::MAX_CATCH_UP_ENTRIES);
+                for (uint32_t i = 0; i < count; ++i) {
+                    packetQueue_.push({timestampedCatchUp.timestamp, timestampedCatchUp.catch_up.entries[i]});
+                }
+            } else if (bytesReceived == sizeof(packets::TimestampedRedirectPacket)) {
+                packets::TimestampedRedirectPacket timestampedRedirect;
+                memcpy(&timestampedRedirect, buffer, sizeof(timestampedRedirect));
+                
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                redirectQueue_.push(timestampedRedirect);
+            } else if (bytesReceived == sizeof(packets::TimestampedStateChecksumPacket)) {
+                packets::TimestampedStateChecksumPacket timestampedChecksum;
+                memcpy(&timestampedChecksum, buffer, sizeof(timestampedChecksum));
+                
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                checksumQueue_.push(timestampedChecksum);
+            } else if (bytesReceived == sizeof(packets::TimestampedInputAckPacket)) {
+                packets::TimestampedInputAckPacket timestampedInputAck;
+                memcpy(&timestampedInputAck, buffer, sizeof(timestampedInputAck));
+                
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                inputAckQueue_.push(timestampedInputAck);
+            } else if (bytesReceived >= sizeof(packets::TimestampedPlayerStatePacket)) {
                 packets::TimestampedPlayerStatePacket timestampedPacket;
                 memcpy(&timestampedPacket, buffer, sizeof(timestampedPacket));
                 
@@ -320,6 +489,38 @@ void Client::processNetworkEvents() {
 }
 
 void Client::handleServerUpdate(const packets::PlayerStatePacket& packet) {
+    // Acknowledge every received state, including resends and heartbeats
+    uint32_t& pendingAck = pendingStateAcks_[packet.player_id];
+    pendingAck = std::max(pendingAck, packet.state_sequence);
+    
+    if (packet.player_id == clientId_) {
+        updateRoundTripTime(packet.last_processed_input_sequence);
+        
+        // Hash the prediction before this state corrects it
+        recordReconstructedState(packet);
+    } else {
+        bool predicted = false;
+        {
+            std::lock_guard<std::mutex> lock(playerMutex_);
+            if (remotePredictionSystem_->isEnabled() && players_.count(packet.player_id)) {
+                // Predict from this state with the input the remote player is holding
+                remotePredictionSystem_->recordServerState(
+                    packet.player_id,
+                    {packet.x, packet.y, packet.z},
+                    {packet.velocity_x, packet.velocity_y, packet.velocity_z},
+                    packet.is_jumping,
+                    {packet.input_x, packet.input_y, packet.input_z},
+                    std::chrono::steady_clock::now()
+                );
+                predicted = true;
+            }
+        }
+        if (predicted) {
+            recordReconstructedState(packet);
+            return;
+        }
+    }
+    
     // Skip reapplying if this was a predicted action
     if (packet.player_id == clientId_ && packet.wasPredicted) {
         LOG_DEBUG("Skipping reapplication of predicted action for sequence " + 
@@ -334,8 +535,321 @@ void Client::handleServerUpdate(const packets::PlayerStatePacket& packet) {
         packet.y, 
         packet.z, 
         packet.is_jumping,
-        packet.last_processed_input_sequence // Use the server's sequence number
+        packet.last_processed_input_sequence, // Use the server's sequence number
+        {packet.velocity_x, packet.velocity_y, packet.velocity_z}
     );
+    
+    if (packet.player_id != clientId_) {
+        recordReconstructedState(packet);
+    }
+}
+
+void Client::recordReconstructedState(const packets::PlayerStatePacket& packet) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    
+    auto entity = players_.find(packet.player_id);
+    if (entity == players_.end()) {
+        // The client holds no state of its own for unknown entities
+        return;
+    }
+    
+    auto previous = reconstructedStates_.find(packet.player_id);
+    bool recorded = previous != reconstructedStates_.end();
+    if (recorded && packet.state_sequence < previous->second.stateSequence) {
+        return;
+    }
+    
+    bool predictedLocally = packet.player_id == clientId_ && settings_ && settings_->isPredictionEnabled();
+    EntitySnapshot snapshot;
+    if (predictedLocally) {
+        if (recorded && packet.state_sequence != previous->second.stateSequence &&
+            packet.last_processed_input_sequence == previous->second.inputSequence) {
+            // The server changed the state without a new input, e.g. released a held
+            // input; the client predicts no such change, so there is nothing to compare
+            return;
+        }
+        
+        // The latest state the client holds for that input, a replay after a correction replaces the first prediction
+        const EntityRecord* record = snapshotManager_->getRecords().findRecord(packet.player_id);
+        if (!record) {
+            return;
+        }
+        auto predictedSnapshot = std::find_if(record->snapshots.rbegin(), record->snapshots.rend(),
+            [&packet](const EntitySnapshot& candidate) {
+                return candidate.sequenceNumber == packet.last_processed_input_sequence;
+            });
+        if (predictedSnapshot == record->snapshots.rend()) {
+            return;
+        }
+        snapshot = *predictedSnapshot;
+    } else if (packet.player_id != clientId_ && remotePredictionSystem_->isEnabled()) {
+        if (!remotePredictionSystem_->getServerState(packet.player_id, snapshot)) {
+            return;
+        }
+    } else if (packet.player_id != clientId_ && settings_ && settings_->isInterpolationEnabled()) {
+        snapshot = snapshotManager_->getLatestEntitySnapshot(packet.player_id);
+        if (snapshot.sequenceNumber == 0) {
+            return;
+        }
+    } else {
+        // Snapped straight to the server state
+        snapshot.position = entity->second->getPosition();
+        snapshot.velocity = entity->second->getVelocity();
+        snapshot.isJumping = entity->second->isJumping();
+    }
+    
+    ReconstructedState& reconstructed = reconstructedStates_[packet.player_id];
+    worldChecksum_ ^= reconstructed.hash;
+    reconstructed.stateSequence = packet.state_sequence;
+    reconstructed.inputSequence = packet.last_processed_input_sequence;
+    reconstructed.hash = utils::hash_entity_state(packet.player_id, snapshot.position, snapshot.velocity,
+                                                  snapshot.isJumping);
+    worldChecksum_ ^= reconstructed.hash;
+}
+
+void Client::handleStateChecksum(const packets::StateChecksumPacket& checksum) {
+    uint32_t count = std::min(checksum.count, packets::MAX_CHECKSUM_ENTRIES);
+    
+    // Fast path: everything in one packet, every entity at the server's sequence and the world checksum matches
+    if (count == checksum.entity_count && reconstructedStates_.size() == checksum.entity_count &&
+        worldChecksum_ == checksum.world_checksum) {
+        bool sameSequences = true;
+        for (uint32_t i = 0; i < count && sameSequences; ++i) {
+            auto it = reconstructedStates_.find(checksum.entries[i].entity_id);
+            sameSequences = it != reconstructedStates_.end() &&
+                            it->second.stateSequence == checksum.entries[i].state_sequence;
+        }
+        if (sameSequences) {
+            return;
+        }
+    }
+    
+    std::vector<uint32_t> divergingEntities;
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto& entry = checksum.entries[i];
+        auto it = reconstructedStates_.find(entry.entity_id);
+        if (it == reconstructedStates_.end() || it->second.stateSequence != entry.state_sequence) {
+            // Not at the same state yet, replication will catch up
+            continue;
+        }
+        if (it->second.hash != entry.hash) {
+            divergingEntities.push_back(entry.entity_id);
+        }
+    }
+    
+    if (divergingEntities.empty()) {
+        return;
+    }
+    
+    std::string ids;
+    for (uint32_t entityId : divergingEntities) {
+        ids += (ids.empty() ? "" : ", ") + std::to_string(entityId);
+        
+        // Ask the server to send the entity again
+        pendingStateAcks_[entityId] = 0;
+    }
+    LOG_WARNING("Client " + std::to_string(clientId_) + " desync at checksum " +
+                std::to_string(checksum.checksum_sequence) + ", diverging entities: " + ids, "Client");
+    
+    if (desyncCallback_) {
+        desyncCallback_(checksum.checksum_sequence, divergingEntities);
+    }
+}
+
+void Client::setDesyncCallback(std::function<void(uint32_t, const std::vector<uint32_t>&)> callback) {
+    desyncCallback_ = callback;
+}
+
+void Client::handleRedirect(const packets::RedirectPacket& redirect) {
+    if (redirect.player_id != clientId_) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    serverAddr_.sin_addr.s_addr = redirect.server_ip;
+    serverAddr_.sin_port = htons(redirect.server_port);
+    serverPort_ = redirect.server_port;
+    
+    // The new server buffers inputs on its own ticks
+    timeDilation_.reset();
+    
+    LOG_INFO("Client " + std::to_string(clientId_) + " redirected to region " +
+             std::to_string(redirect.region_id) + " on port " + std::to_string(redirect.server_port), "Client");
+}
+
+void Client::handleInputAck(const packets::InputAckPacket& inputAck) {
+    if (inputAck.player_id != clientId_) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    timeDilation_.onInputAck(inputAck.server_tick, inputAck.buffer_depth, inputAck.underruns, inputAck.catch_up_inputs);
+}
+
+float Client::getTimeScale() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return timeDilation_.getTimeScale();
+}
+
+void Client::setTimeDilationConfig(const TimeDilationConfig& config) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    timeDilation_.setConfig(config);
+}
+
+TimeDilationStats Client::getTimeDilationStats() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return timeDilation_.getStats();
+}
+
+void Client::handleSession(const packets::SessionPacket& session) {
+    if (session.player_id != clientId_) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    if (session.token == 0) {
+        // The session expired or never existed, start over
+        sessionToken_ = 0;
+        LOG_WARNING("Client " + std::to_string(clientId_) + " could not resume its session, registering again", "Client");
+        sendRegistration();
+        return;
+    }
+    
+    sessionToken_ = session.token;
+    if (!session.resumed) {
+        return;
+    }
+    
+    // Inputs sent while the old address was unreachable never arrived
+    auto now = std::chrono::steady_clock::now();
+    size_t resent = 0;
+    for (auto it = unprocessedInputs_.upper_bound(session.last_processed_input_sequence);
+         it != unprocessedInputs_.end(); ++it) {
+        packets::TimestampedPlayerMovementRequest timestampedRequest;
+        timestampedRequest.timestamp = now + 
+            std::chrono::milliseconds(settings_ ? settings_->getClientToServerDelay() : 10);
+        timestampedRequest.player_movement_request = it->second;
+        sendto(socketFd_, &timestampedRequest, sizeof(timestampedRequest), 0,
+               (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+        resent++;
+    }
+    
+    LOG_INFO("Client " + std::to_string(clientId_) + " resumed its session, resent " +
+             std::to_string(resent) + " inputs", "Client");
+}
+
+int Client::getServerPort() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return serverPort_;
+}
+
+void Client::sendStateAcks() {
+    auto now = std::chrono::steady_clock::now();
+    auto sinceLastAck = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastStateAckTime_).count();
+    if (pendingStateAcks_.empty() && sessionToken_ != 0 && sinceLastAck >= KEEPALIVE_INTERVAL_MS) {
+        // Nothing to acknowledge, but the server must keep hearing from the client
+        packets::TimestampedStateAckPacket timestampedAck{};
+        timestampedAck.timestamp = now + 
+            std::chrono::milliseconds(settings_ ? settings_->getClientToServerDelay() : 10);
+        timestampedAck.state_ack.player_id = clientId_;
+        sendto(socketFd_, &timestampedAck, sizeof(timestampedAck), 0,
+               (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+        lastStateAckTime_ = now;
+        return;
+    }
+    if (pendingStateAcks_.empty() || sinceLastAck < STATE_ACK_INTERVAL_MS) {
+        return;
+    }
+    lastStateAckTime_ = now;
+    
+    auto it = pendingStateAcks_.begin();
+    while (it != pendingStateAcks_.end()) {
+        packets::TimestampedStateAckPacket timestampedAck{};
+        timestampedAck.timestamp = now + 
+            std::chrono::milliseconds(settings_ ? settings_->getClientToServerDelay() : 10);
+        timestampedAck.state_ack.player_id = clientId_;
+        
+        // Fill up to a full packet of acknowledgements
+        auto& ack = timestampedAck.state_ack;
+        for (; it != pendingStateAcks_.end() && ack.count < packets::MAX_STATE_ACKS; ++it) {
+            ack.entries[ack.count].entity_id = it->first;
+            ack.entries[ack.count].state_sequence = it->second;
+            ack.count++;
+        }
+        
+        ssize_t bytesSent = sendto(socketFd_, &timestampedAck, sizeof(timestampedAck), 0,
+                                (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+        if (bytesSent < 0) {
+            LOG_ERROR("Failed to send state acknowledgements: " + std::string(strerror(errno)), "Client");
+        }
+    }
+    pendingStateAcks_.clear();
+}
+
+void Client::updateRoundTripTime(uint32_t acknowledgedSequence) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    
+    unprocessedInputs_.erase(unprocessedInputs_.begin(), unprocessedInputs_.upper_bound(acknowledgedSequence));
+    
+    auto it = inputSendTimes_.find(acknowledgedSequence);
+    if (it == inputSendTimes_.end()) {
+        return;
+    }
+    
+    auto sample = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - it->second);
+    
+    // Exponentially weighted average so single late packets don't cause jumps
+    if (roundTripTime_.count() == 0) {
+        roundTripTime_ = sample;
+    } else {
+        roundTripTime_ += (sample - roundTripTime_) / 8;
+    }
+    remotePredictionSystem_->setLatencyEstimate(roundTripTime_);
+    
+    // Older inputs can no longer be acknowledged on their own
+    inputSendTimes_.erase(inputSendTimes_.begin(), std::next(it));
+}
+
+void Client::setRemotePredictionConfig(const RemotePredictionConfig& config) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    remotePredictionSystem_->setConfig(config);
+}
+
+RemotePredictionStats Client::getRemotePredictionStats(uint32_t playerId) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return remotePredictionSystem_->getStats(playerId);
+}
+
+void Client::setInterpolationConfig(const InterpolationConfig& config) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    interpolationSystem_->setConfig(config);
+}
+
+void Client::setReconciliationThreshold(float threshold) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    reconciliationSystem_->setReconciliationThreshold(threshold);
+}
+
+void Client::setReplayLimits(uint32_t maxInputs, std::chrono::microseconds budget) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    reconciliationSystem_->setPredictionHorizon(maxInputs);
+    reconciliationSystem_->setReplayBudget(budget);
+}
+
+ReconciliationStats Client::getReconciliationStats() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return reconciliationSystem_->getStats();
+}
+
+InterpolationStats Client::getInterpolationStats() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return interpolationSystem_->getStats();
+}
+
+std::chrono::microseconds Client::getRoundTripTime() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return roundTripTime_;
 }
 
 } // namespace netcode
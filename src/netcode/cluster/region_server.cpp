@@ -0,0 +1,555 @@
+#include "netcode/cluster/region_server.hpp"
+#include "netcode/server/state_replicator.hpp"
+#include "netcode/utils/logger.hpp"
+#include "netcode/utils/state_hash.hpp"
+#include "netcode/utils/tick_scheduler.hpp"
+#include "netcode/utils/udp_socket.hpp"
+#include <unistd.h>
+#include <cstring>
+#include <poll.h>
+#include <algorithm>
+#include <cmath>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace netcode {
+
+namespace {
+
+// Distance from a position to a region's bounds on the ground plane, zero if inside
+float distanceToRegion(const netcode::math::MyVec3& position, const RegionConfig& region) {
+    float dx = std::max({region.minX - position.x, 0.0f, position.x - region.maxX});
+    float dz = std::max({region.minZ - position.z, 0.0f, position.z - region.maxZ});
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+bool isInside(const netcode::math::MyVec3& position, const RegionConfig& region, float inset) {
+    return position.x >= region.minX + inset && position.x <= region.maxX - inset &&
+           position.z >= region.minZ + inset && position.z <= region.maxZ - inset;
+}
+
+} // namespace
+
+RegionServer::RegionServer(uint32_t regionId, const ClusterConfig& config, std::shared_ptr<ISettings> settings)
+    : config_(config), settings_(settings), running_(false) {
+    const RegionConfig* region = findRegion(regionId);
+    if (!region) {
+        LOG_ERROR("Region " + std::to_string(regionId) + " is not part of the cluster config", "RegionServer");
+        region_.regionId = regionId;
+    } else {
+        region_ = *region;
+    }
+    LOG_INFO("Region server " + std::to_string(regionId) + " created for x [" + std::to_string(region_.minX) +
+             ", " + std::to_string(region_.maxX) + "]", "RegionServer");
+}
+
+RegionServer::~RegionServer() {
+    stop();
+}
+
+void RegionServer::start() {
+    if (running_) {
+        LOG_WARNING("Region server already running", "RegionServer");
+        return;
+    }
+
+    clientSocketFd_ = utils::open_bound_socket(region_.clientPort);
+    peerSocketFd_ = utils::open_bound_socket(region_.peerPort);
+    if (clientSocketFd_ < 0 || peerSocketFd_ < 0) {
+        LOG_ERROR("Failed to bind region sockets: " + std::string(strerror(errno)), "RegionServer");
+        stop();
+        return;
+    }
+
+    running_ = true;
+    regionThread_ = std::thread(&RegionServer::run, this);
+    LOG_INFO("Region server " + std::to_string(region_.regionId) + " started on client port " +
+             std::to_string(region_.clientPort) + ", peer port " + std::to_string(region_.peerPort), "RegionServer");
+}
+
+void RegionServer::stop() {
+    running_ = false;
+    if (regionThread_.joinable()) {
+        regionThread_.join();
+    }
+    if (clientSocketFd_ != -1) {
+        close(clientSocketFd_);
+        clientSocketFd_ = -1;
+    }
+    if (peerSocketFd_ != -1) {
+        close(peerSocketFd_);
+        peerSocketFd_ = -1;
+    }
+}
+
+void RegionServer::setEntityFactory(EntityFactory factory) {
+    std::lock_guard<std::mutex> lock(entityMutex_);
+    entityFactory_ = factory;
+}
+
+void RegionServer::setPlayerReference(uint32_t playerId, std::shared_ptr<NetworkedEntity> player) {
+    std::lock_guard<std::mutex> lock(entityMutex_);
+    OwnedEntity& owned = owned_[playerId];
+    owned.entity = player;
+    ghosts_.erase(playerId);
+    handedOffTo_.erase(playerId);
+    LOG_INFO("Region " + std::to_string(region_.regionId) + " spawned player " + std::to_string(playerId), "RegionServer");
+}
+
+bool RegionServer::ownsEntity(uint32_t playerId) {
+    std::lock_guard<std::mutex> lock(entityMutex_);
+    return owned_.find(playerId) != owned_.end();
+}
+
+bool RegionServer::hasGhost(uint32_t playerId) {
+    std::lock_guard<std::mutex> lock(entityMutex_);
+    return ghosts_.find(playerId) != ghosts_.end();
+}
+
+uint32_t RegionServer::regionForPosition(const netcode::math::MyVec3& position, uint32_t currentRegion) const {
+    const RegionConfig* current = findRegion(currentRegion);
+    if (current && isInside(position, *current, 0.0f)) {
+        return currentRegion;
+    }
+
+    // Only move once the position is clearly inside another region
+    for (const auto& region : config_.regions) {
+        if (region.regionId != currentRegion && isInside(position, region, config_.handoffHysteresis)) {
+            return region.regionId;
+        }
+    }
+    return currentRegion;
+}
+
+const RegionConfig* RegionServer::findRegion(uint32_t regionId) const {
+    for (const auto& region : config_.regions) {
+        if (region.regionId == regionId) {
+            return &region;
+        }
+    }
+    return nullptr;
+}
+
+void RegionServer::run() {
+    // A tick missed while the thread was descheduled is dropped, not caught up on
+    utils::TickSchedulerConfig schedulerConfig;
+    schedulerConfig.tick_rate = config_.tickRate;
+    schedulerConfig.overrun_policy = utils::OverrunPolicy::SKIP;
+    utils::TickScheduler scheduler(schedulerConfig);
+    scheduler.start();
+
+    while (running_) {
+        // Wait for packets until the next tick is due, the scheduler sleeps the last fraction of a millisecond
+        auto remaining = scheduler.next_deadline() - std::chrono::steady_clock::now();
+        if (remaining >= std::chrono::milliseconds(1)) {
+            int timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count());
+            pollfd fds[2] = {{clientSocketFd_, POLLIN, 0}, {peerSocketFd_, POLLIN, 0}};
+            if (poll(fds, 2, timeoutMs) > 0) {
+                receivePeerMessages();
+                receiveClientPackets();
+            }
+            continue;
+        }
+
+        scheduler.wait_next_tick();
+        receivePeerMessages();
+        receiveClientPackets();
+        tick();
+        tickOverruns_.store(scheduler.stats().overruns, std::memory_order_relaxed);
+    }
+}
+
+void RegionServer::receiveClientPackets() {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+    sockaddr_in clientAddr;
+
+    while (true) {
+        socklen_t clientLen = sizeof(clientAddr);
+        ssize_t bytesReceived = recvfrom(clientSocketFd_, buffer, BUFFER_SIZE, 0,
+                                         (struct sockaddr*)&clientAddr, &clientLen);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "RegionServer");
+            }
+            return;
+        }
+
+        // Only inputs are handled, state acknowledgements are not used by the cluster
+        if (bytesReceived != sizeof(packets::TimestampedPlayerMovementRequest)) {
+            continue;
+        }
+
+        packets::TimestampedPlayerMovementRequest timestampedRequest;
+        memcpy(&timestampedRequest, buffer, sizeof(timestampedRequest));
+        timestampedRequest.clientAddr = clientAddr;
+
+        std::lock_guard<std::mutex> lock(entityMutex_);
+        pendingInputs_.push_back(timestampedRequest);
+    }
+}
+
+void RegionServer::receivePeerMessages() {
+    packets::ClusterMessage message;
+
+    while (true) {
+        ssize_t bytesReceived = recvfrom(peerSocketFd_, &message, sizeof(message), 0, nullptr, nullptr);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "RegionServer");
+            }
+            return;
+        }
+        if (bytesReceived != sizeof(message)) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(entityMutex_);
+        uint32_t playerId = message.state.player_id;
+
+        switch (message.type) {
+            case packets::ClusterMessageType::GHOST_STATE: {
+                if (owned_.count(playerId)) {
+                    // We took over since this was sent
+                    break;
+                }
+                Ghost& ghost = ghosts_[playerId];
+                bool changed = ghost.lastUpdate == std::chrono::steady_clock::time_point() ||
+                               utils::has_state_changed(ghost.state, message.state);
+                ghost.state = message.state;
+                ghost.ownerRegion = message.from_region;
+                ghost.lastUpdate = std::chrono::steady_clock::now();
+                if (changed) {
+                    sendStateToClients(ghost.state);
+                }
+                break;
+            }
+            case packets::ClusterMessageType::HANDOFF:
+                acceptHandoff(message);
+                break;
+            case packets::ClusterMessageType::HANDOFF_ACK: {
+                auto it = pendingHandoffs_.find(playerId);
+                if (it == pendingHandoffs_.end()) {
+                    break;
+                }
+                const auto& handoff = it->second.message;
+                if (handoff.has_client) {
+                    // The new region holds the session now, point the client there
+                    const RegionConfig* target = findRegion(it->second.targetRegion);
+                    packets::TimestampedRedirectPacket redirect{};
+                    redirect.timestamp = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+                    redirect.redirect.player_id = playerId;
+                    redirect.redirect.region_id = it->second.targetRegion;
+                    inet_pton(AF_INET, config_.host.c_str(), &redirect.redirect.server_ip);
+                    redirect.redirect.server_port = static_cast<uint16_t>(target ? target->clientPort : 0);
+                    sendto(clientSocketFd_, &redirect, sizeof(redirect), 0,
+                           (struct sockaddr*)&handoff.client_addr, sizeof(handoff.client_addr));
+                    sessions_.erase(playerId);
+                }
+                LOG_INFO("Region " + std::to_string(region_.regionId) + " handed off player " +
+                         std::to_string(playerId) + " to region " + std::to_string(it->second.targetRegion), "RegionServer");
+                pendingHandoffs_.erase(it);
+                break;
+            }
+            case packets::ClusterMessageType::FORWARDED_INPUT:
+                applyInput(message.input);
+                break;
+            default:
+                LOG_WARNING("Unknown cluster message type", "RegionServer");
+                break;
+        }
+    }
+}
+
+void RegionServer::tick() {
+    std::lock_guard<std::mutex> lock(entityMutex_);
+    auto now = std::chrono::steady_clock::now();
+
+    // Apply inputs that have reached their delivery time
+    std::vector<packets::TimestampedPlayerMovementRequest> remaining;
+    std::vector<packets::TimestampedPlayerMovementRequest> ready;
+    for (const auto& input : pendingInputs_) {
+        (now >= input.timestamp ? ready : remaining).push_back(input);
+    }
+    pendingInputs_ = std::move(remaining);
+    for (const auto& input : ready) {
+        applyInput(input);
+    }
+
+    std::vector<uint32_t> leaving;
+    for (auto& [playerId, owned] : owned_) {
+        // Players whose keys were released send nothing, stop predicting them as moving
+        if (StateReplicator::isInputReleased(owned.lastInputTime, now)) {
+            StateReplicator::releaseHeldInput(*owned.entity, owned.lastInput);
+        }
+
+        // A new acknowledged input is sent too, the client reconciles against it
+        packets::PlayerStatePacket packet = makeStatePacket(playerId, owned);
+        bool changed = utils::has_state_changed(owned.lastSent, packet) ||
+                       packet.last_processed_input_sequence != owned.lastSent.last_processed_input_sequence ||
+                       owned.lastSent.state_sequence == 0;
+        packet.state_sequence = owned.lastSent.state_sequence + (changed ? 1 : 0);
+
+        if (changed) {
+            owned.lastSent = packet;
+            sendStateToClients(packet);
+        }
+
+        // Mirror entities near a border to the neighbouring regions
+        auto position = owned.entity->getPosition();
+        for (const auto& region : config_.regions) {
+            if (region.regionId != region_.regionId && distanceToRegion(position, region) < config_.ghostMargin) {
+                packets::ClusterMessage ghost{};
+                ghost.type = packets::ClusterMessageType::GHOST_STATE;
+                ghost.from_region = region_.regionId;
+                ghost.state = owned.lastSent;
+                sendToRegion(region.regionId, ghost);
+            }
+        }
+
+        if (regionForPosition(position, region_.regionId) != region_.regionId) {
+            leaving.push_back(playerId);
+        }
+    }
+
+    // Hand off entities that crossed into another region
+    for (uint32_t playerId : leaving) {
+        OwnedEntity& owned = owned_[playerId];
+        uint32_t target = regionForPosition(owned.entity->getPosition(), region_.regionId);
+
+        PendingHandoff& handoff = pendingHandoffs_[playerId];
+        handoff.targetRegion = target;
+        handoff.lastSendTime = now;
+        handoff.message.type = packets::ClusterMessageType::HANDOFF;
+        handoff.message.from_region = region_.regionId;
+        handoff.message.state = owned.lastSent;
+        handoff.message.has_client = owned.hasClient;
+        handoff.message.client_addr = owned.clientAddr;
+        sendToRegion(target, handoff.message);
+
+        // Keep showing it to our clients as a ghost of the new owner
+        Ghost& ghost = ghosts_[playerId];
+        ghost.state = owned.lastSent;
+        ghost.ownerRegion = target;
+        ghost.lastUpdate = now;
+
+        handedOffTo_[playerId] = target;
+        owned_.erase(playerId);
+        LOG_INFO("Region " + std::to_string(region_.regionId) + " handing off player " +
+                 std::to_string(playerId) + " to region " + std::to_string(target), "RegionServer");
+    }
+
+    // Resend handoffs that were not acknowledged
+    for (auto& [playerId, handoff] : pendingHandoffs_) {
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - handoff.lastSendTime).count() >= config_.handoffRetryMs) {
+            sendToRegion(handoff.targetRegion, handoff.message);
+            handoff.lastSendTime = now;
+        }
+    }
+
+    // Drop ghosts that moved away from our border
+    for (auto it = ghosts_.begin(); it != ghosts_.end();) {
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.lastUpdate).count() >= config_.ghostTimeoutMs) {
+            it = ghosts_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RegionServer::applyInput(const packets::TimestampedPlayerMovementRequest& timestampedRequest) {
+    const auto& request = timestampedRequest.player_movement_request;
+    uint32_t playerId = request.player_id;
+
+    auto ownedIt = owned_.find(playerId);
+    if (ownedIt == owned_.end()) {
+        auto handedOff = handedOffTo_.find(playerId);
+        if (handedOff != handedOffTo_.end()) {
+            // Sent before the client learned about the handoff, the new owner applies it
+            packets::ClusterMessage forward{};
+            forward.type = packets::ClusterMessageType::FORWARDED_INPUT;
+            forward.from_region = region_.regionId;
+            forward.state.player_id = playerId;
+            forward.input = timestampedRequest;
+            sendToRegion(handedOff->second, forward);
+            return;
+        }
+    }
+
+    // Players joining through the spawn region are created here
+    if (ownedIt == owned_.end() && region_.spawnPlayers && entityFactory_ && !ghosts_.count(playerId)) {
+        ownedIt = spawnPlayer(playerId);
+    }
+
+    // New clients get everything this region knows about
+    if (sessions_.find(playerId) == sessions_.end() && ownedIt != owned_.end()) {
+        sessions_[playerId] = timestampedRequest.clientAddr;
+        sendInitialSnapshot(timestampedRequest.clientAddr);
+        LOG_INFO("Region " + std::to_string(region_.regionId) + " registered client " + std::to_string(playerId), "RegionServer");
+    }
+
+    if (ownedIt == owned_.end()) {
+        LOG_DEBUG("Input for player " + std::to_string(playerId) + " not owned by region " +
+                  std::to_string(region_.regionId), "RegionServer");
+        return;
+    }
+
+    OwnedEntity& owned = ownedIt->second;
+    owned.hasClient = true;
+    owned.clientAddr = timestampedRequest.clientAddr;
+
+    if (request.input_sequence_number <= owned.lastProcessedInputSequence) {
+        return;
+    }
+    owned.lastProcessedInputSequence = request.input_sequence_number;
+
+    netcode::math::MyVec3 movement = {request.movement_x, request.movement_y, request.movement_z};
+    owned.entity->move(movement);
+    owned.lastInput = movement;
+    owned.lastInputTime = std::chrono::steady_clock::now();
+    owned.lastWasPredicted = request.wasPredicted;
+    if (request.is_jumping) {
+        owned.entity->jump();
+    }
+    owned.entity->update();
+}
+
+void RegionServer::acceptHandoff(const packets::ClusterMessage& message) {
+    uint32_t playerId = message.state.player_id;
+
+    if (owned_.find(playerId) == owned_.end()) {
+        if (!entityFactory_) {
+            LOG_ERROR("No entity factory set, cannot take over player " + std::to_string(playerId), "RegionServer");
+            return;
+        }
+
+        OwnedEntity owned;
+        owned.entity = entityFactory_(playerId);
+        if (!owned.entity) {
+            LOG_ERROR("Entity factory returned no entity for player " + std::to_string(playerId), "RegionServer");
+            return;
+        }
+        owned.entity->snapSimulationState(
+            {message.state.x, message.state.y, message.state.z},
+            message.state.is_jumping,
+            {message.state.velocity_x, message.state.velocity_y, message.state.velocity_z});
+        owned.lastProcessedInputSequence = message.state.last_processed_input_sequence;
+        owned.lastInput = {message.state.input_x, message.state.input_y, message.state.input_z};
+        owned.lastInputTime = std::chrono::steady_clock::now();
+        owned.lastWasPredicted = message.state.wasPredicted;
+        owned.lastSent = message.state;
+        owned.hasClient = message.has_client;
+        owned.clientAddr = message.client_addr;
+        owned_[playerId] = owned;
+
+        ghosts_.erase(playerId);
+        handedOffTo_.erase(playerId);
+        pendingHandoffs_.erase(playerId);
+
+        // The session moves along with the entity so the client never has to reconnect,
+        // the client has not seen this region's entities yet
+        sendStateToClients(message.state);
+        if (message.has_client) {
+            sessions_[playerId] = message.client_addr;
+            sendInitialSnapshot(message.client_addr);
+        }
+
+        LOG_INFO("Region " + std::to_string(region_.regionId) + " took over player " + std::to_string(playerId) +
+                 " from region " + std::to_string(message.from_region), "RegionServer");
+    }
+
+    // Acknowledge duplicates too, the previous acknowledgement may have been lost
+    packets::ClusterMessage ack{};
+    ack.type = packets::ClusterMessageType::HANDOFF_ACK;
+    ack.from_region = region_.regionId;
+    ack.state.player_id = playerId;
+    sendToRegion(message.from_region, ack);
+}
+
+std::map<uint32_t, RegionServer::OwnedEntity>::iterator RegionServer::spawnPlayer(uint32_t playerId) {
+    OwnedEntity owned;
+    owned.entity = entityFactory_(playerId);
+    if (!owned.entity) {
+        LOG_ERROR("Entity factory returned no entity for player " + std::to_string(playerId), "RegionServer");
+        return owned_.end();
+    }
+
+    // Spawn in the middle of the region, the factory decides the height
+    float z = std::clamp(0.0f, region_.minZ, region_.maxZ);
+    owned.entity->setPosition({(region_.minX + region_.maxX) / 2.0f, owned.entity->getPosition().y, z});
+    handedOffTo_.erase(playerId);
+    LOG_INFO("Region " + std::to_string(region_.regionId) + " spawned player " + std::to_string(playerId), "RegionServer");
+    return owned_.emplace(playerId, owned).first;
+}
+
+void RegionServer::sendInitialSnapshot(const sockaddr_in& clientAddr) {
+    packets::TimestampedPlayerStatePacket timestampedPacket{};
+    timestampedPacket.timestamp = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+
+    for (const auto& [id, owned] : owned_) {
+        if (owned.lastSent.state_sequence != 0) {
+            timestampedPacket.player_state = owned.lastSent;
+            sendto(clientSocketFd_, &timestampedPacket, sizeof(timestampedPacket), 0,
+                   (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+        }
+    }
+    for (const auto& [id, ghost] : ghosts_) {
+        timestampedPacket.player_state = ghost.state;
+        sendto(clientSocketFd_, &timestampedPacket, sizeof(timestampedPacket), 0,
+               (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    }
+}
+
+packets::PlayerStatePacket RegionServer::makeStatePacket(uint32_t playerId, const OwnedEntity& owned) const {
+    auto pos = owned.entity->getPosition();
+    auto velocity = owned.entity->getVelocity();
+
+    packets::PlayerStatePacket packet{};
+    packet.player_id = playerId;
+    packet.x = pos.x;
+    packet.y = pos.y;
+    packet.z = pos.z;
+    packet.velocity_x = velocity.x;
+    packet.velocity_y = velocity.y;
+    packet.velocity_z = velocity.z;
+    packet.is_jumping = owned.entity->isJumping();
+    packet.input_x = owned.lastInput.x;
+    packet.input_y = owned.lastInput.y;
+    packet.input_z = owned.lastInput.z;
+    packet.last_processed_input_sequence = owned.lastProcessedInputSequence;
+    packet.state_sequence = owned.lastSent.state_sequence;
+    packet.wasPredicted = owned.lastWasPredicted;
+    return packet;
+}
+
+void RegionServer::sendToRegion(uint32_t regionId, const packets::ClusterMessage& message) {
+    const RegionConfig* region = findRegion(regionId);
+    if (!region) {
+        LOG_WARNING("Cannot send to unknown region " + std::to_string(regionId), "RegionServer");
+        return;
+    }
+
+    sockaddr_in peerAddr;
+    memset(&peerAddr, 0, sizeof(peerAddr));
+    peerAddr.sin_family = AF_INET;
+    peerAddr.sin_port = htons(region->peerPort);
+    inet_pton(AF_INET, config_.host.c_str(), &peerAddr.sin_addr);
+
+    sendto(peerSocketFd_, &message, sizeof(message), 0, (struct sockaddr*)&peerAddr, sizeof(peerAddr));
+}
+
+void RegionServer::sendStateToClients(const packets::PlayerStatePacket& packet) {
+    packets::TimestampedPlayerStatePacket timestampedPacket{};
+    timestampedPacket.timestamp = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+    timestampedPacket.player_state = packet;
+
+    for (const auto& [clientId, clientAddr] : sessions_) {
+        sendto(clientSocketFd_, &timestampedPacket, sizeof(timestampedPacket), 0,
+               (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    }
+}
+
+} // namespace netcode
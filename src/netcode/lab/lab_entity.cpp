@@ -0,0 +1,61 @@
+#include "netcode/lab/lab_entity.hpp"
+
+namespace netcode {
+
+LabEntity::LabEntity(uint32_t id, const netcode::math::MyVec3& position)
+    : id_(id), position_(position), velocity_(0.0f, 0.0f, 0.0f), renderPosition_(position) {}
+
+void LabEntity::move(const netcode::math::MyVec3& direction) {
+    velocity_.x = direction.x * MOVE_SPEED;
+    velocity_.z = direction.z * MOVE_SPEED;
+    position_ += direction * MOVE_SPEED;
+    movedThisStep_ = true;
+}
+
+void LabEntity::update() {
+    // A step without movement input leaves the entity standing
+    if (!movedThisStep_) {
+        velocity_.x = 0.0f;
+        velocity_.z = 0.0f;
+    }
+    movedThisStep_ = false;
+
+    if (isJumping_) {
+        position_.y += velocity_.y;
+        velocity_.y -= GRAVITY;
+        if (position_.y <= GROUND_LEVEL) {
+            position_.y = GROUND_LEVEL;
+            velocity_.y = 0.0f;
+            isJumping_ = false;
+        }
+    }
+    if (position_.y < GROUND_LEVEL && !isJumping_) {
+        position_.y = GROUND_LEVEL;
+        velocity_.y = 0.0f;
+    }
+}
+
+void LabEntity::jump() {
+    if (!isJumping_ && position_.y <= GROUND_LEVEL + 0.01f) {
+        velocity_.y = JUMP_FORCE;
+        isJumping_ = true;
+    }
+}
+
+void LabEntity::updateRenderPosition(float deltaTime) {
+    errorOffset_.decay(deltaTime);
+    renderPosition_ = position_ + errorOffset_.get();
+}
+
+void LabEntity::snapSimulationState(const netcode::math::MyVec3& position, bool isJumping,
+                                    const netcode::math::MyVec3& velocity) {
+    position_ = position;
+    isJumping_ = isJumping;
+    velocity_ = velocity;
+}
+
+void LabEntity::initiateVisualBlend() {
+    errorOffset_.capture(renderPosition_, position_);
+}
+
+} // namespace netcode
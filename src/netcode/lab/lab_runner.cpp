@@ -0,0 +1,239 @@
+#include "netcode/lab/lab_runner.hpp"
+#include "netcode/lab/lab_entity.hpp"
+#include "netcode/client/client.hpp"
+#include "netcode/server/server.hpp"
+#include "netcode/server/sharded_server.hpp"
+#include "netcode/settings.hpp"
+#include "netcode/utils/logger.hpp"
+#include "netcode/utils/tick_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <map>
+#include <vector>
+
+namespace netcode {
+
+namespace {
+
+/**
+ * @brief Settings of a lab run, the emulated links add all delay
+ */
+class LabSettings : public ISettings {
+public:
+    explicit LabSettings(bool predictionEnabled) : predictionEnabled_(predictionEnabled) {}
+
+    int getClientToServerDelay() const override { return 0; }
+    int getServerToClientDelay() const override { return 0; }
+    bool isPredictionEnabled() const override { return predictionEnabled_; }
+    bool isInterpolationEnabled() const override { return true; }
+
+private:
+    bool predictionEnabled_;
+};
+
+int64_t processCpuTimeUs() {
+    timespec cpuTime;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuTime);
+    return static_cast<int64_t>(cpuTime.tv_sec) * 1000000 + cpuTime.tv_nsec / 1000;
+}
+
+netcode::math::MyVec3 spawnPosition(uint32_t playerIndex) {
+    return {static_cast<float>(playerIndex) * 3.0f, 1.0f, 0.0f};
+}
+
+// Each player circles at its own phase with a change of direction every second, like a player strafing around an objective
+netcode::math::MyVec3 scriptedMovement(uint32_t playerIndex, double seconds) {
+    double angle = seconds * 2.0 + playerIndex * 1.3;
+    double turn = std::fmod(seconds + playerIndex * 0.25, 2.0) < 1.0 ? 1.0 : -1.0;
+    return {static_cast<float>(std::cos(angle) * turn), 0.0f, static_cast<float>(std::sin(angle))};
+}
+
+} // namespace
+
+LabCellResult runLabCell(const LabCellConfig& config) {
+    LabCellResult result;
+    uint32_t playerCount = std::max<uint32_t>(config.players, 1);
+    auto settings = std::make_shared<LabSettings>(config.predictionEnabled);
+
+    // Shards tick on their own threads, the single-threaded server is ticked by the lab loop
+    std::unique_ptr<Server> server;
+    std::unique_ptr<ShardedServer> shardedServer;
+    if (config.serverShards > 0) {
+        if (config.inputBuffering) {
+            LOG_WARNING("The sharded server does not buffer inputs, running without", "Lab");
+        }
+        ShardedServerConfig shardedConfig;
+        shardedConfig.shardCount = config.serverShards;
+        shardedConfig.tickRate = std::max(config.tickRate, 1.0f);
+        shardedServer = std::make_unique<ShardedServer>(config.basePort, shardedConfig, settings);
+        for (uint32_t i = 0; i < playerCount; ++i) {
+            shardedServer->setPlayerReference(i + 1, std::make_shared<LabEntity>(i + 1, spawnPosition(i)));
+        }
+        shardedServer->start();
+    } else {
+        server = std::make_unique<Server>(config.basePort, settings);
+        for (uint32_t i = 0; i < playerCount; ++i) {
+            server->setPlayerReference(i + 1, std::make_shared<LabEntity>(i + 1, spawnPosition(i)));
+        }
+        InputBufferConfig inputBufferConfig;
+        inputBufferConfig.enabled = config.inputBuffering;
+        server->setInputBuffering(inputBufferConfig);
+        server->start();
+    }
+    auto stopServer = [&server, &shardedServer]() {
+        if (server) {
+            server->stop();
+        }
+        if (shardedServer) {
+            shardedServer->stop();
+        }
+    };
+
+    // Same snapping distance as the client's own interpolation defaults
+    InterpolationConfig interpolationConfig;
+    interpolationConfig.interpolationDelay = config.interpolationDelayMs;
+    interpolationConfig.maxInterpolationDistance = 3.0f;
+
+    std::vector<std::unique_ptr<LinkEmulator>> links;
+    std::vector<std::unique_ptr<Client>> clients;
+    for (uint32_t i = 0; i < playerCount; ++i) {
+        LinkEmulatorConfig linkConfig;
+        linkConfig.listenPort = config.basePort + 1 + static_cast<int>(i);
+        linkConfig.serverPort = config.basePort;
+        linkConfig.upstream = config.link;
+        linkConfig.downstream = config.link;
+        linkConfig.seed = i + 1;
+        links.push_back(std::make_unique<LinkEmulator>(linkConfig));
+        if (!links.back()->start()) {
+            LOG_ERROR("Could not start the link of player " + std::to_string(i + 1), "Lab");
+            clients.clear();
+            links.clear();
+            stopServer();
+            return result;
+        }
+
+        auto client = std::make_unique<Client>(i + 1, config.basePort + 100 + static_cast<int>(i), "127.0.0.1",
+                                               linkConfig.listenPort, settings);
+        client->setInterpolationConfig(interpolationConfig);
+        client->setReconciliationThreshold(config.reconciliationThreshold);
+        for (uint32_t j = 0; j < playerCount; ++j) {
+            client->setPlayerReference(j + 1, std::make_shared<LabEntity>(j + 1, spawnPosition(j)));
+        }
+        client->start();
+        clients.push_back(std::move(client));
+    }
+
+    // Trace players are handed to the clients in ID order
+    std::unique_ptr<TraceReplayer> replayer;
+    std::map<uint32_t, uint32_t> traceClients;
+    if (config.trace) {
+        replayer = std::make_unique<TraceReplayer>(*config.trace);
+        for (uint32_t playerId : config.trace->getPlayerIds()) {
+            uint32_t index = static_cast<uint32_t>(traceClients.size()) % playerCount;
+            traceClients[playerId] = index;
+        }
+    }
+
+    auto linkCpuTime = [&links]() {
+        std::chrono::microseconds total{0};
+        for (const auto& link : links) {
+            total += link->getStats().cpuTime;
+        }
+        return total.count();
+    };
+
+    // Ticks missed to a slow tick are run back to back like a server catching up would
+    utils::TickSchedulerConfig schedulerConfig;
+    schedulerConfig.tick_rate = std::max(config.tickRate, 1.0f);
+    schedulerConfig.overrun_policy = utils::OverrunPolicy::CATCH_UP;
+    utils::TickScheduler scheduler(schedulerConfig);
+    uint32_t dueTicks = 1;
+
+    float deltaTime = 1.0f / std::max(config.tickRate, 1.0f);
+    double inputInterval = 1.0 / std::max(config.sendRate, 0.1f);
+    std::vector<double> nextInputTimes(playerCount, 0.0);
+    auto duration = std::chrono::milliseconds(config.durationMs);
+
+    int64_t startCpuUs = processCpuTimeUs() - linkCpuTime();
+    auto startTime = std::chrono::steady_clock::now();
+    scheduler.start();
+    while (std::chrono::steady_clock::now() - startTime < duration) {
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+        double seconds = std::chrono::duration<double>(elapsed).count();
+
+        if (replayer) {
+            auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+            for (const auto& event : replayer->advanceTo(static_cast<uint64_t>(elapsedUs))) {
+                netcode::math::MyVec3 movement(event.input.movement_x, event.input.movement_y, event.input.movement_z);
+                clients[traceClients[event.input.player_id]]->sendMovementRequest(movement, event.input.is_jumping);
+            }
+        } else {
+            for (uint32_t i = 0; i < playerCount; ++i) {
+                // Each client's input clock follows its own server buffer depth
+                double interval = inputInterval / clients[i]->getTimeScale();
+                while (nextInputTimes[i] <= seconds) {
+                    bool jump = std::fmod(nextInputTimes[i] + i * 0.5, 2.0) < interval;
+                    clients[i]->sendMovementRequest(scriptedMovement(i, nextInputTimes[i]), jump);
+                    nextInputTimes[i] += interval;
+                }
+            }
+        }
+
+        for (uint32_t tick = 0; tick < dueTicks; ++tick) {
+            for (auto& client : clients) {
+                client->updateEntities(deltaTime);
+            }
+            if (server) {
+                server->updateEntities(deltaTime);
+            }
+            result.ticks++;
+        }
+
+        dueTicks = scheduler.wait_next_tick();
+    }
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    int64_t cpuUs = processCpuTimeUs() - linkCpuTime() - startCpuUs;
+
+    uint64_t interpolationUpdates = 0;
+    uint64_t starvedUpdates = 0;
+    double totalError = 0.0;
+    for (auto& client : clients) {
+        ReconciliationStats reconciliation = client->getReconciliationStats();
+        result.corrections += reconciliation.corrections;
+        totalError += reconciliation.totalError;
+        result.maxPredictionError = std::max(result.maxPredictionError, reconciliation.maxError);
+
+        InterpolationStats interpolation = client->getInterpolationStats();
+        interpolationUpdates += interpolation.updates;
+        starvedUpdates += interpolation.starvedUpdates;
+        client->stop();
+    }
+
+    uint64_t upstreamBytes = 0;
+    uint64_t downstreamBytes = 0;
+    for (auto& link : links) {
+        LinkEmulatorStats stats = link->getStats();
+        upstreamBytes += stats.upstreamBytes;
+        downstreamBytes += stats.downstreamBytes;
+        result.packetsDropped += stats.packetsDropped;
+        link->stop();
+    }
+    if (server) {
+        result.inputUnderruns = server->getInputBufferStats().underruns;
+    }
+    stopServer();
+
+    result.upstreamBytesPerSecond = upstreamBytes / elapsedSeconds / playerCount;
+    result.downstreamBytesPerSecond = downstreamBytes / elapsedSeconds / playerCount;
+    result.cpuUsPerTick = result.ticks > 0 ? static_cast<double>(cpuUs) / result.ticks : 0.0;
+    result.meanPredictionError = result.corrections > 0 ? totalError / result.corrections : 0.0;
+    result.interpolationStarvation = interpolationUpdates > 0
+        ? static_cast<double>(starvedUpdates) / interpolationUpdates : 0.0;
+    result.tickOverruns = scheduler.stats().overruns;
+    result.tickJitterP99Us = static_cast<double>(scheduler.stats().jitter.percentile(99.0).count());
+    return result;
+}
+
+} // namespace netcode
@@ -0,0 +1,186 @@
+#include "netcode/lab/link_emulator.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace netcode {
+
+namespace {
+
+int openSocket(int port) {
+    int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd < 0) {
+        LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "LinkEmulator");
+        return -1;
+    }
+
+    int flags = fcntl(socketFd, F_GETFL, 0);
+    fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(socketFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind socket to port " + std::to_string(port) + ": " + std::string(strerror(errno)),
+                  "LinkEmulator");
+        close(socketFd);
+        return -1;
+    }
+    return socketFd;
+}
+
+} // namespace
+
+LinkEmulator::LinkEmulator(const LinkEmulatorConfig& config) : config_(config), random_(config.seed) {
+    memset(&serverAddr_, 0, sizeof(serverAddr_));
+    serverAddr_.sin_family = AF_INET;
+    serverAddr_.sin_port = htons(config_.serverPort);
+    inet_pton(AF_INET, config_.serverIp.c_str(), &serverAddr_.sin_addr);
+    memset(&clientAddr_, 0, sizeof(clientAddr_));
+}
+
+LinkEmulator::~LinkEmulator() {
+    stop();
+}
+
+bool LinkEmulator::start() {
+    if (running_) {
+        return true;
+    }
+
+    clientSocketFd_ = openSocket(config_.listenPort);
+    serverSocketFd_ = clientSocketFd_ < 0 ? -1 : openSocket(0);
+    if (serverSocketFd_ < 0) {
+        if (clientSocketFd_ >= 0) {
+            close(clientSocketFd_);
+            clientSocketFd_ = -1;
+        }
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&LinkEmulator::run, this);
+    return true;
+}
+
+void LinkEmulator::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (clientSocketFd_ != -1) {
+        close(clientSocketFd_);
+        clientSocketFd_ = -1;
+    }
+    if (serverSocketFd_ != -1) {
+        close(serverSocketFd_);
+        serverSocketFd_ = -1;
+    }
+    inFlight_ = {};
+}
+
+LinkEmulatorStats LinkEmulator::getStats() const {
+    LinkEmulatorStats stats;
+    stats.upstreamPackets = upstreamPackets_;
+    stats.upstreamBytes = upstreamBytes_;
+    stats.downstreamPackets = downstreamPackets_;
+    stats.downstreamBytes = downstreamBytes_;
+    stats.packetsDropped = packetsDropped_;
+    stats.cpuTime = std::chrono::microseconds(cpuTimeUs_.load());
+    return stats;
+}
+
+void LinkEmulator::run() {
+    pollfd fds[2];
+    fds[0].fd = clientSocketFd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = serverSocketFd_;
+    fds[1].events = POLLIN;
+
+    while (running_) {
+        // Wake for new datagrams, the next delivery, or at least every millisecond to notice stop()
+        int timeoutMs = 1;
+        if (!inFlight_.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                inFlight_.top().due - std::chrono::steady_clock::now());
+            timeoutMs = static_cast<int>(std::clamp<int64_t>(wait.count(), 0, 1));
+        }
+        poll(fds, 2, timeoutMs);
+
+        auto now = std::chrono::steady_clock::now();
+        receive(clientSocketFd_, true, now);
+        receive(serverSocketFd_, false, now);
+
+        while (!inFlight_.empty() && inFlight_.top().due <= now) {
+            const DelayedPacket& packet = inFlight_.top();
+            int socketFd = packet.upstream ? serverSocketFd_ : clientSocketFd_;
+            const sockaddr_in& addr = packet.upstream ? serverAddr_ : clientAddr_;
+            ssize_t bytesSent = sendto(socketFd, packet.data.data(), packet.data.size(), 0,
+                                       (const struct sockaddr*)&addr, sizeof(addr));
+            if (bytesSent >= 0) {
+                (packet.upstream ? upstreamPackets_ : downstreamPackets_)++;
+                (packet.upstream ? upstreamBytes_ : downstreamBytes_) += static_cast<uint64_t>(bytesSent);
+            }
+            inFlight_.pop();
+        }
+
+        timespec cpuTime;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+        cpuTimeUs_ = static_cast<int64_t>(cpuTime.tv_sec) * 1000000 + cpuTime.tv_nsec / 1000;
+    }
+}
+
+void LinkEmulator::receive(int socketFd, bool upstream, std::chrono::steady_clock::time_point now) {
+    const LinkConditions& conditions = upstream ? config_.upstream : config_.downstream;
+    std::uniform_real_distribution<float> lossDraw(0.0f, 100.0f);
+    std::uniform_int_distribution<int64_t> jitterDraw(-static_cast<int64_t>(conditions.jitterMs) * 1000,
+                                                      static_cast<int64_t>(conditions.jitterMs) * 1000);
+    char buffer[2048];
+    sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+
+    while (true) {
+        ssize_t bytesReceived = recvfrom(socketFd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLen);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "LinkEmulator");
+            }
+            return;
+        }
+        if (upstream) {
+            // Replies go to wherever the client last sent from
+            clientAddr_ = from;
+            clientKnown_ = true;
+        } else if (!clientKnown_) {
+            continue;
+        }
+
+        if (conditions.lossPercent > 0.0f && lossDraw(random_) < conditions.lossPercent) {
+            packetsDropped_++;
+            continue;
+        }
+
+        int64_t delayUs = static_cast<int64_t>(conditions.delayMs) * 1000;
+        if (conditions.jitterMs > 0) {
+            delayUs = std::max<int64_t>(0, delayUs + jitterDraw(random_));
+        }
+
+        DelayedPacket packet;
+        packet.due = now + std::chrono::microseconds(delayUs);
+        packet.order = nextOrder_++;
+        packet.upstream = upstream;
+        packet.data.assign(buffer, buffer + bytesReceived);
+        inFlight_.push(std::move(packet));
+    }
+}
+
+} // namespace netcode
@@ -0,0 +1,181 @@
+#include "netcode/lockstep/lockstep_peer.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace netcode {
+
+namespace {
+
+// Bytes of a lockstep packet before its commands
+constexpr size_t LOCKSTEP_HEADER_SIZE = offsetof(packets::LockstepPacket, commands);
+
+// Bytes a packet carries after its header
+size_t payloadSize(const packets::LockstepPacket& packet) {
+    if (packet.type == packets::LockstepMessageType::CHECKPOINT) {
+        return packet.count;
+    }
+    return packet.count * sizeof(packets::PlayerMovementRequest);
+}
+
+} // namespace
+
+LockstepPeer::LockstepPeer(const LockstepConfig& config, const LockstepTransportConfig& transportConfig,
+                           ILockstepSimulation& simulation)
+    : config_(config), transportConfig_(transportConfig), session_(config, simulation),
+      turnInterval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<float>(1.0f / std::max(transportConfig.turnRate, 0.001f)))) {
+    for (const auto& peer : transportConfig_.peers) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(peer.port);
+        inet_pton(AF_INET, peer.ip.c_str(), &addr.sin_addr);
+        peerAddresses_.push_back(addr);
+    }
+}
+
+LockstepPeer::~LockstepPeer() {
+    stop();
+}
+
+bool LockstepPeer::start() {
+    socketFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd_ < 0) {
+        LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "Lockstep");
+        return false;
+    }
+
+    int flags = fcntl(socketFd_, F_GETFL, 0);
+    fcntl(socketFd_, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(transportConfig_.port);
+    if (bind(socketFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind socket: " + std::string(strerror(errno)), "Lockstep");
+        close(socketFd_);
+        socketFd_ = -1;
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    nextTurnTime_ = now;
+    lastProgressTime_ = now;
+    lastRequestTime_ = now;
+    if (!session_.isMember()) {
+        broadcast(session_.makeJoinRequest());
+    }
+
+    LOG_INFO("Lockstep peer " + std::to_string(config_.peerId) + " started on port " +
+             std::to_string(transportConfig_.port), "Lockstep");
+    return true;
+}
+
+void LockstepPeer::stop() {
+    if (socketFd_ != -1) {
+        close(socketFd_);
+        socketFd_ = -1;
+    }
+}
+
+void LockstepPeer::submitCommand(const packets::PlayerMovementRequest& command) {
+    session_.submitCommand(command);
+}
+
+size_t LockstepPeer::update() {
+    if (socketFd_ == -1) {
+        return 0;
+    }
+
+    // Take in everything that arrived, answering requests right away
+    packets::LockstepPacket packet;
+    sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    while (true) {
+        memset(&packet, 0, sizeof(packet));
+        ssize_t bytesReceived = recvfrom(socketFd_, &packet, sizeof(packet), 0, (struct sockaddr*)&from, &fromLen);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "Lockstep");
+            }
+            break;
+        }
+        if (static_cast<size_t>(bytesReceived) < LOCKSTEP_HEADER_SIZE ||
+            payloadSize(packet) > sizeof(packet.commands) ||
+            static_cast<size_t>(bytesReceived) < LOCKSTEP_HEADER_SIZE + payloadSize(packet)) {
+            continue;
+        }
+        for (const auto& reply : session_.receive(packet)) {
+            send(from, reply);
+        }
+    }
+
+    // Run flat out while behind, otherwise keep to the turn rate
+    auto now = std::chrono::steady_clock::now();
+    size_t executed = 0;
+    if (session_.isBehind()) {
+        executed = session_.advance(transportConfig_.maxCatchUpTurns);
+        fastForwardTurns_ += executed;
+    } else if (now >= nextTurnTime_) {
+        executed = session_.advance(1);
+        if (executed == 0) {
+            stalledUpdates_++;
+        }
+    }
+    if (executed > 0) {
+        nextTurnTime_ += turnInterval_;
+        if (nextTurnTime_ <= now) {
+            nextTurnTime_ = now + turnInterval_;
+        }
+        lastProgressTime_ = now;
+    }
+
+    for (const auto& outgoing : session_.takeOutgoing()) {
+        broadcast(outgoing);
+    }
+
+    // Commands got lost or we are a joiner still waiting for the match
+    auto resendInterval = std::chrono::milliseconds(transportConfig_.resendIntervalMs);
+    if (now - lastProgressTime_ >= turnInterval_ + resendInterval && now - lastRequestTime_ >= resendInterval) {
+        broadcast(session_.isMember() ? session_.makeResendRequest() : session_.makeJoinRequest());
+        lastRequestTime_ = now;
+    }
+    return executed;
+}
+
+LockstepStats LockstepPeer::getStats() const {
+    LockstepStats stats = session_.getStats();
+    stats.stalledUpdates = stalledUpdates_;
+    stats.fastForwardTurns = fastForwardTurns_;
+    stats.packetsSent = packetsSent_;
+    stats.bytesSent = bytesSent_;
+    return stats;
+}
+
+void LockstepPeer::send(const sockaddr_in& addr, const packets::LockstepPacket& packet) {
+    size_t size = LOCKSTEP_HEADER_SIZE + payloadSize(packet);
+    ssize_t bytesSent = sendto(socketFd_, &packet, size, 0, (const struct sockaddr*)&addr, sizeof(addr));
+    if (bytesSent < 0) {
+        LOG_ERROR("Failed to send lockstep packet: " + std::string(strerror(errno)), "Lockstep");
+        return;
+    }
+    packetsSent_++;
+    bytesSent_ += static_cast<uint64_t>(bytesSent);
+}
+
+void LockstepPeer::broadcast(const packets::LockstepPacket& packet) {
+    for (const auto& addr : peerAddresses_) {
+        send(addr, packet);
+    }
+}
+
+} // namespace netcode
@@ -0,0 +1,400 @@
+#include "netcode/lockstep/lockstep_session.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace netcode {
+
+namespace {
+
+void appendUint32(std::vector<uint8_t>& buffer, uint32_t value) {
+    uint8_t bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+
+bool readUint32(const std::vector<uint8_t>& buffer, size_t& offset, uint32_t& value) {
+    if (buffer.size() - offset < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, buffer.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+
+} // namespace
+
+LockstepSession::LockstepSession(const LockstepConfig& config, ILockstepSimulation& simulation)
+    : config_(config), simulation_(simulation) {
+    for (uint32_t founder : config_.founders) {
+        members_[founder] = 1;
+    }
+    if (members_.count(config_.peerId)) {
+        firstOwnTurn_ = 1;
+        nextOwnTurn_ = 1;
+        closeDueTurns();
+    }
+}
+
+void LockstepSession::submitCommand(const packets::PlayerMovementRequest& command) {
+    pendingCommands_.push_back(command);
+}
+
+std::vector<packets::LockstepPacket> LockstepSession::receive(const packets::LockstepPacket& packet) {
+    std::vector<packets::LockstepPacket> replies;
+    if (packet.peer_id == config_.peerId) {
+        return replies;
+    }
+
+    uint32_t firstTurn = packet.turn;
+    switch (packet.type) {
+    case packets::LockstepMessageType::TURN: {
+        // Commands of dropped turns were simulated by every member already
+        if (packet.turn > prunedTurn_) {
+            auto& inputs = turns_[packet.turn];
+            if (!inputs.count(packet.peer_id)) {
+                TurnInput& input = inputs[packet.peer_id];
+                uint32_t count = std::min(packet.count, packets::MAX_LOCKSTEP_COMMANDS);
+                input.commands.assign(packet.commands, packet.commands + count);
+                input.joiningPeer = packet.joining_peer;
+            }
+        }
+        newestRemoteTurn_ = std::max(newestRemoteTurn_, packet.turn);
+
+        // A peer closes a turn only after simulating the one inputDelayTurns + 1 before it
+        if (packet.turn > 1 + config_.inputDelayTurns) {
+            uint32_t& confirmed = confirmedTurns_[packet.peer_id];
+            confirmed = std::max(confirmed, packet.turn - 1 - config_.inputDelayTurns);
+        }
+        if (packet.checksum_turn != 0) {
+            compareChecksum(packet.checksum_turn, packet.peer_id, packet.checksum);
+        }
+        break;
+    }
+    case packets::LockstepMessageType::JOIN_REQUEST:
+        if (config_.peerId != config_.hostId) {
+            break;
+        }
+        if (!members_.count(packet.peer_id) &&
+            std::find(pendingJoins_.begin(), pendingJoins_.end(), packet.peer_id) == pendingJoins_.end()) {
+            pendingJoins_.push_back(packet.peer_id);
+            LOG_INFO("Peer " + std::to_string(packet.peer_id) + " asks to join at turn " +
+                     std::to_string(stats_.executedTurn), "Lockstep");
+        }
+
+        // The joiner starts from the latest checkpoint rather than from turn 1
+        if (!checkpoint_.empty() && packet.turn <= checkpointTurn_) {
+            replies = makeCheckpointPackets();
+            firstTurn = checkpointTurn_ + 1;
+        }
+        [[fallthrough]];
+    case packets::LockstepMessageType::RESEND_REQUEST: {
+        // Answer with every peer's commands we hold, starting at the requested turn
+        uint32_t lastTurn = firstTurn + config_.maxResendTurns;
+        for (auto it = turns_.lower_bound(firstTurn); it != turns_.end() && it->first < lastTurn; ++it) {
+            for (const auto& [peerId, input] : it->second) {
+                replies.push_back(makeTurnPacket(peerId, it->first, input));
+            }
+        }
+        break;
+    }
+    case packets::LockstepMessageType::CHECKPOINT:
+        receiveCheckpoint(packet);
+        break;
+    }
+    return replies;
+}
+
+size_t LockstepSession::advance(size_t maxTurns) {
+    size_t executed = 0;
+    std::vector<packets::PlayerMovementRequest> commands;
+    while (executed < maxTurns && isComplete(stats_.executedTurn + 1)) {
+        uint32_t turn = stats_.executedTurn + 1;
+        auto& inputs = turns_[turn];
+
+        // Peers are visited in ID order, so every peer sees the same command order
+        commands.clear();
+        for (const auto& [peerId, input] : inputs) {
+            auto member = members_.find(peerId);
+            if (member != members_.end() && member->second <= turn) {
+                commands.insert(commands.end(), input.commands.begin(), input.commands.end());
+            }
+        }
+        simulation_.step(turn, commands);
+        stats_.executedTurn = turn;
+        executed++;
+
+        // Admissions take effect at the same turn on every peer
+        auto host = inputs.find(config_.hostId);
+        if (host != inputs.end() && host->second.joiningPeer != 0 && !members_.count(host->second.joiningPeer)) {
+            uint32_t joiner = host->second.joiningPeer;
+            uint32_t firstTurn = turn + 1 + config_.inputDelayTurns;
+            members_[joiner] = firstTurn;
+            if (joiner == config_.peerId) {
+                firstOwnTurn_ = firstTurn;
+                nextOwnTurn_ = firstTurn;
+            }
+            LOG_INFO("Peer " + std::to_string(joiner) + " joins the match at turn " + std::to_string(firstTurn), "Lockstep");
+        }
+
+        if (config_.checksumInterval != 0 && turn % config_.checksumInterval == 0) {
+            checksums_[turn] = simulation_.checksum();
+            auto [first, last] = remoteChecksums_.equal_range(turn);
+            std::vector<std::pair<uint32_t, uint64_t>> waiting;
+            for (auto it = first; it != last; ++it) {
+                waiting.push_back(it->second);
+            }
+            remoteChecksums_.erase(first, last);
+            for (const auto& [peerId, checksum] : waiting) {
+                compareChecksum(turn, peerId, checksum);
+            }
+        }
+
+        if (config_.checkpointInterval != 0 && turn % config_.checkpointInterval == 0) {
+            takeCheckpoint();
+        }
+
+        closeDueTurns();
+    }
+    if (executed > 0) {
+        prune();
+    }
+    return executed;
+}
+
+std::vector<packets::LockstepPacket> LockstepSession::takeOutgoing() {
+    std::vector<packets::LockstepPacket> packets;
+    packets.swap(outgoing_);
+    return packets;
+}
+
+packets::LockstepPacket LockstepSession::makeResendRequest() const {
+    packets::LockstepPacket packet{};
+    packet.type = packets::LockstepMessageType::RESEND_REQUEST;
+    packet.peer_id = config_.peerId;
+    packet.turn = stats_.executedTurn + 1;
+    return packet;
+}
+
+packets::LockstepPacket LockstepSession::makeJoinRequest() const {
+    packets::LockstepPacket packet{};
+    packet.type = packets::LockstepMessageType::JOIN_REQUEST;
+    packet.peer_id = config_.peerId;
+    packet.turn = stats_.executedTurn + 1;
+    return packet;
+}
+
+bool LockstepSession::isBehind() const {
+    return newestRemoteTurn_ > stats_.executedTurn + config_.inputDelayTurns + 2;
+}
+
+void LockstepSession::setDesyncCallback(std::function<void(uint32_t, uint32_t)> callback) {
+    desyncCallback_ = callback;
+}
+
+void LockstepSession::closeDueTurns() {
+    if (!isMember()) {
+        return;
+    }
+
+    while (nextOwnTurn_ <= stats_.executedTurn + 1 + config_.inputDelayTurns) {
+        uint32_t turn = nextOwnTurn_++;
+        TurnInput& input = turns_[turn][config_.peerId];
+
+        // Commands beyond the per-turn limit wait for the next turn
+        size_t count = std::min<size_t>(pendingCommands_.size(), packets::MAX_LOCKSTEP_COMMANDS);
+        input.commands.assign(pendingCommands_.begin(), pendingCommands_.begin() + count);
+        pendingCommands_.erase(pendingCommands_.begin(), pendingCommands_.begin() + count);
+        for (auto& command : input.commands) {
+            command.input_sequence_number = turn;
+        }
+
+        if (config_.peerId == config_.hostId && !pendingJoins_.empty()) {
+            input.joiningPeer = pendingJoins_.front();
+            pendingJoins_.erase(pendingJoins_.begin());
+        }
+
+        packets::LockstepPacket packet = makeTurnPacket(config_.peerId, turn, input);
+        auto checksum = checksums_.find(stats_.executedTurn);
+        if (checksum != checksums_.end() && turn == stats_.executedTurn + 1 + config_.inputDelayTurns) {
+            packet.checksum_turn = checksum->first;
+            packet.checksum = checksum->second;
+        }
+        outgoing_.push_back(packet);
+    }
+}
+
+bool LockstepSession::isComplete(uint32_t turn) const {
+    auto inputs = turns_.find(turn);
+    if (inputs == turns_.end()) {
+        return false;
+    }
+    for (const auto& [peerId, firstTurn] : members_) {
+        if (firstTurn <= turn && !inputs->second.count(peerId)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LockstepSession::compareChecksum(uint32_t turn, uint32_t peerId, uint64_t checksum) {
+    auto own = checksums_.find(turn);
+    if (own == checksums_.end()) {
+        if (turn > prunedTurn_) {
+            remoteChecksums_.emplace(turn, std::make_pair(peerId, checksum));
+        }
+        return;
+    }
+
+    stats_.checksumsCompared++;
+    if (own->second == checksum) {
+        return;
+    }
+
+    stats_.desyncs++;
+    if (stats_.firstDesyncTurn == 0 || turn < stats_.firstDesyncTurn) {
+        stats_.firstDesyncTurn = turn;
+    }
+    LOG_ERROR("Desync with peer " + std::to_string(peerId) + " at turn " + std::to_string(turn), "Lockstep");
+    if (desyncCallback_) {
+        desyncCallback_(turn, peerId);
+    }
+}
+
+packets::LockstepPacket LockstepSession::makeTurnPacket(uint32_t peerId, uint32_t turn, const TurnInput& input) const {
+    packets::LockstepPacket packet{};
+    packet.type = packets::LockstepMessageType::TURN;
+    packet.peer_id = peerId;
+    packet.turn = turn;
+    packet.joining_peer = input.joiningPeer;
+    packet.count = static_cast<uint32_t>(input.commands.size());
+    std::copy(input.commands.begin(), input.commands.end(), packet.commands);
+    return packet;
+}
+
+void LockstepSession::takeCheckpoint() {
+    checkpointTurn_ = stats_.executedTurn;
+    if (config_.peerId != config_.hostId) {
+        return;
+    }
+
+    // Members first, a joiner may already have been admitted at the checkpoint
+    checkpoint_.clear();
+    appendUint32(checkpoint_, static_cast<uint32_t>(members_.size()));
+    for (const auto& [peerId, firstTurn] : members_) {
+        appendUint32(checkpoint_, peerId);
+        appendUint32(checkpoint_, firstTurn);
+    }
+    std::vector<uint8_t> state = simulation_.saveState();
+    checkpoint_.insert(checkpoint_.end(), state.begin(), state.end());
+    checkpointChecksum_ = simulation_.checksum();
+}
+
+std::vector<packets::LockstepPacket> LockstepSession::makeCheckpointPackets() const {
+    std::vector<packets::LockstepPacket> packets;
+    for (size_t offset = 0; offset < checkpoint_.size(); offset += packets::MAX_LOCKSTEP_CHECKPOINT_BYTES) {
+        packets::LockstepPacket packet{};
+        packet.type = packets::LockstepMessageType::CHECKPOINT;
+        packet.peer_id = config_.peerId;
+        packet.turn = checkpointTurn_;
+        packet.checksum = checkpointChecksum_;
+        packet.offset = static_cast<uint32_t>(offset);
+        packet.total_size = static_cast<uint32_t>(checkpoint_.size());
+        packet.count = static_cast<uint32_t>(
+            std::min<size_t>(checkpoint_.size() - offset, packets::MAX_LOCKSTEP_CHECKPOINT_BYTES));
+        std::memcpy(packet.data, checkpoint_.data() + offset, packet.count);
+        packets.push_back(packet);
+    }
+    return packets;
+}
+
+void LockstepSession::receiveCheckpoint(const packets::LockstepPacket& packet) {
+    constexpr uint32_t chunkSize = packets::MAX_LOCKSTEP_CHECKPOINT_BYTES;
+    if (isMember() || packet.turn <= stats_.executedTurn || packet.total_size == 0 ||
+        packet.offset % chunkSize != 0 || packet.offset >= packet.total_size ||
+        packet.count != std::min(chunkSize, packet.total_size - packet.offset)) {
+        return;
+    }
+
+    // A newer checkpoint replaces a partly received one
+    if (incoming_.turn != packet.turn || incoming_.data.size() != packet.total_size) {
+        incoming_ = IncomingCheckpoint{};
+        incoming_.turn = packet.turn;
+        incoming_.checksum = packet.checksum;
+        incoming_.data.resize(packet.total_size);
+        incoming_.missing = (packet.total_size + chunkSize - 1) / chunkSize;
+        incoming_.chunks.assign(incoming_.missing, false);
+    }
+
+    size_t chunk = packet.offset / chunkSize;
+    if (incoming_.chunks[chunk]) {
+        return;
+    }
+    std::memcpy(incoming_.data.data() + packet.offset, packet.data, packet.count);
+    incoming_.chunks[chunk] = true;
+    if (--incoming_.missing == 0) {
+        loadCheckpoint();
+        incoming_ = IncomingCheckpoint{};
+    }
+}
+
+bool LockstepSession::loadCheckpoint() {
+    const std::vector<uint8_t>& data = incoming_.data;
+    size_t offset = 0;
+    uint32_t memberCount = 0;
+    std::map<uint32_t, uint32_t> members;
+    bool valid = readUint32(data, offset, memberCount);
+    for (uint32_t i = 0; valid && i < memberCount; ++i) {
+        uint32_t peerId = 0;
+        uint32_t firstTurn = 0;
+        valid = readUint32(data, offset, peerId) && readUint32(data, offset, firstTurn);
+        members[peerId] = firstTurn;
+    }
+    std::vector<uint8_t> state(data.begin() + static_cast<std::ptrdiff_t>(std::min(offset, data.size())), data.end());
+    if (!valid || !simulation_.loadState(state) || simulation_.checksum() != incoming_.checksum) {
+        LOG_ERROR("Discarding invalid checkpoint of turn " + std::to_string(incoming_.turn), "Lockstep");
+        return false;
+    }
+
+    uint32_t turn = incoming_.turn;
+    members_ = members;
+    stats_.executedTurn = turn;
+    checkpointTurn_ = turn;
+    prunedTurn_ = turn;
+    checksums_[turn] = incoming_.checksum;
+    turns_.erase(turns_.begin(), turns_.upper_bound(turn));
+    remoteChecksums_.erase(remoteChecksums_.begin(), remoteChecksums_.upper_bound(turn));
+
+    // Admitted between the checkpoint and its transfer
+    auto self = members_.find(config_.peerId);
+    if (self != members_.end()) {
+        firstOwnTurn_ = std::max(self->second, turn + 1);
+        nextOwnTurn_ = firstOwnTurn_;
+        closeDueTurns();
+    }
+    LOG_INFO("Loaded checkpoint of turn " + std::to_string(turn) + ", " + std::to_string(data.size()) + " bytes",
+             "Lockstep");
+    return true;
+}
+
+void LockstepSession::prune() {
+    uint32_t bound = std::min(checkpointTurn_, stats_.executedTurn);
+    for (const auto& [peerId, firstTurn] : members_) {
+        if (peerId == config_.peerId) {
+            continue;
+        }
+        auto confirmed = confirmedTurns_.find(peerId);
+        bound = std::min(bound, confirmed == confirmedTurns_.end() ? 0 : confirmed->second);
+    }
+    if (bound <= prunedTurn_) {
+        return;
+    }
+
+    turns_.erase(turns_.begin(), turns_.upper_bound(bound));
+    checksums_.erase(checksums_.begin(), checksums_.upper_bound(bound));
+    remoteChecksums_.erase(remoteChecksums_.begin(), remoteChecksums_.upper_bound(bound));
+    prunedTurn_ = bound;
+}
+
+} // namespace netcode
@@ -0,0 +1,75 @@
+#include "netcode/physics/prop.hpp"
+#include <algorithm>
+
+namespace netcode {
+
+Prop::Prop(uint32_t id, const netcode::math::MyVec3& position, const PropConfig& config)
+    : id_(id), config_(config), position_(position), renderPosition_(position) {
+}
+
+void Prop::update() {
+    if (sleeping_) {
+        return;
+    }
+
+    velocity_.y -= config_.gravity;
+    position_ += velocity_;
+
+    // Bounce off the ground, losing speed with every bounce
+    float restHeight = config_.groundLevel + config_.radius;
+    onGround_ = position_.y <= restHeight;
+    if (onGround_) {
+        position_.y = restHeight;
+        velocity_.y = velocity_.y < -config_.gravity * 2.0f ? -velocity_.y * config_.restitution : 0.0f;
+
+        float keep = std::max(0.0f, 1.0f - config_.friction);
+        velocity_.x *= keep;
+        velocity_.z *= keep;
+    }
+
+    // Fall asleep after resting on the ground for a while
+    if (onGround_ && netcode::math::Magnitude(velocity_) < config_.sleepSpeed) {
+        if (++restingSteps_ >= config_.sleepSteps) {
+            sleeping_ = true;
+            velocity_ = {};
+        }
+    } else {
+        restingSteps_ = 0;
+    }
+}
+
+void Prop::jump() {
+    applyImpulse({0.0f, 0.5f, 0.0f});
+}
+
+void Prop::updateRenderPosition(float deltaTime) {
+    errorOffset_.decay(deltaTime);
+    renderPosition_ = position_ + errorOffset_.get();
+}
+
+void Prop::snapSimulationState(const netcode::math::MyVec3& position, bool isJumping, const netcode::math::MyVec3& velocity) {
+    position_ = position;
+    onGround_ = !isJumping;
+    velocity_ = velocity;
+}
+
+void Prop::initiateVisualBlend() {
+    errorOffset_.capture(renderPosition_, position_);
+}
+
+void Prop::setPosition(const netcode::math::MyVec3& pos) {
+    position_ = pos;
+    wake();
+}
+
+void Prop::applyImpulse(const netcode::math::MyVec3& impulse) {
+    velocity_ += impulse;
+    wake();
+}
+
+void Prop::wake() {
+    sleeping_ = false;
+    restingSteps_ = 0;
+}
+
+} // namespace netcode
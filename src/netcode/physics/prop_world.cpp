@@ -0,0 +1,192 @@
+#include "netcode/physics/prop_world.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace netcode {
+
+namespace {
+
+// Key of a cell of the broad-phase grid
+int64_t cellKey(int64_t x, int64_t z) {
+    return (x << 32) ^ (z & 0xffffffff);
+}
+
+} // namespace
+
+PropWorld::PropWorld(const PropWorldConfig& config) : config_(config) {
+}
+
+void PropWorld::addProp(std::shared_ptr<Prop> prop) {
+    uint32_t propId = prop->getId();
+    props_[propId].prop = std::move(prop);
+    LOG_DEBUG("Added prop " + std::to_string(propId), "PropWorld");
+}
+
+std::shared_ptr<Prop> PropWorld::getProp(uint32_t propId) const {
+    auto it = props_.find(propId);
+    return it != props_.end() ? it->second.prop : nullptr;
+}
+
+uint32_t PropWorld::update(float deltaTime, const std::vector<netcode::math::MyVec3>& playerPositions) {
+    float stepTime = 1.0f / std::max(config_.stepRate, 1.0f);
+    accumulator_ = std::min(accumulator_ + deltaTime, stepTime * config_.maxStepsPerUpdate);
+
+    uint32_t steps = 0;
+    while (accumulator_ >= stepTime) {
+        step(playerPositions);
+        accumulator_ -= stepTime;
+        steps++;
+    }
+    return steps;
+}
+
+void PropWorld::step(const std::vector<netcode::math::MyVec3>& playerPositions) {
+    stepsSimulated_++;
+
+    for (auto& [propId, entry] : props_) {
+        Prop& prop = *entry.prop;
+
+        // Players push props out of their way, waking them up
+        for (const auto& playerPosition : playerPositions) {
+            netcode::math::MyVec3 offset = prop.getPosition() - playerPosition;
+            offset.y = 0.0f;
+            float minDistance = prop.getConfig().radius + config_.playerRadius;
+            float distance = netcode::math::Magnitude(offset);
+            if (distance < minDistance && std::abs(prop.getPosition().y - playerPosition.y) < minDistance) {
+                netcode::math::MyVec3 normal = distance > 0.0001f ? offset / distance : netcode::math::MyVec3(1.0f, 0.0f, 0.0f);
+                prop.setPosition(playerPosition + normal * minDistance + netcode::math::MyVec3(0.0f, prop.getPosition().y - playerPosition.y, 0.0f));
+                prop.applyImpulse(normal * config_.pushImpulse);
+            }
+        }
+
+        if (!prop.isSleeping()) {
+            prop.update();
+            entry.dirty = true;
+        }
+    }
+
+    // Broad phase: bucket props into a grid as large as the biggest prop
+    float cellSize = 0.0f;
+    for (const auto& [propId, entry] : props_) {
+        cellSize = std::max(cellSize, entry.prop->getConfig().radius * 2.0f);
+    }
+    if (cellSize <= 0.0f) {
+        return;
+    }
+
+    std::unordered_map<int64_t, std::vector<Prop*>> grid;
+    for (auto& [propId, entry] : props_) {
+        auto position = entry.prop->getPosition();
+        grid[cellKey(static_cast<int64_t>(std::floor(position.x / cellSize)),
+                     static_cast<int64_t>(std::floor(position.z / cellSize)))].push_back(entry.prop.get());
+    }
+
+    // Narrow phase against the props in the same and the neighbouring cells, each pair once
+    for (auto& [propId, entry] : props_) {
+        Prop& prop = *entry.prop;
+        if (prop.isSleeping()) {
+            continue;
+        }
+        auto position = prop.getPosition();
+        int64_t cellX = static_cast<int64_t>(std::floor(position.x / cellSize));
+        int64_t cellZ = static_cast<int64_t>(std::floor(position.z / cellSize));
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            for (int64_t dz = -1; dz <= 1; ++dz) {
+                auto cell = grid.find(cellKey(cellX + dx, cellZ + dz));
+                if (cell == grid.end()) {
+                    continue;
+                }
+                for (Prop* other : cell->second) {
+                    if (other == &prop || (!other->isSleeping() && other->getId() < prop.getId())) {
+                        continue;
+                    }
+                    resolveCollision(prop, *other);
+                }
+            }
+        }
+    }
+}
+
+void PropWorld::resolveCollision(Prop& a, Prop& b) {
+    netcode::math::MyVec3 offset = b.getPosition() - a.getPosition();
+    float minDistance = a.getConfig().radius + b.getConfig().radius;
+    float distance = netcode::math::Magnitude(offset);
+    if (distance >= minDistance) {
+        return;
+    }
+
+    netcode::math::MyVec3 normal = distance > 0.0001f ? offset / distance : netcode::math::MyVec3(1.0f, 0.0f, 0.0f);
+    float inverseMassA = 1.0f / std::max(a.getConfig().mass, 0.001f);
+    float inverseMassB = 1.0f / std::max(b.getConfig().mass, 0.001f);
+    float inverseMassSum = inverseMassA + inverseMassB;
+
+    float penetration = minDistance - distance;
+    float approachSpeed = netcode::math::Dot(a.getVelocity() - b.getVelocity(), normal);
+
+    // A gentle touch does not wake a sleeping prop, the awake one just moves out of its way
+    if (b.isSleeping() && approachSpeed <= b.getConfig().sleepSpeed) {
+        a.setPosition(a.getPosition() - normal * penetration);
+        props_[a.getId()].dirty = true;
+        return;
+    }
+
+    // Push the props apart in proportion to their inverse masses
+    a.setPosition(a.getPosition() - normal * (penetration * inverseMassA / inverseMassSum));
+    b.setPosition(b.getPosition() + normal * (penetration * inverseMassB / inverseMassSum));
+
+    // Exchange momentum along the normal if they are moving towards each other
+    if (approachSpeed > 0.0f) {
+        float restitution = std::min(a.getConfig().restitution, b.getConfig().restitution);
+        float impulse = (1.0f + restitution) * approachSpeed / inverseMassSum;
+        a.applyImpulse(normal * (-impulse * inverseMassA));
+        b.applyImpulse(normal * (impulse * inverseMassB));
+    }
+
+    props_[a.getId()].dirty = true;
+    props_[b.getId()].dirty = true;
+}
+
+std::vector<std::shared_ptr<Prop>> PropWorld::selectForReplication() {
+    std::vector<PropEntry*> candidates;
+    for (auto& [propId, entry] : props_) {
+        if (entry.dirty) {
+            // Waiting props gain priority every tick, fast ones faster
+            entry.priority += 1.0f + netcode::math::Magnitude(entry.prop->getVelocity()) * 10.0f;
+            candidates.push_back(&entry);
+        }
+    }
+
+    size_t budget = std::min<size_t>(candidates.size(), config_.maxUpdatesPerTick);
+    std::partial_sort(candidates.begin(), candidates.begin() + budget, candidates.end(),
+                      [](const PropEntry* a, const PropEntry* b) { return a->priority > b->priority; });
+
+    std::vector<std::shared_ptr<Prop>> selected;
+    selected.reserve(budget);
+    for (size_t i = 0; i < budget; ++i) {
+        candidates[i]->dirty = false;
+        candidates[i]->priority = 0.0f;
+        selected.push_back(candidates[i]->prop);
+    }
+    return selected;
+}
+
+void PropWorld::updateRenderPositions(float deltaTime) {
+    for (auto& [propId, entry] : props_) {
+        entry.prop->updateRenderPosition(deltaTime);
+    }
+}
+
+PropWorldStats PropWorld::getStats() const {
+    PropWorldStats stats;
+    stats.propCount = props_.size();
+    stats.stepsSimulated = stepsSimulated_;
+    for (const auto& [propId, entry] : props_) {
+        stats.awakeCount += entry.prop->isSleeping() ? 0 : 1;
+        stats.pendingUpdates += entry.dirty ? 1 : 0;
+    }
+    return stats;
+}
+
+} // namespace netcode
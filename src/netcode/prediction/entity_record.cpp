@@ -0,0 +1,61 @@
+#include "netcode/prediction/entity_record.hpp"
+
+namespace netcode {
+
+EntityHandle EntityRecordTable::acquire(uint32_t entityId) {
+    auto it = handles_.find(entityId);
+    if (it != handles_.end()) {
+        return it->second;
+    }
+
+    // Reuse a released slot before growing the table
+    uint32_t index;
+    if (!freeSlots_.empty()) {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(records_.size());
+        records_.emplace_back();
+    }
+    records_[index].entityId = entityId;
+
+    EntityHandle handle{index, records_[index].generation};
+    handles_.emplace(entityId, handle);
+    return handle;
+}
+
+EntityHandle EntityRecordTable::find(uint32_t entityId) const {
+    auto it = handles_.find(entityId);
+    return it != handles_.end() ? it->second : INVALID_ENTITY_HANDLE;
+}
+
+bool EntityRecordTable::release(uint32_t entityId) {
+    auto it = handles_.find(entityId);
+    if (it == handles_.end()) {
+        return false;
+    }
+
+    uint32_t index = it->second.index;
+    uint32_t generation = records_[index].generation + 1;
+    records_[index] = EntityRecord();
+    records_[index].generation = generation;
+    freeSlots_.push_back(index);
+    handles_.erase(it);
+    return true;
+}
+
+EntityRecord* EntityRecordTable::get(EntityHandle handle) {
+    if (handle.index >= records_.size() || records_[handle.index].generation != handle.generation) {
+        return nullptr;
+    }
+    return &records_[handle.index];
+}
+
+const EntityRecord* EntityRecordTable::get(EntityHandle handle) const {
+    if (handle.index >= records_.size() || records_[handle.index].generation != handle.generation) {
+        return nullptr;
+    }
+    return &records_[handle.index];
+}
+
+} // namespace netcode
@@ -0,0 +1,52 @@
+#include "netcode/prediction/error_correction.hpp"
+#include "netcode/utils/logger.hpp"
+#include <cmath>
+
+namespace netcode {
+
+VisualErrorOffset::VisualErrorOffset(const ErrorCorrectionConfig& config)
+    : config_(config) {
+}
+
+void VisualErrorOffset::capture(const netcode::math::MyVec3& renderPosition,
+                                const netcode::math::MyVec3& simulationPosition) {
+    offset_ = renderPosition - simulationPosition;
+
+    float error = Magnitude(offset_);
+    if (error > config_.snapDistance) {
+        // Too far off to hide, show the corrected state right away
+        LOG_DEBUG("Snapping visual error of " + std::to_string(error), "VisualErrorOffset");
+        reset();
+        return;
+    }
+
+    active_ = error > config_.convergenceDistance;
+    if (!active_) {
+        offset_ = {0.0f, 0.0f, 0.0f};
+    }
+}
+
+void VisualErrorOffset::decay(float deltaTime) {
+    if (!active_) {
+        return;
+    }
+
+    if (config_.halfLife <= 0.0f) {
+        reset();
+        return;
+    }
+
+    // Exponential decay: the offset halves every halfLife seconds, independent of frame rate
+    offset_ *= std::exp2(-deltaTime / config_.halfLife);
+
+    if (Magnitude(offset_) <= config_.convergenceDistance) {
+        reset();
+    }
+}
+
+void VisualErrorOffset::reset() {
+    offset_ = {0.0f, 0.0f, 0.0f};
+    active_ = false;
+}
+
+} // namespace netcode
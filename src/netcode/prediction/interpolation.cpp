@@ -15,25 +15,30 @@ void InterpolationSystem::updateEntity(std::shared_ptr<NetworkedEntity> entity,
         LOG_ERROR("Null entity passed to interpolation system", "InterpolationSystem");
         return;
     }
-    
-    uint32_t entityId = entity->getId();
+    updateEntity(*entity, deltaTime);
+}
+
+void InterpolationSystem::updateEntity(NetworkedEntity& entity, float deltaTime) {
+    uint32_t entityId = entity.getId();
+    EntityRecord& record = snapshotManager_.getRecords().record(entityId);
     
     // Initialize render time for this entity if it doesn't exist
-    if (renderTimes_.find(entityId) == renderTimes_.end()) {
-        renderTimes_[entityId] = std::chrono::steady_clock::now() - 
+    if (!record.renderTimeStarted) {
+        record.renderTime = std::chrono::steady_clock::now() - 
             std::chrono::milliseconds(config_.interpolationDelay);
+        record.renderTimeStarted = true;
     }
     
     // Advance render time
-    renderTimes_[entityId] += std::chrono::microseconds(static_cast<int64_t>(deltaTime * 1000000));
+    record.renderTime += std::chrono::microseconds(static_cast<int64_t>(deltaTime * 1000000));
+    auto renderTime = record.renderTime;
     
     // Find appropriate snapshots for interpolation
     EntitySnapshot startSnapshot;
     EntitySnapshot endSnapshot;
     float t = 0.0f;
     
-    bool haveSnapshots = findInterpolationSnapshots(entityId, renderTimes_[entityId], 
-                                                   startSnapshot, endSnapshot, t);
+    bool haveSnapshots = findInterpolationSnapshots(record, renderTime, startSnapshot, endSnapshot, t);
     
     if (!haveSnapshots) {
         // No suitable snapshots found, can't interpolate
@@ -41,25 +46,37 @@ void InterpolationSystem::updateEntity(std::shared_ptr<NetworkedEntity> entity,
         return;
     }
     
-    // Calculate interpolated position
-    netcode::math::MyVec3 currentPos = entity->getPosition();
+    stats_.updates++;
+    if (renderTime > endSnapshot.timestamp) {
+        stats_.starvedUpdates++;
+    }
+    
+    // Calculate interpolated kinematic state
+    netcode::math::MyVec3 currentPos = entity.getPosition();
     netcode::math::MyVec3 targetPos = Lerp(startSnapshot.position, endSnapshot.position, t);
+    netcode::math::MyVec3 targetVelocity = Lerp(startSnapshot.velocity, endSnapshot.velocity, t);
+    
+    // Past the newest snapshot, dead-reckon with the replicated velocity for a limited time
+    if (config_.maxExtrapolationMs > 0 && renderTime > endSnapshot.timestamp) {
+        auto overshoot = std::min(
+            std::chrono::duration_cast<std::chrono::microseconds>(renderTime - endSnapshot.timestamp),
+            std::chrono::microseconds(config_.maxExtrapolationMs * 1000));
+        float steps = static_cast<float>(overshoot.count()) / 1000000.0f * config_.simulationRate;
+        targetPos += endSnapshot.velocity * steps;
+    }
+    
+    // Set simulation state to the interpolated target. The entity is not stepped
+    // here: the interpolated state already is the server's state.
+    entity.snapSimulationState(targetPos, endSnapshot.isJumping, targetVelocity);
     
-    // Check if we need to snap instead of interpolate
+    // Check if we need to snap instead of smoothing the change visually
     float distance = Magnitude(targetPos - currentPos);
     if (distance > config_.maxInterpolationDistance) {
         LOG_INFO("Snapping entity " + std::to_string(entityId) + 
                 " due to large distance: " + std::to_string(distance), "InterpolationSystem");
-        // Immediately snap simulation state
-        entity->snapSimulationState(targetPos, endSnapshot.isJumping);
-        entity->initiateVisualBlend();
     } else {
-        // Set simulation position to interpolated target
-        entity->snapSimulationState(targetPos, endSnapshot.isJumping);
-        entity->initiateVisualBlend();
+        entity.initiateVisualBlend();
     }
-    
-    entity->update();
 }
 
 void InterpolationSystem::recordEntityPosition(
@@ -67,12 +84,22 @@ void InterpolationSystem::recordEntityPosition(
     const netcode::math::MyVec3& position,
     std::chrono::steady_clock::time_point timestamp) {
     
+    recordEntityState(entityId, position, {0, 0, 0}, false, timestamp);
+}
+
+void InterpolationSystem::recordEntityState(
+    uint32_t entityId,
+    const netcode::math::MyVec3& position,
+    const netcode::math::MyVec3& velocity,
+    bool isJumping,
+    std::chrono::steady_clock::time_point timestamp) {
+    
     // Create and store a snapshot with an incremented sequence number
     EntitySnapshot snapshot;
     snapshot.entityId = entityId;
     snapshot.position = position;
-    snapshot.velocity = {0, 0, 0}; // Velocity not tracked
-    snapshot.isJumping = false; // We don't know this from the position update
+    snapshot.velocity = velocity;
+    snapshot.isJumping = isJumping;
     snapshot.timestamp = timestamp;
     
     // Use the latest snapshot's sequence + 1, or 0 if none exists
@@ -86,25 +113,29 @@ void InterpolationSystem::recordEntityPosition(
 }
 
 bool InterpolationSystem::findInterpolationSnapshots(
-    uint32_t entityId,
+    const EntityRecord& record,
     std::chrono::steady_clock::time_point renderTime,
     EntitySnapshot& out_start,
     EntitySnapshot& out_end,
     float& out_t) {
     
-    // Get all snapshots for this entity
-    auto latestSnapshot = snapshotManager_.getLatestEntitySnapshot(entityId);
-    auto allSnapshots = snapshotManager_.getEntitySnapshotsAfter(entityId, 0); // Get all snapshots
-    
-    if (allSnapshots.empty()) {
+    if (record.snapshots.empty()) {
         return false;
     }
     
-    // Sort snapshots by timestamp
-    std::sort(allSnapshots.begin(), allSnapshots.end(), 
-             [](const EntitySnapshot& a, const EntitySnapshot& b) {
-                 return a.timestamp < b.timestamp;
-             });
+    // Snapshots are kept in sequence order, which normally is timestamp order too;
+    // only sort a copy when a late server state broke that
+    auto byTimestamp = [](const EntitySnapshot& a, const EntitySnapshot& b) {
+        return a.timestamp < b.timestamp;
+    };
+    std::vector<EntitySnapshot> sorted;
+    const std::vector<EntitySnapshot>* snapshots = &record.snapshots;
+    if (!std::is_sorted(snapshots->begin(), snapshots->end(), byTimestamp)) {
+        sorted = record.snapshots;
+        std::sort(sorted.begin(), sorted.end(), byTimestamp);
+        snapshots = &sorted;
+    }
+    const std::vector<EntitySnapshot>& allSnapshots = *snapshots;
     
     // Find the first snapshot with timestamp >= renderTime
     auto it = std::find_if(allSnapshots.begin(), allSnapshots.end(),
@@ -158,8 +189,10 @@ const InterpolationConfig& InterpolationSystem::getConfig() const {
 }
 
 void InterpolationSystem::reset() {
-    renderTimes_.clear();
-    interpolationTargets_.clear();
+    for (EntityRecord& record : snapshotManager_.getRecords()) {
+        record.renderTimeStarted = false;
+    }
+    stats_ = InterpolationStats();
     LOG_INFO("Interpolation system reset", "InterpolationSystem");
 }
 
@@ -17,23 +17,27 @@ uint32_t PredictionSystem::applyInputPrediction(
         LOG_ERROR("Null entity passed to prediction system", "PredictionSystem");
         return currentSequence_;
     }
-    
-    // Store reference to the entity
-    entities_[entity->getId()] = entity;
+    return applyInputPrediction(*entity, input, isJumping);
+}
+
+uint32_t PredictionSystem::applyInputPrediction(
+    NetworkedEntity& entity,
+    const netcode::math::MyVec3& input,
+    bool isJumping) {
     
     // Apply movement locally
-    entity->move(input);
+    entity.move(input);
     if (isJumping) {
-        entity->jump();
+        entity.jump();
     }
-    entity->update();
+    entity.update();
     
     // Increment sequence number
     uint32_t sequence = getNextSequenceNumber();
     
     // Store input snapshot
     InputSnapshot inputSnapshot;
-    inputSnapshot.playerId = entity->getId();
+    inputSnapshot.playerId = entity.getId();
     inputSnapshot.movement = input;
     inputSnapshot.isJumping = isJumping;
     inputSnapshot.timestamp = std::chrono::steady_clock::now();
@@ -42,15 +46,15 @@ uint32_t PredictionSystem::applyInputPrediction(
     
     // Store entity snapshot
     EntitySnapshot snapshot;
-    snapshot.entityId = entity->getId();
-    snapshot.position = entity->getPosition();
-    snapshot.velocity = {0, 0, 0}; // Velocity not tracked in base interface
-    snapshot.isJumping = isJumping;
+    snapshot.entityId = entity.getId();
+    snapshot.position = entity.getPosition();
+    snapshot.velocity = entity.getVelocity();
+    snapshot.isJumping = entity.isJumping();
     snapshot.timestamp = std::chrono::steady_clock::now();
     snapshot.sequenceNumber = sequence;
     snapshotManager_.storeEntitySnapshot(snapshot);
     
-    LOG_DEBUG("Applied prediction for entity " + std::to_string(entity->getId()) + 
+    LOG_DEBUG("Applied prediction for entity " + std::to_string(entity.getId()) + 
               " with sequence " + std::to_string(sequence), "PredictionSystem");
     
     return sequence;
@@ -66,7 +70,6 @@ uint32_t PredictionSystem::getCurrentSequenceNumber() const {
 
 void PredictionSystem::reset() {
     currentSequence_ = 0;
-    entities_.clear();
     LOG_INFO("Prediction system reset", "PredictionSystem");
 }
 
@@ -1,10 +1,11 @@
 #include "netcode/prediction/reconciliation.hpp"
 #include "netcode/utils/logger.hpp"
+#include <algorithm>
 
 namespace netcode {
 
 ReconciliationSystem::ReconciliationSystem(PredictionSystem& predictionSystem)
-    : predictionSystem_(predictionSystem), reconciliationThreshold_(0.5f), smoothingFactor_(10.0f) {
+    : predictionSystem_(predictionSystem), reconciliationThreshold_(0.5f) {
     LOG_INFO("Reconciliation system initialized", "ReconciliationSystem");
 }
 
@@ -13,30 +14,37 @@ bool ReconciliationSystem::reconcileState(
     const netcode::math::MyVec3& serverPosition,
     uint32_t serverSequence,
     std::chrono::steady_clock::time_point serverTimestamp,
-    bool serverIsJumping) {
+    bool serverIsJumping,
+    const netcode::math::MyVec3& serverVelocity) {
     
     if (!entity) {
         LOG_ERROR("Null entity passed to reconciliation system", "ReconciliationSystem");
         return false;
     }
+    return reconcileState(*entity, serverPosition, serverSequence, serverTimestamp, serverIsJumping, serverVelocity);
+}
+
+bool ReconciliationSystem::reconcileState(
+    const NetworkedEntity& entity,
+    const netcode::math::MyVec3& serverPosition,
+    uint32_t serverSequence,
+    std::chrono::steady_clock::time_point serverTimestamp,
+    bool serverIsJumping,
+    const netcode::math::MyVec3& serverVelocity) {
     
-    uint32_t entityId = entity->getId();
+    uint32_t entityId = entity.getId();
     
-    // Check if enough time has passed since last reconciliation for this entity
-    auto now = std::chrono::steady_clock::now();
-    auto it = lastReconciliationTimes_.find(entityId);
-    
-    if (it != lastReconciliationTimes_.end()) {
-        auto timeSinceLastReconciliation = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second).count();
-        if (timeSinceLastReconciliation < MIN_RECONCILIATION_INTERVAL_MS) {
-            // Too soon since last reconciliation, skip this one
-            LOG_DEBUG("Skipping reconciliation for entity " + std::to_string(entityId) + 
-                     " (cooldown: " + std::to_string(timeSinceLastReconciliation) + "ms)", "ReconciliationSystem");
-            return false;
-        }
+    // Ignore updates older than a correction that is already pending
+    SnapshotManager& snapshots = predictionSystem_.getSnapshotManager();
+    const EntityRecord* pending = snapshots.getRecords().findRecord(entityId);
+    if (pending && pending->correction.active && serverSequence < pending->correction.serverSequence) {
+        LOG_DEBUG("Ignoring stale server update " + std::to_string(serverSequence) + 
+                 " for entity " + std::to_string(entityId), "ReconciliationSystem");
+        return false;
     }
     
-    netcode::math::MyVec3 clientPosition = entity->getPosition();
+    stats_.serverUpdates++;
+    netcode::math::MyVec3 clientPosition = entity.getPosition();
     
     // Calculate distance between client and server positions
     float positionDifference = Magnitude(serverPosition - clientPosition);
@@ -48,9 +56,6 @@ bool ReconciliationSystem::reconcileState(
         return false;
     }
     
-    // Update last reconciliation time
-    lastReconciliationTimes_[entityId] = now;
-    
     // Log reconciliation event
     LOG_INFO("Reconciling entity " + std::to_string(entityId) + 
              " (diff: " + std::to_string(positionDifference) + ")", "ReconciliationSystem");
@@ -58,24 +63,24 @@ bool ReconciliationSystem::reconcileState(
     // Store positions for callback and for reconciliation state
     netcode::math::MyVec3 oldPosition = clientPosition;
     
-    // Instead of setting up a blend that we manage, create a reconciliation state
-    // that will be processed on the next update
-    ReconciliationState& state = reconciliationStates_[entityId];
-    state.startPosition = clientPosition; // Still needed for callback
-    state.targetPosition = serverPosition;
-    state.reconciling = true;
-    state.serverSequence = serverSequence;
-    state.serverIsJumping = serverIsJumping;
+    // Create a correction that will be processed on the next update.
+    // A newer server update simply replaces a pending one.
+    PendingCorrection& correction = snapshots.getRecords().record(entityId).correction;
+    correction.position = serverPosition;
+    correction.velocity = serverVelocity;
+    correction.serverSequence = serverSequence;
+    correction.isJumping = serverIsJumping;
+    correction.active = true;
     
     // Store this server snapshot
     EntitySnapshot serverSnapshot;
     serverSnapshot.entityId = entityId;
     serverSnapshot.position = serverPosition;
-    serverSnapshot.velocity = {0, 0, 0}; // Velocity not tracked in base interface
+    serverSnapshot.velocity = serverVelocity;
     serverSnapshot.isJumping = serverIsJumping; // Use server's jumping state
     serverSnapshot.timestamp = serverTimestamp;
     serverSnapshot.sequenceNumber = serverSequence;
-    predictionSystem_.getSnapshotManager().storeEntitySnapshot(serverSnapshot);
+    snapshots.storeEntitySnapshot(serverSnapshot);
     
     // We'll handle the actual state update in the update() method
     
@@ -88,44 +93,56 @@ bool ReconciliationSystem::reconcileState(
 }
 
 void ReconciliationSystem::update(float deltaTime) {
-    for (auto it = reconciliationStates_.begin(); it != reconciliationStates_.end(); ) {
-        uint32_t entityId = it->first;
-        ReconciliationState& state = it->second;
+    auto now = std::chrono::steady_clock::now();
+    bool budgeted = replayBudget_.count() > 0;
+    auto deadline = budgeted ? now + replayBudget_ : std::chrono::steady_clock::time_point::max();
+    
+    // Replaying only adds snapshots for known entities, so the records stay in place
+    for (EntityRecord& record : predictionSystem_.getSnapshotManager().getRecords()) {
+        if (!record.correction.active) {
+            continue;
+        }
         
-        if (!state.reconciling) {
-            ++it;
+        // The budget is spent, the correction keeps until the next update
+        if (budgeted && std::chrono::steady_clock::now() >= deadline) {
+            stats_.deferredCorrections++;
             continue;
         }
         
-        auto entityPtr = predictionSystem_.getSnapshotManager().getEntity(entityId);
+        PendingCorrection correction = record.correction;
+        record.correction.active = false;
+        NetworkedEntity* entityPtr = record.entity.get();
         if (!entityPtr) {
-            it = reconciliationStates_.erase(it);
             continue;
         }
         
         // We're not doing visual blending here anymore - entity handles that
         // Just apply the correct simulation state and trigger the entity's visual blend
         
-        // Snap the entity's simulation state to server position and jumping state
-        entityPtr->snapSimulationState(state.targetPosition, state.serverIsJumping);
+        // Snap the entity's full kinematic state to the server's, so a jump
+        // continues from the server's point in the arc
+        netcode::math::MyVec3 predictedPosition = entityPtr->getPosition();
+        entityPtr->snapSimulationState(correction.position, correction.isJumping, correction.velocity);
         
         // Reapply inputs to get the final simulation state
-        reapplyInputs(entityPtr, state.serverSequence, state.targetPosition);
+        reapplyInputs(*entityPtr, correction.serverSequence, deadline);
         
-        // Tell the entity to start visual blending
-        entityPtr->initiateVisualBlend();
+        float error = Magnitude(entityPtr->getPosition() - predictedPosition);
+        stats_.corrections++;
+        stats_.totalError += error;
+        stats_.maxError = std::max(stats_.maxError, error);
         
-        // We're done with this reconciliation
-        it = reconciliationStates_.erase(it);
+        // Let the entity hide the correction behind a decaying visual offset
+        entityPtr->initiateVisualBlend();
     }
 }
 
 void ReconciliationSystem::reapplyInputs(
-    std::shared_ptr<NetworkedEntity> entity,
+    NetworkedEntity& entity,
     uint32_t serverSequence,
-    const netcode::math::MyVec3& targetPosition) {
+    std::chrono::steady_clock::time_point deadline) {
     
-    uint32_t entityId = entity->getId();
+    uint32_t entityId = entity.getId();
     
     // Get all inputs that came after the server's acknowledged sequence
     auto pendingInputs = predictionSystem_.getSnapshotManager()
@@ -139,29 +156,93 @@ void ReconciliationSystem::reapplyInputs(
     LOG_DEBUG("Reapplying " + std::to_string(pendingInputs.size()) + 
              " inputs for entity " + std::to_string(entityId), "ReconciliationSystem");
     
-    // Set entity to the server position first
-    entity->setPosition(targetPosition);
+    // Inputs beyond the horizon are merged into one step ahead of the ones replayed one by one
+    size_t next = 0;
+    if (predictionHorizon_ > 0 && pendingInputs.size() > predictionHorizon_) {
+        next = pendingInputs.size() - predictionHorizon_ + 1;
+        replayMerged(entity, pendingInputs, 0, next);
+        stats_.horizonCaps++;
+    }
     
     // Reapply each input in sequence
-    for (const auto& input : pendingInputs) {
-        entity->move(input.movement);
-        if (input.isJumping && input.sequenceNumber > serverSequence) {
-            entity->jump();
+    for (; next < pendingInputs.size(); ++next) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            // Out of budget, catch up on the rest in one step
+            replayMerged(entity, pendingInputs, next, pendingInputs.size());
+            stats_.budgetOverruns++;
+            break;
+        }
+        const auto& input = pendingInputs[next];
+        replayStep(entity, input.movement, input.isJumping, input.sequenceNumber);
+        stats_.inputsReplayed++;
+    }
+}
+
+void ReconciliationSystem::replayMerged(
+    NetworkedEntity& entity,
+    const std::vector<InputSnapshot>& inputs,
+    size_t first,
+    size_t last) {
+    
+    size_t next = first;
+    while (next < last) {
+        // Jumps and steps in the air depend on the step count, they are replayed one by one
+        if (entity.isJumping() || inputs[next].isJumping) {
+            replayStep(entity, inputs[next].movement, inputs[next].isJumping, inputs[next].sequenceNumber);
+            stats_.inputsReplayed++;
+            ++next;
+            continue;
+        }
+        
+        size_t runEnd = next;
+        while (runEnd < last && !inputs[runEnd].isJumping) {
+            ++runEnd;
+        }
+        if (runEnd - next == 1) {
+            replayStep(entity, inputs[next].movement, false, inputs[next].sequenceNumber);
+            stats_.inputsReplayed++;
+            ++next;
+            continue;
         }
-        entity->update();
         
-        // Update snapshot with new predicted position
-        EntitySnapshot newSnapshot;
-        newSnapshot.entityId = entityId;
-        newSnapshot.position = entity->getPosition();
-        newSnapshot.velocity = {0, 0, 0}; // Velocity not tracked in base interface
-        newSnapshot.isJumping = input.isJumping;
-        newSnapshot.timestamp = std::chrono::steady_clock::now();
-        newSnapshot.sequenceNumber = input.sequenceNumber;
-        predictionSystem_.getSnapshotManager().storeEntitySnapshot(newSnapshot);
+        // On the ground the moves add up: one step covers all but the last input, and
+        // the last input is replayed on its own so the entity ends with its velocity
+        netcode::math::MyVec3 movement;
+        for (size_t i = next; i + 1 < runEnd; ++i) {
+            movement += inputs[i].movement;
+        }
+        entity.move(movement);
+        entity.update();
+        const auto& lastInput = inputs[runEnd - 1];
+        replayStep(entity, lastInput.movement, false, lastInput.sequenceNumber);
+        stats_.inputsMerged += runEnd - next;
+        next = runEnd;
     }
 }
 
+void ReconciliationSystem::replayStep(
+    NetworkedEntity& entity,
+    const netcode::math::MyVec3& movement,
+    bool jump,
+    uint32_t sequenceNumber) {
+    
+    entity.move(movement);
+    if (jump) {
+        entity.jump();
+    }
+    entity.update();
+    
+    // Update snapshot with new predicted position
+    EntitySnapshot newSnapshot;
+    newSnapshot.entityId = entity.getId();
+    newSnapshot.position = entity.getPosition();
+    newSnapshot.velocity = entity.getVelocity();
+    newSnapshot.isJumping = entity.isJumping();
+    newSnapshot.timestamp = std::chrono::steady_clock::now();
+    newSnapshot.sequenceNumber = sequenceNumber;
+    predictionSystem_.getSnapshotManager().storeEntitySnapshot(newSnapshot);
+}
+
 void ReconciliationSystem::setReconciliationThreshold(float threshold) {
     reconciliationThreshold_ = threshold;
     LOG_INFO("Set reconciliation threshold to " + std::to_string(threshold), "ReconciliationSystem");
@@ -176,14 +257,21 @@ void ReconciliationSystem::setReconciliationCallback(
     reconciliationCallback_ = callback;
 }
 
-void ReconciliationSystem::setSmoothingFactor(float smoothFactor) {
-    smoothingFactor_ = smoothFactor;
-    LOG_INFO("Set reconciliation smoothing factor to " + std::to_string(smoothFactor), "ReconciliationSystem");
+void ReconciliationSystem::setPredictionHorizon(uint32_t maxInputs) {
+    predictionHorizon_ = maxInputs;
+    LOG_INFO("Set prediction horizon to " + std::to_string(maxInputs) + " inputs", "ReconciliationSystem");
+}
+
+void ReconciliationSystem::setReplayBudget(std::chrono::microseconds budget) {
+    replayBudget_ = budget;
+    LOG_INFO("Set replay budget to " + std::to_string(budget.count()) + " us", "ReconciliationSystem");
 }
 
 void ReconciliationSystem::reset() {
-    reconciliationStates_.clear();
-    lastReconciliationTimes_.clear();
+    for (EntityRecord& record : predictionSystem_.getSnapshotManager().getRecords()) {
+        record.correction = PendingCorrection();
+    }
+    stats_ = ReconciliationStats();
     LOG_INFO("Reconciliation system reset", "ReconciliationSystem");
 }
 
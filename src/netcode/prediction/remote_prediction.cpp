@@ -0,0 +1,127 @@
+#include "netcode/prediction/remote_prediction.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+
+namespace netcode {
+
+RemotePredictionSystem::RemotePredictionSystem(const RemotePredictionConfig& config)
+    : config_(config) {
+    LOG_INFO(std::string("Remote prediction system initialized (") +
+             (config.enabled ? "enabled" : "disabled") + ")", "RemotePredictionSystem");
+}
+
+void RemotePredictionSystem::recordServerState(
+    uint32_t entityId,
+    const netcode::math::MyVec3& position,
+    const netcode::math::MyVec3& velocity,
+    bool isJumping,
+    const netcode::math::MyVec3& heldInput,
+    std::chrono::steady_clock::time_point receiveTime) {
+
+    RemoteEntityState& state = states_[entityId];
+    state.serverPosition = position;
+    state.serverVelocity = velocity;
+    state.serverIsJumping = isJumping;
+    state.heldInput = heldInput;
+    state.receiveTime = receiveTime;
+    state.needsResimulation = true;
+    state.stats.serverUpdates++;
+}
+
+void RemotePredictionSystem::updateEntity(std::shared_ptr<NetworkedEntity> entity) {
+    if (!entity) {
+        LOG_ERROR("Null entity passed to remote prediction system", "RemotePredictionSystem");
+        return;
+    }
+
+    auto it = states_.find(entity->getId());
+    if (it == states_.end()) {
+        // Nothing received from the server yet
+        return;
+    }
+    RemoteEntityState& state = it->second;
+
+    // How far ahead of the server state the present is, capped to the prediction horizon
+    auto ahead = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - state.receiveTime) + latencyEstimate_;
+    ahead = std::clamp(ahead, std::chrono::microseconds(0),
+                       std::chrono::microseconds(config_.maxPredictionMs * 1000));
+    uint32_t targetSteps = static_cast<uint32_t>(
+        static_cast<float>(ahead.count()) / 1000000.0f * config_.simulationRate);
+
+    if (!state.needsResimulation && targetSteps <= state.simulatedSteps) {
+        return;
+    }
+
+    auto simulationStart = std::chrono::steady_clock::now();
+
+    if (state.needsResimulation) {
+        // Rewind to the authoritative state and predict from there
+        entity->snapSimulationState(state.serverPosition, state.serverIsJumping, state.serverVelocity);
+        state.simulatedSteps = 0;
+        state.stats.resimulations++;
+    }
+
+    // Keep applying the held input until fresh data arrives. Jumps are not
+    // repeated: a jump in progress is part of the replicated kinematic state.
+    for (uint32_t step = state.simulatedSteps; step < targetSteps; ++step) {
+        entity->move(state.heldInput);
+        entity->update();
+    }
+    state.stats.stepsSimulated += targetSteps - state.simulatedSteps;
+    state.simulatedSteps = targetSteps;
+
+    if (state.needsResimulation) {
+        // Hide the difference between the old and the corrected prediction
+        entity->initiateVisualBlend();
+        state.needsResimulation = false;
+    }
+
+    state.stats.simulationTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - simulationStart);
+}
+
+void RemotePredictionSystem::setLatencyEstimate(std::chrono::microseconds roundTripTime) {
+    latencyEstimate_ = roundTripTime;
+}
+
+RemotePredictionStats RemotePredictionSystem::getStats(uint32_t entityId) const {
+    auto it = states_.find(entityId);
+    if (it == states_.end()) {
+        return RemotePredictionStats();
+    }
+    return it->second.stats;
+}
+
+bool RemotePredictionSystem::getServerState(uint32_t entityId, EntitySnapshot& out) const {
+    auto it = states_.find(entityId);
+    if (it == states_.end()) {
+        return false;
+    }
+    out.entityId = entityId;
+    out.position = it->second.serverPosition;
+    out.velocity = it->second.serverVelocity;
+    out.isJumping = it->second.serverIsJumping;
+    out.timestamp = it->second.receiveTime;
+    out.sequenceNumber = 0;
+    return true;
+}
+
+void RemotePredictionSystem::setConfig(const RemotePredictionConfig& config) {
+    config_ = config;
+    LOG_INFO(std::string("Updated remote prediction config (") +
+             (config.enabled ? "enabled" : "disabled") + ", max " +
+             std::to_string(config.maxPredictionMs) + "ms)", "RemotePredictionSystem");
+}
+
+const RemotePredictionConfig& RemotePredictionSystem::getConfig() const {
+    return config_;
+}
+
+void RemotePredictionSystem::reset() {
+    states_.clear();
+    latencyEstimate_ = std::chrono::microseconds(0);
+    LOG_INFO("Remote prediction system reset", "RemotePredictionSystem");
+}
+
+} // namespace netcode
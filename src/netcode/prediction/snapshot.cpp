@@ -5,25 +5,23 @@
 namespace netcode {
 
 void SnapshotManager::storeEntitySnapshot(const EntitySnapshot& snapshot) {
-    entitySnapshots_[snapshot.entityId].push_back(snapshot);
+    auto& snapshots = records_.record(snapshot.entityId).snapshots;
     
-    // Sort snapshots by sequence number to ensure they're in order
-    std::sort(entitySnapshots_[snapshot.entityId].begin(), 
-              entitySnapshots_[snapshot.entityId].end());
+    // Insert in sequence order, snapshots almost always arrive newest last
+    snapshots.insert(std::upper_bound(snapshots.begin(), snapshots.end(), snapshot), snapshot);
 }
 
 void SnapshotManager::storeInputSnapshot(const InputSnapshot& input) {
-    inputSnapshots_[input.playerId].push_back(input);
+    auto& inputs = records_.record(input.playerId).inputs;
     
-    // Sort inputs by sequence number to ensure they're in order
-    std::sort(inputSnapshots_[input.playerId].begin(), 
-              inputSnapshots_[input.playerId].end());
+    // Insert in sequence order, inputs almost always arrive newest last
+    inputs.insert(std::upper_bound(inputs.begin(), inputs.end(), input), input);
 }
 
 EntitySnapshot SnapshotManager::getLatestEntitySnapshot(uint32_t entityId) const {
-    auto it = entitySnapshots_.find(entityId);
-    if (it != entitySnapshots_.end() && !it->second.empty()) {
-        return it->second.back(); // Return the most recent snapshot
+    const EntityRecord* record = records_.findRecord(entityId);
+    if (record && !record->snapshots.empty()) {
+        return record->snapshots.back(); // Return the most recent snapshot
     }
     
     // Return an empty snapshot if none exists
@@ -36,97 +34,74 @@ EntitySnapshot SnapshotManager::getLatestEntitySnapshot(uint32_t entityId) const
 std::vector<EntitySnapshot> SnapshotManager::getEntitySnapshotsAfter(
     uint32_t entityId, uint32_t afterSequence) const {
     
-    std::vector<EntitySnapshot> result;
-    auto it = entitySnapshots_.find(entityId);
-    
-    if (it != entitySnapshots_.end()) {
-        // Find the first snapshot with sequence number > afterSequence
-        for (const auto& snapshot : it->second) {
-            if (snapshot.sequenceNumber > afterSequence) {
-                result.push_back(snapshot);
-            }
-        }
+    const EntityRecord* record = records_.findRecord(entityId);
+    if (!record) {
+        return {};
     }
     
-    return result;
+    // Snapshots are ordered, so everything after the first newer one is newer too
+    auto first = std::find_if(record->snapshots.begin(), record->snapshots.end(),
+        [afterSequence](const EntitySnapshot& snapshot) { return snapshot.sequenceNumber > afterSequence; });
+    return std::vector<EntitySnapshot>(first, record->snapshots.end());
 }
 
 std::vector<InputSnapshot> SnapshotManager::getInputSnapshotsAfter(
     uint32_t playerId, uint32_t afterSequence) const {
     
-    std::vector<InputSnapshot> result;
-    auto it = inputSnapshots_.find(playerId);
-    
-    if (it != inputSnapshots_.end()) {
-        // Find all inputs with sequence number > afterSequence
-        for (const auto& input : it->second) {
-            if (input.sequenceNumber > afterSequence) {
-                result.push_back(input);
-            }
-        }
+    const EntityRecord* record = records_.findRecord(playerId);
+    if (!record) {
+        return {};
     }
     
-    return result;
+    // Inputs are ordered, so everything after the first newer one is newer too
+    auto first = std::find_if(record->inputs.begin(), record->inputs.end(),
+        [afterSequence](const InputSnapshot& input) { return input.sequenceNumber > afterSequence; });
+    return std::vector<InputSnapshot>(first, record->inputs.end());
 }
 
 void SnapshotManager::pruneOldSnapshots(uint64_t maxAge) {
     auto now = std::chrono::steady_clock::now();
+    auto isOld = [now, maxAge](std::chrono::steady_clock::time_point timestamp) {
+        auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - timestamp).count();
+        return age > static_cast<int64_t>(maxAge);
+    };
     
-    // Prune entity snapshots
-    for (auto& [entityId, snapshots] : entitySnapshots_) {
-        auto newEnd = std::remove_if(snapshots.begin(), snapshots.end(),
-            [now, maxAge](const EntitySnapshot& snapshot) {
-                auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - snapshot.timestamp).count();
-                return age > maxAge;
-            });
-        
-        if (newEnd != snapshots.end()) {
-            snapshots.erase(newEnd, snapshots.end());
-            //LOG_DEBUG("Pruned " + std::to_string(std::distance(newEnd, snapshots.end())) + 
-             //        " old snapshots for entity " + std::to_string(entityId), "SnapshotManager");
-        }
-    }
-    
-    // Prune input snapshots
-    for (auto& [playerId, inputs] : inputSnapshots_) {
-        auto newEnd = std::remove_if(inputs.begin(), inputs.end(),
-            [now, maxAge](const InputSnapshot& input) {
-                auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - input.timestamp).count();
-                return age > maxAge;
-            });
-        
-        if (newEnd != inputs.end()) {
-            inputs.erase(newEnd, inputs.end());
-            //LOG_DEBUG("Pruned " + std::to_string(std::distance(newEnd, inputs.end())) + 
-            //         " old input snapshots for player " + std::to_string(playerId), "SnapshotManager");
-        }
+    for (EntityRecord& record : records_) {
+        std::erase_if(record.snapshots, [&isOld](const EntitySnapshot& snapshot) {
+            return isOld(snapshot.timestamp);
+        });
+        std::erase_if(record.inputs, [&isOld](const InputSnapshot& input) {
+            return isOld(input.timestamp);
+        });
     }
 }
 
 std::shared_ptr<NetworkedEntity> SnapshotManager::getEntity(uint32_t entityId) const {
-    auto it = entities_.find(entityId);
-    if (it != entities_.end()) {
-        // Try to lock the weak_ptr to get a shared_ptr
-        auto entity = it->second.lock();
-        if (entity) {
-            return entity;
-        } else {
-            // Remove expired reference
-            entities_.erase(it);
-        }
-    }
-    return nullptr;
+    const EntityRecord* record = records_.findRecord(entityId);
+    return record ? record->entity : nullptr;
 }
 
-void SnapshotManager::registerEntity(uint32_t entityId, std::shared_ptr<NetworkedEntity> entity) {
-    if (entity) {
-        entities_[entityId] = entity;
-        LOG_DEBUG("Registered entity with ID " + std::to_string(entityId), "SnapshotManager");
-    } else {
+NetworkedEntity* SnapshotManager::resolveEntity(EntityHandle handle) const {
+    const EntityRecord* record = records_.get(handle);
+    return record ? record->entity.get() : nullptr;
+}
+
+EntityHandle SnapshotManager::registerEntity(uint32_t entityId, std::shared_ptr<NetworkedEntity> entity) {
+    if (!entity) {
         LOG_WARNING("Attempted to register null entity for ID " + std::to_string(entityId), "SnapshotManager");
+        return INVALID_ENTITY_HANDLE;
+    }
+    
+    EntityHandle handle = records_.acquire(entityId);
+    records_.get(handle)->entity = std::move(entity);
+    LOG_DEBUG("Registered entity with ID " + std::to_string(entityId), "SnapshotManager");
+    return handle;
+}
+
+void SnapshotManager::unregisterEntity(uint32_t entityId) {
+    if (records_.release(entityId)) {
+        LOG_DEBUG("Unregistered entity with ID " + std::to_string(entityId), "SnapshotManager");
     }
 }
 
-} // namespace netcode 
\ No newline at end of file
+} // namespace netcode
@@ -0,0 +1,79 @@
+#include "netcode/prediction/time_dilation.hpp"
+#include <algorithm>
+
+namespace netcode {
+
+TimeDilationController::TimeDilationController(const TimeDilationConfig& config) : config_(config) {}
+
+void TimeDilationController::onInputAck(uint32_t serverTick, uint32_t bufferDepth, uint32_t underruns, uint32_t catchUpInputs) {
+    if (hasSample_ && serverTick <= lastServerTick_) {
+        return;
+    }
+
+    // The totals only grow, a lost acknowledgement loses no underruns
+    uint32_t newUnderruns = hasSample_ ? underruns - std::min(underruns, lastUnderruns_) : 0;
+    uint32_t newCatchUps = hasSample_ ? catchUpInputs - std::min(catchUpInputs, lastCatchUpInputs_) : 0;
+    lastServerTick_ = serverTick;
+    lastUnderruns_ = underruns;
+    lastCatchUpInputs_ = catchUpInputs;
+    acks_++;
+    underruns_ += newUnderruns;
+    catchUpInputs_ += newCatchUps;
+
+    float sample = newUnderruns > 0 ? -static_cast<float>(newUnderruns) : static_cast<float>(bufferDepth);
+    smoothedDepth_ = hasSample_ ? smoothedDepth_ + config_.smoothing * (sample - smoothedDepth_) : sample;
+    hasSample_ = true;
+
+    if (!config_.enabled) {
+        timeScale_ = 1.0f;
+        return;
+    }
+    float dilation = config_.gain * (config_.targetDepth - smoothedDepth_);
+    timeScale_ = 1.0f + std::clamp(dilation, -config_.maxDilation, config_.maxDilation);
+}
+
+void TimeDilationController::setConfig(const TimeDilationConfig& config) {
+    config_ = config;
+    if (!config_.enabled) {
+        timeScale_ = 1.0f;
+    }
+}
+
+TimeDilationStats TimeDilationController::getStats() const {
+    TimeDilationStats stats;
+    stats.acks = acks_;
+    stats.underruns = underruns_;
+    stats.catchUpInputs = catchUpInputs_;
+    stats.smoothedDepth = smoothedDepth_;
+    stats.timeScale = timeScale_;
+    return stats;
+}
+
+void TimeDilationController::reset() {
+    smoothedDepth_ = 0.0f;
+    timeScale_ = 1.0f;
+    hasSample_ = false;
+    lastServerTick_ = 0;
+    lastUnderruns_ = 0;
+    lastCatchUpInputs_ = 0;
+}
+
+InputClock::InputClock(float inputRate) : inputRate_(std::max(inputRate, 1.0f)) {}
+
+uint32_t InputClock::advance(std::chrono::steady_clock::time_point now, float timeScale) {
+    if (!running_) {
+        running_ = true;
+        lastAdvance_ = now;
+        pendingInputs_ = 0.0;
+        return 1;
+    }
+
+    // Fractions of an input carry over, so the average rate follows the scale exactly
+    pendingInputs_ += std::chrono::duration<double>(now - lastAdvance_).count() * inputRate_ * timeScale;
+    lastAdvance_ = now;
+    auto due = static_cast<uint32_t>(std::min(pendingInputs_, static_cast<double>(MAX_INPUTS_PER_FRAME)));
+    pendingInputs_ = std::min(pendingInputs_ - due, 1.0);
+    return due;
+}
+
+} // namespace netcode
@@ -0,0 +1,301 @@
+#include "netcode/relay/relay.hpp"
+#include "netcode/packets/cluster_packets.hpp"
+#include "netcode/packets/session_packets.hpp"
+#include "netcode/utils/logger.hpp"
+#include "netcode/utils/udp_socket.hpp"
+#include <unistd.h>
+#include <cstring>
+#include <poll.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace netcode {
+
+Relay::Relay(const RelayConfig& config) : config_(config), running_(false) {
+    memset(&serverAddr_, 0, sizeof(serverAddr_));
+    serverAddr_.sin_family = AF_INET;
+    serverAddr_.sin_port = htons(config_.serverPort);
+    inet_pton(AF_INET, config_.serverIp.c_str(), &serverAddr_.sin_addr);
+    uplink_.relay_id = config_.relayId;
+
+    LOG_INFO("Relay " + std::to_string(config_.relayId) + " created on port " + std::to_string(config_.clientPort) +
+             " for server " + config_.serverIp + ":" + std::to_string(config_.serverPort), "Relay");
+}
+
+Relay::~Relay() {
+    stop();
+}
+
+bool Relay::start() {
+    if (running_) {
+        LOG_WARNING("Relay already running", "Relay");
+        return true;
+    }
+
+    clientSocketFd_ = utils::open_bound_socket(config_.clientPort);
+    serverSocketFd_ = utils::open_bound_socket(0);
+    if (clientSocketFd_ < 0 || serverSocketFd_ < 0) {
+        LOG_ERROR("Failed to bind relay sockets: " + std::string(strerror(errno)), "Relay");
+        stop();
+        return false;
+    }
+
+    running_ = true;
+    relayThread_ = std::thread(&Relay::run, this);
+    LOG_INFO("Relay " + std::to_string(config_.relayId) + " started", "Relay");
+    return true;
+}
+
+void Relay::stop() {
+    running_ = false;
+    if (relayThread_.joinable()) {
+        relayThread_.join();
+    }
+    if (clientSocketFd_ != -1) {
+        close(clientSocketFd_);
+        clientSocketFd_ = -1;
+    }
+    if (serverSocketFd_ != -1) {
+        close(serverSocketFd_);
+        serverSocketFd_ = -1;
+    }
+}
+
+RelayStats Relay::getStats() {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+void Relay::run() {
+    while (running_) {
+        pollfd fds[2] = {{clientSocketFd_, POLLIN, 0}, {serverSocketFd_, POLLIN, 0}};
+        int timeoutMs = uplink_.count > 0 ? static_cast<int>(config_.maxBatchDelayMs) : 10;
+        if (poll(fds, 2, timeoutMs) > 0) {
+            receiveFromServer();
+            receiveFromClients();
+        }
+
+        // Send a partial batch once its oldest input has waited long enough
+        if (uplink_.count > 0 &&
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - uplinkStarted_).count() >=
+                config_.maxBatchDelayMs) {
+            flushUplink();
+        }
+
+        expireSessions();
+    }
+}
+
+void Relay::receiveFromClients() {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+    sockaddr_in clientAddr;
+
+    while (true) {
+        socklen_t clientLen = sizeof(clientAddr);
+        ssize_t bytesReceived = recvfrom(clientSocketFd_, buffer, BUFFER_SIZE, 0,
+                                         (struct sockaddr*)&clientAddr, &clientLen);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "Relay");
+            }
+            return;
+        }
+
+        if (bytesReceived == sizeof(packets::TimestampedPlayerMovementRequest)) {
+            packets::TimestampedPlayerMovementRequest timestampedRequest;
+            memcpy(&timestampedRequest, buffer, sizeof(timestampedRequest));
+            if (!admit(timestampedRequest.player_movement_request.player_id, clientAddr)) {
+                continue;
+            }
+
+            if (uplink_.count == 0) {
+                uplinkStarted_ = std::chrono::steady_clock::now();
+            }
+            uplink_.inputs[uplink_.count++] = timestampedRequest;
+            if (uplink_.count == packets::MAX_RELAY_BATCH) {
+                flushUplink();
+            }
+        } else if (bytesReceived == sizeof(packets::TimestampedStateAckPacket)) {
+            // Acknowledgements are small and rare, pass them through unbatched
+            packets::TimestampedStateAckPacket timestampedAck;
+            memcpy(&timestampedAck, buffer, sizeof(timestampedAck));
+            if (admit(timestampedAck.state_ack.player_id, clientAddr)) {
+                sendto(serverSocketFd_, buffer, bytesReceived, 0, (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+            }
+        } else if (bytesReceived == sizeof(packets::TimestampedResumeRequestPacket)) {
+            // The session only moves to the new address once the server accepts the token
+            packets::TimestampedResumeRequestPacket timestampedResume;
+            memcpy(&timestampedResume, buffer, sizeof(timestampedResume));
+            uint32_t playerId = timestampedResume.resume_request.player_id;
+            if (admit(playerId, clientAddr)) {
+                pendingResumes_[playerId] = clientAddr;
+                sendto(serverSocketFd_, buffer, bytesReceived, 0, (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+            }
+        }
+    }
+}
+
+void Relay::receiveFromServer() {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+
+    while (true) {
+        ssize_t bytesReceived = recvfrom(serverSocketFd_, buffer, BUFFER_SIZE, 0, nullptr, nullptr);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "Relay");
+            }
+            return;
+        }
+
+        uint64_t sent = 0;
+        if (bytesReceived == sizeof(packets::TimestampedRedirectPacket)) {
+            // Redirects concern a single client
+            packets::TimestampedRedirectPacket timestampedRedirect;
+            memcpy(&timestampedRedirect, buffer, sizeof(timestampedRedirect));
+            sent = sendToPlayer(timestampedRedirect.redirect.player_id, buffer, bytesReceived);
+        } else if (bytesReceived == sizeof(packets::TimestampedInputAckPacket)) {
+            // So do input acknowledgements
+            packets::TimestampedInputAckPacket timestampedInputAck;
+            memcpy(&timestampedInputAck, buffer, sizeof(timestampedInputAck));
+            sent = sendToPlayer(timestampedInputAck.input_ack.player_id, buffer, bytesReceived);
+        } else if (bytesReceived == sizeof(packets::TimestampedSessionPacket)) {
+            // A session token lets its holder take over the player, it must never reach other clients
+            packets::TimestampedSessionPacket timestampedSession;
+            memcpy(&timestampedSession, buffer, sizeof(timestampedSession));
+            const packets::SessionPacket& session = timestampedSession.session;
+            auto pending = pendingResumes_.find(session.player_id);
+            auto it = sessions_.find(session.player_id);
+            if (pending != pendingResumes_.end()) {
+                // The answer to a resume goes to the requester; only an accepted one moves the session
+                sockaddr_in requester = pending->second;
+                pendingResumes_.erase(pending);
+                if (session.resumed && session.token != 0 && it != sessions_.end()) {
+                    it->second.addr = requester;
+                    it->second.lastSeen = std::chrono::steady_clock::now();
+                    it->second.serverGracePeriodMs = session.grace_period_ms;
+                }
+                sendto(clientSocketFd_, buffer, bytesReceived, 0, (struct sockaddr*)&requester, sizeof(requester));
+                sent = 1;
+            } else {
+                sent = sendToPlayer(session.player_id, buffer, bytesReceived);
+                if (it != sessions_.end()) {
+                    if (session.token == 0) {
+                        // The server expired the session, the client registers again if it is still there
+                        closeSession(it, "expired by the server");
+                    } else {
+                        it->second.serverGracePeriodMs = session.grace_period_ms;
+                    }
+                }
+            }
+        } else if (bytesReceived == sizeof(packets::TimestampedCatchUpPacket)) {
+            // Catch-ups answer one client's resume
+            packets::TimestampedCatchUpPacket timestampedCatchUp;
+            memcpy(&timestampedCatchUp, buffer, sizeof(timestampedCatchUp));
+            sent = sendToPlayer(timestampedCatchUp.catch_up.player_id, buffer, bytesReceived);
+        } else {
+            // State updates and checksums go to every client, the server sent them only once
+            for (const auto& [playerId, session] : sessions_) {
+                sendto(clientSocketFd_, buffer, bytesReceived, 0, (struct sockaddr*)&session.addr, sizeof(session.addr));
+                sent++;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.packetsFannedOut += sent;
+    }
+}
+
+uint64_t Relay::sendToPlayer(uint32_t playerId, const char* data, size_t size) {
+    auto it = sessions_.find(playerId);
+    if (it == sessions_.end()) {
+        return 0;
+    }
+    sendto(clientSocketFd_, data, size, 0, (struct sockaddr*)&it->second.addr, sizeof(it->second.addr));
+    return 1;
+}
+
+bool Relay::admit(uint32_t playerId, const sockaddr_in& addr) {
+    auto now = std::chrono::steady_clock::now();
+
+    auto it = sessions_.find(playerId);
+    if (it == sessions_.end()) {
+        Session session;
+        session.addr = addr;
+        session.tokens = config_.burstPackets;
+        session.lastRefill = now;
+        it = sessions_.emplace(playerId, session).first;
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.sessionsOpened++;
+        stats_.activeSessions = sessions_.size();
+        LOG_INFO("Relay " + std::to_string(config_.relayId) + " opened session for client " + std::to_string(playerId), "Relay");
+    }
+
+    // The session only moves to another address through an accepted resume, and only
+    // its own client keeps it alive; a packet naming the player proves nothing
+    Session& session = it->second;
+    if (session.addr.sin_addr.s_addr == addr.sin_addr.s_addr && session.addr.sin_port == addr.sin_port) {
+        session.lastSeen = now;
+    }
+
+    // Token bucket: refill at the sustained rate, capped at the burst size
+    float elapsed = std::chrono::duration<float>(now - session.lastRefill).count();
+    session.tokens = std::min(config_.burstPackets, session.tokens + elapsed * config_.maxPacketsPerSecond);
+    session.lastRefill = now;
+
+    if (session.tokens < 1.0f) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.packetsDropped++;
+        return false;
+    }
+    session.tokens -= 1.0f;
+    return true;
+}
+
+void Relay::flushUplink() {
+    if (uplink_.count == 0) {
+        return;
+    }
+
+    ssize_t bytesSent = sendto(serverSocketFd_, &uplink_, sizeof(uplink_), 0,
+                               (struct sockaddr*)&serverAddr_, sizeof(serverAddr_));
+    if (bytesSent < 0) {
+        LOG_ERROR("Failed to send uplink batch: " + std::string(strerror(errno)), "Relay");
+    } else {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.inputsForwarded += uplink_.count;
+        stats_.uplinkPackets++;
+    }
+    uplink_.count = 0;
+}
+
+void Relay::expireSessions() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        // Sessions the server knows about are closed by the server, the timeout only covers a lost notice
+        uint64_t timeoutMs = static_cast<uint64_t>(config_.sessionTimeoutMs) + it->second.serverGracePeriodMs;
+        if (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.lastSeen).count()) >= timeoutMs) {
+            it = closeSession(it, "silent for too long");
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::unordered_map<uint32_t, Relay::Session>::iterator Relay::closeSession(
+    std::unordered_map<uint32_t, Session>::iterator it, const std::string& reason) {
+    LOG_INFO("Relay " + std::to_string(config_.relayId) + " closed session for client " + std::to_string(it->first) +
+             ": " + reason, "Relay");
+    pendingResumes_.erase(it->first);
+    it = sessions_.erase(it);
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.sessionsClosed++;
+    stats_.activeSessions = sessions_.size();
+    return it;
+}
+
+} // namespace netcode
@@ -0,0 +1,99 @@
+#include "netcode/server/outbound_pacer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace netcode {
+
+namespace {
+
+uint64_t destinationKey(const sockaddr_in& destination) {
+    return (static_cast<uint64_t>(destination.sin_addr.s_addr) << 16) | destination.sin_port;
+}
+
+} // namespace
+
+OutboundPacer::OutboundPacer(const OutboundPacerConfig& config) : config_(config) {}
+
+void OutboundPacer::setConfig(const OutboundPacerConfig& config) {
+    config_ = config;
+}
+
+void OutboundPacer::enqueue(const sockaddr_in& destination, const packets::PlayerStatePacket& state,
+                            std::chrono::steady_clock::time_point now) {
+    DestinationQueue& queue = queues_[destinationKey(destination)];
+    if (queue.order.empty()) {
+        queue.destination = destination;
+        queue.lastRelease = now;
+    }
+    stats_.queued++;
+
+    // Latest wins, the entity keeps its place in the queue
+    auto waiting = queue.latest.find(state.player_id);
+    if (waiting != queue.latest.end()) {
+        waiting->second = state;
+        stats_.coalesced++;
+        return;
+    }
+    queue.latest[state.player_id] = state;
+    queue.order.emplace_back(state.player_id, now);
+    stats_.maxBacklog = std::max(stats_.maxBacklog, queue.order.size());
+}
+
+std::vector<OutboundPacer::Outgoing> OutboundPacer::release(std::chrono::steady_clock::time_point now) {
+    std::vector<Outgoing> out;
+    auto window = std::chrono::milliseconds(config_.pacingWindowMs);
+    for (auto it = queues_.begin(); it != queues_.end();) {
+        DestinationQueue& queue = it->second;
+        if (queue.order.empty()) {
+            it = queues_.erase(it);
+            continue;
+        }
+
+        // Drain the backlog evenly from the last release until the oldest state's window ends
+        auto deadline = queue.order.front().second + window;
+        size_t count = queue.order.size();
+        if (now < deadline) {
+            double share = std::chrono::duration<double>(now - queue.lastRelease) /
+                           std::chrono::duration<double>(deadline - queue.lastRelease);
+            count = static_cast<size_t>(std::ceil(share * queue.order.size()));
+        }
+        if (count > 0) {
+            take(queue, count, out);
+            queue.lastRelease = now;
+        }
+        ++it;
+    }
+    return out;
+}
+
+std::vector<OutboundPacer::Outgoing> OutboundPacer::releaseAll(const sockaddr_in& destination) {
+    std::vector<Outgoing> out;
+    auto it = queues_.find(destinationKey(destination));
+    if (it != queues_.end()) {
+        take(it->second, it->second.order.size(), out);
+        queues_.erase(it);
+    }
+    return out;
+}
+
+size_t OutboundPacer::getBacklog() const {
+    size_t backlog = 0;
+    for (const auto& [key, queue] : queues_) {
+        backlog += queue.order.size();
+    }
+    return backlog;
+}
+
+void OutboundPacer::take(DestinationQueue& queue, size_t count, std::vector<Outgoing>& out) {
+    count = std::min(count, queue.order.size());
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t entityId = queue.order.front().first;
+        auto state = queue.latest.find(entityId);
+        out.push_back({queue.destination, state->second});
+        queue.latest.erase(state);
+        queue.order.pop_front();
+    }
+    stats_.sent += count;
+}
+
+} // namespace netcode
@@ -1,11 +1,16 @@
 #include "netcode/server/server.hpp"
 #include "netcode/utils/logger.hpp"
 #include "netcode/networked_entity.hpp"
+#include "netcode/utils/state_hash.hpp"
+#include "netcode/utils/secure_random.hpp"
+#include "netcode/utils/udp_socket.hpp"
+#include "netcode/packets/relay_packets.hpp"
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
 #include <fcntl.h>
 #include <queue>
+#include <algorithm>
 
 namespace netcode {
 
@@ -52,6 +57,21 @@ void Server::start() {
         return;
     }
     
+    if (spectatorStream_) {
+        spectatorSocketFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        serverAddr.sin_port = htons(spectatorConfig_.port);
+        if (spectatorSocketFd_ < 0 || bind(spectatorSocketFd_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+            LOG_ERROR("Failed to bind spectator socket: " + std::string(strerror(errno)), "Server");
+            if (spectatorSocketFd_ >= 0) {
+                close(spectatorSocketFd_);
+            }
+            spectatorSocketFd_ = -1;
+        } else {
+            fcntl(spectatorSocketFd_, F_SETFL, fcntl(spectatorSocketFd_, F_GETFL, 0) | O_NONBLOCK);
+            LOG_INFO("Spectator stream on port " + std::to_string(spectatorConfig_.port), "Server");
+        }
+    }
+    
     LOG_INFO("Server started on port " + std::to_string(port_), "Server");
     
     // Start network processing thread
@@ -70,6 +90,10 @@ void Server::stop() {
             close(socketFd_);
             socketFd_ = -1;
         }
+        if (spectatorSocketFd_ != -1) {
+            close(spectatorSocketFd_);
+            spectatorSocketFd_ = -1;
+        }
         
         LOG_INFO("Server stopped", "Server");
     }
@@ -85,7 +109,10 @@ void Server::setPlayerReference(uint32_t playerId, std::shared_ptr<NetworkedEnti
 
 void Server::updatePlayerState(const packets::PlayerMovementRequest& request) {
     std::lock_guard<std::mutex> lock(playerMutex_);
-    
+    applyInput(request);
+}
+
+void Server::applyInput(const packets::PlayerMovementRequest& request) {
     auto it = players_.find(request.player_id);
     if (it == players_.end()) {
         LOG_WARNING("Received update for unknown player ID: " + std::to_string(request.player_id), "Server");
@@ -118,14 +145,16 @@ void Server::updatePlayerState(const packets::PlayerMovementRequest& request) {
     
     // Update player position
     player->move(movement);
+    lastInputMovement_[playerId] = movement;
+    lastInputTime_[playerId] = std::chrono::steady_clock::now();
     if (request.is_jumping) {
         player->jump();
     }
     player->update();
     
-    // Get updated position and broadcast to all clients
+    // Broadcast the updated state to all clients
     auto pos = player->getPosition();
-    broadcastPlayerState(request.player_id, pos.x, pos.y, pos.z, request.is_jumping, sequenceNumber, request.wasPredicted);
+    broadcastPlayerState(request.player_id, *player, sequenceNumber, request.wasPredicted);
     
     LOG_DEBUG("Updated player " + std::to_string(request.player_id) + 
               " position: [" + std::to_string(pos.x) + ", " + 
@@ -153,7 +182,7 @@ void Server::setPlayerPosition(uint32_t playerId, float x, float y, float z, boo
     uint32_t sequenceNumber = lastProcessedInputSequence_[playerId];
     
     // Broadcast updated state to clients
-    broadcastPlayerState(playerId, x, y, z, isJumping, sequenceNumber, false);
+    broadcastPlayerState(playerId, *it->second, sequenceNumber, false);
 }
 
 void Server::processNetworkEvents() {
@@ -176,10 +205,23 @@ void Server::processNetworkEvents() {
                     uint32_t playerId = timestampedRequest.player_movement_request.player_id;
                     
                     // Store client address from this request
-                    if (clientAddresses_.find(playerId) == clientAddresses_.end()) {
+                    bool registered = clientAddresses_.find(playerId) == clientAddresses_.end();
+                    if (registered) {
                         // This is a new client
+                        std::lock_guard<std::mutex> lock(playerMutex_);
                         clientAddresses_[playerId] = timestampedRequest.clientAddr;
+                        
+                        // Clients behind a relay share its address and get each packet only once
+                        if (!utils::contains_address(destinations_, timestampedRequest.clientAddr)) {
+                            destinations_.push_back(timestampedRequest.clientAddr);
+                        }
                         LOG_INFO("Registered new client with ID: " + std::to_string(playerId), "Server");
+                    } else {
+                        std::lock_guard<std::mutex> lock(playerMutex_);
+                        auto session = sessions_.find(playerId);
+                        if (session != sessions_.end()) {
+                            session->second.lastHeard = currentTime;
+                        }
                     }
                     
                     // Process client request with the stored client address
@@ -193,43 +235,24 @@ void Server::processNetworkEvents() {
                         
                         // This is a new connection or registration packet
                         // Send this player's state to all clients
+                        std::lock_guard<std::mutex> lock(playerMutex_);
                         auto it = players_.find(request.player_id);
                         if (it != players_.end()) {
-                            auto pos = it->second->getPosition();
                             // Get the sequence number from the request
                             uint32_t sequenceNumber = request.input_sequence_number;
-                            broadcastPlayerState(request.player_id, pos.x, pos.y, pos.z, false, sequenceNumber, false);
+                            broadcastPlayerState(request.player_id, *it->second, sequenceNumber, false);
                         }
                         
                         // Send all other players' states to this new client - important for initial sync!
-                        std::lock_guard<std::mutex> lock(playerMutex_);
                         for (const auto& playerPair : players_) {
                             // Skip the new player itself
                             if (playerPair.first != request.player_id) {
-                                auto pos = playerPair.second->getPosition();
                                 // Use the last processed sequence for this player
                                 uint32_t seq = lastProcessedInputSequence_[playerPair.first];
                                 
                                 // Send this player's state directly to the new client
-                                packets::PlayerStatePacket packet;
-                                packet.player_id = playerPair.first;
-                                packet.x = pos.x;
-                                packet.y = pos.y;
-                                packet.z = pos.z;
-                                packet.velocity_y = 0.0f;
-                                packet.is_jumping = false;
-                                packet.last_processed_input_sequence = seq;
-                                packet.wasPredicted = false;
-                                
-                                // Create timestamped packet
-                                packets::TimestampedPlayerStatePacket timestampedPacket;
-                                timestampedPacket.timestamp = std::chrono::steady_clock::now() + 
-                                    std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
-                                timestampedPacket.player_state = packet;
-                                
-                                // Send directly to the new client
-                                sendto(socketFd_, &timestampedPacket, sizeof(timestampedPacket), 0,
-                                    (struct sockaddr*)&clientAddresses_[request.player_id], sizeof(sockaddr_in));
+                                packets::PlayerStatePacket packet = makeStatePacket(playerPair.first, *playerPair.second, seq, false);
+                                sendStatePacket(clientAddresses_[request.player_id], packet);
                                 
                                 LOG_INFO("Sent existing player " + std::to_string(playerPair.first) + 
                                          " state to new client " + std::to_string(request.player_id), "Server");
@@ -237,6 +260,15 @@ void Server::processNetworkEvents() {
                         }
                     }
                     
+                    // The token follows the initial sync so the client's first packet is still its state
+                    if (registered) {
+                        std::lock_guard<std::mutex> lock(playerMutex_);
+                        for (const auto& outgoing : outboundPacer_.releaseAll(clientAddresses_[playerId])) {
+                            writeStatePacket(outgoing.destination, outgoing.state);
+                        }
+                        openSession(playerId, clientAddresses_[playerId]);
+                    }
+                    
                     packetQueue_.pop();
                 } else {
                     remainingPackets.push(timestampedRequest);
@@ -244,7 +276,39 @@ void Server::processNetworkEvents() {
                 }
             }
             packetQueue_ = std::move(remainingPackets);
+            
+            // Apply state acknowledgements that are ready
+            std::queue<packets::TimestampedStateAckPacket> remainingAcks;
+            while (!ackQueue_.empty()) {
+                if (currentTime >= ackQueue_.front().timestamp) {
+                    handleStateAck(ackQueue_.front().state_ack);
+                } else {
+                    remainingAcks.push(ackQueue_.front());
+                }
+                ackQueue_.pop();
+            }
+            ackQueue_ = std::move(remainingAcks);
+            
+            // Move sessions whose resume requests are ready
+            std::queue<packets::TimestampedResumeRequestPacket> remainingResumes;
+            while (!resumeQueue_.empty()) {
+                if (currentTime >= resumeQueue_.front().timestamp) {
+                    handleResumeRequest(resumeQueue_.front().resume_request, resumeQueue_.front().clientAddr);
+                } else {
+                    remainingResumes.push(resumeQueue_.front());
+                }
+                resumeQueue_.pop();
+            }
+            resumeQueue_ = std::move(remainingResumes);
         }
+        
+        expireSessions();
+        
+        // Send changed entities, resends and heartbeats
+        flushReplication();
+        sendPacedStates();
+        sendStateChecksums();
+        updateSpectatorStream();
 
         // Receive new data from clients
         memset(buffer, 0, BUFFER_SIZE);
@@ -252,7 +316,33 @@ void Server::processNetworkEvents() {
                                      (struct sockaddr*)&clientAddr, &clientLen);
                                      
         if (bytesReceived > 0) {
-            if (bytesReceived >= sizeof(packets::TimestampedPlayerMovementRequest)) {
+            if (bytesReceived == sizeof(packets::RelayUplinkPacket)) {
+                // A relay forwards the inputs of all its clients over one flow
+                packets::RelayUplinkPacket uplink;
+                memcpy(&uplink, buffer, sizeof(uplink));
+                
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                uint32_t count = std::min(uplink.count, packets::MAX_RELAY_BATCH);
+                for (uint32_t i = 0; i < count; ++i) {
+                    uplink.inputs[i].clientAddr = clientAddr;
+                    packetQueue_.push(uplink.inputs[i]);
+                }
+            } else if (bytesReceived == sizeof(packets::TimestampedStateAckPacket)) {
+                packets::TimestampedStateAckPacket timestampedAck;
+                memcpy(&timestampedAck, buffer, sizeof(timestampedAck));
+                
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                ackQueue_.push(timestampedAck);
+            } else if (bytesReceived == sizeof(packets::TimestampedResumeRequestPacket)) {
+                packets::TimestampedResumeRequestPacket timestampedResume;
+                memcpy(&timestampedResume, buffer, sizeof(timestampedResume));
+                
+                // The session moves to wherever the request came from
+                timestampedResume.clientAddr = clientAddr;
+                
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                resumeQueue_.push(timestampedResume);
+            } else if (bytesReceived >= sizeof(packets::TimestampedPlayerMovementRequest)) {
                 packets::TimestampedPlayerMovementRequest timestampedRequest;
                 memcpy(&timestampedRequest, buffer, sizeof(timestampedRequest));
                 
@@ -273,60 +363,473 @@ void Server::processNetworkEvents() {
 }
 
 void Server::handleClientRequest(const sockaddr_in& clientAddr, const packets::PlayerMovementRequest& request) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    
+    // With buffering the input waits for its tick
+    if (inputBufferConfig_.enabled) {
+        bufferInput(request);
+        return;
+    }
+    
     // Process player movement request
-    updatePlayerState(request);
+    applyInput(request);
 }
 
-void Server::broadcastPlayerState(uint32_t playerId, float x, float y, float z, bool isJumping, uint32_t sequenceNumber, bool wasPredicted) {
-    // Check if enough time has passed since last broadcast for this player
+void Server::bufferInput(const packets::PlayerMovementRequest& request) {
+    if (players_.find(request.player_id) == players_.end()) {
+        LOG_WARNING("Received input for unknown player ID: " + std::to_string(request.player_id), "Server");
+        return;
+    }
+    if (request.input_sequence_number <= lastProcessedInputSequence_[request.player_id]) {
+        return;
+    }
+    
+    // Ordered by sequence, a duplicate replaces the waiting copy
+    InputBuffer& buffer = inputBuffers_[request.player_id];
+    buffer.inputs[request.input_sequence_number] = request;
+    buffer.lastArrival = std::chrono::steady_clock::now();
+    inputBufferStats_.inputsBuffered++;
+    
+    // The stream went on, so the ticks that ran dry meanwhile were waiting for this input
+    buffer.underruns += buffer.dryTicks;
+    inputBufferStats_.underruns += buffer.dryTicks;
+    buffer.dryTicks = 0;
+}
+
+void Server::applyBufferedInputs() {
+    serverTick_++;
+    inputBufferStats_.ticks++;
     auto now = std::chrono::steady_clock::now();
-    auto it = lastBroadcastTimes_.find(playerId);
     
-    if (it != lastBroadcastTimes_.end()) {
-        auto timeSinceLastBroadcast = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second).count();
-        if (timeSinceLastBroadcast < MIN_BROADCAST_INTERVAL_MS) {
-            // Too soon since last broadcast, skip this one
-            return;
+    for (auto& [playerId, buffer] : inputBuffers_) {
+        if (buffer.inputs.empty()) {
+            // Clients only send while keys are held; whether a dry tick was an underrun or the
+            // player stopped is only known once the next input arrives or the stream stays silent
+            if (!StateReplicator::isInputReleased(buffer.lastArrival, now)) {
+                buffer.dryTicks++;
+            } else {
+                buffer.dryTicks = 0;
+            }
+            
+            // The player sent nothing for this tick, so it stands still during it
+            auto player = players_.find(playerId);
+            if (player != players_.end()) {
+                releaseHeldInput(playerId, *player->second);
+            }
         }
+        
+        // One input per tick, more while the buffer is deeper than allowed
+        bool first = true;
+        while (!buffer.inputs.empty() && (first || buffer.inputs.size() > inputBufferConfig_.maxDepth)) {
+            if (!first) {
+                buffer.catchUpInputs++;
+                inputBufferStats_.catchUpInputs++;
+            }
+            applyInput(buffer.inputs.begin()->second);
+            buffer.inputs.erase(buffer.inputs.begin());
+            inputBufferStats_.inputsApplied++;
+            first = false;
+        }
+        
+        auto client = clientAddresses_.find(playerId);
+        if (client == clientAddresses_.end()) {
+            continue;
+        }
+        
+        packets::TimestampedInputAckPacket timestampedAck{};
+        timestampedAck.timestamp = now +
+            std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+        timestampedAck.input_ack.player_id = playerId;
+        timestampedAck.input_ack.server_tick = serverTick_;
+        timestampedAck.input_ack.last_processed_input_sequence = lastProcessedInputSequence_[playerId];
+        timestampedAck.input_ack.buffer_depth = static_cast<uint32_t>(buffer.inputs.size());
+        timestampedAck.input_ack.underruns = buffer.underruns;
+        timestampedAck.input_ack.catch_up_inputs = buffer.catchUpInputs;
+        timestampedAck.input_ack.max_depth = inputBufferConfig_.maxDepth;
+        sendto(socketFd_, &timestampedAck, sizeof(timestampedAck), 0,
+               (struct sockaddr*)&client->second, sizeof(client->second));
+    }
+}
+
+void Server::releaseHeldInput(uint32_t playerId, NetworkedEntity& player) {
+    auto input = lastInputMovement_.find(playerId);
+    if (input != lastInputMovement_.end() && StateReplicator::releaseHeldInput(player, input->second)) {
+        broadcastPlayerState(playerId, player, lastProcessedInputSequence_[playerId], false);
+    }
+}
+
+void Server::setInputBuffering(const InputBufferConfig& config) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    inputBufferConfig_ = config;
+    if (!config.enabled) {
+        // Inputs still waiting are applied rather than lost
+        for (auto& [playerId, buffer] : inputBuffers_) {
+            for (const auto& [sequence, request] : buffer.inputs) {
+                applyInput(request);
+            }
+        }
+        inputBuffers_.clear();
     }
+}
+
+InputBufferStats Server::getInputBufferStats() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return inputBufferStats_;
+}
+
+packets::PlayerStatePacket Server::makeStatePacket(uint32_t playerId, const NetworkedEntity& player, uint32_t sequenceNumber, bool wasPredicted) const {
+    auto input = lastInputMovement_.find(playerId);
+    netcode::math::MyVec3 heldInput = input != lastInputMovement_.end() ? input->second : netcode::math::MyVec3();
     
-    // Update last broadcast time
-    lastBroadcastTimes_[playerId] = now;
+    packets::PlayerStatePacket packet = StateReplicator::makeStatePacket(playerId, player, heldInput, sequenceNumber, wasPredicted);
+    packet.state_sequence = replicator_.getStateSequence(playerId);
+    return packet;
+}
+
+void Server::broadcastPlayerState(uint32_t playerId, const NetworkedEntity& player, uint32_t sequenceNumber, bool wasPredicted) {
+    packets::PlayerStatePacket packet = makeStatePacket(playerId, player, sequenceNumber, wasPredicted);
+    if (!replicator_.update(packet)) {
+        // Nothing new to replicate, resends and heartbeats are up to flushReplication()
+        return;
+    }
+    stateEvents_.publish(packet);
     
-    packets::PlayerStatePacket packet;
-    packet.player_id = playerId;
-    packet.x = x;
-    packet.y = y;
-    packet.z = z;
-    packet.velocity_y = 0.0f;
-    packet.is_jumping = isJumping;
-    packet.last_processed_input_sequence = sequenceNumber; // Include the sequence number
-    packet.wasPredicted = wasPredicted; // Echo back the prediction flag
+    // Send update to all known clients, unless the throttle holds it back for flushReplication()
+    replicator_.sendChange(playerId, std::chrono::steady_clock::now(), destinations_, outboundPacer_);
     
-    // Create timestamped packet
+    LOG_DEBUG("Replicated player " + std::to_string(playerId) + " state to " + 
+              std::to_string(clientAddresses_.size()) + " clients with sequence " +
+              std::to_string(sequenceNumber), "Server");
+}
+
+void Server::sendStatePacket(const sockaddr_in& clientAddr, const packets::PlayerStatePacket& packet) {
+    outboundPacer_.enqueue(clientAddr, packet, std::chrono::steady_clock::now());
+}
+
+void Server::sendPacedStates() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    for (const auto& outgoing : outboundPacer_.release(std::chrono::steady_clock::now())) {
+        writeStatePacket(outgoing.destination, outgoing.state);
+    }
+}
+
+void Server::writeStatePacket(const sockaddr_in& clientAddr, const packets::PlayerStatePacket& packet) {
+    // Create timestamped packet, stamped when it actually leaves
     packets::TimestampedPlayerStatePacket timestampedPacket;
     timestampedPacket.timestamp = std::chrono::steady_clock::now() + 
         std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
     timestampedPacket.player_state = packet;
     
-    // Send update to all known clients
-    for (const auto& client : clientAddresses_) {
-        sendto(socketFd_, &timestampedPacket, sizeof(timestampedPacket), 0,
-               (struct sockaddr*)&client.second, sizeof(client.second));
+    sendto(socketFd_, &timestampedPacket, sizeof(timestampedPacket), 0,
+           (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+}
+
+void Server::sendStateChecksums() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    if (clientAddresses_.empty()) {
+        return;
     }
     
-    LOG_DEBUG("Broadcast player " + std::to_string(playerId) + " state to " + 
-              std::to_string(clientAddresses_.size()) + " clients with sequence " +
-              std::to_string(sequenceNumber), "Server");
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& checksum : replicator_.takeChecksums(now)) {
+        packets::TimestampedStateChecksumPacket timestampedChecksum;
+        timestampedChecksum.timestamp = now + 
+            std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+        timestampedChecksum.checksum = checksum;
+        
+        for (const auto& destination : destinations_) {
+            sendto(socketFd_, &timestampedChecksum, sizeof(timestampedChecksum), 0,
+                   (struct sockaddr*)&destination, sizeof(destination));
+        }
+    }
+}
+
+void Server::enableSpectatorStream(const SpectatorStreamConfig& config) {
+    if (running_) {
+        LOG_WARNING("Spectator stream must be enabled before the server starts", "Server");
+        return;
+    }
+    spectatorConfig_ = config;
+    spectatorStream_ = std::make_unique<SpectatorStream>(config);
+    spectatorFanout_ = std::make_unique<SpectatorFanout>(config.subscriberTimeoutMs);
+}
+
+size_t Server::getSpectatorCount() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return spectatorFanout_ ? spectatorFanout_->getSubscriberCount() : 0;
+}
+
+void Server::updateSpectatorStream() {
+    if (!spectatorStream_ || spectatorSocketFd_ == -1) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    
+    // Take in subscriptions, new subscribers start from the latest released keyframe
+    packets::SpectatorSubscribePacket subscription;
+    sockaddr_in spectatorAddr;
+    socklen_t spectatorLen = sizeof(spectatorAddr);
+    ssize_t bytesReceived;
+    while ((bytesReceived = recvfrom(spectatorSocketFd_, &subscription, sizeof(subscription), 0,
+                                     (struct sockaddr*)&spectatorAddr, &spectatorLen)) > 0) {
+        if (bytesReceived == sizeof(subscription) &&
+            spectatorFanout_->handleSubscription(spectatorAddr, subscription)) {
+            spectatorFanout_->sendTo(spectatorSocketFd_, spectatorAddr, spectatorStream_->getCatchUpFrames());
+        }
+        spectatorLen = sizeof(spectatorAddr);
+    }
+    spectatorFanout_->expireSubscribers();
+    
+    auto now = std::chrono::steady_clock::now();
+    if (spectatorStream_->isCaptureDue(now)) {
+        // Everything replicated so far, players and props, plus players that never moved
+        std::vector<packets::PlayerStatePacket> states = replicator_.getLatestStates();
+        for (const auto& [playerId, player] : players_) {
+            if (!replicator_.contains(playerId)) {
+                states.push_back(makeStatePacket(playerId, *player, 0, false));
+            }
+        }
+        spectatorStream_->capture(states, now);
+    }
+    
+    spectatorFanout_->send(spectatorSocketFd_, spectatorStream_->releaseFrames(now));
+}
+
+void Server::handleStateAck(const packets::StateAckPacket& ack) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    
+    // Acks double as keepalives of idle clients
+    auto session = sessions_.find(ack.player_id);
+    if (session != sessions_.end()) {
+        session->second.lastHeard = std::chrono::steady_clock::now();
+    }
+    
+    replicator_.acknowledge(ack);
+}
+
+utils::EventBus<packets::PlayerStatePacket>::Subscriber Server::subscribeStateChanges() const {
+    return stateEvents_.subscribe();
+}
+
+void Server::setOutboundPacing(const OutboundPacerConfig& config) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    outboundPacer_.setConfig(config);
+}
+
+OutboundPacerStats Server::getOutboundStats() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return outboundPacer_.getStats();
+}
+
+void Server::setSessionGracePeriod(uint32_t gracePeriodMs) {
+    sessionGracePeriodMs_ = gracePeriodMs;
+}
+
+size_t Server::getSessionCount() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return sessions_.size();
+}
+
+void Server::openSession(uint32_t playerId, const sockaddr_in& clientAddr) {
+    Session& session = sessions_[playerId];
+    session.token = 0;
+    while (session.token == 0) {
+        // Zero marks a rejected resume; the token must not be predictable from other players' tokens
+        if (!utils::fill_secure_random(&session.token, sizeof(session.token))) {
+            LOG_ERROR("No secure random source, player " + std::to_string(playerId) + " cannot resume its session", "Server");
+            session.token = 0;
+            break;
+        }
+    }
+    session.lastHeard = std::chrono::steady_clock::now();
+    
+    packets::TimestampedSessionPacket timestampedSession{};
+    timestampedSession.timestamp = session.lastHeard +
+        std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+    timestampedSession.session.player_id = playerId;
+    timestampedSession.session.grace_period_ms = sessionGracePeriodMs_;
+    timestampedSession.session.token = session.token;
+    timestampedSession.session.last_processed_input_sequence = lastProcessedInputSequence_[playerId];
+    timestampedSession.session.resumed = false;
+    
+    sendto(socketFd_, &timestampedSession, sizeof(timestampedSession), 0,
+           (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+}
+
+void Server::handleResumeRequest(const packets::ResumeRequestPacket& request, const sockaddr_in& clientAddr) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    auto now = std::chrono::steady_clock::now();
+    
+    packets::TimestampedSessionPacket timestampedSession{};
+    timestampedSession.timestamp = now +
+        std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+    timestampedSession.session.player_id = request.player_id;
+    timestampedSession.session.grace_period_ms = sessionGracePeriodMs_;
+    
+    auto session = sessions_.find(request.player_id);
+    if (session == sessions_.end() || request.token == 0 ||
+        !utils::constant_time_equals(&session->second.token, &request.token, sizeof(request.token))) {
+        // Unknown, expired or forged; the token stays zero and the client registers again
+        sendto(socketFd_, &timestampedSession, sizeof(timestampedSession), 0,
+               (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+        LOG_WARNING("Rejected session resume for player " + std::to_string(request.player_id), "Server");
+        return;
+    }
+    
+    session->second.lastHeard = now;
+    clientAddresses_[request.player_id] = clientAddr;
+    rebuildDestinations();
+    
+    // The client has to acknowledge everything again at its new address, so a lost catch-up is resent
+    replicator_.forgetClient(request.player_id);
+    
+    timestampedSession.session.token = session->second.token;
+    timestampedSession.session.last_processed_input_sequence = lastProcessedInputSequence_[request.player_id];
+    timestampedSession.session.resumed = true;
+    sendto(socketFd_, &timestampedSession, sizeof(timestampedSession), 0,
+           (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    sendCatchUp(request.player_id, clientAddr);
+    
+    LOG_INFO("Player " + std::to_string(request.player_id) + " resumed its session from port " +
+             std::to_string(ntohs(clientAddr.sin_port)), "Server");
+}
+
+void Server::sendCatchUp(uint32_t playerId, const sockaddr_in& clientAddr) {
+    // Replicated entities plus players that never changed since they joined
+    std::vector<packets::PlayerStatePacket> states = replicator_.getLatestStates();
+    for (const auto& [id, player] : players_) {
+        if (!replicator_.contains(id)) {
+            states.push_back(makeStatePacket(id, *player, lastProcessedInputSequence_[id], false));
+        }
+    }
+    
+    uint32_t partCount = static_cast<uint32_t>(
+        (states.size() + packets::MAX_CATCH_UP_ENTRIES - 1) / packets::MAX_CATCH_UP_ENTRIES);
+    for (uint32_t part = 0; part < partCount; ++part) {
+        packets::TimestampedCatchUpPacket timestampedCatchUp{};
+        timestampedCatchUp.timestamp = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+        
+        auto& catchUp = timestampedCatchUp.catch_up;
+        catchUp.player_id = playerId;
+        catchUp.part = part;
+        catchUp.part_count = partCount;
+        for (size_t i = part * packets::MAX_CATCH_UP_ENTRIES;
+             i < states.size() && catchUp.count < packets::MAX_CATCH_UP_ENTRIES; ++i) {
+            catchUp.entries[catchUp.count++] = states[i];
+        }
+        
+        sendto(socketFd_, &timestampedCatchUp, sizeof(timestampedCatchUp), 0,
+               (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    }
+}
+
+void Server::expireSessions() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    auto now = std::chrono::steady_clock::now();
+    
+    bool expired = false;
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        auto silence = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.lastHeard).count();
+        if (silence <= sessionGracePeriodMs_) {
+            ++it;
+            continue;
+        }
+        
+        uint32_t playerId = it->first;
+        
+        // A zero token tells the client, or the relay it sits behind, that the session is gone
+        auto client = clientAddresses_.find(playerId);
+        if (client != clientAddresses_.end()) {
+            packets::TimestampedSessionPacket timestampedSession{};
+            timestampedSession.timestamp = now +
+                std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+            timestampedSession.session.player_id = playerId;
+            timestampedSession.session.grace_period_ms = sessionGracePeriodMs_;
+            sendto(socketFd_, &timestampedSession, sizeof(timestampedSession), 0,
+                   (struct sockaddr*)&client->second, sizeof(client->second));
+        }
+        clientAddresses_.erase(playerId);
+        inputBuffers_.erase(playerId);
+        replicator_.forgetClient(playerId);
+        it = sessions_.erase(it);
+        expired = true;
+        LOG_INFO("Session of player " + std::to_string(playerId) + " expired", "Server");
+    }
+    
+    if (expired) {
+        rebuildDestinations();
+    }
+}
+
+void Server::rebuildDestinations() {
+    destinations_.clear();
+    for (const auto& client : clientAddresses_) {
+        if (!utils::contains_address(destinations_, client.second)) {
+            destinations_.push_back(client.second);
+        }
+    }
+}
+
+void Server::flushReplication() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    replicator_.flush(std::chrono::steady_clock::now(), clientAddresses_, destinations_, outboundPacer_);
 }
 
 void Server::updateEntities(float deltaTime) {
     std::lock_guard<std::mutex> lock(playerMutex_);
     
+    if (inputBufferConfig_.enabled) {
+        applyBufferedInputs();
+    }
+    
+    // Players whose keys were released send nothing, stop predicting them as moving
+    auto now = std::chrono::steady_clock::now();
+    for (auto& [playerId, player] : players_) {
+        auto lastInput = lastInputTime_.find(playerId);
+        if (lastInput != lastInputTime_.end() && StateReplicator::isInputReleased(lastInput->second, now)) {
+            releaseHeldInput(playerId, *player);
+        }
+    }
+    
+    // Step the props, players push them around
+    std::vector<netcode::math::MyVec3> playerPositions;
+    playerPositions.reserve(players_.size());
+    for (const auto& [playerId, player] : players_) {
+        playerPositions.push_back(player->getPosition());
+    }
+    props_.update(deltaTime, playerPositions);
+    
+    // Replicate the most important changed props, the rest wait for a later tick
+    for (const auto& prop : props_.selectForReplication()) {
+        broadcastPlayerState(prop->getId(), *prop, 0, false);
+        replicator_.setSleeping(prop->getId(), prop->isSleeping());
+    }
+    
     // Update render positions for all entities
     for (auto& [playerId, player] : players_) {
         player->updateRenderPosition(deltaTime);
     }
+    props_.updateRenderPositions(deltaTime);
+}
+
+void Server::addProp(std::shared_ptr<Prop> prop) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    if (players_.count(prop->getId())) {
+        LOG_ERROR("Prop ID " + std::to_string(prop->getId()) + " is already used by a player", "Server");
+        return;
+    }
+    props_.addProp(prop);
+}
+
+void Server::setPropWorldConfig(const PropWorldConfig& config) {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    props_.setConfig(config);
+}
+
+PropWorldStats Server::getPropStats() {
+    std::lock_guard<std::mutex> lock(playerMutex_);
+    return props_.getStats();
 }
 
 } // namespace netcode
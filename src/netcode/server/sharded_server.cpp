@@ -0,0 +1,524 @@
+#include "netcode/server/sharded_server.hpp"
+#include "netcode/server/outbound_pacer.hpp"
+#include "netcode/server/state_replicator.hpp"
+#include "netcode/utils/logger.hpp"
+#include "netcode/utils/spsc_queue.hpp"
+#include "netcode/utils/tick_scheduler.hpp"
+#include "netcode/utils/udp_socket.hpp"
+#include <unistd.h>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <thread>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
+
+namespace netcode {
+
+/**
+ * @brief State owned by a single shard thread
+ */
+struct ShardedServer::Shard {
+    using RequestMailbox = utils::SpscQueue<packets::TimestampedPlayerMovementRequest>;
+    using AckMailbox = utils::SpscQueue<packets::TimestampedStateAckPacket>;
+    using StateMailbox = utils::SpscQueue<std::vector<packets::PlayerStatePacket>>;
+
+    uint32_t index = 0;
+    int socketFd = -1;
+    std::thread thread;
+
+    // Sessions and entities owned by this shard
+    std::map<uint32_t, std::shared_ptr<NetworkedEntity>> players;
+    std::map<uint32_t, uint32_t> lastProcessedInputSequence;
+    std::map<uint32_t, netcode::math::MyVec3> lastInputMovement;
+    std::map<uint32_t, bool> lastWasPredicted;
+    std::map<uint32_t, std::chrono::steady_clock::time_point> lastInputTime;
+    std::unordered_map<uint32_t, sockaddr_in> sessions;
+    std::unordered_map<uint32_t, std::chrono::steady_clock::time_point> lastHeard;
+    std::vector<sockaddr_in> destinations;
+    std::vector<uint32_t> newSessions;
+
+    // Replication of owned entities and of the entities other shards published to this shard's clients
+    StateReplicator replicator;
+    OutboundPacer pacer;
+
+    // Inputs and acknowledgements waiting for their simulated delivery time
+    std::deque<packets::TimestampedPlayerMovementRequest> pendingRequests;
+    std::deque<packets::TimestampedStateAckPacket> pendingAcks;
+
+    // Mailboxes from every other shard, indexed by the sending shard
+    std::vector<std::unique_ptr<RequestMailbox>> requestInbox;
+    std::vector<std::unique_ptr<AckMailbox>> ackInbox;
+    std::vector<std::unique_ptr<StateMailbox>> stateInbox;
+
+    // Changes that did not fit into another shard's mailbox yet, indexed by the receiving shard
+    std::vector<std::vector<packets::PlayerStatePacket>> stateOutbox;
+
+    std::atomic<uint64_t> packetsReceived{0};
+    std::atomic<uint64_t> packetsForwarded{0};
+    std::atomic<uint64_t> inputsProcessed{0};
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> sessionsExpired{0};
+    std::atomic<uint64_t> tickOverruns{0};
+};
+
+ShardedServer::ShardedServer(int port, const ShardedServerConfig& config, std::shared_ptr<ISettings> settings)
+    : port_(port), config_(config), settings_(settings), running_(false) {
+    if (config_.shardCount == 0) {
+        LOG_WARNING("Shard count of 0 requested, using a single shard", "ShardedServer");
+        config_.shardCount = 1;
+    }
+
+    for (uint32_t i = 0; i < config_.shardCount; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        shard->requestInbox.resize(config_.shardCount);
+        shard->ackInbox.resize(config_.shardCount);
+        shard->stateInbox.resize(config_.shardCount);
+        shard->stateOutbox.resize(config_.shardCount);
+        shard->pacer.setConfig(config_.pacing);
+        for (uint32_t sender = 0; sender < config_.shardCount; ++sender) {
+            if (sender == i) {
+                continue;
+            }
+            shard->requestInbox[sender] = std::make_unique<Shard::RequestMailbox>(config_.mailboxCapacity);
+            shard->ackInbox[sender] = std::make_unique<Shard::AckMailbox>(config_.mailboxCapacity);
+            shard->stateInbox[sender] = std::make_unique<Shard::StateMailbox>(config_.mailboxCapacity);
+        }
+        shards_.push_back(std::move(shard));
+    }
+
+    LOG_INFO("Sharded server created on port " + std::to_string(port_) + " with " +
+             std::to_string(config_.shardCount) + " shards", "ShardedServer");
+}
+
+ShardedServer::~ShardedServer() {
+    stop();
+}
+
+void ShardedServer::start() {
+    if (running_) {
+        LOG_WARNING("Sharded server already running", "ShardedServer");
+        return;
+    }
+
+    // Every shard binds its own socket to the shared port
+    for (auto& shard : shards_) {
+        shard->socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (shard->socketFd < 0) {
+            LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "ShardedServer");
+            stop();
+            return;
+        }
+
+        int enable = 1;
+        if (setsockopt(shard->socketFd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+            LOG_ERROR("Failed to enable SO_REUSEPORT: " + std::string(strerror(errno)), "ShardedServer");
+            stop();
+            return;
+        }
+
+        int flags = fcntl(shard->socketFd, F_GETFL, 0);
+        fcntl(shard->socketFd, F_SETFL, flags | O_NONBLOCK);
+
+        sockaddr_in serverAddr;
+        memset(&serverAddr, 0, sizeof(serverAddr));
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_addr.s_addr = INADDR_ANY;
+        serverAddr.sin_port = htons(port_);
+
+        if (bind(shard->socketFd, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+            LOG_ERROR("Failed to bind shard socket: " + std::string(strerror(errno)), "ShardedServer");
+            stop();
+            return;
+        }
+    }
+
+    // Sockets join the reuseport group in bind order, so the program can return the shard index
+    kernelSteering_ = attachSteeringProgram(shards_.front()->socketFd);
+    if (!kernelSteering_) {
+        LOG_WARNING("Kernel steering unavailable, packets for other shards are forwarded", "ShardedServer");
+    }
+
+    running_ = true;
+    for (auto& shard : shards_) {
+        Shard& shardRef = *shard;
+        shard->thread = std::thread([this, &shardRef]() { runShard(shardRef); });
+    }
+
+    LOG_INFO("Sharded server started on port " + std::to_string(port_), "ShardedServer");
+}
+
+void ShardedServer::stop() {
+    running_ = false;
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+        if (shard->socketFd != -1) {
+            close(shard->socketFd);
+            shard->socketFd = -1;
+        }
+    }
+}
+
+void ShardedServer::setPlayerReference(uint32_t playerId, std::shared_ptr<NetworkedEntity> player) {
+    if (running_) {
+        LOG_WARNING("Player references must be set before the sharded server starts", "ShardedServer");
+        return;
+    }
+
+    Shard& shard = *shards_[shardForPlayer(playerId)];
+    shard.players[playerId] = player;
+    shard.lastProcessedInputSequence[playerId] = 0;
+    LOG_INFO("Set player reference for ID: " + std::to_string(playerId) + " on shard " +
+             std::to_string(shard.index), "ShardedServer");
+}
+
+ShardStats ShardedServer::getShardStats(uint32_t shardIndex) const {
+    ShardStats stats;
+    if (shardIndex >= shards_.size()) {
+        return stats;
+    }
+    const Shard& shard = *shards_[shardIndex];
+    stats.packetsReceived = shard.packetsReceived.load(std::memory_order_relaxed);
+    stats.packetsForwarded = shard.packetsForwarded.load(std::memory_order_relaxed);
+    stats.inputsProcessed = shard.inputsProcessed.load(std::memory_order_relaxed);
+    stats.ticks = shard.ticks.load(std::memory_order_relaxed);
+    stats.sessionsExpired = shard.sessionsExpired.load(std::memory_order_relaxed);
+    stats.tickOverruns = shard.tickOverruns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ShardedServer::attachSteeringProgram(int socketFd) {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    // The program sees the UDP payload. Movement requests and acks both start with an
+    // 8 byte timestamp followed by the little endian player ID; select socket id % shards.
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 11),
+        BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 8),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 10),
+        BPF_STMT(BPF_ALU | BPF_OR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 8),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 9),
+        BPF_STMT(BPF_ALU | BPF_OR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 8),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 8),
+        BPF_STMT(BPF_ALU | BPF_OR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, config_.shardCount),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog program;
+    program.len = sizeof(code) / sizeof(code[0]);
+    program.filter = code;
+
+    if (setsockopt(socketFd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) < 0) {
+        LOG_WARNING("Failed to attach reuseport program: " + std::string(strerror(errno)), "ShardedServer");
+        return false;
+    }
+    return true;
+#else
+    (void)socketFd;
+    return false;
+#endif
+}
+
+void ShardedServer::runShard(Shard& shard) {
+    // A tick missed while the thread was descheduled is dropped, not caught up on
+    utils::TickSchedulerConfig schedulerConfig;
+    schedulerConfig.tick_rate = config_.tickRate;
+    schedulerConfig.overrun_policy = utils::OverrunPolicy::SKIP;
+    utils::TickScheduler scheduler(schedulerConfig);
+    scheduler.start();
+
+    while (running_) {
+        // Wait for packets until the next tick is due, or the next paced states while any are queued;
+        // the scheduler sleeps the last fraction of a millisecond precisely
+        auto remaining = scheduler.next_deadline() - std::chrono::steady_clock::now();
+        if (remaining >= std::chrono::milliseconds(1)) {
+            int timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count());
+            if (shard.pacer.getBacklog() > 0) {
+                timeoutMs = 1;
+            }
+            pollfd pfd{shard.socketFd, POLLIN, 0};
+            if (poll(&pfd, 1, timeoutMs) > 0) {
+                receivePackets(shard);
+            }
+            sendPacedStates(shard);
+            continue;
+        }
+
+        scheduler.wait_next_tick();
+        receivePackets(shard);
+        tickShard(shard);
+        sendPacedStates(shard);
+        shard.tickOverruns.store(scheduler.stats().overruns, std::memory_order_relaxed);
+    }
+}
+
+void ShardedServer::receivePackets(Shard& shard) {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+    sockaddr_in clientAddr;
+
+    while (true) {
+        socklen_t clientLen = sizeof(clientAddr);
+        ssize_t bytesReceived = recvfrom(shard.socketFd, buffer, BUFFER_SIZE, 0,
+                                         (struct sockaddr*)&clientAddr, &clientLen);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "ShardedServer");
+            }
+            return;
+        }
+        shard.packetsReceived.fetch_add(1, std::memory_order_relaxed);
+
+        if (bytesReceived == sizeof(packets::TimestampedStateAckPacket)) {
+            packets::TimestampedStateAckPacket timestampedAck;
+            memcpy(&timestampedAck, buffer, sizeof(timestampedAck));
+
+            // Acknowledgements belong to the shard that owns the client's session
+            uint32_t owner = shardForPlayer(timestampedAck.state_ack.player_id);
+            if (owner == shard.index) {
+                shard.pendingAcks.push_back(timestampedAck);
+            } else if (shards_[owner]->ackInbox[shard.index]->try_push(std::move(timestampedAck))) {
+                shard.packetsForwarded.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                LOG_WARNING("Mailbox to shard " + std::to_string(owner) + " full, dropping acknowledgement", "ShardedServer");
+            }
+            continue;
+        }
+
+        if (bytesReceived != sizeof(packets::TimestampedPlayerMovementRequest)) {
+            continue;
+        }
+
+        packets::TimestampedPlayerMovementRequest timestampedRequest;
+        memcpy(&timestampedRequest, buffer, sizeof(timestampedRequest));
+        timestampedRequest.clientAddr = clientAddr;
+
+        uint32_t owner = shardForPlayer(timestampedRequest.player_movement_request.player_id);
+        if (owner == shard.index) {
+            shard.pendingRequests.push_back(timestampedRequest);
+            continue;
+        }
+
+        // Landed on the wrong shard, hand it to the owner
+        if (shards_[owner]->requestInbox[shard.index]->try_push(std::move(timestampedRequest))) {
+            shard.packetsForwarded.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            LOG_WARNING("Mailbox to shard " + std::to_string(owner) + " full, dropping input", "ShardedServer");
+        }
+    }
+}
+
+void ShardedServer::tickShard(Shard& shard) {
+    auto now = std::chrono::steady_clock::now();
+    shard.ticks.fetch_add(1, std::memory_order_relaxed);
+
+    // Collect inputs and acknowledgements other shards received for our sessions
+    packets::TimestampedPlayerMovementRequest forwarded;
+    for (auto& inbox : shard.requestInbox) {
+        while (inbox && inbox->try_pop(forwarded)) {
+            shard.pendingRequests.push_back(forwarded);
+        }
+    }
+    packets::TimestampedStateAckPacket forwardedAck;
+    for (auto& inbox : shard.ackInbox) {
+        while (inbox && inbox->try_pop(forwardedAck)) {
+            shard.pendingAcks.push_back(forwardedAck);
+        }
+    }
+
+    // Apply inputs that have reached their delivery time
+    std::deque<packets::TimestampedPlayerMovementRequest> remaining;
+    for (const auto& timestampedRequest : shard.pendingRequests) {
+        if (now < timestampedRequest.timestamp) {
+            remaining.push_back(timestampedRequest);
+            continue;
+        }
+
+        const auto& request = timestampedRequest.player_movement_request;
+        if (shard.sessions.find(request.player_id) == shard.sessions.end()) {
+            shard.sessions[request.player_id] = timestampedRequest.clientAddr;
+            shard.newSessions.push_back(request.player_id);
+            if (!utils::contains_address(shard.destinations, timestampedRequest.clientAddr)) {
+                shard.destinations.push_back(timestampedRequest.clientAddr);
+            }
+            LOG_INFO("Shard " + std::to_string(shard.index) + " registered client " +
+                     std::to_string(request.player_id), "ShardedServer");
+        }
+        shard.lastHeard[request.player_id] = now;
+
+        auto it = shard.players.find(request.player_id);
+        if (it == shard.players.end() ||
+            request.input_sequence_number <= shard.lastProcessedInputSequence[request.player_id]) {
+            continue;
+        }
+        shard.lastProcessedInputSequence[request.player_id] = request.input_sequence_number;
+
+        netcode::math::MyVec3 movement = {request.movement_x, request.movement_y, request.movement_z};
+        it->second->move(movement);
+        shard.lastInputMovement[request.player_id] = movement;
+        shard.lastInputTime[request.player_id] = now;
+        shard.lastWasPredicted[request.player_id] = request.wasPredicted;
+        if (request.is_jumping) {
+            it->second->jump();
+        }
+        it->second->update();
+        shard.inputsProcessed.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.pendingRequests = std::move(remaining);
+
+    // Apply acknowledgements that have reached their delivery time, they double as keepalives
+    std::deque<packets::TimestampedStateAckPacket> remainingAcks;
+    for (const auto& timestampedAck : shard.pendingAcks) {
+        if (now < timestampedAck.timestamp) {
+            remainingAcks.push_back(timestampedAck);
+            continue;
+        }
+        uint32_t clientId = timestampedAck.state_ack.player_id;
+        if (shard.sessions.find(clientId) != shard.sessions.end()) {
+            shard.lastHeard[clientId] = now;
+            shard.replicator.acknowledge(timestampedAck.state_ack);
+        }
+    }
+    shard.pendingAcks = std::move(remainingAcks);
+
+    // Players whose keys were released send nothing, stop predicting them as moving
+    for (auto& [playerId, player] : shard.players) {
+        auto lastInput = shard.lastInputTime.find(playerId);
+        if (lastInput != shard.lastInputTime.end() && StateReplicator::isInputReleased(lastInput->second, now)) {
+            StateReplicator::releaseHeldInput(*player, shard.lastInputMovement[playerId]);
+        }
+    }
+
+    // Take over entity states other shards published, stamped by their owners
+    std::vector<packets::PlayerStatePacket> published;
+    for (auto& inbox : shard.stateInbox) {
+        while (inbox && inbox->try_pop(published)) {
+            for (const auto& state : published) {
+                shard.replicator.adopt(state);
+            }
+        }
+    }
+
+    // Find owned entities that changed since the last tick
+    std::vector<packets::PlayerStatePacket> ownChanges;
+    for (const auto& [playerId, player] : shard.players) {
+        packets::PlayerStatePacket packet = StateReplicator::makeStatePacket(
+            playerId, *player, shard.lastInputMovement[playerId],
+            shard.lastProcessedInputSequence[playerId], shard.lastWasPredicted[playerId]);
+        if (shard.replicator.update(packet)) {
+            ownChanges.push_back(packet);
+        }
+    }
+
+    // Publish our changes to every other shard, keeping what doesn't fit for the next tick
+    for (uint32_t target = 0; target < shards_.size(); ++target) {
+        if (target == shard.index) {
+            continue;
+        }
+        auto& outbox = shard.stateOutbox[target];
+        outbox.insert(outbox.end(), ownChanges.begin(), ownChanges.end());
+        if (!outbox.empty() && shards_[target]->stateInbox[shard.index]->try_push(std::move(outbox))) {
+            outbox.clear();
+        }
+    }
+
+    expireSessions(shard, now);
+
+    // New sessions get the whole known world once, resends cover what they don't acknowledge
+    for (uint32_t clientId : shard.newSessions) {
+        auto session = shard.sessions.find(clientId);
+        if (session == shard.sessions.end()) {
+            continue;
+        }
+        for (const auto& state : shard.replicator.getLatestStates()) {
+            shard.pacer.enqueue(session->second, state, now);
+        }
+    }
+    shard.newSessions.clear();
+
+    // Changes, resends to clients that have not acknowledged and heartbeats of dormant entities
+    shard.replicator.flush(now, shard.sessions, shard.destinations, shard.pacer);
+
+    if (!shard.sessions.empty()) {
+        for (const auto& checksum : shard.replicator.takeChecksums(now)) {
+            packets::TimestampedStateChecksumPacket timestampedChecksum;
+            timestampedChecksum.timestamp = now +
+                std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+            timestampedChecksum.checksum = checksum;
+            for (const auto& destination : shard.destinations) {
+                sendto(shard.socketFd, &timestampedChecksum, sizeof(timestampedChecksum), 0,
+                       (struct sockaddr*)&destination, sizeof(destination));
+            }
+        }
+    }
+}
+
+void ShardedServer::expireSessions(Shard& shard, std::chrono::steady_clock::time_point now) {
+    bool expired = false;
+    for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+        uint32_t clientId = it->first;
+        auto silence = std::chrono::duration_cast<std::chrono::milliseconds>(now - shard.lastHeard[clientId]).count();
+        if (silence <= config_.sessionTimeoutMs) {
+            ++it;
+            continue;
+        }
+
+        // The client registers again with its next input and then gets the whole world
+        shard.lastHeard.erase(clientId);
+        shard.replicator.forgetClient(clientId);
+        it = shard.sessions.erase(it);
+        expired = true;
+        shard.sessionsExpired.fetch_add(1, std::memory_order_relaxed);
+        LOG_INFO("Shard " + std::to_string(shard.index) + " expired the session of client " +
+                 std::to_string(clientId), "ShardedServer");
+    }
+    if (!expired) {
+        return;
+    }
+
+    // Several clients behind a relay share a destination, keep it while any of them is left
+    std::vector<sockaddr_in> destinations;
+    for (const auto& [clientId, clientAddr] : shard.sessions) {
+        if (!utils::contains_address(destinations, clientAddr)) {
+            destinations.push_back(clientAddr);
+        }
+    }
+    for (const auto& destination : shard.destinations) {
+        if (!utils::contains_address(destinations, destination)) {
+            shard.pacer.releaseAll(destination);
+        }
+    }
+    shard.destinations = std::move(destinations);
+}
+
+void ShardedServer::sendPacedStates(Shard& shard) {
+    for (const auto& outgoing : shard.pacer.release(std::chrono::steady_clock::now())) {
+        sendState(shard, outgoing.destination, outgoing.state);
+    }
+}
+
+void ShardedServer::sendState(Shard& shard, const sockaddr_in& clientAddr, const packets::PlayerStatePacket& packet) {
+    packets::TimestampedPlayerStatePacket timestampedPacket;
+    timestampedPacket.timestamp = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(settings_ ? settings_->getServerToClientDelay() : 50);
+    timestampedPacket.player_state = packet;
+
+    sendto(shard.socketFd, &timestampedPacket, sizeof(timestampedPacket), 0,
+           (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+}
+
+} // namespace netcode
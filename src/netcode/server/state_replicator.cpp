@@ -0,0 +1,240 @@
+#include "netcode/server/state_replicator.hpp"
+#include "netcode/utils/logger.hpp"
+#include "netcode/utils/state_hash.hpp"
+#include "netcode/utils/udp_socket.hpp"
+#include <algorithm>
+
+namespace netcode {
+
+packets::PlayerStatePacket StateReplicator::makeStatePacket(uint32_t entityId, const NetworkedEntity& entity,
+                                                            const netcode::math::MyVec3& input,
+                                                            uint32_t inputSequence, bool wasPredicted) {
+    auto pos = entity.getPosition();
+    auto velocity = entity.getVelocity();
+
+    packets::PlayerStatePacket packet{};
+    packet.player_id = entityId;
+    packet.x = pos.x;
+    packet.y = pos.y;
+    packet.z = pos.z;
+    packet.velocity_x = velocity.x;
+    packet.velocity_y = velocity.y;
+    packet.velocity_z = velocity.z;
+    packet.is_jumping = entity.isJumping();
+    packet.input_x = input.x;
+    packet.input_y = input.y;
+    packet.input_z = input.z;
+    packet.last_processed_input_sequence = inputSequence; // Include the sequence number
+    packet.wasPredicted = wasPredicted; // Echo back the prediction flag
+    return packet;
+}
+
+bool StateReplicator::releaseHeldInput(NetworkedEntity& player, netcode::math::MyVec3& heldInput) {
+    if (heldInput == netcode::math::MyVec3()) {
+        return false;
+    }
+    heldInput = netcode::math::MyVec3();
+
+    // Keep the position and any jump in progress, only the walking stops
+    auto velocity = player.getVelocity();
+    player.snapSimulationState(player.getPosition(), player.isJumping(), {0.0f, velocity.y, 0.0f});
+    return true;
+}
+
+bool StateReplicator::update(packets::PlayerStatePacket& packet) {
+    EntityState& entity = entities_[packet.player_id];
+
+    if (entity.latest.state_sequence != 0 && !utils::has_state_changed(entity.latest, packet)) {
+        // Nothing new to replicate, keep the acknowledgement fields current for resends and heartbeats
+        entity.latest.last_processed_input_sequence = packet.last_processed_input_sequence;
+        entity.latest.wasPredicted = packet.wasPredicted;
+        packet.state_sequence = entity.latest.state_sequence;
+        return false;
+    }
+
+    // The state changed, give it a new sequence so clients have to acknowledge it again
+    packet.state_sequence = entity.latest.state_sequence + 1;
+    replaceLatest(entity, packet);
+    return true;
+}
+
+bool StateReplicator::adopt(const packets::PlayerStatePacket& packet) {
+    EntityState& entity = entities_[packet.player_id];
+    if (packet.state_sequence <= entity.latest.state_sequence) {
+        return false;
+    }
+    replaceLatest(entity, packet);
+    return true;
+}
+
+void StateReplicator::replaceLatest(EntityState& entity, const packets::PlayerStatePacket& packet) {
+    entity.latest = packet;
+
+    // Swap the entity's old hash for the new one in the world checksum
+    worldChecksum_ ^= entity.hash;
+    entity.hash = utils::hash_entity_state(packet);
+    worldChecksum_ ^= entity.hash;
+    if (entity.dormant) {
+        entity.dormant = false;
+        LOG_DEBUG("Entity " + std::to_string(packet.player_id) + " woke up from dormancy", "Replication");
+    }
+}
+
+void StateReplicator::sendChange(uint32_t entityId, std::chrono::steady_clock::time_point now,
+                                 const std::vector<sockaddr_in>& destinations, OutboundPacer& pacer) {
+    auto it = entities_.find(entityId);
+    if (it == entities_.end()) {
+        return;
+    }
+    EntityState& entity = it->second;
+
+    // Too soon since the last send, flush() sends it once the interval has passed
+    auto timeSinceLastSend = std::chrono::duration_cast<std::chrono::milliseconds>(now - entity.lastSendTime).count();
+    if (entity.sentSequence != 0 && timeSinceLastSend < MIN_BROADCAST_INTERVAL_MS) {
+        return;
+    }
+
+    for (const auto& destination : destinations) {
+        pacer.enqueue(destination, entity.latest, now);
+    }
+    entity.sentSequence = entity.latest.state_sequence;
+    entity.lastSendTime = now;
+}
+
+void StateReplicator::flush(std::chrono::steady_clock::time_point now,
+                            const std::unordered_map<uint32_t, sockaddr_in>& clients,
+                            const std::vector<sockaddr_in>& destinations, OutboundPacer& pacer) {
+    for (auto& [entityId, entity] : entities_) {
+        const auto& packet = entity.latest;
+        auto timeSinceLastSend = std::chrono::duration_cast<std::chrono::milliseconds>(now - entity.lastSendTime).count();
+
+        // A change that was held back by the broadcast throttle
+        if (entity.sentSequence != packet.state_sequence) {
+            if (timeSinceLastSend < MIN_BROADCAST_INTERVAL_MS) {
+                continue;
+            }
+            for (const auto& destination : destinations) {
+                pacer.enqueue(destination, packet, now);
+            }
+            entity.sentSequence = packet.state_sequence;
+            entity.lastSendTime = now;
+            continue;
+        }
+
+        // Resend the latest state to clients that have not acknowledged it
+        bool allAcknowledged = true;
+        bool resend = timeSinceLastSend >= STATE_RESEND_INTERVAL_MS;
+        std::vector<sockaddr_in> resendTo;
+        for (const auto& client : clients) {
+            auto acked = entity.ackedSequences.find(client.first);
+            if (acked != entity.ackedSequences.end() && acked->second >= packet.state_sequence) {
+                continue;
+            }
+            allAcknowledged = false;
+            if (resend && !utils::contains_address(resendTo, client.second)) {
+                resendTo.push_back(client.second);
+            }
+        }
+        for (const auto& destination : resendTo) {
+            pacer.enqueue(destination, packet, now);
+        }
+
+        if (!allAcknowledged) {
+            entity.dormant = false;
+            if (resend) {
+                entity.lastSendTime = now;
+            }
+            continue;
+        }
+
+        // Every client has the latest state, only send heartbeats until it changes
+        if (!entity.dormant) {
+            entity.dormant = true;
+            LOG_DEBUG("Entity " + std::to_string(entityId) + " is dormant", "Replication");
+        }
+        if (!entity.sleeping && timeSinceLastSend >= DORMANT_HEARTBEAT_INTERVAL_MS) {
+            for (const auto& destination : destinations) {
+                pacer.enqueue(destination, packet, now);
+            }
+            entity.lastSendTime = now;
+        }
+    }
+}
+
+std::vector<packets::StateChecksumPacket> StateReplicator::takeChecksums(std::chrono::steady_clock::time_point now) {
+    std::vector<packets::StateChecksumPacket> checksums;
+    if (entities_.empty() ||
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - lastChecksumTime_).count() < CHECKSUM_INTERVAL_MS) {
+        return checksums;
+    }
+    lastChecksumTime_ = now;
+    checksumSequence_++;
+
+    auto it = entities_.begin();
+    while (it != entities_.end()) {
+        packets::StateChecksumPacket& checksum = checksums.emplace_back();
+        checksum = packets::StateChecksumPacket{};
+        checksum.checksum_sequence = checksumSequence_;
+        checksum.entity_count = static_cast<uint32_t>(entities_.size());
+        checksum.world_checksum = worldChecksum_;
+        for (; it != entities_.end() && checksum.count < packets::MAX_CHECKSUM_ENTRIES; ++it) {
+            checksum.entries[checksum.count].entity_id = it->first;
+            checksum.entries[checksum.count].state_sequence = it->second.latest.state_sequence;
+            checksum.entries[checksum.count].hash = it->second.hash;
+            checksum.count++;
+        }
+    }
+
+    LOG_DEBUG("Built world checksum " + std::to_string(checksumSequence_) + " for " +
+              std::to_string(entities_.size()) + " entities", "Replication");
+    return checksums;
+}
+
+void StateReplicator::acknowledge(const packets::StateAckPacket& ack) {
+    uint32_t count = std::min(ack.count, packets::MAX_STATE_ACKS);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto it = entities_.find(ack.entries[i].entity_id);
+        if (it == entities_.end()) {
+            continue;
+        }
+
+        uint32_t& acked = it->second.ackedSequences[ack.player_id];
+        if (ack.entries[i].state_sequence == 0) {
+            // The client asks for the entity again, e.g. after detecting a desync
+            acked = 0;
+            continue;
+        }
+
+        // Acks can arrive out of order, only ever move forward
+        acked = std::max(acked, ack.entries[i].state_sequence);
+    }
+}
+
+void StateReplicator::forgetClient(uint32_t clientId) {
+    for (auto& [entityId, entity] : entities_) {
+        entity.ackedSequences.erase(clientId);
+    }
+}
+
+void StateReplicator::setSleeping(uint32_t entityId, bool sleeping) {
+    auto it = entities_.find(entityId);
+    if (it != entities_.end()) {
+        it->second.sleeping = sleeping;
+    }
+}
+
+uint32_t StateReplicator::getStateSequence(uint32_t entityId) const {
+    auto it = entities_.find(entityId);
+    return it != entities_.end() ? it->second.latest.state_sequence : 0;
+}
+
+std::vector<packets::PlayerStatePacket> StateReplicator::getLatestStates() const {
+    std::vector<packets::PlayerStatePacket> states;
+    states.reserve(entities_.size());
+    for (const auto& [entityId, entity] : entities_) {
+        states.push_back(entity.latest);
+    }
+    return states;
+}
+
+} // namespace netcode
@@ -0,0 +1,187 @@
+#include "netcode/spectator/spectator_client.hpp"
+#include "netcode/utils/logger.hpp"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace netcode {
+
+SpectatorClient::SpectatorClient(const SpectatorClientConfig& config) : config_(config), running_(false) {
+    streamAddr_.sin_family = AF_INET;
+    streamAddr_.sin_port = htons(config_.streamPort);
+    inet_pton(AF_INET, config_.streamIp.c_str(), &streamAddr_.sin_addr);
+}
+
+SpectatorClient::~SpectatorClient() {
+    stop();
+}
+
+bool SpectatorClient::start() {
+    if (running_) {
+        LOG_WARNING("Spectator client already running", "SpectatorClient");
+        return true;
+    }
+
+    socketFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd_ < 0) {
+        LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "SpectatorClient");
+        return false;
+    }
+
+    int flags = fcntl(socketFd_, F_GETFL, 0);
+    fcntl(socketFd_, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(config_.port);
+    if (bind(socketFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind socket: " + std::string(strerror(errno)), "SpectatorClient");
+        close(socketFd_);
+        socketFd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    receiveThread_ = std::thread(&SpectatorClient::run, this);
+    LOG_INFO("Spectator " + std::to_string(config_.spectatorId) + " watching " + config_.streamIp + ":" +
+             std::to_string(config_.streamPort), "SpectatorClient");
+    return true;
+}
+
+void SpectatorClient::stop() {
+    if (running_) {
+        running_ = false;
+        if (receiveThread_.joinable()) {
+            receiveThread_.join();
+        }
+        sendSubscription(true);
+    }
+    if (socketFd_ != -1) {
+        close(socketFd_);
+        socketFd_ = -1;
+    }
+}
+
+std::map<uint32_t, packets::SpectatorEntityState> SpectatorClient::getEntityStates() {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    return world_;
+}
+
+bool SpectatorClient::isSynchronized() {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    return synchronized_;
+}
+
+SpectatorClientStats SpectatorClient::getStats() {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    return stats_;
+}
+
+void SpectatorClient::run() {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+    std::chrono::steady_clock::time_point lastKeepalive;
+
+    while (running_) {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastKeepalive).count() >= config_.keepaliveMs) {
+            sendSubscription(false);
+            lastKeepalive = now;
+        }
+
+        pollfd fd = {socketFd_, POLLIN, 0};
+        if (poll(&fd, 1, 10) <= 0) {
+            continue;
+        }
+
+        while (true) {
+            ssize_t bytesReceived = recvfrom(socketFd_, buffer, BUFFER_SIZE, 0, nullptr, nullptr);
+            if (bytesReceived < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "SpectatorClient");
+                }
+                break;
+            }
+            if (bytesReceived == sizeof(packets::SpectatorFramePacket)) {
+                packets::SpectatorFramePacket frame;
+                memcpy(&frame, buffer, sizeof(frame));
+                handleFrame(frame);
+            }
+        }
+    }
+}
+
+void SpectatorClient::handleFrame(const packets::SpectatorFramePacket& packet) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+
+    // Frames older than the world shown are of no use any more
+    if (packet.frame_number <= stats_.lastFrame) {
+        return;
+    }
+
+    PendingFrame& pending = pendingFrames_[packet.frame_number];
+    pending.keyframe = packet.keyframe;
+    pending.baseFrame = packet.base_frame;
+    pending.captureTimeMs = packet.capture_time_ms;
+    pending.partCount = packet.part_count;
+    pending.partsReceived++;
+    uint32_t count = std::min(packet.count, packets::MAX_SPECTATOR_ENTITIES);
+    for (uint32_t i = 0; i < count; ++i) {
+        pending.entities[packet.entities[i].player_id] = packet.entities[i];
+    }
+
+    if (pending.partsReceived < pending.partCount) {
+        return;
+    }
+
+    PendingFrame frame = std::move(pending);
+    pendingFrames_.erase(packet.frame_number);
+    applyFrame(packet.frame_number, frame);
+
+    // Drop incomplete frames the world has moved past
+    pendingFrames_.erase(pendingFrames_.begin(), pendingFrames_.upper_bound(stats_.lastFrame));
+}
+
+void SpectatorClient::applyFrame(uint32_t frameNumber, const PendingFrame& frame) {
+    if (frame.keyframe) {
+        world_ = frame.entities;
+        synchronized_ = true;
+        stats_.keyframesApplied++;
+    } else if (synchronized_ && frame.baseFrame == stats_.lastFrame) {
+        for (const auto& [entityId, state] : frame.entities) {
+            world_[entityId] = state;
+        }
+        stats_.deltasApplied++;
+    } else {
+        // A frame in between was lost, the world is stale until the next keyframe
+        if (synchronized_) {
+            LOG_DEBUG("Spectator " + std::to_string(config_.spectatorId) + " lost frame before " +
+                      std::to_string(frameNumber) + ", waiting for keyframe", "SpectatorClient");
+        }
+        synchronized_ = false;
+        stats_.framesSkipped++;
+        return;
+    }
+
+    stats_.lastFrame = frameNumber;
+    stats_.lastCaptureTimeMs = frame.captureTimeMs;
+}
+
+void SpectatorClient::sendSubscription(bool unsubscribe) {
+    if (socketFd_ == -1) {
+        return;
+    }
+    packets::SpectatorSubscribePacket subscription{};
+    subscription.magic = packets::SPECTATOR_SUBSCRIBE_MAGIC;
+    subscription.spectator_id = config_.spectatorId;
+    subscription.unsubscribe = unsubscribe;
+    sendto(socketFd_, &subscription, sizeof(subscription), 0, (struct sockaddr*)&streamAddr_, sizeof(streamAddr_));
+}
+
+} // namespace netcode
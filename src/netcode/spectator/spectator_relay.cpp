@@ -0,0 +1,145 @@
+#include "netcode/spectator/spectator_relay.hpp"
+#include "netcode/utils/logger.hpp"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace netcode {
+
+SpectatorRelay::SpectatorRelay(const SpectatorRelayConfig& config)
+    : config_(config), running_(false), fanout_(config.subscriberTimeoutMs) {
+    upstreamAddr_.sin_family = AF_INET;
+    upstreamAddr_.sin_port = htons(config_.upstreamPort);
+    inet_pton(AF_INET, config_.upstreamIp.c_str(), &upstreamAddr_.sin_addr);
+}
+
+SpectatorRelay::~SpectatorRelay() {
+    stop();
+}
+
+bool SpectatorRelay::start() {
+    if (running_) {
+        LOG_WARNING("Spectator relay already running", "SpectatorRelay");
+        return true;
+    }
+
+    socketFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd_ < 0) {
+        LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "SpectatorRelay");
+        return false;
+    }
+
+    int flags = fcntl(socketFd_, F_GETFL, 0);
+    fcntl(socketFd_, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(config_.port);
+    if (bind(socketFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind socket: " + std::string(strerror(errno)), "SpectatorRelay");
+        close(socketFd_);
+        socketFd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    relayThread_ = std::thread(&SpectatorRelay::run, this);
+    LOG_INFO("Spectator relay " + std::to_string(config_.relayId) + " started on port " + std::to_string(config_.port), "SpectatorRelay");
+    return true;
+}
+
+void SpectatorRelay::stop() {
+    if (running_) {
+        running_ = false;
+        if (relayThread_.joinable()) {
+            relayThread_.join();
+        }
+        sendUpstreamSubscription(true);
+        LOG_INFO("Spectator relay " + std::to_string(config_.relayId) + " stopped", "SpectatorRelay");
+    }
+    if (socketFd_ != -1) {
+        close(socketFd_);
+        socketFd_ = -1;
+    }
+}
+
+size_t SpectatorRelay::getSubscriberCount() {
+    std::lock_guard<std::mutex> lock(fanoutMutex_);
+    return fanout_.getSubscriberCount();
+}
+
+uint64_t SpectatorRelay::getPacketsSent() {
+    std::lock_guard<std::mutex> lock(fanoutMutex_);
+    return fanout_.getPacketsSent();
+}
+
+void SpectatorRelay::run() {
+    constexpr size_t BUFFER_SIZE = 1024;
+    char buffer[BUFFER_SIZE];
+    std::chrono::steady_clock::time_point lastKeepalive;
+
+    while (running_) {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastKeepalive).count() >= config_.keepaliveMs) {
+            sendUpstreamSubscription(false);
+            lastKeepalive = now;
+        }
+
+        pollfd fd = {socketFd_, POLLIN, 0};
+        if (poll(&fd, 1, 10) <= 0) {
+            std::lock_guard<std::mutex> lock(fanoutMutex_);
+            fanout_.expireSubscribers();
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(fanoutMutex_);
+        while (true) {
+            sockaddr_in senderAddr;
+            socklen_t senderLen = sizeof(senderAddr);
+            ssize_t bytesReceived = recvfrom(socketFd_, buffer, BUFFER_SIZE, 0, (struct sockaddr*)&senderAddr, &senderLen);
+            if (bytesReceived < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    LOG_ERROR("recvfrom failed: " + std::string(strerror(errno)), "SpectatorRelay");
+                }
+                break;
+            }
+
+            if (bytesReceived == sizeof(packets::SpectatorFramePacket)) {
+                // Frames are forwarded as they are, the server already encoded them
+                packets::SpectatorFramePacket frame;
+                memcpy(&frame, buffer, sizeof(frame));
+                if (frame.keyframe && frame.part == 0) {
+                    catchUp_.clear();
+                }
+                catchUp_.push_back(frame);
+                fanout_.send(socketFd_, {frame});
+            } else if (bytesReceived == sizeof(packets::SpectatorSubscribePacket)) {
+                packets::SpectatorSubscribePacket subscription;
+                memcpy(&subscription, buffer, sizeof(subscription));
+                if (fanout_.handleSubscription(senderAddr, subscription)) {
+                    fanout_.sendTo(socketFd_, senderAddr, catchUp_);
+                }
+            }
+        }
+        fanout_.expireSubscribers();
+    }
+}
+
+void SpectatorRelay::sendUpstreamSubscription(bool unsubscribe) {
+    if (socketFd_ == -1) {
+        return;
+    }
+    packets::SpectatorSubscribePacket subscription{};
+    subscription.magic = packets::SPECTATOR_SUBSCRIBE_MAGIC;
+    subscription.spectator_id = config_.relayId;
+    subscription.unsubscribe = unsubscribe;
+    sendto(socketFd_, &subscription, sizeof(subscription), 0, (struct sockaddr*)&upstreamAddr_, sizeof(upstreamAddr_));
+}
+
+} // namespace netcode
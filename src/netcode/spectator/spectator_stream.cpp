@@ -0,0 +1,185 @@
+#include "netcode/spectator/spectator_stream.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+
+namespace netcode {
+
+namespace {
+
+// Maximum number of datagrams handed to the kernel in one sendmmsg call
+constexpr size_t SEND_BATCH = 64;
+
+bool sameAddress(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+packets::SpectatorEntityState toSpectatorState(const packets::PlayerStatePacket& state) {
+    packets::SpectatorEntityState entity{};
+    entity.player_id = state.player_id;
+    entity.x = state.x;
+    entity.y = state.y;
+    entity.z = state.z;
+    entity.velocity_x = state.velocity_x;
+    entity.velocity_y = state.velocity_y;
+    entity.velocity_z = state.velocity_z;
+    entity.state_sequence = state.state_sequence;
+    entity.is_jumping = state.is_jumping;
+    return entity;
+}
+
+} // namespace
+
+SpectatorStream::SpectatorStream(const SpectatorStreamConfig& config)
+    : config_(config), streamStart_(std::chrono::steady_clock::now()) {
+}
+
+bool SpectatorStream::isCaptureDue(std::chrono::steady_clock::time_point now) const {
+    if (frameNumber_ == 0) {
+        return true;
+    }
+    auto interval = std::chrono::duration<float>(1.0f / std::max(config_.frameRate, 0.1f));
+    return now - lastCaptureTime_ >= interval;
+}
+
+void SpectatorStream::capture(const std::vector<packets::PlayerStatePacket>& states,
+                              std::chrono::steady_clock::time_point now) {
+    lastCaptureTime_ = now;
+    uint32_t previousFrame = frameNumber_;
+    frameNumber_++;
+
+    bool keyframe = previousFrame == 0 || framesSinceKeyframe_ + 1 >= config_.keyframeInterval;
+    framesSinceKeyframe_ = keyframe ? 0 : framesSinceKeyframe_ + 1;
+
+    // A delta only carries entities whose state sequence moved since the previous frame
+    std::vector<packets::SpectatorEntityState> entities;
+    for (const auto& state : states) {
+        auto it = capturedSequences_.find(state.player_id);
+        bool changed = it == capturedSequences_.end() || it->second != state.state_sequence;
+        if (keyframe || changed) {
+            entities.push_back(toSpectatorState(state));
+        }
+        capturedSequences_[state.player_id] = state.state_sequence;
+    }
+
+    DelayedFrame frame;
+    frame.releaseTime = now + std::chrono::milliseconds(config_.delayMs);
+    uint16_t partCount = static_cast<uint16_t>(
+        std::max<size_t>(1, (entities.size() + packets::MAX_SPECTATOR_ENTITIES - 1) / packets::MAX_SPECTATOR_ENTITIES));
+    for (uint16_t part = 0; part < partCount; ++part) {
+        packets::SpectatorFramePacket packet{};
+        packet.frame_number = frameNumber_;
+        packet.base_frame = keyframe ? frameNumber_ : previousFrame;
+        packet.capture_time_ms = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - streamStart_).count());
+        packet.part = part;
+        packet.part_count = partCount;
+        packet.keyframe = keyframe;
+
+        size_t first = static_cast<size_t>(part) * packets::MAX_SPECTATOR_ENTITIES;
+        size_t last = std::min(entities.size(), first + packets::MAX_SPECTATOR_ENTITIES);
+        for (size_t i = first; i < last; ++i) {
+            packet.entities[packet.count++] = entities[i];
+        }
+        frame.parts.push_back(packet);
+    }
+    delayed_.push_back(std::move(frame));
+}
+
+std::vector<packets::SpectatorFramePacket> SpectatorStream::releaseFrames(std::chrono::steady_clock::time_point now) {
+    std::vector<packets::SpectatorFramePacket> released;
+    while (!delayed_.empty() && delayed_.front().releaseTime <= now) {
+        auto& parts = delayed_.front().parts;
+        if (parts.front().keyframe) {
+            catchUp_.clear();
+        }
+        catchUp_.insert(catchUp_.end(), parts.begin(), parts.end());
+        released.insert(released.end(), parts.begin(), parts.end());
+        delayed_.pop_front();
+    }
+    return released;
+}
+
+SpectatorFanout::SpectatorFanout(uint32_t subscriberTimeoutMs) : subscriberTimeoutMs_(subscriberTimeoutMs) {
+}
+
+bool SpectatorFanout::handleSubscription(const sockaddr_in& addr, const packets::SpectatorSubscribePacket& packet) {
+    if (packet.magic != packets::SPECTATOR_SUBSCRIBE_MAGIC) {
+        return false;
+    }
+
+    auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                           [&addr](const Subscriber& subscriber) { return sameAddress(subscriber.addr, addr); });
+    if (packet.unsubscribe) {
+        if (it != subscribers_.end()) {
+            subscribers_.erase(it);
+            LOG_INFO("Spectator " + std::to_string(packet.spectator_id) + " left the stream", "Spectator");
+        }
+        return false;
+    }
+
+    if (it != subscribers_.end()) {
+        it->lastSeen = std::chrono::steady_clock::now();
+        return false;
+    }
+
+    subscribers_.push_back({addr, std::chrono::steady_clock::now()});
+    LOG_INFO("Spectator " + std::to_string(packet.spectator_id) + " joined the stream (" +
+             std::to_string(subscribers_.size()) + " watching)", "Spectator");
+    return true;
+}
+
+void SpectatorFanout::expireSubscribers() {
+    auto now = std::chrono::steady_clock::now();
+    auto expired = std::remove_if(subscribers_.begin(), subscribers_.end(), [&](const Subscriber& subscriber) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - subscriber.lastSeen).count() >=
+               subscriberTimeoutMs_;
+    });
+    if (expired != subscribers_.end()) {
+        LOG_INFO("Dropped " + std::to_string(subscribers_.end() - expired) + " idle spectators", "Spectator");
+        subscribers_.erase(expired, subscribers_.end());
+    }
+}
+
+void SpectatorFanout::send(int socketFd, const std::vector<packets::SpectatorFramePacket>& frames) {
+    if (frames.empty() || subscribers_.empty()) {
+        return;
+    }
+
+    // The same encoded bytes go to every subscriber, batched to keep the syscall count low
+    mmsghdr messages[SEND_BATCH];
+    iovec iovecs[SEND_BATCH];
+    for (const auto& frame : frames) {
+        for (size_t first = 0; first < subscribers_.size(); first += SEND_BATCH) {
+            size_t batch = std::min(SEND_BATCH, subscribers_.size() - first);
+            for (size_t i = 0; i < batch; ++i) {
+                iovecs[i].iov_base = const_cast<packets::SpectatorFramePacket*>(&frame);
+                iovecs[i].iov_len = sizeof(frame);
+                memset(&messages[i], 0, sizeof(messages[i]));
+                messages[i].msg_hdr.msg_name = &subscribers_[first + i].addr;
+                messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                messages[i].msg_hdr.msg_iov = &iovecs[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int sent = sendmmsg(socketFd, messages, static_cast<unsigned int>(batch), 0);
+            if (sent < 0) {
+                LOG_ERROR("Failed to send spectator frame: " + std::string(strerror(errno)), "Spectator");
+                return;
+            }
+            packetsSent_ += static_cast<uint64_t>(sent);
+        }
+    }
+}
+
+void SpectatorFanout::sendTo(int socketFd, const sockaddr_in& addr,
+                             const std::vector<packets::SpectatorFramePacket>& frames) {
+    for (const auto& frame : frames) {
+        if (sendto(socketFd, &frame, sizeof(frame), 0, (const struct sockaddr*)&addr, sizeof(addr)) > 0) {
+            packetsSent_++;
+        }
+    }
+}
+
+} // namespace netcode
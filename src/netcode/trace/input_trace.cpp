@@ -0,0 +1,213 @@
+#include "netcode/trace/input_trace.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <utility>
+
+namespace netcode {
+
+namespace {
+
+// "NTRC" in a little-endian file
+constexpr uint32_t TRACE_MAGIC = 0x4352544E;
+constexpr uint32_t TRACE_VERSION = 1;
+
+// Time, player, four floats, jump flag, sequence number and prediction flag
+constexpr size_t TRACE_RECORD_SIZE = 8 + 4 + 4 * 4 + 1 + 4 + 1;
+
+template <typename T>
+void writeField(char*& out, const T& value) {
+    memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+template <typename T>
+void readField(const char*& in, T& value) {
+    memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+}
+
+} // namespace
+
+void InputTrace::add(const InputTraceEvent& event) {
+    // Inputs nearly always arrive in order, which makes this an append
+    auto position = std::upper_bound(events_.begin(), events_.end(), event.timeUs,
+                                     [](uint64_t timeUs, const InputTraceEvent& other) { return timeUs < other.timeUs; });
+    events_.insert(position, event);
+}
+
+std::vector<uint32_t> InputTrace::getPlayerIds() const {
+    std::set<uint32_t> playerIds;
+    for (const auto& event : events_) {
+        playerIds.insert(event.input.player_id);
+    }
+    return std::vector<uint32_t>(playerIds.begin(), playerIds.end());
+}
+
+bool InputTrace::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR("Failed to open trace file for writing: " + path, "Trace");
+        return false;
+    }
+
+    uint64_t count = events_.size();
+    file.write(reinterpret_cast<const char*>(&TRACE_MAGIC), sizeof(TRACE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&TRACE_VERSION), sizeof(TRACE_VERSION));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    char record[TRACE_RECORD_SIZE];
+    for (const auto& event : events_) {
+        char* out = record;
+        writeField(out, event.timeUs);
+        writeField(out, event.input.player_id);
+        writeField(out, event.input.movement_x);
+        writeField(out, event.input.movement_y);
+        writeField(out, event.input.movement_z);
+        writeField(out, event.input.velocity_y);
+        writeField(out, static_cast<uint8_t>(event.input.is_jumping));
+        writeField(out, event.input.input_sequence_number);
+        writeField(out, static_cast<uint8_t>(event.input.wasPredicted));
+        file.write(record, sizeof(record));
+    }
+
+    if (!file) {
+        LOG_ERROR("Failed to write trace file: " + path, "Trace");
+        return false;
+    }
+    return true;
+}
+
+bool InputTrace::load(const std::string& path) {
+    events_.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Failed to open trace file: " + path, "Trace");
+        return false;
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t count = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || magic != TRACE_MAGIC || version != TRACE_VERSION) {
+        LOG_ERROR("Not a version " + std::to_string(TRACE_VERSION) + " input trace: " + path, "Trace");
+        return false;
+    }
+
+    char record[TRACE_RECORD_SIZE];
+    uint64_t previousTimeUs = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (!file.read(record, sizeof(record))) {
+            LOG_ERROR("Trace file is truncated after " + std::to_string(i) + " events: " + path, "Trace");
+            events_.clear();
+            return false;
+        }
+
+        InputTraceEvent event;
+        uint8_t isJumping = 0;
+        uint8_t wasPredicted = 0;
+        const char* in = record;
+        readField(in, event.timeUs);
+        readField(in, event.input.player_id);
+        readField(in, event.input.movement_x);
+        readField(in, event.input.movement_y);
+        readField(in, event.input.movement_z);
+        readField(in, event.input.velocity_y);
+        readField(in, isJumping);
+        readField(in, event.input.input_sequence_number);
+        readField(in, wasPredicted);
+        event.input.is_jumping = isJumping != 0;
+        event.input.wasPredicted = wasPredicted != 0;
+
+        if (event.timeUs < previousTimeUs) {
+            LOG_ERROR("Trace events are out of order: " + path, "Trace");
+            events_.clear();
+            return false;
+        }
+        previousTimeUs = event.timeUs;
+        events_.push_back(event);
+    }
+    return true;
+}
+
+void InputTraceRecorder::record(const packets::PlayerMovementRequest& input) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        startTime_ = now;
+        started_ = true;
+    }
+
+    InputTraceEvent event;
+    event.timeUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - startTime_).count());
+    event.input = input;
+    trace_.add(event);
+}
+
+InputTrace InputTraceRecorder::getTrace() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return trace_;
+}
+
+void InputTraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trace_ = InputTrace();
+    started_ = false;
+}
+
+InputTrace transformTrace(const InputTrace& trace, const TraceTransform& transform) {
+    double timeScale = std::max(transform.timeScale, 0.001f);
+    InputTrace result;
+    for (InputTraceEvent event : trace.getEvents()) {
+        event.timeUs = transform.startOffsetUs + static_cast<uint64_t>(std::llround(event.timeUs / timeScale));
+        event.input.player_id += transform.playerIdOffset;
+        if (transform.mirrorX) {
+            event.input.movement_x = -event.input.movement_x;
+        }
+        if (transform.mirrorZ) {
+            event.input.movement_z = -event.input.movement_z;
+        }
+        result.add(event);
+    }
+    return result;
+}
+
+InputTrace mixTraces(const std::vector<InputTrace>& traces) {
+    std::vector<InputTraceEvent> events;
+    for (const auto& trace : traces) {
+        events.insert(events.end(), trace.getEvents().begin(), trace.getEvents().end());
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const InputTraceEvent& a, const InputTraceEvent& b) { return a.timeUs < b.timeUs; });
+
+    // Already in order, so every event is appended
+    InputTrace result;
+    for (const auto& event : events) {
+        result.add(event);
+    }
+    return result;
+}
+
+TraceReplayer::TraceReplayer(InputTrace trace) : trace_(std::move(trace)) {}
+
+std::vector<InputTraceEvent> TraceReplayer::advanceTo(uint64_t elapsedUs) {
+    std::vector<InputTraceEvent> due;
+    const auto& events = trace_.getEvents();
+    while (next_ < events.size() && events[next_].timeUs <= elapsedUs) {
+        due.push_back(events[next_++]);
+    }
+    return due;
+}
+
+uint64_t TraceReplayer::getNextEventTimeUs() const {
+    return isFinished() ? trace_.getDurationUs() : trace_.getEvents()[next_].timeUs;
+}
+
+} // namespace netcode
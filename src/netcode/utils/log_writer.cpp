@@ -0,0 +1,310 @@
+#include "netcode/utils/log_writer.hpp"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <string_view>
+
+#ifdef NETCODE_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace netcode::utils {
+
+    LogWriter::LogWriter(const LogFileConfig& config) : config_(config), path_(config.path) {}
+
+    LogWriter::~LogWriter() {
+        close();
+    }
+
+    // The file is opened on the caller's thread so a bad path is reported right away
+    bool LogWriter::open() {
+        if (thread_.joinable()) {
+            return true;
+        }
+        if (!open_file()) {
+            return false;
+        }
+        stopping_ = false;
+        housekeeper_stopping_ = false;
+        thread_ = std::thread(&LogWriter::run, this);
+        housekeeper_ = std::thread(&LogWriter::run_housekeeping, this);
+        return true;
+    }
+
+    void LogWriter::write(std::string line) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= config_.max_queued_lines) {
+                stats_.lines_dropped++;
+                return;
+            }
+            queue_.push_back(std::move(line));
+        }
+        wake_.notify_one();
+    }
+
+    void LogWriter::flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) {
+            return;
+        }
+        wake_.notify_one();
+        drained_.wait(lock, [this]() {
+            return queue_.empty() && !writing_ && rotated_files_.empty() && !housekeeping_;
+        });
+    }
+
+    // Rotations still queued for the housekeeper are finished before it stops
+    void LogWriter::close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            housekeeper_stopping_ = true;
+        }
+        housekeeping_wake_.notify_one();
+        if (housekeeper_.joinable()) {
+            housekeeper_.join();
+        }
+        if (file_.is_open()) {
+            file_.close();
+        }
+    }
+
+    LogWriterStats LogWriter::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    // Takes the whole queue at once, so logging threads hold the lock only for a swap
+    void LogWriter::run() {
+        std::vector<std::string> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            // Wake up at least once a second, time based rotation also applies to a quiet log
+            wake_.wait_for(lock, std::chrono::seconds(1), [this]() { return stopping_ || !queue_.empty(); });
+            batch.swap(queue_);
+            writing_ = true;
+            bool stopping = stopping_;
+            lock.unlock();
+
+            uint64_t bytes = 0;
+            for (const std::string& line : batch) {
+                if (rotation_due()) {
+                    rotate();
+                }
+                file_ << line << '\n';
+                file_bytes_ += line.size() + 1;
+                bytes += line.size() + 1;
+            }
+            file_.flush();
+            if (batch.empty() && rotation_due()) {
+                rotate();
+            }
+
+            lock.lock();
+            stats_.lines_written += batch.size();
+            stats_.bytes_written += bytes;
+            batch.clear();
+            writing_ = false;
+            if (queue_.empty()) {
+                drained_.notify_all();
+            }
+            if (stopping && queue_.empty()) {
+                return;
+            }
+        }
+    }
+
+    // Compressing and deleting rotated files can take a while, the writer thread keeps writing meanwhile
+    void LogWriter::run_housekeeping() {
+        std::vector<std::filesystem::path> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            housekeeping_wake_.wait(lock, [this]() { return housekeeper_stopping_ || !rotated_files_.empty(); });
+            if (rotated_files_.empty()) {
+                return;
+            }
+            batch.swap(rotated_files_);
+            housekeeping_ = true;
+            lock.unlock();
+
+            for (const auto& rotated : batch) {
+                if (config_.compress && !rotated.empty()) {
+                    compress(rotated);
+                }
+            }
+            enforce_budget();
+
+            lock.lock();
+            batch.clear();
+            housekeeping_ = false;
+            if (rotated_files_.empty()) {
+                drained_.notify_all();
+            }
+        }
+    }
+
+    bool LogWriter::open_file() {
+        file_.open(path_, std::ios::out | std::ios::app);
+        if (!file_.is_open()) {
+            std::cerr << "Failed to open log file: " << path_.string() << std::endl;
+            return false;
+        }
+        std::error_code error;
+        auto size = std::filesystem::file_size(path_, error);
+        file_bytes_ = error ? 0 : size;
+        file_opened_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool LogWriter::rotation_due() const {
+        if (file_bytes_ == 0) {
+            return false;
+        }
+        if (config_.max_file_bytes > 0 && file_bytes_ >= config_.max_file_bytes) {
+            return true;
+        }
+        return config_.max_file_age_s > 0 &&
+               std::chrono::steady_clock::now() - file_opened_ >= std::chrono::seconds(config_.max_file_age_s);
+    }
+
+    // Rotated files are named <path>.YYYYMMDD-HHMMSS, with a counter if several rotations share a second
+    void LogWriter::rotate() {
+        file_.close();
+
+        std::time_t now = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+        std::filesystem::path rotated = path_.string() + "." + stamp;
+        for (int counter = 1; std::filesystem::exists(rotated) ||
+                              std::filesystem::exists(rotated.string() + ".gz"); ++counter) {
+            rotated = path_.string() + "." + stamp + "." + std::to_string(counter);
+        }
+
+        std::error_code error;
+        std::filesystem::rename(path_, rotated, error);
+        if (error) {
+            std::cerr << "Failed to rotate log file " << path_.string() << ": " << error.message() << std::endl;
+        }
+
+        // Logging continues into the new file while the housekeeper compresses the old one
+        open_file();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error) {
+                stats_.rotations++;
+            }
+            rotated_files_.push_back(error ? std::filesystem::path() : rotated);
+        }
+        housekeeping_wake_.notify_one();
+    }
+
+    void LogWriter::compress(const std::filesystem::path& rotated) {
+#ifdef NETCODE_HAS_ZLIB
+        std::string target = rotated.string() + ".gz";
+        std::ifstream input(rotated, std::ios::binary);
+        gzFile output = gzopen(target.c_str(), "wb");
+        if (!input || output == nullptr) {
+            std::cerr << "Failed to compress log file " << rotated.string() << std::endl;
+            if (output != nullptr) {
+                gzclose(output);
+            }
+            return;
+        }
+
+        std::vector<char> buffer(64 * 1024);
+        bool ok = true;
+        while (ok && input) {
+            input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            auto count = static_cast<unsigned>(input.gcount());
+            ok = count == 0 || gzwrite(output, buffer.data(), count) == static_cast<int>(count);
+        }
+        ok = gzclose(output) == Z_OK && ok;
+
+        std::error_code error;
+        std::filesystem::remove(ok ? rotated : std::filesystem::path(target), error);
+        if (!ok) {
+            std::cerr << "Failed to compress log file " << rotated.string() << std::endl;
+        }
+#else
+        (void)rotated;
+#endif
+    }
+
+    // Matches <name>.YYYYMMDD-HHMMSS[.N][.gz], other files next to the log are never touched
+    bool LogWriter::is_rotated_file(const std::string& file_name) const {
+        std::string prefix = path_.filename().string() + ".";
+        if (file_name.size() < prefix.size() + 15 || file_name.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+
+        auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+        std::string_view rest(file_name);
+        rest.remove_prefix(prefix.size());
+        for (size_t i = 0; i < 15; ++i) {
+            if (i == 8 ? rest[i] != '-' : !is_digit(rest[i])) {
+                return false;
+            }
+        }
+        rest.remove_prefix(15);
+
+        if (rest.size() >= 3 && rest.substr(rest.size() - 3) == ".gz") {
+            rest.remove_suffix(3);
+        }
+        if (rest.empty()) {
+            return true;
+        }
+        return rest.size() >= 2 && rest[0] == '.' &&
+               std::all_of(rest.begin() + 1, rest.end(), is_digit);
+    }
+
+    // Deletes the oldest rotated files until the active and rotated files fit into the budget
+    void LogWriter::enforce_budget() {
+        if (config_.disk_budget_bytes == 0) {
+            return;
+        }
+
+        std::filesystem::path directory = path_.parent_path().empty() ? "." : path_.parent_path();
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> rotated;
+
+        // Runs next to the writer thread, so the active file is measured on disk
+        std::error_code error;
+        uint64_t total = std::filesystem::file_size(path_, error);
+        if (error) {
+            total = 0;
+        }
+
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            std::string name = entry.path().filename().string();
+            if (!entry.is_regular_file(error) || !is_rotated_file(name)) {
+                continue;
+            }
+            total += entry.file_size(error);
+            rotated.emplace_back(entry.last_write_time(error), entry.path());
+        }
+        std::sort(rotated.begin(), rotated.end());
+
+        uint64_t deleted = 0;
+        for (const auto& [time, file] : rotated) {
+            if (total <= config_.disk_budget_bytes) {
+                break;
+            }
+            uint64_t size = std::filesystem::file_size(file, error);
+            if (std::filesystem::remove(file, error)) {
+                total -= std::min(total, size);
+                deleted++;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.files_deleted += deleted;
+    }
+
+}
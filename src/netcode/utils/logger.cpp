@@ -1,4 +1,5 @@
 #include "netcode/utils/logger.hpp"
+#include <cctype>
 
 namespace netcode::utils {
 
@@ -16,31 +17,114 @@ namespace netcode::utils {
     }
 
     void Logger::set_level(LogLevel level) {
-        std::lock_guard<std::mutex> lock(log_mutex_);
+        std::lock_guard<std::mutex> lock(category_mutex_);
         current_level_ = level;
+        for (auto& [name, category] : categories_) {
+            if (!category->overridden_) {
+                category->level_ = level;
+            }
+        }
     }
 
-    // Opens in append mode and flushes the previous log file if any
-    bool Logger::set_log_file(const std::string &filename) {
-        std::lock_guard<std::mutex> lock(log_mutex_);
+    // Categories are never removed, so references handed out stay valid
+    LogCategory& Logger::category(const std::string& name) {
+        std::lock_guard<std::mutex> lock(category_mutex_);
+        auto& category = categories_[name];
+        if (!category) {
+            category = std::make_unique<LogCategory>(name, current_level_.load());
+        }
+        return *category;
+    }
+
+    void Logger::set_category_level(const std::string& name, LogLevel level) {
+        LogCategory& entry = category(name);
+        std::lock_guard<std::mutex> lock(category_mutex_);
+        entry.overridden_ = true;
+        entry.level_ = level;
+    }
+
+    void Logger::clear_category_level(const std::string& name) {
+        LogCategory& entry = category(name);
+        std::lock_guard<std::mutex> lock(category_mutex_);
+        entry.overridden_ = false;
+        entry.level_ = current_level_.load();
+    }
 
-        if (log_file_.is_open()) {
-            log_file_.close();
+    bool Logger::set_category_levels(const std::string& spec) {
+        bool valid = true;
+        std::stringstream stream(spec);
+        std::string pair;
+        while (std::getline(stream, pair, ',')) {
+            if (pair.empty()) {
+                continue;
+            }
+            auto separator = pair.find('=');
+            LogLevel level;
+            if (separator == std::string::npos || separator == 0 ||
+                !parse_level(pair.substr(separator + 1), level)) {
+                std::cerr << "Invalid log category level: " << pair << std::endl;
+                valid = false;
+                continue;
+            }
+            set_category_level(pair.substr(0, separator), level);
         }
+        return valid;
+    }
 
-        log_file_.open(filename, std::ios::out | std::ios::app);
+    bool Logger::parse_level(const std::string& name, LogLevel& level) {
+        std::string upper = name;
+        for (char& c : upper) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        for (LogLevel candidate : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARNING, LogLevel::ERROR, LogLevel::NONE}) {
+            if (upper == level_to_string(candidate)) {
+                level = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
 
-        if (!log_file_.is_open()) {
-            std::cerr << "Failed to open log file: " << filename << std::endl;
+    bool Logger::set_log_file(const std::string &filename) {
+        LogFileConfig config;
+        config.path = filename;
+        return set_log_file(config);
+    }
+
+    // Opens in append mode and closes the previous log file if any
+    bool Logger::set_log_file(const LogFileConfig& config) {
+        close_log_file();
+
+        auto writer = std::make_shared<LogWriter>(config);
+        if (!writer->open()) {
             return false;
         }
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        log_writer_ = std::move(writer);
         return true;
     }
 
+    // Waits outside the lock, logging threads keep queueing lines while the writer drains
+    void Logger::flush_log_file() {
+        std::shared_ptr<LogWriter> writer;
+        {
+            std::lock_guard<std::mutex> lock(log_mutex_);
+            writer = log_writer_;
+        }
+        if (writer) {
+            writer->flush();
+        }
+    }
+
+    // The writer is closed outside the lock, writing the remaining lines must not block logging threads
     void Logger::close_log_file() {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        if (log_file_.is_open()) {
-            log_file_.close();
+        std::shared_ptr<LogWriter> writer;
+        {
+            std::lock_guard<std::mutex> lock(log_mutex_);
+            writer = std::move(log_writer_);
+        }
+        if (writer) {
+            writer->close();
         }
     }
 
@@ -65,28 +149,32 @@ namespace netcode::utils {
         log(LogLevel::ERROR, message, component);
     }
 
-    // Format: [timestamp] [level] [component] message
-    // Implementation details:
-    // - Messages below current_level_ are filtered out
-    // - Output goes to both console and file (if open)
-    // - All registered callbacks are notified with the formatted message
-    // - Thread-safe with mutex lock
+    // Messages below the component's category level are filtered out
     void Logger::log(LogLevel level, const std::string& message, const std::string& component) {
-        if (level < current_level_) {
+        const LogCategory& entry = category(component);
+        if (!entry.enabled(level)) {
             return;
         }
+        log(level, message, entry);
+    }
 
+    // Format: [timestamp] [level] [component] message
+    // Implementation details:
+    // - The caller already checked the category level
+    // - Output goes to the console and is queued for the file writer (if open)
+    // - All registered callbacks are notified with the formatted message
+    // - Thread-safe with mutex lock
+    void Logger::log(LogLevel level, const std::string& message, const LogCategory& category) {
         std::lock_guard<std::mutex> lock(log_mutex_);
 
         std::string timestamp = get_current_time();
         std::string level_str = level_to_string(level);
-        std::string formatted_message = "[" + timestamp + "] [" + level_str + "] [" + component + "] " + message;
+        std::string formatted_message = "[" + timestamp + "] [" + level_str + "] [" + category.name() + "] " + message;
 
         std::cout << formatted_message << std::endl;
 
-        if (log_file_.is_open()) {
-            log_file_ << formatted_message << std::endl;
-            log_file_.flush();  // Ensure immediate write to disk
+        if (log_writer_) {
+            log_writer_->write(formatted_message);
         }
 
         for (const auto& callback : callbacks_) {
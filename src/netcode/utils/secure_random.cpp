@@ -0,0 +1,68 @@
+#include "netcode/utils/secure_random.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+namespace netcode::utils {
+
+    namespace {
+
+        bool fill_from_urandom(unsigned char* data, size_t size) {
+            int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                return false;
+            }
+            size_t filled = 0;
+            while (filled < size) {
+                ssize_t count = read(fd, data + filled, size - filled);
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    break;
+                }
+                filled += static_cast<size_t>(count);
+            }
+            close(fd);
+            return filled == size;
+        }
+
+    }
+
+    bool fill_secure_random(void* data, size_t size) {
+        auto* bytes = static_cast<unsigned char*>(data);
+#if defined(__linux__)
+        size_t filled = 0;
+        while (filled < size) {
+            ssize_t count = getrandom(bytes + filled, size - filled, 0);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                // Kernels older than 3.17 lack the system call
+                return fill_from_urandom(bytes + filled, size - filled);
+            }
+            filled += static_cast<size_t>(count);
+        }
+        return true;
+#else
+        return fill_from_urandom(bytes, size);
+#endif
+    }
+
+    bool constant_time_equals(const void* a, const void* b, size_t size) {
+        // Volatile keeps the compiler from stopping at the first difference
+        const volatile unsigned char* left = static_cast<const volatile unsigned char*>(a);
+        const volatile unsigned char* right = static_cast<const volatile unsigned char*>(b);
+        unsigned char difference = 0;
+        for (size_t i = 0; i < size; ++i) {
+            difference |= left[i] ^ right[i];
+        }
+        return difference == 0;
+    }
+
+}
@@ -0,0 +1,51 @@
+#include "netcode/utils/state_hash.hpp"
+#include <cstring>
+
+namespace netcode::utils {
+
+    namespace {
+
+        constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+        constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+        template <typename T>
+        void hash_value(uint64_t& hash, const T& value) {
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            for (unsigned char byte : bytes) {
+                hash ^= byte;
+                hash *= FNV_PRIME;
+            }
+        }
+
+    }
+
+    uint64_t hash_entity_state(const packets::PlayerStatePacket& state) {
+        return hash_entity_state(state.player_id, {state.x, state.y, state.z},
+                                 {state.velocity_x, state.velocity_y, state.velocity_z}, state.is_jumping);
+    }
+
+    uint64_t hash_entity_state(uint32_t entity_id, const math::MyVec3& position,
+                               const math::MyVec3& velocity, bool is_jumping) {
+        // Hash field by field, struct padding is not guaranteed to be zeroed
+        uint64_t hash = FNV_OFFSET_BASIS;
+        hash_value(hash, entity_id);
+        hash_value(hash, position.x);
+        hash_value(hash, position.y);
+        hash_value(hash, position.z);
+        hash_value(hash, velocity.x);
+        hash_value(hash, velocity.y);
+        hash_value(hash, velocity.z);
+        hash_value(hash, static_cast<uint8_t>(is_jumping ? 1 : 0));
+        return hash;
+    }
+
+    bool has_state_changed(const packets::PlayerStatePacket& previous, const packets::PlayerStatePacket& current) {
+        return previous.x != current.x || previous.y != current.y || previous.z != current.z ||
+               previous.velocity_x != current.velocity_x || previous.velocity_y != current.velocity_y ||
+               previous.velocity_z != current.velocity_z || previous.is_jumping != current.is_jumping ||
+               previous.input_x != current.input_x || previous.input_y != current.input_y ||
+               previous.input_z != current.input_z;
+    }
+
+}
@@ -0,0 +1,102 @@
+#include "netcode/utils/tick_scheduler.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+namespace netcode::utils {
+
+    void DurationHistogram::record(std::chrono::nanoseconds duration) {
+        duration = std::max(duration, std::chrono::nanoseconds(0));
+        uint64_t micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+        size_t bucket = 0;
+        while (micros > 0 && bucket + 1 < BUCKET_COUNT) {
+            micros >>= 1;
+            ++bucket;
+        }
+        ++buckets_[bucket];
+        ++count_;
+        total_ += duration;
+        max_ = std::max(max_, duration);
+    }
+
+    std::chrono::microseconds DurationHistogram::percentile(double percentile) const {
+        if (count_ == 0) {
+            return std::chrono::microseconds(0);
+        }
+        uint64_t target = static_cast<uint64_t>(std::clamp(percentile, 0.0, 100.0) / 100.0 * count_);
+        target = std::max<uint64_t>(target, 1);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += buckets_[bucket];
+            if (seen >= target) {
+                return std::chrono::microseconds(uint64_t(1) << bucket);
+            }
+        }
+        return std::chrono::microseconds(uint64_t(1) << (BUCKET_COUNT - 1));
+    }
+
+    std::chrono::nanoseconds DurationHistogram::mean() const {
+        return count_ > 0 ? total_ / static_cast<int64_t>(count_) : std::chrono::nanoseconds(0);
+    }
+
+    TickScheduler::TickScheduler(const TickSchedulerConfig& config)
+        : config_(config),
+          interval_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::duration<double>(1.0 / std::max(config.tick_rate, 0.001)))) {}
+
+    void TickScheduler::start() {
+        start_ = std::chrono::steady_clock::now();
+        deadline_index_ = 0;
+        started_ = true;
+    }
+
+    uint32_t TickScheduler::wait_next_tick() {
+        if (!started_) {
+            start();
+        }
+
+        auto deadline = next_deadline();
+        auto now = std::chrono::steady_clock::now();
+        if (now < deadline) {
+            sleep_until(deadline);
+            stats_.jitter.record(std::chrono::steady_clock::now() - deadline);
+            ++deadline_index_;
+            ++stats_.ticks;
+            return 1;
+        }
+
+        // The previous tick ended past this deadline, maybe past later ones too
+        auto late = now - deadline;
+        uint64_t missed = static_cast<uint64_t>(late / interval_) + 1;
+        uint64_t run = 1;
+        if (config_.overrun_policy == OverrunPolicy::CATCH_UP) {
+            run = std::clamp<uint64_t>(missed, 1, std::max<uint32_t>(config_.max_catch_up_ticks, 1));
+        }
+        ++stats_.overruns;
+        stats_.overrun.record(late);
+        stats_.skipped_ticks += missed - run;
+        stats_.ticks += run;
+        deadline_index_ += missed;
+        return static_cast<uint32_t>(run);
+    }
+
+    std::chrono::steady_clock::time_point TickScheduler::next_deadline() const {
+        return start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            interval_ * static_cast<int64_t>(deadline_index_ + 1));
+    }
+
+    void TickScheduler::sleep_until(std::chrono::steady_clock::time_point deadline) const {
+        auto wake = deadline - std::chrono::microseconds(config_.spin_us);
+        if (wake > std::chrono::steady_clock::now()) {
+            auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count();
+            timespec wake_time;
+            wake_time.tv_sec = static_cast<time_t>(since_epoch / 1000000000);
+            wake_time.tv_nsec = static_cast<long>(since_epoch % 1000000000);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, nullptr) == EINTR) {
+            }
+        }
+        while (std::chrono::steady_clock::now() < deadline) {
+        }
+    }
+
+}
@@ -0,0 +1,43 @@
+#include "netcode/utils/udp_socket.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace netcode::utils {
+
+    int open_bound_socket(int port) {
+        int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (socketFd < 0) {
+            return -1;
+        }
+
+        int flags = fcntl(socketFd, F_GETFL, 0);
+        fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = INADDR_ANY;
+        addr.sin_port = htons(port);
+
+        if (bind(socketFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            // Keep the bind error for the caller's log message
+            int error = errno;
+            close(socketFd);
+            errno = error;
+            return -1;
+        }
+        return socketFd;
+    }
+
+    bool contains_address(const std::vector<sockaddr_in>& addresses, const sockaddr_in& addr) {
+        return std::any_of(addresses.begin(), addresses.end(), [&addr](const sockaddr_in& other) {
+            return other.sin_addr.s_addr == addr.sin_addr.s_addr && other.sin_port == addr.sin_port;
+        });
+    }
+
+}
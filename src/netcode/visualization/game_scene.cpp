@@ -188,7 +188,36 @@ void GameScene::moveCameraRight(float amount) {
     camera_.target = Vector3Add(camera_.target, offset);
 }
 
+bool GameScene::needsRender() const {
+    return !rendered_ || renderSignature() != lastRenderSignature_;
+}
+
+GameScene::RenderSignature GameScene::renderSignature() const {
+    RenderSignature signature{};
+    size_t i = 0;
+    auto add = [&signature, &i](float value) { signature[i++] = value; };
+
+    for (const Vector3& v : {camera_.position, camera_.target, camera_.up}) {
+        add(v.x);
+        add(v.y);
+        add(v.z);
+    }
+    add(camera_.fovy);
+    for (const Player* player : {redPlayer_.get(), bluePlayer_.get()}) {
+        netcode::math::MyVec3 position = player ? player->getRenderPosition() : netcode::math::MyVec3{};
+        add(position.x);
+        add(position.y);
+        add(position.z);
+        add(player ? player->getRotationAngle() : 0.0f);
+    }
+    add(settings_ && settings_->useTexturedGround() && groundTextureLoaded_ ? 1.0f : 0.0f);
+    return signature;
+}
+
 void GameScene::render() {
+    lastRenderSignature_ = renderSignature();
+    rendered_ = true;
+
     ClearBackground(RAYWHITE);
     // Draw viewport label
     DrawText(label_, 10, 5, 20, BLACK);
@@ -44,6 +44,12 @@ GameWindow::GameWindow(const char* title, int width, int height, NetworkUtility:
     rt1_ = LoadRenderTexture(viewportWidth, height);
     rt2_ = LoadRenderTexture(viewportWidth, height);
     rt3_ = LoadRenderTexture(viewportWidth, height);
+    viewports_[0].scene = scene1_.get();
+    viewports_[0].target = &rt1_;
+    viewports_[1].scene = scene2_.get();
+    viewports_[1].target = &rt2_;
+    viewports_[2].scene = scene3_.get();
+    viewports_[2].target = &rt3_;
 
     // Create control panel at the bottom of the window
     controlPanel_ = std::make_unique<ControlPanel>(0, height, width * 2, CONTROL_PANEL_HEIGHT);
@@ -201,21 +207,11 @@ void GameWindow::render() {
     BeginDrawing();
     ClearBackground(RAYWHITE);
 
-    // Draw each scene to its render texture
-    BeginTextureMode(rt1_);
-    ClearBackground(RAYWHITE);
-    scene1_->render();
-    EndTextureMode();
-
-    BeginTextureMode(rt2_);
-    ClearBackground(RAYWHITE);
-    scene2_->render();
-    EndTextureMode();
-
-    BeginTextureMode(rt3_);
-    ClearBackground(RAYWHITE);
-    scene3_->render();
-    EndTextureMode();
+    // Draw each scene to its render texture, skipped textures keep their last image
+    double now = GetTime();
+    for (size_t i = 0; i < viewports_.size(); ++i) {
+        renderViewport(viewports_[i], activeSceneIndex_ == static_cast<int>(i) + 1, now);
+    }
 
     // Draw render textures to screen
     DrawTextureRec(rt1_.texture,
@@ -230,6 +226,11 @@ void GameWindow::render() {
                    Rectangle{0, 0, static_cast<float>(rt3_.texture.width), static_cast<float>(-rt3_.texture.height)},
                    Vector2{static_cast<float>(rt1_.texture.width + rt2_.texture.width), 0}, WHITE);
 
+    // Per viewport frame time breakdown
+    drawViewportTiming(viewports_[0], 0);
+    drawViewportTiming(viewports_[1], rt1_.texture.width);
+    drawViewportTiming(viewports_[2], rt1_.texture.width + rt2_.texture.width);
+
     // Draw control panel
     controlPanel_->render();
 
@@ -244,7 +245,54 @@ void GameWindow::render() {
     EndDrawing();
 }
 
+void GameWindow::renderViewport(ViewportRender& viewport, bool focused, double now) {
+    viewport.frames++;
+    if (adaptiveRendering_ && viewport.renders > 0) {
+        // Nothing moved, the texture still shows the current state
+        if (!viewport.scene->needsRender()) {
+            viewport.skippedUnchanged++;
+            return;
+        }
+        // Views nobody is watching closely only need to keep up roughly
+        if (!focused && now - viewport.lastRenderTime < 1.0 / UNFOCUSED_RENDER_RATE) {
+            viewport.skippedThrottled++;
+            return;
+        }
+    }
+
+    double start = GetTime();
+    BeginTextureMode(*viewport.target);
+    ClearBackground(RAYWHITE);
+    viewport.scene->render();
+    EndTextureMode();
+
+    viewport.lastRenderMs = (GetTime() - start) * 1000.0;
+    viewport.averageRenderMs = viewport.renders == 0
+        ? viewport.lastRenderMs
+        : viewport.averageRenderMs + 0.1 * (viewport.lastRenderMs - viewport.averageRenderMs);
+    viewport.lastRenderTime = now;
+    viewport.renders++;
+}
+
+void GameWindow::drawViewportTiming(const ViewportRender& viewport, int x) const {
+    double renderedShare = viewport.frames > 0
+        ? 100.0 * static_cast<double>(viewport.renders) / static_cast<double>(viewport.frames)
+        : 0.0;
+    const char* text = TextFormat("%.2f ms/render, %.0f%% of frames (skipped: %llu unchanged, %llu throttled)%s",
+                                  viewport.averageRenderMs, renderedShare,
+                                  static_cast<unsigned long long>(viewport.skippedUnchanged),
+                                  static_cast<unsigned long long>(viewport.skippedThrottled),
+                                  adaptiveRendering_ ? "" : " [F4: adaptive off]");
+    DrawText(text, x + 10, viewport.target->texture.height - 20, 10, DARKGRAY);
+}
+
 void GameWindow::handleInput() {
+    // Toggle adaptive viewport rendering, e.g. to compare the frame time breakdown
+    if (IsKeyPressed(KEY_F4)) {
+        adaptiveRendering_ = !adaptiveRendering_;
+        LOG_INFO(std::string("Adaptive viewport rendering ") + (adaptiveRendering_ ? "enabled" : "disabled"), "GameWindow");
+    }
+
     // Check if any text field is active in the control panel
     bool textFieldActive = controlPanel_->isTextFieldActive();
 
@@ -292,6 +340,8 @@ void GameWindow::handleInput() {
                 if (redJump) msg += " + JUMP";
                 if (redPosition.y > 1.0f) msg += " (airborne)";
                 add_network_message(msg);
+            } else {
+                network_->clientInputReleased(redPlayer1);
             }
         }
 
@@ -318,6 +368,8 @@ void GameWindow::handleInput() {
                 if (blueJump) msg += " + JUMP";
                 if (bluePosition.y > 1.0f) msg += " (airborne)";
                 add_network_message(msg);
+            } else {
+                network_->clientInputReleased(bluePlayer2);
             }
         }
 
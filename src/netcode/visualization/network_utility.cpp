@@ -69,22 +69,43 @@ void NetworkUtility::clientToServerUpdate(std::shared_ptr<Player> clientPlayer,
             serverPlayerRef_ = serverPlayer;
             client1PlayerRef_ = clientPlayer;
             
-            // Send movement request from client1 to server
-            // Convert Vector3 to MyVec3 for the network layer
-            client1_->sendMovementRequest(toMyVec3(movement), jumpRequested);
+            // Send movement requests from client1 to server
+            sendPacedInputs(*client1_, client1Input_, movement, jumpRequested);
         }
         else if (playerId == CLIENT2_PLAYER_ID && client2_) {
             // Store references for future use
             serverPlayerRef_ = serverPlayer;
             client2PlayerRef_ = clientPlayer;
             
-            // Send movement request from client2 to server
-            // Convert Vector3 to MyVec3 for the network layer
-            client2_->sendMovementRequest(toMyVec3(movement), jumpRequested);
+            // Send movement requests from client2 to server
+            sendPacedInputs(*client2_, client2Input_, movement, jumpRequested);
         }
     }
 }
 
+void NetworkUtility::clientInputReleased(std::shared_ptr<Player> clientPlayer) {
+    if (!clientPlayer) {
+        return;
+    }
+    // Nothing is owed for the time no key was held
+    if (clientPlayer->getId() == CLIENT1_PLAYER_ID) {
+        client1Input_.clock.stop();
+    } else if (clientPlayer->getId() == CLIENT2_PLAYER_ID) {
+        client2Input_.clock.stop();
+    }
+}
+
+void NetworkUtility::sendPacedInputs(Client& client, PacedInput& input, const Vector3& movement, bool jumpRequested) {
+    // The time scale speeds the clock up or slows it down to the server's input buffer
+    uint32_t due = input.clock.advance(std::chrono::steady_clock::now(), client.getTimeScale());
+    input.jumpPending = input.jumpPending || jumpRequested;
+    for (uint32_t i = 0; i < due; ++i) {
+        // Convert Vector3 to MyVec3 for the network layer
+        client.sendMovementRequest(toMyVec3(movement), input.jumpPending);
+        input.jumpPending = false;
+    }
+}
+
 void NetworkUtility::serverToClientsUpdate(std::shared_ptr<Player> serverPlayer,
                                          std::shared_ptr<Player> client1Player,
                                          std::shared_ptr<Player> client2Player) {
@@ -25,7 +25,7 @@ Player::ModelConfig Player::getModelConfig(PlayerType type) {
 
 Player::Player(PlayerType type, const netcode::math::MyVec3& startPos, const Color& playerColor)
     : position_(startPos), renderPosition_(startPos), color_(playerColor), velocity_({0.0f, 0.0f, 0.0f}), type_(type),
-      scale_(1.0f), modelLoaded_(false), isJumping_(false), isVisuallyBlending_(false),
+      scale_(1.0f), modelLoaded_(false), isJumping_(false),
       id_(type == PlayerType::RED_PLAYER ? 1 : 2), rotationAngle_(0.0f), facingLeft_(true) {
     loadModel(false);
 }
@@ -75,6 +75,11 @@ void Player::loadModel(bool useCubes) {
 }
 
 void Player::move(const netcode::math::MyVec3& direction) {
+    // Horizontal velocity is the displacement of the latest step, so it can be replicated
+    velocity_.x = direction.x * MOVE_SPEED;
+    velocity_.z = direction.z * MOVE_SPEED;
+    movedThisStep_ = true;
+
     // Calculate new position
     netcode::math::MyVec3 newPosition = {
         position_.x + direction.x * MOVE_SPEED,
@@ -119,6 +124,13 @@ void Player::jump() {
 void Player::update() {
     const float ground_level = 1.0f;
 
+    // A step without movement input leaves the player standing
+    if (!movedThisStep_) {
+        velocity_.x = 0.0f;
+        velocity_.z = 0.0f;
+    }
+    movedThisStep_ = false;
+
     if (isJumping_) {
         // Calculate new position with gravity applied
         netcode::math::MyVec3 newPosition = position_;
@@ -145,46 +157,24 @@ void Player::update() {
 }
 
 void Player::updateRenderPosition(float deltaTime) {
-    if (isVisuallyBlending_) {
-        // Update blend progress
-        visualBlendProgress_ += deltaTime * VISUAL_BLEND_SPEED;
-
-        if (visualBlendProgress_ >= 1.0f) {
-            // Blending complete
-            renderPosition_ = position_;
-            isVisuallyBlending_ = false;
-            visualBlendProgress_ = 0.0f;
-        } else {
-            // Calculate new render position using interpolation
-            float t = visualBlendProgress_;
-            netcode::math::MyVec3 startPos = renderPosition_;
-            netcode::math::MyVec3 targetPos = position_;
-
-            renderPosition_.x = startPos.x + (targetPos.x - startPos.x) * t;
-            renderPosition_.y = startPos.y + (targetPos.y - startPos.y) * t;
-            renderPosition_.z = startPos.z + (targetPos.z - startPos.z) * t;
-        }
-    } else {
-        // If not blending, immediately use simulation position
-        renderPosition_ = position_;
-    }
+    // Render at the simulation position plus whatever correction error is left to hide
+    errorOffset_.decay(deltaTime);
+    renderPosition_ = position_ + errorOffset_.get();
 }
 
-void Player::snapSimulationState(const netcode::math::MyVec3& position, bool isJumping, float velocityY) {
+void Player::snapSimulationState(const netcode::math::MyVec3& position, bool isJumping, const netcode::math::MyVec3& velocity) {
     // Update simulation state to match the server's authoritative state
     // Use setPosition to ensure rotation is calculated
     setPosition(position);
     isJumping_ = isJumping;
 
-    if (velocityY != 0.0f) {
-        velocity_.y = velocityY;
-    }
+    // Take over the full kinematic state so a jump continues from the server's point in the arc
+    velocity_ = velocity;
 }
 
 void Player::initiateVisualBlend() {
-    // Start visual blending from current render position to new simulation position
-    isVisuallyBlending_ = true;
-    visualBlendProgress_ = 0.0f;
+    // Keep showing the current render position and let it converge on the new simulation position
+    errorOffset_.capture(renderPosition_, position_);
 }
 
 void Player::draw() const {
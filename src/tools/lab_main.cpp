@@ -0,0 +1,211 @@
+#include "netcode/lab/lab_runner.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program
+              << " [--delays MS,...] [--jitters MS,...] [--losses PERCENT,...]"
+              << " [--interpolation-delays MS,...] [--thresholds F,...] [--send-rates HZ,...]"
+              << " [--prediction on,off] [--input-buffering on,off] [--shards N,...] [--players N] [--duration-ms N]"
+              << " [--base-port N] [--trace FILE] [--out FILE] [--log-levels COMPONENT=LEVEL,...]" << std::endl;
+}
+
+// Parse the whole string as a number, rejecting trailing characters and values out of range
+template <typename T>
+bool parseNumber(const std::string& value, T& result) {
+    const char* end = value.data() + value.size();
+    auto [ptr, error] = std::from_chars(value.data(), end, result);
+    return error == std::errc() && ptr == end;
+}
+
+// Parse a comma separated list, every item has to parse and the list must not be empty
+template <typename T>
+bool parseList(const std::string& value, std::vector<T>& values) {
+    std::vector<T> parsed;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        if constexpr (std::is_same_v<T, bool>) {
+            if (item == "on" || item == "1" || item == "true") {
+                parsed.push_back(true);
+            } else if (item == "off" || item == "0" || item == "false") {
+                parsed.push_back(false);
+            } else {
+                return false;
+            }
+        } else {
+            T number;
+            if (!parseNumber(item, number)) {
+                return false;
+            }
+            parsed.push_back(number);
+        }
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    values.swap(parsed);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> delays = {0, 50, 150};
+    std::vector<uint32_t> jitters = {0, 20};
+    std::vector<float> losses = {0.0f, 5.0f};
+    std::vector<uint32_t> interpolationDelays = {50, 100};
+    std::vector<float> thresholds = {0.5f};
+    std::vector<float> sendRates = {60.0f};
+    std::vector<bool> predictions = {true};
+    std::vector<bool> inputBufferings = {false};
+    std::vector<uint32_t> shardCounts = {0};
+    netcode::LabCellConfig base;
+    std::string tracePath;
+    std::string outPath;
+    std::string logLevels;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--delays") {
+            valid = parseList(value, delays);
+        } else if (arg == "--jitters") {
+            valid = parseList(value, jitters);
+        } else if (arg == "--losses") {
+            valid = parseList(value, losses) &&
+                    std::all_of(losses.begin(), losses.end(), [](float loss) { return loss >= 0.0f && loss <= 100.0f; });
+        } else if (arg == "--interpolation-delays") {
+            valid = parseList(value, interpolationDelays);
+        } else if (arg == "--thresholds") {
+            valid = parseList(value, thresholds) &&
+                    std::all_of(thresholds.begin(), thresholds.end(), [](float threshold) { return threshold >= 0.0f; });
+        } else if (arg == "--send-rates") {
+            valid = parseList(value, sendRates) &&
+                    std::all_of(sendRates.begin(), sendRates.end(), [](float rate) { return rate > 0.0f; });
+        } else if (arg == "--prediction") {
+            valid = parseList(value, predictions);
+        } else if (arg == "--input-buffering") {
+            valid = parseList(value, inputBufferings);
+        } else if (arg == "--shards") {
+            valid = parseList(value, shardCounts);
+        } else if (arg == "--players") {
+            // Link ports count up from base + 1 and must stay below the client ports at base + 100
+            valid = parseNumber(value, base.players) && base.players > 0 && base.players < 100;
+        } else if (arg == "--duration-ms") {
+            valid = parseNumber(value, base.durationMs) && base.durationMs > 0;
+        } else if (arg == "--base-port") {
+            valid = parseNumber(value, base.basePort) && base.basePort > 0 && base.basePort <= 65535;
+        } else if (arg == "--trace") {
+            tracePath = value;
+        } else if (arg == "--out") {
+            outPath = value;
+        } else if (arg == "--log-levels") {
+            logLevels = value;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // A cell binds the server at the base port and its clients up to base + 100 + players
+    if (base.basePort + 100 + static_cast<int>(base.players) > 65535) {
+        std::cerr << "Invalid value for --base-port: " << base.basePort << " leaves no room for "
+                  << base.players << " players" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // The stack logs every correction, which would cost more CPU than the netcode being measured
+    netcode::utils::Logger::get_instance().set_level(netcode::utils::LogLevel::WARNING);
+    if (!logLevels.empty() && !netcode::utils::Logger::get_instance().set_category_levels(logLevels)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!tracePath.empty()) {
+        auto trace = std::make_shared<netcode::InputTrace>();
+        if (!trace->load(tracePath)) {
+            return 1;
+        }
+        base.trace = trace;
+    }
+
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath, std::ios::trunc);
+        if (!file) {
+            LOG_ERROR("Failed to open output file: " + outPath, "Lab");
+            return 1;
+        }
+    }
+    std::ostream& out = outPath.empty() ? std::cout : file;
+
+    out << "delay_ms,jitter_ms,loss_percent,interpolation_delay_ms,reconciliation_threshold,send_rate_hz,prediction,input_buffering,server_shards,"
+        << "up_bytes_per_s,down_bytes_per_s,cpu_us_per_tick,mean_prediction_error,max_prediction_error,"
+        << "corrections,interpolation_starvation,packets_dropped,input_underruns,tick_overruns,tick_jitter_p99_us" << std::endl;
+
+    // Every combination of the listed values is one cell
+    std::vector<netcode::LabCellConfig> cells = {base};
+    auto expand = [&cells](const auto& values, auto apply) {
+        std::vector<netcode::LabCellConfig> expanded;
+        for (const auto& cell : cells) {
+            for (auto value : values) {
+                netcode::LabCellConfig config = cell;
+                apply(config, value);
+                expanded.push_back(config);
+            }
+        }
+        cells.swap(expanded);
+    };
+    expand(delays, [](netcode::LabCellConfig& config, uint32_t value) { config.link.delayMs = value; });
+    expand(jitters, [](netcode::LabCellConfig& config, uint32_t value) { config.link.jitterMs = value; });
+    expand(losses, [](netcode::LabCellConfig& config, float value) { config.link.lossPercent = value; });
+    expand(interpolationDelays, [](netcode::LabCellConfig& config, uint32_t value) { config.interpolationDelayMs = value; });
+    expand(thresholds, [](netcode::LabCellConfig& config, float value) { config.reconciliationThreshold = value; });
+    expand(sendRates, [](netcode::LabCellConfig& config, float value) { config.sendRate = value; });
+    expand(predictions, [](netcode::LabCellConfig& config, bool value) { config.predictionEnabled = value; });
+    expand(inputBufferings, [](netcode::LabCellConfig& config, bool value) { config.inputBuffering = value; });
+    expand(shardCounts, [](netcode::LabCellConfig& config, uint32_t value) { config.serverShards = value; });
+
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const netcode::LabCellConfig& config = cells[i];
+        std::cerr << "Cell " << i + 1 << "/" << cells.size() << std::endl;
+        netcode::LabCellResult result = netcode::runLabCell(config);
+        out << config.link.delayMs << "," << config.link.jitterMs << "," << config.link.lossPercent << ","
+            << config.interpolationDelayMs << "," << config.reconciliationThreshold << "," << config.sendRate << ","
+            << (config.predictionEnabled ? "on" : "off") << "," << (config.inputBuffering ? "on" : "off") << "," << config.serverShards << ","
+            << result.upstreamBytesPerSecond << "," << result.downstreamBytesPerSecond << ","
+            << result.cpuUsPerTick << "," << result.meanPredictionError << "," << result.maxPredictionError << ","
+            << result.corrections << "," << result.interpolationStarvation << "," << result.packetsDropped << "," << result.inputUnderruns << ","
+            << result.tickOverruns << "," << result.tickJitterP99Us << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include "netcode/trace/input_trace.hpp"
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/utils/logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void handleSignal(int) {
+    stopRequested = true;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program
+              << " --trace FILE [--trace FILE ...] [--copies N] [--time-scale F] [--stagger-ms N]"
+              << " [--server-ip IP] [--server-port N] [--base-port N] [--delay-ms N]" << std::endl;
+}
+
+// Parse the whole string as a number, rejecting trailing characters and values out of range
+template <typename T>
+bool parseNumber(const std::string& value, T& result) {
+    const char* end = value.data() + value.size();
+    auto [ptr, error] = std::from_chars(value.data(), end, result);
+    return error == std::errc() && ptr == end;
+}
+
+int openBotSocket(int port) {
+    int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd < 0) {
+        LOG_ERROR("Failed to create socket: " + std::string(strerror(errno)), "LoadGen");
+        return -1;
+    }
+
+    int flags = fcntl(socketFd, F_GETFL, 0);
+    fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(socketFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind socket to port " + std::to_string(port) + ": " + std::string(strerror(errno)), "LoadGen");
+        close(socketFd);
+        return -1;
+    }
+    return socketFd;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> tracePaths;
+    int copies = 1;
+    float timeScale = 1.0f;
+    uint32_t staggerMs = 0;
+    std::string serverIp = "127.0.0.1";
+    int serverPort = 7000;
+    int basePort = 7400;
+    int delayMs = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--trace") {
+            tracePaths.push_back(value);
+        } else if (arg == "--copies") {
+            valid = parseNumber(value, copies) && copies > 0;
+        } else if (arg == "--time-scale") {
+            valid = parseNumber(value, timeScale) && timeScale > 0.0f;
+        } else if (arg == "--stagger-ms") {
+            valid = parseNumber(value, staggerMs);
+        } else if (arg == "--server-ip") {
+            in_addr addr;
+            valid = inet_pton(AF_INET, value.c_str(), &addr) == 1;
+            serverIp = value;
+        } else if (arg == "--server-port") {
+            valid = parseNumber(value, serverPort) && serverPort > 0 && serverPort <= 65535;
+        } else if (arg == "--base-port") {
+            valid = parseNumber(value, basePort) && basePort > 0 && basePort <= 65535;
+        } else if (arg == "--delay-ms") {
+            valid = parseNumber(value, delayMs) && delayMs >= 0;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (tracePaths.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<netcode::InputTrace> traces(tracePaths.size());
+    uint32_t idStride = 1;
+    for (size_t i = 0; i < tracePaths.size(); ++i) {
+        if (!traces[i].load(tracePaths[i])) {
+            return 1;
+        }
+        for (uint32_t playerId : traces[i].getPlayerIds()) {
+            idStride = std::max(idStride, playerId + 1);
+        }
+    }
+
+    // Every copy gets its own players and start time, every other copy runs through the mirrored map
+    std::vector<netcode::InputTrace> copiesToMix;
+    for (size_t i = 0; i < traces.size(); ++i) {
+        for (int copy = 0; copy < copies; ++copy) {
+            uint32_t index = static_cast<uint32_t>(i * copies + copy);
+            netcode::TraceTransform transform;
+            transform.timeScale = timeScale;
+            transform.startOffsetUs = static_cast<uint64_t>(index) * staggerMs * 1000;
+            transform.playerIdOffset = index * idStride;
+            transform.mirrorX = copy % 2 == 1;
+            transform.mirrorZ = copy % 2 == 1;
+            copiesToMix.push_back(netcode::transformTrace(traces[i], transform));
+        }
+    }
+    netcode::TraceReplayer replayer(netcode::mixTraces(copiesToMix));
+
+    // Every bot binds its own port counting up from the base port
+    size_t botCount = replayer.getTrace().getPlayerIds().size();
+    if (static_cast<size_t>(basePort) + botCount - 1 > 65535) {
+        std::cerr << "Invalid value for --base-port: " << basePort << " leaves no room for " << botCount << " bots" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(serverPort);
+    inet_pton(AF_INET, serverIp.c_str(), &serverAddr.sin_addr);
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    // One socket per bot, so the server sees as many clients as the trace has players
+    std::map<uint32_t, int> botSockets;
+    int nextPort = basePort;
+    for (uint32_t playerId : replayer.getTrace().getPlayerIds()) {
+        int socketFd = openBotSocket(nextPort++);
+        if (socketFd < 0) {
+            for (const auto& [id, fd] : botSockets) {
+                close(fd);
+            }
+            return 1;
+        }
+        botSockets[playerId] = socketFd;
+
+        netcode::packets::TimestampedPlayerMovementRequest registration{};
+        registration.timestamp = std::chrono::steady_clock::now();
+        registration.player_movement_request.player_id = playerId;
+        sendto(socketFd, &registration, sizeof(registration), 0, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+    }
+    LOG_INFO("Replaying " + std::to_string(replayer.getTrace().getEvents().size()) + " inputs of " +
+             std::to_string(botSockets.size()) + " bots over " +
+             std::to_string(replayer.getTrace().getDurationUs() / 1000) + " ms", "LoadGen");
+
+    uint64_t inputsSent = 0;
+    uint64_t packetsReceived = 0;
+    uint64_t bytesReceived = 0;
+    char buffer[2048];
+    auto startTime = std::chrono::steady_clock::now();
+    while (!stopRequested && !replayer.isFinished()) {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime).count();
+        for (const auto& event : replayer.advanceTo(static_cast<uint64_t>(elapsedUs))) {
+            netcode::packets::TimestampedPlayerMovementRequest request{};
+            request.timestamp = now + std::chrono::milliseconds(delayMs);
+            request.player_movement_request = event.input;
+            int socketFd = botSockets[event.input.player_id];
+            if (sendto(socketFd, &request, sizeof(request), 0, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+                LOG_ERROR("Failed to send input: " + std::string(strerror(errno)), "LoadGen");
+                continue;
+            }
+            inputsSent++;
+        }
+
+        // Drain the state updates so the bots' socket buffers never fill up
+        for (const auto& [playerId, socketFd] : botSockets) {
+            ssize_t received;
+            while ((received = recv(socketFd, buffer, sizeof(buffer), 0)) > 0) {
+                packetsReceived++;
+                bytesReceived += static_cast<uint64_t>(received);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (const auto& [playerId, socketFd] : botSockets) {
+        close(socketFd);
+    }
+    LOG_INFO("Sent " + std::to_string(inputsSent) + " inputs and received " + std::to_string(packetsReceived) +
+             " packets (" + std::to_string(bytesReceived) + " bytes)", "LoadGen");
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "netcode/cluster/region_server.hpp"
+#include "netcode/lab/lab_entity.hpp"
+#include "netcode/utils/logger.hpp"
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void handleSignal(int) {
+    stopRequested = true;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program
+              << " --region N [--regions N] [--region-width F] [--host IP] [--base-port N] [--tick-rate N]" << std::endl
+              << "Runs one region of a world split along X into equally wide regions numbered from 1."
+              << " Region N takes client port base + 2 * (N - 1) and the next port for cluster messages;"
+              << " players join through region 1." << std::endl;
+}
+
+// Parse the whole string as a number, rejecting trailing characters and values out of range
+template <typename T>
+bool parseNumber(const std::string& value, T& result) {
+    const char* end = value.data() + value.size();
+    auto [ptr, error] = std::from_chars(value.data(), end, result);
+    return error == std::errc() && ptr == end;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t regionId = 0;
+    uint32_t regionCount = 2;
+    float regionWidth = 100.0f;
+    int basePort = 7100;
+    netcode::ClusterConfig cluster;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--region") {
+            valid = parseNumber(value, regionId) && regionId > 0;
+        } else if (arg == "--regions") {
+            valid = parseNumber(value, regionCount) && regionCount > 0;
+        } else if (arg == "--region-width") {
+            valid = parseNumber(value, regionWidth) && regionWidth > 0.0f;
+        } else if (arg == "--host") {
+            in_addr addr;
+            valid = inet_pton(AF_INET, value.c_str(), &addr) == 1;
+            cluster.host = value;
+        } else if (arg == "--base-port") {
+            valid = parseNumber(value, basePort) && basePort > 0 && basePort <= 65535;
+        } else if (arg == "--tick-rate") {
+            valid = parseNumber(value, cluster.tickRate) && cluster.tickRate > 0.0f;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (regionId == 0 || regionId > regionCount) {
+        std::cerr << "--region must be between 1 and the number of regions" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (basePort + 2 * static_cast<int64_t>(regionCount) - 1 > 65535) {
+        std::cerr << "Not enough ports above " << basePort << " for " << regionCount << " regions" << std::endl;
+        return 1;
+    }
+
+    // Every process derives the same layout, centered on the origin
+    float worldMinX = -regionWidth * static_cast<float>(regionCount) / 2.0f;
+    for (uint32_t id = 1; id <= regionCount; ++id) {
+        netcode::RegionConfig region;
+        region.regionId = id;
+        region.minX = worldMinX + regionWidth * static_cast<float>(id - 1);
+        region.maxX = region.minX + regionWidth;
+        region.clientPort = basePort + 2 * static_cast<int>(id - 1);
+        region.peerPort = region.clientPort + 1;
+        region.spawnPlayers = id == 1;
+        cluster.regions.push_back(region);
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    netcode::RegionServer regionServer(regionId, cluster);
+    regionServer.setEntityFactory([](uint32_t playerId) {
+        return std::make_shared<netcode::LabEntity>(playerId, netcode::math::MyVec3(0.0f, 1.0f, 0.0f));
+    });
+    regionServer.start();
+
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    regionServer.stop();
+    LOG_INFO("Region " + std::to_string(regionId) + " stopped", "RegionServer");
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "netcode/relay/relay.hpp"
+#include "netcode/utils/logger.hpp"
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void handleSignal(int) {
+    stopRequested = true;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program
+              << " [--id N] [--port N] [--server-ip IP] [--server-port N] [--rate N]" << std::endl;
+}
+
+// Parse the whole string as a number, rejecting trailing characters and values out of range
+template <typename T>
+bool parseNumber(const std::string& value, T& result) {
+    const char* end = value.data() + value.size();
+    auto [ptr, error] = std::from_chars(value.data(), end, result);
+    return error == std::errc() && ptr == end;
+}
+
+bool parsePort(const std::string& value, int& port) {
+    return parseNumber(value, port) && port > 0 && port <= 65535;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    netcode::RelayConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--id") {
+            valid = parseNumber(value, config.relayId);
+        } else if (arg == "--port") {
+            valid = parsePort(value, config.clientPort);
+        } else if (arg == "--server-ip") {
+            in_addr addr;
+            valid = inet_pton(AF_INET, value.c_str(), &addr) == 1;
+            config.serverIp = value;
+        } else if (arg == "--server-port") {
+            valid = parsePort(value, config.serverPort);
+        } else if (arg == "--rate") {
+            valid = parseNumber(value, config.maxPacketsPerSecond) && config.maxPacketsPerSecond > 0.0f;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    netcode::Relay relay(config);
+    if (!relay.start()) {
+        return 1;
+    }
+
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    relay.stop();
+    auto stats = relay.getStats();
+    LOG_INFO("Relay forwarded " + std::to_string(stats.inputsForwarded) + " inputs in " +
+             std::to_string(stats.uplinkPackets) + " packets and fanned out " +
+             std::to_string(stats.packetsFannedOut) + " packets", "Relay");
+    return 0;
+}
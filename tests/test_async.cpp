@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+#include "netcode/async/task.hpp"
+#include "netcode/async/event_loop.hpp"
+#include "netcode/async/udp_endpoint.hpp"
+#include "netcode/async/ack_tracker.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+using netcode::async::AckTracker;
+using netcode::async::EventLoop;
+using netcode::async::Task;
+using netcode::async::UdpEndpoint;
+
+namespace {
+
+sockaddr_in localAddress(int port) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    return addr;
+}
+
+Task<int> addAfter(EventLoop& loop, int a, int b, std::chrono::milliseconds delay) {
+    co_await loop.sleepFor(delay);
+    co_return a + b;
+}
+
+} // namespace
+
+TEST(EventLoopTest, TasksSleepTickAndReturnValues) {
+    EventLoop loop(100.0f);
+    std::vector<std::string> order;
+    int sum = 0;
+    uint64_t firstTick = 0;
+    uint64_t secondTick = 0;
+
+    loop.spawn([](EventLoop& loop, std::vector<std::string>& order) -> Task<void> {
+        co_await loop.sleepFor(30ms);
+        order.push_back("slow");
+    }(loop, order));
+    loop.spawn([](EventLoop& loop, std::vector<std::string>& order, int& sum) -> Task<void> {
+        sum = co_await addAfter(loop, 2, 3, 10ms);
+        order.push_back("fast");
+    }(loop, order, sum));
+    loop.spawn([](EventLoop& loop, uint64_t& first, uint64_t& second) -> Task<void> {
+        first = co_await loop.nextTick();
+        second = co_await loop.nextTick();
+    }(loop, firstTick, secondTick));
+
+    EXPECT_EQ(loop.getActiveTaskCount(), 3u);
+    loop.run();
+
+    EXPECT_EQ(loop.getActiveTaskCount(), 0u);
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], "fast");
+    EXPECT_EQ(order[1], "slow");
+    EXPECT_EQ(sum, 5);
+    EXPECT_EQ(secondTick, firstTick + 1);
+}
+
+TEST(EventLoopTest, ReliableSendRetriesUntilAcknowledged) {
+    EventLoop loop;
+    UdpEndpoint sender(loop);
+    UdpEndpoint receiver(loop);
+    ASSERT_TRUE(sender.bind(0));
+    ASSERT_TRUE(receiver.bind(0));
+    AckTracker acks(loop);
+
+    // The receiver ignores the first copy and acknowledges the second
+    int received = 0;
+    loop.spawn([](UdpEndpoint& receiver, UdpEndpoint& sender, int& received) -> Task<void> {
+        while (received < 2) {
+            auto datagram = co_await receiver.accept(1s);
+            if (!datagram) {
+                co_return;
+            }
+            received++;
+            receiver.release(datagram->from);
+        }
+        uint32_t ack = 7;
+        receiver.sendTo(localAddress(sender.getPort()), &ack, sizeof(ack));
+    }(receiver, sender, received));
+
+    // The sender's receive path feeds the acknowledgements into the tracker
+    loop.spawn([](UdpEndpoint& sender, UdpEndpoint& receiver, AckTracker& acks) -> Task<void> {
+        auto datagram = co_await sender.nextPacket(localAddress(receiver.getPort()), 1s);
+        if (datagram && datagram->data.size() == sizeof(uint32_t)) {
+            uint32_t ack;
+            memcpy(&ack, datagram->data.data(), sizeof(ack));
+            acks.acknowledge(ack);
+        }
+    }(sender, receiver, acks));
+
+    bool delivered = false;
+    bool timedOut = true;
+    loop.spawn([](UdpEndpoint& sender, UdpEndpoint& receiver, AckTracker& acks, bool& delivered, bool& timedOut) -> Task<void> {
+        // Nothing acknowledges sequence 8 within the timeout
+        timedOut = !(co_await acks.waitForAck(8, 20ms));
+        std::vector<char> payload(16, 'x');
+        delivered = co_await netcode::async::sendReliable(sender, localAddress(receiver.getPort()),
+                                                          payload, acks, 7, 5, 30ms);
+    }(sender, receiver, acks, delivered, timedOut));
+
+    loop.run();
+
+    EXPECT_TRUE(timedOut);
+    EXPECT_TRUE(delivered);
+    EXPECT_EQ(received, 2);
+    EXPECT_TRUE(acks.isAcknowledged(7));
+    EXPECT_FALSE(acks.isAcknowledged(8));
+    // The timed out waits for 8 and for the first copy of 7 are gone
+    EXPECT_EQ(acks.getPendingWaitCount(), 0u);
+}
+
+TEST(EventLoopTest, TimedOutReceivesLeaveNoWaits) {
+    EventLoop loop;
+    UdpEndpoint endpoint(loop);
+    UdpEndpoint silent(loop);
+    ASSERT_TRUE(endpoint.bind(0));
+    ASSERT_TRUE(silent.bind(0));
+
+    // A session polling a peer that never sends, and a server accepting while nobody connects
+    int timeouts = 0;
+    loop.spawn([](UdpEndpoint& endpoint, UdpEndpoint& silent, int& timeouts) -> Task<void> {
+        for (int i = 0; i < 10; ++i) {
+            if (!(co_await endpoint.nextPacket(localAddress(silent.getPort()), 2ms))) {
+                timeouts++;
+            }
+            if (!(co_await endpoint.accept(2ms))) {
+                timeouts++;
+            }
+        }
+    }(endpoint, silent, timeouts));
+
+    loop.run();
+
+    EXPECT_EQ(timeouts, 20);
+    EXPECT_EQ(endpoint.getPendingWaitCount(), 0u);
+}
+
+TEST(EventLoopTest, ThousandsOfCoroutinesShareOneThread) {
+    // Sessions are told apart by address, so every client gets its own socket
+    constexpr int SESSION_COUNT = 500;
+    EventLoop loop;
+    UdpEndpoint server(loop);
+    ASSERT_TRUE(server.bind(0));
+    sockaddr_in serverAddr = localAddress(server.getPort());
+
+    // One coroutine per session: hello, welcome and a ping round trip, written as straight-line code
+    auto session = [](UdpEndpoint& server, netcode::async::Datagram hello, int& completed) -> Task<void> {
+        server.sendTo(hello.from, hello.data.data(), hello.data.size());
+        auto ping = co_await server.nextPacket(hello.from, 2s);
+        while (ping && ping->data == hello.data) {
+            // The client resent its hello before our welcome arrived
+            server.sendTo(hello.from, hello.data.data(), hello.data.size());
+            ping = co_await server.nextPacket(hello.from, 2s);
+        }
+        if (ping) {
+            server.sendTo(hello.from, ping->data.data(), ping->data.size());
+            completed++;
+        }
+        server.release(hello.from);
+    };
+
+    int completed = 0;
+    loop.spawn([](EventLoop& loop, UdpEndpoint& server, auto session, int& completed) -> Task<void> {
+        for (int i = 0; i < SESSION_COUNT; ++i) {
+            auto hello = co_await server.accept(2s);
+            if (!hello) {
+                co_return;
+            }
+            loop.spawn(session(server, std::move(*hello), completed));
+        }
+    }(loop, server, session, completed));
+
+    // One coroutine per client, all on the same loop as the server
+    int answered = 0;
+    std::vector<std::unique_ptr<UdpEndpoint>> clients;
+    for (uint32_t id = 0; id < SESSION_COUNT; ++id) {
+        clients.push_back(std::make_unique<UdpEndpoint>(loop));
+        ASSERT_TRUE(clients.back()->bind(0));
+        loop.spawn([](UdpEndpoint& client, sockaddr_in serverAddr, uint32_t id, int& answered) -> Task<void> {
+            // Everybody connects at once, so hellos can overflow the server's socket buffer and need a retry
+            std::optional<netcode::async::Datagram> welcome;
+            for (int attempt = 0; attempt < 20 && !welcome; ++attempt) {
+                client.sendTo(serverAddr, &id, sizeof(id));
+                welcome = co_await client.nextPacket(serverAddr, 100ms);
+            }
+            if (!welcome) {
+                co_return;
+            }
+            uint32_t ping = id + 1;
+            client.sendTo(serverAddr, &ping, sizeof(ping));
+            auto pong = co_await client.nextPacket(serverAddr, 2s);
+            while (pong && pong->data == welcome->data) {
+                pong = co_await client.nextPacket(serverAddr, 2s);
+            }
+            uint32_t echoed = 0;
+            if (pong && pong->data.size() == sizeof(echoed)) {
+                memcpy(&echoed, pong->data.data(), sizeof(echoed));
+                answered += echoed == ping ? 1 : 0;
+            }
+        }(*clients.back(), serverAddr, id, answered));
+    }
+
+    EXPECT_EQ(loop.getActiveTaskCount(), SESSION_COUNT + 1u);
+    loop.run();
+
+    EXPECT_EQ(completed, SESSION_COUNT);
+    EXPECT_EQ(answered, SESSION_COUNT);
+    EXPECT_EQ(server.getDroppedCount(), 0u);
+}
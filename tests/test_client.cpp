@@ -2,9 +2,13 @@
 #include "netcode/client/client.hpp"
 #include "netcode/networked_entity.hpp"
 #include "netcode/settings.hpp"
+#include "netcode/packets/player_state_packet.hpp"
+#include "netcode/utils/state_hash.hpp"
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <vector>
 
 // Mock settings for testing
 class MockSettings : public netcode::ISettings {
@@ -42,10 +46,11 @@ public:
     void update() override {  }
     void jump() override { }
     void updateRenderPosition(float deltaTime) override { renderPosition_ = position_; }
-    void snapSimulationState(const netcode::math::MyVec3& pos, bool isJumping = false, float velocityY = 0.0f) override {
+    void snapSimulationState(const netcode::math::MyVec3& pos, bool isJumping = false, const netcode::math::MyVec3& velocity = {}) override {
         position_ = pos;
 
-        velocity_.y = velocityY;
+        isJumping_ = isJumping;
+        velocity_ = velocity;
 
     }
     void initiateVisualBlend() override {}
@@ -53,6 +58,7 @@ public:
     netcode::math::MyVec3 getRenderPosition() const override { return renderPosition_; }
     void setPosition(const netcode::math::MyVec3& pos) override { position_ = pos; renderPosition_ = pos; }
     netcode::math::MyVec3 getVelocity() const override { return velocity_; }
+    bool isJumping() const override { return isJumping_; }
     uint32_t getId() const override { return id_; }
     float getMoveSpeed() const override { return 1.0f; } 
 
@@ -61,6 +67,7 @@ private:
     netcode::math::MyVec3 position_;
     netcode::math::MyVec3 renderPosition_;
     netcode::math::MyVec3 velocity_;
+    bool isJumping_ = false;
 };
 
 class ClientTest : public ::testing::Test {
@@ -140,6 +147,26 @@ TEST_F(ClientTest, SendMovementRequest) {
     client_->stop();
 }
 
+TEST_F(ClientTest, RecordsSentInputs) {
+    auto playerEntity = std::make_shared<MockNetworkedEntity>(clientId_);
+    client_->setPlayerReference(clientId_, playerEntity);
+    auto recorder = std::make_shared<netcode::InputTraceRecorder>();
+    client_->setInputRecorder(recorder);
+
+    client_->sendMovementRequest({1.0f, 0.0f, 0.0f}, false);
+    client_->sendMovementRequest({0.0f, 0.0f, -1.0f}, true);
+    client_->setInputRecorder(nullptr);
+    client_->sendMovementRequest({1.0f, 0.0f, 0.0f}, false);
+
+    auto trace = recorder->getTrace();
+    ASSERT_EQ(trace.getEvents().size(), 2u);
+    EXPECT_EQ(trace.getEvents()[0].input.player_id, clientId_);
+    EXPECT_EQ(trace.getEvents()[0].input.movement_x, 1.0f);
+    EXPECT_EQ(trace.getEvents()[1].input.movement_z, -1.0f);
+    EXPECT_TRUE(trace.getEvents()[1].input.is_jumping);
+    EXPECT_LT(trace.getEvents()[0].input.input_sequence_number, trace.getEvents()[1].input.input_sequence_number);
+}
+
 TEST_F(ClientTest, UpdatePlayerPositionRemotePlayerWithInterpolation) {
     client_->start();
     uint32_t remotePlayerId = 2;
@@ -191,4 +218,211 @@ TEST_F(ClientTest, UpdatePlayerPositionRemotePlayerNoInterpolation) {
     EXPECT_EQ(remotePlayerEntity->getPosition().z, serverPos.z);
     
     client_->stop();
-}
\ No newline at end of file
+}
+TEST_F(ClientTest, ReportsDivergingEntitiesFromWorldChecksum) {
+    // Act as the server so state and checksum packets can be sent to the client
+    int mockServerSocketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(mockServerSocketFd, 0);
+    sockaddr_in mockServerAddr;
+    memset(&mockServerAddr, 0, sizeof(mockServerAddr));
+    mockServerAddr.sin_family = AF_INET;
+    mockServerAddr.sin_addr.s_addr = inet_addr(serverIp_.c_str());
+    mockServerAddr.sin_port = htons(serverPort_);
+    ASSERT_GE(bind(mockServerSocketFd, (struct sockaddr*)&mockServerAddr, sizeof(mockServerAddr)), 0);
+
+    std::atomic<int> desyncReports{0};
+    std::vector<uint32_t> reportedEntities;
+    client_->setDesyncCallback([&](uint32_t, const std::vector<uint32_t>& entityIds) {
+        reportedEntities = entityIds;
+        desyncReports++;
+    });
+
+    client_->start();
+    uint32_t remotePlayerId = 2;
+    auto remotePlayerEntity = std::make_shared<MockNetworkedEntity>(remotePlayerId);
+    client_->setPlayerReference(remotePlayerId, remotePlayerEntity);
+
+    sockaddr_in clientAddr;
+    memset(&clientAddr, 0, sizeof(clientAddr));
+    clientAddr.sin_family = AF_INET;
+    clientAddr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    clientAddr.sin_port = htons(clientPort_);
+
+    netcode::packets::TimestampedPlayerStatePacket state{};
+    state.timestamp = std::chrono::steady_clock::now();
+    state.player_state.player_id = remotePlayerId;
+    state.player_state.x = 4.0f;
+    state.player_state.state_sequence = 1;
+    sendto(mockServerSocketFd, &state, sizeof(state), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+
+    // A matching checksum is not reported
+    netcode::packets::TimestampedStateChecksumPacket checksum{};
+    checksum.timestamp = std::chrono::steady_clock::now();
+    checksum.checksum.checksum_sequence = 1;
+    checksum.checksum.entity_count = 1;
+    checksum.checksum.count = 1;
+    checksum.checksum.entries[0] = {remotePlayerId, 1, netcode::utils::hash_entity_state(state.player_state)};
+    checksum.checksum.world_checksum = checksum.checksum.entries[0].hash;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sendto(mockServerSocketFd, &checksum, sizeof(checksum), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(desyncReports.load(), 0);
+
+    // The server's state differs at the same sequence
+    state.player_state.x = 5.0f;
+    checksum.checksum.checksum_sequence = 2;
+    checksum.checksum.entries[0].hash = netcode::utils::hash_entity_state(state.player_state);
+    checksum.checksum.world_checksum = checksum.checksum.entries[0].hash;
+    sendto(mockServerSocketFd, &checksum, sizeof(checksum), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(desyncReports.load(), 1);
+    ASSERT_EQ(reportedEntities.size(), 1u);
+    EXPECT_EQ(reportedEntities[0], remotePlayerId);
+
+    // The client asks for the diverging entity again with a zero acknowledgement
+    bool resyncRequested = false;
+    char buffer[1024];
+    auto startTime = std::chrono::steady_clock::now();
+    while (!resyncRequested &&
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 300) {
+        ssize_t bytesReceived = recvfrom(mockServerSocketFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesReceived == static_cast<ssize_t>(sizeof(netcode::packets::TimestampedStateAckPacket))) {
+            netcode::packets::TimestampedStateAckPacket ack;
+            memcpy(&ack, buffer, sizeof(ack));
+            for (uint32_t i = 0; i < ack.state_ack.count; ++i) {
+                resyncRequested |= ack.state_ack.entries[i].entity_id == remotePlayerId &&
+                                   ack.state_ack.entries[i].state_sequence == 0;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(resyncRequested);
+
+    client_->stop();
+    close(mockServerSocketFd);
+}
+
+TEST_F(ClientTest, ChecksumIsComparedAgainstThePredictedState) {
+    int mockServerSocketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(mockServerSocketFd, 0);
+    sockaddr_in mockServerAddr;
+    memset(&mockServerAddr, 0, sizeof(mockServerAddr));
+    mockServerAddr.sin_family = AF_INET;
+    mockServerAddr.sin_addr.s_addr = inet_addr(serverIp_.c_str());
+    mockServerAddr.sin_port = htons(serverPort_);
+    ASSERT_GE(bind(mockServerSocketFd, (struct sockaddr*)&mockServerAddr, sizeof(mockServerAddr)), 0);
+
+    std::atomic<int> desyncReports{0};
+    std::vector<uint32_t> reportedEntities;
+    client_->setDesyncCallback([&](uint32_t, const std::vector<uint32_t>& entityIds) {
+        reportedEntities = entityIds;
+        desyncReports++;
+    });
+
+    client_->start();
+    auto playerEntity = std::make_shared<MockNetworkedEntity>(clientId_);
+    client_->setPlayerReference(clientId_, playerEntity);
+
+    sockaddr_in clientAddr;
+    memset(&clientAddr, 0, sizeof(clientAddr));
+    clientAddr.sin_family = AF_INET;
+    clientAddr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    clientAddr.sin_port = htons(clientPort_);
+
+    // The server ends up where the client predicted the first input
+    client_->sendMovementRequest({1.0f, 0.0f, 0.0f}, false);
+    netcode::packets::TimestampedPlayerStatePacket state{};
+    state.timestamp = std::chrono::steady_clock::now();
+    state.player_state.player_id = clientId_;
+    state.player_state.x = 1.0f;
+    state.player_state.state_sequence = 1;
+    state.player_state.last_processed_input_sequence = 1;
+    state.player_state.wasPredicted = true;
+    sendto(mockServerSocketFd, &state, sizeof(state), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+
+    netcode::packets::TimestampedStateChecksumPacket checksum{};
+    checksum.timestamp = std::chrono::steady_clock::now();
+    checksum.checksum.checksum_sequence = 1;
+    checksum.checksum.entity_count = 1;
+    checksum.checksum.count = 1;
+    checksum.checksum.entries[0] = {clientId_, 1, netcode::utils::hash_entity_state(state.player_state)};
+    checksum.checksum.world_checksum = checksum.checksum.entries[0].hash;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sendto(mockServerSocketFd, &checksum, sizeof(checksum), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(desyncReports.load(), 0);
+
+    // Corrupt the client's state, its prediction of the second input no longer matches the server
+    playerEntity->setPosition({10.0f, 0.0f, 0.0f});
+    client_->sendMovementRequest({1.0f, 0.0f, 0.0f}, false);
+    state.timestamp = std::chrono::steady_clock::now();
+    state.player_state.x = 2.0f;
+    state.player_state.state_sequence = 2;
+    state.player_state.last_processed_input_sequence = 2;
+    sendto(mockServerSocketFd, &state, sizeof(state), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+
+    checksum.timestamp = std::chrono::steady_clock::now();
+    checksum.checksum.checksum_sequence = 2;
+    checksum.checksum.entries[0] = {clientId_, 2, netcode::utils::hash_entity_state(state.player_state)};
+    checksum.checksum.world_checksum = checksum.checksum.entries[0].hash;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sendto(mockServerSocketFd, &checksum, sizeof(checksum), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(desyncReports.load(), 1);
+    ASSERT_EQ(reportedEntities.size(), 1u);
+    EXPECT_EQ(reportedEntities[0], clientId_);
+
+    client_->stop();
+    close(mockServerSocketFd);
+}
+
+TEST_F(ClientTest, RedirectSwitchesServer) {
+    client_->start();
+    auto playerEntity = std::make_shared<MockNetworkedEntity>(clientId_);
+    client_->setPlayerReference(clientId_, playerEntity);
+
+    // The region server the client is redirected to
+    int newServerSocketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(newServerSocketFd, 0);
+    sockaddr_in newServerAddr;
+    memset(&newServerAddr, 0, sizeof(newServerAddr));
+    newServerAddr.sin_family = AF_INET;
+    newServerAddr.sin_addr.s_addr = inet_addr(serverIp_.c_str());
+    newServerAddr.sin_port = htons(7031);
+    ASSERT_GE(bind(newServerSocketFd, (struct sockaddr*)&newServerAddr, sizeof(newServerAddr)), 0);
+
+    sockaddr_in clientAddr;
+    memset(&clientAddr, 0, sizeof(clientAddr));
+    clientAddr.sin_family = AF_INET;
+    clientAddr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    clientAddr.sin_port = htons(clientPort_);
+
+    // The redirect takes effect at its timestamp, like the states sent before it
+    netcode::packets::TimestampedRedirectPacket redirect{};
+    redirect.timestamp = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    redirect.redirect.player_id = clientId_;
+    redirect.redirect.region_id = 2;
+    redirect.redirect.server_ip = inet_addr("127.0.0.1");
+    redirect.redirect.server_port = 7031;
+    sendto(newServerSocketFd, &redirect, sizeof(redirect), 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(client_->getServerPort(), serverPort_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    EXPECT_EQ(client_->getServerPort(), 7031);
+
+    client_->sendMovementRequest({1.0f, 0.0f, 0.0f}, false);
+
+    char buffer[1024];
+    bool received = false;
+    auto startTime = std::chrono::steady_clock::now();
+    while (!received &&
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 300) {
+        ssize_t bytesReceived = recvfrom(newServerSocketFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        received = bytesReceived == sizeof(netcode::packets::TimestampedPlayerMovementRequest);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(received);
+
+    client_->stop();
+    close(newServerSocketFd);
+}
@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+#include "netcode/lab/link_emulator.hpp"
+#include "netcode/lab/lab_runner.hpp"
+#include "netcode/lab/lab_entity.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+int openTestSocket(int port) {
+    int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    int flags = fcntl(socketFd, F_GETFL, 0);
+    fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(port);
+    bind(socketFd, (struct sockaddr*)&addr, sizeof(addr));
+    return socketFd;
+}
+
+sockaddr_in makeAddress(int port) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+} // namespace
+
+TEST(LabTest, EntityStopsOnStepsWithoutMovement) {
+    netcode::LabEntity entity(1, {0.0f, 1.0f, 0.0f});
+    entity.move({1.0f, 0.0f, 0.0f});
+    entity.jump();
+    entity.update();
+    EXPECT_GT(entity.getVelocity().x, 0.0f);
+    EXPECT_GT(entity.getVelocity().y, 0.0f);
+
+    // The next step has no input: horizontal velocity is gone, the jump carries on
+    entity.update();
+    EXPECT_EQ(entity.getVelocity().x, 0.0f);
+    EXPECT_EQ(entity.getVelocity().z, 0.0f);
+    EXPECT_TRUE(entity.isJumping());
+    EXPECT_FLOAT_EQ(entity.getPosition().x, 0.2f);
+}
+
+TEST(LabTest, LinkEmulatorDelaysAndDropsPackets) {
+    netcode::LinkEmulatorConfig config;
+    config.listenPort = 9061;
+    config.serverPort = 9060;
+    config.upstream.delayMs = 40;
+    config.downstream.lossPercent = 50.0f;
+    netcode::LinkEmulator link(config);
+    ASSERT_TRUE(link.start());
+
+    int serverFd = openTestSocket(9060);
+    int clientFd = openTestSocket(9062);
+    sockaddr_in linkAddr = makeAddress(9061);
+
+    // Upstream packets arrive whole, but only after the delay
+    uint32_t value = 42;
+    auto sendTime = std::chrono::steady_clock::now();
+    sendto(clientFd, &value, sizeof(value), 0, (struct sockaddr*)&linkAddr, sizeof(linkAddr));
+    uint32_t received = 0;
+    sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    while (recvfrom(serverFd, &received, sizeof(received), 0, (struct sockaddr*)&from, &fromLen) < 0 &&
+           std::chrono::steady_clock::now() - sendTime < std::chrono::seconds(1)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(received, 42u);
+    EXPECT_GE(std::chrono::steady_clock::now() - sendTime, std::chrono::milliseconds(40));
+
+    // Replies to the emulator's forwarding address reach the client, about half of them
+    for (uint32_t i = 0; i < 200; ++i) {
+        sendto(serverFd, &i, sizeof(i), 0, (struct sockaddr*)&from, fromLen);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    int delivered = 0;
+    while (recv(clientFd, &received, sizeof(received), 0) > 0) {
+        delivered++;
+    }
+    EXPECT_GT(delivered, 60);
+    EXPECT_LT(delivered, 140);
+
+    auto stats = link.getStats();
+    EXPECT_EQ(stats.upstreamPackets, 1u);
+    EXPECT_EQ(stats.downstreamPackets, static_cast<uint64_t>(delivered));
+    EXPECT_EQ(stats.packetsDropped, 200u - delivered);
+
+    link.stop();
+    close(serverFd);
+    close(clientFd);
+}
+
+TEST(LabTest, CellMeasuresTrafficAndCorrections) {
+    netcode::LabCellConfig config;
+    config.link.delayMs = 30;
+    config.link.jitterMs = 10;
+    config.durationMs = 800;
+    config.basePort = 9070;
+    netcode::LabCellResult result = netcode::runLabCell(config);
+
+    EXPECT_GT(result.ticks, 30u);
+    EXPECT_GT(result.upstreamBytesPerSecond, 0.0);
+    EXPECT_GT(result.downstreamBytesPerSecond, 0.0);
+    EXPECT_GT(result.cpuUsPerTick, 0.0);
+    EXPECT_GT(result.corrections, 0u);
+    EXPECT_GE(result.maxPredictionError, result.meanPredictionError);
+    EXPECT_GE(result.interpolationStarvation, 0.0);
+    EXPECT_LE(result.interpolationStarvation, 1.0);
+    EXPECT_EQ(result.packetsDropped, 0u);
+}
@@ -0,0 +1,293 @@
+#include "gtest/gtest.h"
+#include "netcode/lockstep/lockstep_session.hpp"
+#include "netcode/lockstep/lockstep_peer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Deterministic unit simulation in integer math, units are owned round robin by players 1 and 2
+class UnitSimulation : public netcode::ILockstepSimulation {
+public:
+    explicit UnitSimulation(size_t unitCount) : positions_(unitCount, 0) {}
+
+    void step(uint32_t turn, const std::vector<netcode::packets::PlayerMovementRequest>& commands) override {
+        stepsRun_++;
+        for (size_t i = 0; i < positions_.size(); ++i) {
+            positions_[i] += static_cast<int64_t>((i * 7 + turn) % 3) - 1;
+        }
+        for (const auto& command : commands) {
+            commandTurns_.push_back(turn);
+            for (size_t i = command.player_id % 2; i < positions_.size(); i += 2) {
+                positions_[i] += static_cast<int64_t>(command.movement_x * 100.0f);
+            }
+        }
+        if (turn == corruptTurn_) {
+            positions_[0]++;
+        }
+    }
+
+    uint64_t checksum() const override {
+        uint64_t hash = 14695981039346656037ull;
+        for (int64_t position : positions_) {
+            hash = (hash ^ static_cast<uint64_t>(position)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // The command log is part of the state, so joiners can be compared against founders
+    std::vector<uint8_t> saveState() const override {
+        std::vector<uint8_t> state(2 * sizeof(uint64_t) + positions_.size() * sizeof(int64_t) +
+                                   commandTurns_.size() * sizeof(uint32_t));
+        uint64_t sizes[2] = {positions_.size(), commandTurns_.size()};
+        uint8_t* out = state.data();
+        std::memcpy(out, sizes, sizeof(sizes));
+        std::memcpy(out + sizeof(sizes), positions_.data(), positions_.size() * sizeof(int64_t));
+        std::memcpy(out + sizeof(sizes) + positions_.size() * sizeof(int64_t), commandTurns_.data(),
+                    commandTurns_.size() * sizeof(uint32_t));
+        return state;
+    }
+
+    bool loadState(const std::vector<uint8_t>& state) override {
+        uint64_t sizes[2];
+        if (state.size() < sizeof(sizes)) {
+            return false;
+        }
+        std::memcpy(sizes, state.data(), sizeof(sizes));
+        if (state.size() != sizeof(sizes) + sizes[0] * sizeof(int64_t) + sizes[1] * sizeof(uint32_t)) {
+            return false;
+        }
+        positions_.resize(sizes[0]);
+        commandTurns_.resize(sizes[1]);
+        std::memcpy(positions_.data(), state.data() + sizeof(sizes), sizes[0] * sizeof(int64_t));
+        std::memcpy(commandTurns_.data(), state.data() + sizeof(sizes) + sizes[0] * sizeof(int64_t),
+                    sizes[1] * sizeof(uint32_t));
+        return true;
+    }
+
+    std::vector<int64_t> positions_;
+    std::vector<uint32_t> commandTurns_;
+    uint32_t corruptTurn_ = 0;
+    uint32_t stepsRun_ = 0;
+};
+
+netcode::packets::PlayerMovementRequest makeCommand(uint32_t playerId, float x) {
+    netcode::packets::PlayerMovementRequest command{};
+    command.player_id = playerId;
+    command.movement_x = x;
+    return command;
+}
+
+// Deliver every queued packet between in-memory sessions, replies go back to the requester
+void exchange(const std::vector<netcode::LockstepSession*>& sessions) {
+    for (auto* sender : sessions) {
+        for (const auto& packet : sender->takeOutgoing()) {
+            for (auto* receiver : sessions) {
+                if (receiver == sender) {
+                    continue;
+                }
+                for (const auto& reply : receiver->receive(packet)) {
+                    sender->receive(reply);
+                }
+            }
+        }
+    }
+}
+
+// Advance every session once: flat out while behind, otherwise a single turn; stalled sessions ask for commands
+void tick(const std::vector<netcode::LockstepSession*>& sessions) {
+    exchange(sessions);
+    for (auto* session : sessions) {
+        if (session->advance(session->isBehind() ? 64 : 1) > 0) {
+            continue;
+        }
+        auto request = session->isMember() ? session->makeResendRequest() : session->makeJoinRequest();
+        for (auto* other : sessions) {
+            if (other == session) {
+                continue;
+            }
+            for (const auto& reply : other->receive(request)) {
+                session->receive(reply);
+            }
+        }
+    }
+}
+
+netcode::LockstepConfig makeConfig(uint32_t peerId) {
+    netcode::LockstepConfig config;
+    config.peerId = peerId;
+    config.founders = {1, 2};
+    config.hostId = 1;
+    config.inputDelayTurns = 2;
+    config.checksumInterval = 10;
+    return config;
+}
+
+} // namespace
+
+TEST(LockstepTest, PeersExecuteDelayedCommandsInTheSameTurn) {
+    UnitSimulation simulationA(100);
+    UnitSimulation simulationB(100);
+    netcode::LockstepSession a(makeConfig(1), simulationA);
+    netcode::LockstepSession b(makeConfig(2), simulationB);
+
+    // Turns 1 to 3 were closed on creation, so commands issued now wait for turn 4
+    a.submitCommand(makeCommand(1, 1.0f));
+    b.submitCommand(makeCommand(2, -0.5f));
+    for (int i = 0; i < 40; ++i) {
+        tick({&a, &b});
+    }
+
+    EXPECT_EQ(a.getExecutedTurn(), b.getExecutedTurn());
+    EXPECT_GE(a.getExecutedTurn(), 30u);
+    EXPECT_EQ(simulationA.commandTurns_, (std::vector<uint32_t>{4, 4}));
+    EXPECT_EQ(simulationA.commandTurns_, simulationB.commandTurns_);
+    EXPECT_EQ(simulationA.positions_, simulationB.positions_);
+    EXPECT_GT(a.getStats().checksumsCompared, 0u);
+    EXPECT_EQ(a.getStats().desyncs, 0u);
+}
+
+TEST(LockstepTest, ChecksumsRevealDesync) {
+    UnitSimulation simulationA(100);
+    UnitSimulation simulationB(100);
+    simulationB.corruptTurn_ = 15;
+    netcode::LockstepSession a(makeConfig(1), simulationA);
+    netcode::LockstepSession b(makeConfig(2), simulationB);
+
+    uint32_t reportedTurn = 0;
+    a.setDesyncCallback([&reportedTurn](uint32_t turn, uint32_t peerId) {
+        if (reportedTurn == 0) {
+            reportedTurn = turn;
+        }
+        EXPECT_EQ(peerId, 2u);
+    });
+    for (int i = 0; i < 40; ++i) {
+        tick({&a, &b});
+    }
+
+    // The first checksum after the divergence catches it
+    EXPECT_EQ(reportedTurn, 20u);
+    EXPECT_EQ(a.getStats().firstDesyncTurn, 20u);
+    EXPECT_GT(b.getStats().desyncs, 0u);
+}
+
+TEST(LockstepTest, LateJoinerFastForwardsAndTakesPart) {
+    UnitSimulation simulationA(1000);
+    UnitSimulation simulationB(1000);
+    netcode::LockstepSession a(makeConfig(1), simulationA);
+    netcode::LockstepSession b(makeConfig(2), simulationB);
+    for (int i = 0; i < 200; ++i) {
+        if (i % 10 == 0) {
+            a.submitCommand(makeCommand(1, 0.25f));
+        }
+        tick({&a, &b});
+    }
+    ASSERT_GE(a.getExecutedTurn(), 190u);
+
+    UnitSimulation simulationC(1000);
+    netcode::LockstepSession c(makeConfig(3), simulationC);
+    EXPECT_FALSE(c.isMember());
+    for (int i = 0; i < 40 && (!c.isMember() || c.getExecutedTurn() + 1 < a.getExecutedTurn()); ++i) {
+        tick({&a, &b, &c});
+    }
+
+    // The joiner started from the latest checkpoint instead of replaying the whole match, and is a member now
+    ASSERT_TRUE(c.isMember());
+    EXPECT_GT(c.getExecutedTurn(), 190u);
+    EXPECT_EQ(c.getCheckpointTurn(), a.getCheckpointTurn());
+    EXPECT_LT(simulationC.stepsRun_, 20u);
+
+    c.submitCommand(makeCommand(3, 1.0f));
+    for (int i = 0; i < 30; ++i) {
+        tick({&a, &b, &c});
+    }
+    // Ticks advance the joiner after the founders, let it take the turn they are ahead
+    exchange({&a, &b, &c});
+    c.advance(a.getExecutedTurn() - c.getExecutedTurn());
+    EXPECT_EQ(a.getExecutedTurn(), c.getExecutedTurn());
+    EXPECT_EQ(simulationA.positions_, simulationC.positions_);
+    EXPECT_EQ(simulationA.commandTurns_, simulationC.commandTurns_);
+    EXPECT_EQ(simulationB.commandTurns_.size(), 21u);
+    EXPECT_EQ(c.getStats().desyncs, 0u);
+}
+
+TEST(LockstepTest, TurnsEveryPeerSimulatedAreDropped) {
+    UnitSimulation simulationA(100);
+    UnitSimulation simulationB(100);
+    netcode::LockstepConfig configA = makeConfig(1);
+    netcode::LockstepConfig configB = makeConfig(2);
+    configA.checkpointInterval = 50;
+    configB.checkpointInterval = 50;
+    netcode::LockstepSession a(configA, simulationA);
+    netcode::LockstepSession b(configB, simulationB);
+
+    size_t mostStoredTurns = 0;
+    for (int i = 0; i < 500; ++i) {
+        if (i % 7 == 0) {
+            b.submitCommand(makeCommand(2, 0.5f));
+        }
+        tick({&a, &b});
+        mostStoredTurns = std::max({mostStoredTurns, a.getStoredTurnCount(), b.getStoredTurnCount()});
+    }
+
+    // Memory stays bounded by the checkpoint interval however long the match runs
+    ASSERT_GE(a.getExecutedTurn(), 450u);
+    EXPECT_EQ(a.getCheckpointTurn(), a.getExecutedTurn() / 50 * 50);
+    EXPECT_LE(mostStoredTurns, 50u + 2 * (configA.inputDelayTurns + 2));
+    EXPECT_EQ(simulationA.positions_, simulationB.positions_);
+    EXPECT_EQ(a.getStats().desyncs, 0u);
+}
+
+TEST(LockstepTest, UdpPeersSendOnlyInputs) {
+    // Bandwidth is the same for thousands of units as for a handful
+    auto run = [](size_t unitCount, int basePort, netcode::LockstepStats& stats) {
+        UnitSimulation simulationA(unitCount);
+        UnitSimulation simulationB(unitCount);
+        netcode::LockstepTransportConfig transportA;
+        transportA.port = basePort;
+        transportA.turnRate = 100.0f;
+        transportA.peers = {{2, "127.0.0.1", basePort + 1}};
+        netcode::LockstepTransportConfig transportB = transportA;
+        transportB.port = basePort + 1;
+        transportB.peers = {{1, "127.0.0.1", basePort}};
+
+        netcode::LockstepPeer a(makeConfig(1), transportA, simulationA);
+        netcode::LockstepPeer b(makeConfig(2), transportB, simulationB);
+        ASSERT_TRUE(a.start());
+        ASSERT_TRUE(b.start());
+
+        auto startTime = std::chrono::steady_clock::now();
+        while (a.getSession().getExecutedTurn() < 50 &&
+               std::chrono::steady_clock::now() - startTime < std::chrono::seconds(5)) {
+            if (a.update() > 0 && a.getSession().getExecutedTurn() % 5 == 0) {
+                a.submitCommand(makeCommand(1, 0.5f));
+            }
+            b.update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (int i = 0; i < 50; ++i) {
+            a.update();
+            b.update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ASSERT_GE(a.getSession().getExecutedTurn(), 50u);
+        EXPECT_EQ(a.getStats().desyncs, 0u);
+        EXPECT_EQ(b.getStats().desyncs, 0u);
+        EXPECT_GT(b.getStats().checksumsCompared, 0u);
+        stats = a.getStats();
+    };
+
+    netcode::LockstepStats small;
+    netcode::LockstepStats large;
+    run(10, 7070, small);
+    run(5000, 7072, large);
+
+    double smallBytesPerTurn = static_cast<double>(small.bytesSent) / small.executedTurn;
+    double largeBytesPerTurn = static_cast<double>(large.bytesSent) / large.executedTurn;
+    EXPECT_LT(largeBytesPerTurn, 200.0);
+    EXPECT_LT(largeBytesPerTurn, smallBytesPerTurn * 1.5);
+}
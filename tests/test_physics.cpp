@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "netcode/physics/prop.hpp"
+#include "netcode/physics/prop_world.hpp"
+#include <memory>
+
+using netcode::math::MyVec3;
+
+TEST(PropTest, FallsBouncesAndFallsAsleep) {
+    netcode::Prop prop(100, {0.0f, 5.0f, 0.0f});
+    EXPECT_FALSE(prop.isSleeping());
+
+    bool bounced = false;
+    for (int i = 0; i < 1000 && !prop.isSleeping(); ++i) {
+        prop.update();
+        bounced = bounced || prop.getVelocity().y > 0.0f;
+    }
+
+    EXPECT_TRUE(bounced);
+    ASSERT_TRUE(prop.isSleeping());
+    EXPECT_FLOAT_EQ(prop.getPosition().y, prop.getConfig().radius);
+    EXPECT_FALSE(prop.isJumping());
+
+    // A sleeping prop is not simulated until something wakes it
+    auto restingPosition = prop.getPosition();
+    prop.update();
+    EXPECT_EQ(prop.getPosition(), restingPosition);
+    prop.applyImpulse({0.1f, 0.0f, 0.0f});
+    EXPECT_FALSE(prop.isSleeping());
+    prop.update();
+    EXPECT_GT(prop.getPosition().x, restingPosition.x);
+}
+
+TEST(PropWorldTest, ReplicatesChangedPropsWithinBudget) {
+    netcode::PropWorldConfig config;
+    config.maxUpdatesPerTick = 10;
+    netcode::PropWorld world(config);
+    for (uint32_t i = 0; i < 25; ++i) {
+        world.addProp(std::make_shared<netcode::Prop>(100 + i, MyVec3(i * 2.0f, 0.5f, 0.0f)));
+    }
+
+    // Every new prop needs to be sent once, ten per tick
+    EXPECT_EQ(world.selectForReplication().size(), 10u);
+    EXPECT_EQ(world.selectForReplication().size(), 10u);
+    EXPECT_EQ(world.selectForReplication().size(), 5u);
+
+    // Once they are asleep they cost nothing
+    for (int i = 0; i < 120; ++i) {
+        world.update(1.0f / 60.0f, {});
+    }
+    while (!world.selectForReplication().empty()) {
+    }
+    EXPECT_EQ(world.getStats().awakeCount, 0u);
+    world.update(1.0f / 60.0f, {});
+    EXPECT_TRUE(world.selectForReplication().empty());
+
+    // A player walking into a prop wakes it and only that prop is sent
+    world.update(1.0f / 60.0f, {MyVec3(10.2f, 0.5f, 0.0f)});
+    auto selected = world.selectForReplication();
+    ASSERT_EQ(selected.size(), 1u);
+    EXPECT_EQ(selected[0]->getId(), 105u);
+    EXPECT_LT(selected[0]->getPosition().x, 10.0f);
+}
+
+TEST(PropWorldTest, CollidingPropsExchangeMomentum) {
+    netcode::PropWorld world;
+    auto moving = std::make_shared<netcode::Prop>(100, MyVec3(0.0f, 0.5f, 0.0f));
+    auto resting = std::make_shared<netcode::Prop>(101, MyVec3(1.5f, 0.5f, 0.0f));
+    world.addProp(moving);
+    world.addProp(resting);
+    moving->applyImpulse({0.2f, 0.0f, 0.0f});
+
+    for (int i = 0; i < 10; ++i) {
+        world.update(1.0f / 60.0f, {});
+    }
+
+    EXPECT_GT(resting->getPosition().x, 1.5f);
+    EXPECT_LT(moving->getVelocity().x, resting->getVelocity().x);
+    EXPECT_GE(netcode::math::Magnitude(resting->getPosition() - moving->getPosition()), 1.0f - 0.001f);
+}
@@ -0,0 +1,398 @@
+#include "gtest/gtest.h"
+#include "netcode/prediction/snapshot.hpp"
+#include "netcode/prediction/prediction.hpp"
+#include "netcode/prediction/reconciliation.hpp"
+#include "netcode/prediction/error_correction.hpp"
+#include "netcode/prediction/remote_prediction.hpp"
+#include "netcode/prediction/time_dilation.hpp"
+#include "netcode/lab/lab_entity.hpp"
+#include "netcode/networked_entity.hpp"
+#include <memory>
+#include <chrono>
+#include <thread>
+
+// Entity that records visual blends for testing the prediction systems
+class MockPredictionEntity : public netcode::NetworkedEntity {
+public:
+    explicit MockPredictionEntity(uint32_t id) : id_(id) {}
+
+    void move(const netcode::math::MyVec3& direction) override { position_ = position_ + direction; }
+    void update() override { }
+    void jump() override { }
+    void updateRenderPosition(float deltaTime) override {
+        errorOffset_.decay(deltaTime);
+        renderPosition_ = position_ + errorOffset_.get();
+    }
+    void snapSimulationState(const netcode::math::MyVec3& pos, bool isJumping = false, const netcode::math::MyVec3& velocity = {}) override {
+        position_ = pos;
+        isJumping_ = isJumping;
+        velocity_ = velocity;
+    }
+    void initiateVisualBlend() override {
+        errorOffset_.capture(renderPosition_, position_);
+        ++blendCount_;
+    }
+    netcode::math::MyVec3 getPosition() const override { return position_; }
+    netcode::math::MyVec3 getRenderPosition() const override { return renderPosition_; }
+    void setPosition(const netcode::math::MyVec3& pos) override { position_ = pos; }
+    netcode::math::MyVec3 getVelocity() const override { return velocity_; }
+    bool isJumping() const override { return isJumping_; }
+    uint32_t getId() const override { return id_; }
+    float getMoveSpeed() const override { return 1.0f; }
+
+    int getBlendCount() const { return blendCount_; }
+
+private:
+    uint32_t id_;
+    netcode::math::MyVec3 position_;
+    netcode::math::MyVec3 renderPosition_;
+    netcode::math::MyVec3 velocity_;
+    bool isJumping_ = false;
+    netcode::VisualErrorOffset errorOffset_;
+    int blendCount_ = 0;
+};
+
+TEST(VisualErrorOffsetTest, DecaysByHalfEveryHalfLife) {
+    netcode::ErrorCorrectionConfig config;
+    config.halfLife = 0.1f;
+    netcode::VisualErrorOffset offset(config);
+
+    offset.capture({2.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(offset.isActive());
+    EXPECT_FLOAT_EQ(offset.get().x, 2.0f);
+
+    offset.decay(0.1f);
+    EXPECT_NEAR(offset.get().x, 1.0f, 1e-4f);
+
+    // Two half steps equal one full half-life
+    offset.decay(0.05f);
+    offset.decay(0.05f);
+    EXPECT_NEAR(offset.get().x, 0.5f, 1e-4f);
+}
+
+TEST(VisualErrorOffsetTest, SnapsLargeErrors) {
+    netcode::ErrorCorrectionConfig config;
+    config.snapDistance = 1.0f;
+    netcode::VisualErrorOffset offset(config);
+
+    offset.capture({5.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+    EXPECT_FALSE(offset.isActive());
+    EXPECT_FLOAT_EQ(offset.get().x, 0.0f);
+}
+
+TEST(VisualErrorOffsetTest, ConvergesToZero) {
+    netcode::VisualErrorOffset offset;
+    offset.capture({0.5f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+    for (int i = 0; i < 600; ++i) {
+        offset.decay(1.0f / 60.0f);
+    }
+    EXPECT_FALSE(offset.isActive());
+    EXPECT_FLOAT_EQ(offset.get().x, 0.0f);
+}
+
+TEST(SnapshotManagerTest, KeepsEntityStateInOneRecord) {
+    netcode::SnapshotManager snapshotManager;
+    auto entity = std::make_shared<MockPredictionEntity>(7);
+    snapshotManager.registerEntity(7, entity);
+
+    // Out of order arrivals end up in sequence order
+    auto now = std::chrono::steady_clock::now();
+    for (uint32_t sequence : {3u, 1u, 2u}) {
+        snapshotManager.storeEntitySnapshot({7, {static_cast<float>(sequence), 0, 0}, {}, false, now, sequence});
+        snapshotManager.storeInputSnapshot({7, {1, 0, 0}, false, now, sequence});
+    }
+
+    const auto& records = snapshotManager.getRecords();
+    ASSERT_EQ(records.size(), 1u);
+    netcode::EntityHandle handle = records.find(7);
+    const netcode::EntityRecord* record = records.get(handle);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->entityId, 7u);
+    EXPECT_EQ(record->entity, entity);
+    ASSERT_EQ(record->snapshots.size(), 3u);
+    EXPECT_EQ(record->snapshots.front().sequenceNumber, 1u);
+    EXPECT_EQ(snapshotManager.getLatestEntitySnapshot(7).sequenceNumber, 3u);
+    EXPECT_EQ(snapshotManager.getInputSnapshotsAfter(7, 1).size(), 2u);
+    EXPECT_EQ(records.find(8), netcode::INVALID_ENTITY_HANDLE);
+    EXPECT_EQ(records.get(netcode::INVALID_ENTITY_HANDLE), nullptr);
+}
+
+TEST(SnapshotManagerTest, StaleHandlesStopResolvingAfterDespawn) {
+    netcode::SnapshotManager snapshotManager;
+    auto first = std::make_shared<MockPredictionEntity>(1);
+    netcode::EntityHandle firstHandle = snapshotManager.registerEntity(1, first);
+    EXPECT_EQ(snapshotManager.resolveEntity(firstHandle), first.get());
+    EXPECT_EQ(snapshotManager.getHandle(1), firstHandle);
+
+    snapshotManager.unregisterEntity(1);
+    EXPECT_EQ(snapshotManager.resolveEntity(firstHandle), nullptr);
+    EXPECT_EQ(snapshotManager.getEntity(1), nullptr);
+    EXPECT_EQ(first.use_count(), 1);
+
+    // The next entity reuses the slot, the old handle still resolves to nothing
+    auto second = std::make_shared<MockPredictionEntity>(2);
+    netcode::EntityHandle secondHandle = snapshotManager.registerEntity(2, second);
+    EXPECT_EQ(secondHandle.index, firstHandle.index);
+    EXPECT_EQ(snapshotManager.resolveEntity(firstHandle), nullptr);
+    EXPECT_EQ(snapshotManager.resolveEntity(secondHandle), second.get());
+    EXPECT_EQ(snapshotManager.registerEntity(3, nullptr), netcode::INVALID_ENTITY_HANDLE);
+}
+
+TEST(ReconciliationTest, CorrectsEveryServerUpdateWithoutCooldown) {
+    netcode::SnapshotManager snapshotManager;
+    netcode::PredictionSystem predictionSystem(snapshotManager);
+    netcode::ReconciliationSystem reconciliationSystem(predictionSystem);
+    reconciliationSystem.setReconciliationThreshold(0.1f);
+
+    auto entity = std::make_shared<MockPredictionEntity>(1);
+    snapshotManager.registerEntity(1, entity);
+
+    auto now = std::chrono::steady_clock::now();
+    EXPECT_TRUE(reconciliationSystem.reconcileState(entity, {1.0f, 0.0f, 0.0f}, 0, now));
+    reconciliationSystem.update(0.0f);
+    EXPECT_FLOAT_EQ(entity->getPosition().x, 1.0f);
+
+    // A second correction right away is applied as well
+    EXPECT_TRUE(reconciliationSystem.reconcileState(entity, {2.0f, 0.0f, 0.0f}, 0, now));
+    reconciliationSystem.update(0.0f);
+    EXPECT_FLOAT_EQ(entity->getPosition().x, 2.0f);
+    EXPECT_EQ(entity->getBlendCount(), 2);
+
+    // The simulation corrected instantly, the render position converges smoothly
+    entity->updateRenderPosition(0.0f);
+    EXPECT_FLOAT_EQ(entity->getRenderPosition().x, 0.0f);
+    entity->updateRenderPosition(0.5f);
+    EXPECT_NEAR(entity->getRenderPosition().x, 2.0f, 0.05f);
+}
+
+TEST(ReconciliationTest, RestoresServerKinematicState) {
+    netcode::SnapshotManager snapshotManager;
+    netcode::PredictionSystem predictionSystem(snapshotManager);
+    netcode::ReconciliationSystem reconciliationSystem(predictionSystem);
+
+    auto entity = std::make_shared<MockPredictionEntity>(1);
+    snapshotManager.registerEntity(1, entity);
+
+    netcode::math::MyVec3 serverVelocity = {0.2f, 1.1f, 0.0f};
+    EXPECT_TRUE(reconciliationSystem.reconcileState(
+        entity, {0.0f, 3.0f, 0.0f}, 0, std::chrono::steady_clock::now(), true, serverVelocity));
+    reconciliationSystem.update(0.0f);
+
+    // The jump continues from the server's point in the arc
+    EXPECT_TRUE(entity->isJumping());
+    EXPECT_FLOAT_EQ(entity->getVelocity().x, 0.2f);
+    EXPECT_FLOAT_EQ(entity->getVelocity().y, 1.1f);
+    EXPECT_FLOAT_EQ(entity->getPosition().y, 3.0f);
+}
+
+// Entity whose simulation step takes a while, like a player with expensive collision
+class SlowPredictionEntity : public MockPredictionEntity {
+public:
+    using MockPredictionEntity::MockPredictionEntity;
+    void update() override { std::this_thread::sleep_for(std::chrono::microseconds(200)); }
+};
+
+TEST(ReconciliationTest, MergesInputsBeyondPredictionHorizon) {
+    netcode::SnapshotManager snapshotManager;
+    netcode::PredictionSystem predictionSystem(snapshotManager);
+    netcode::ReconciliationSystem reconciliationSystem(predictionSystem);
+    reconciliationSystem.setPredictionHorizon(10);
+    reconciliationSystem.setReplayBudget(std::chrono::microseconds(0));
+
+    auto entity = std::make_shared<MockPredictionEntity>(1);
+    snapshotManager.registerEntity(1, entity);
+    for (int i = 0; i < 100; ++i) {
+        predictionSystem.applyInputPrediction(entity, {1.0f, 0.0f, 0.0f}, false);
+    }
+
+    // The server has seen none of the inputs yet; 91 of them are replayed as one step
+    EXPECT_TRUE(reconciliationSystem.reconcileState(entity, {0.0f, 0.0f, 5.0f}, 0, std::chrono::steady_clock::now()));
+    reconciliationSystem.update(0.0f);
+    EXPECT_FLOAT_EQ(entity->getPosition().x, 100.0f);
+    EXPECT_FLOAT_EQ(entity->getPosition().z, 5.0f);
+
+    const auto& stats = reconciliationSystem.getStats();
+    EXPECT_EQ(stats.inputsReplayed, 9u);
+    EXPECT_EQ(stats.horizonCaps, 1u);
+    EXPECT_EQ(stats.inputsMerged, 91u);
+    EXPECT_EQ(stats.budgetOverruns, 0u);
+}
+
+TEST(ReconciliationTest, MergingKeepsJumpsAndVelocity) {
+    netcode::SnapshotManager snapshotManager;
+    netcode::PredictionSystem predictionSystem(snapshotManager);
+    netcode::ReconciliationSystem reconciliationSystem(predictionSystem);
+    reconciliationSystem.setPredictionHorizon(5);
+    reconciliationSystem.setReplayBudget(std::chrono::microseconds(0));
+
+    // Walk, jump and keep walking through the landing, all beyond the horizon
+    auto entity = std::make_shared<netcode::LabEntity>(1, netcode::math::MyVec3(0.0f, 1.0f, 0.0f));
+    snapshotManager.registerEntity(1, entity);
+    for (int i = 0; i < 60; ++i) {
+        predictionSystem.applyInputPrediction(entity, {1.0f, 0.0f, 0.0f}, i == 10);
+    }
+
+    // The same inputs stepped one by one from the server's state
+    netcode::LabEntity reference(1, {0.0f, 1.0f, 5.0f});
+    for (int i = 0; i < 60; ++i) {
+        reference.move({1.0f, 0.0f, 0.0f});
+        if (i == 10) {
+            reference.jump();
+        }
+        reference.update();
+    }
+
+    EXPECT_TRUE(reconciliationSystem.reconcileState(entity, {0.0f, 1.0f, 5.0f}, 0, std::chrono::steady_clock::now()));
+    reconciliationSystem.update(0.0f);
+    EXPECT_NEAR(entity->getPosition().x, reference.getPosition().x, 1e-3f);
+    EXPECT_FLOAT_EQ(entity->getPosition().y, reference.getPosition().y);
+    EXPECT_FLOAT_EQ(entity->getPosition().z, 5.0f);
+    EXPECT_FLOAT_EQ(entity->getVelocity().x, reference.getVelocity().x);
+    EXPECT_EQ(entity->isJumping(), reference.isJumping());
+
+    // The jump and the steps in the air were replayed one by one, only the walks around them merged
+    const auto& stats = reconciliationSystem.getStats();
+    EXPECT_GT(stats.inputsMerged, 0u);
+    EXPECT_EQ(stats.inputsReplayed + stats.inputsMerged, 60u);
+    EXPECT_GT(stats.inputsReplayed, 5u);
+}
+
+TEST(ReconciliationTest, ReplayStaysWithinFrameBudget) {
+    netcode::SnapshotManager snapshotManager;
+    netcode::PredictionSystem predictionSystem(snapshotManager);
+    netcode::ReconciliationSystem reconciliationSystem(predictionSystem);
+    reconciliationSystem.setPredictionHorizon(0);
+    reconciliationSystem.setReplayBudget(std::chrono::microseconds(1000));
+
+    auto first = std::make_shared<SlowPredictionEntity>(1);
+    auto second = std::make_shared<SlowPredictionEntity>(2);
+    snapshotManager.registerEntity(1, first);
+    snapshotManager.registerEntity(2, second);
+    for (int i = 0; i < 20; ++i) {
+        predictionSystem.applyInputPrediction(first, {1.0f, 0.0f, 0.0f}, false);
+        predictionSystem.applyInputPrediction(second, {1.0f, 0.0f, 0.0f}, false);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    EXPECT_TRUE(reconciliationSystem.reconcileState(first, {0.0f, 0.0f, 5.0f}, 0, now));
+    EXPECT_TRUE(reconciliationSystem.reconcileState(second, {0.0f, 0.0f, 5.0f}, 0, now));
+
+    // Twenty 200 us steps do not fit into 1 ms: the rest of the replay is merged and the second correction waits
+    auto start = std::chrono::steady_clock::now();
+    reconciliationSystem.update(0.0f);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(3));
+    EXPECT_FLOAT_EQ(first->getPosition().x, 20.0f);
+    EXPECT_FLOAT_EQ(second->getPosition().z, 0.0f);
+    EXPECT_EQ(reconciliationSystem.getStats().budgetOverruns, 1u);
+    EXPECT_EQ(reconciliationSystem.getStats().deferredCorrections, 1u);
+
+    reconciliationSystem.update(0.0f);
+    EXPECT_FLOAT_EQ(second->getPosition().x, 20.0f);
+    EXPECT_FLOAT_EQ(second->getPosition().z, 5.0f);
+    EXPECT_EQ(reconciliationSystem.getStats().corrections, 2u);
+}
+
+TEST(RemotePredictionTest, SimulatesHeldInputToThePresent) {
+    netcode::RemotePredictionConfig config;
+    config.enabled = true;
+    config.simulationRate = 60.0f;
+    config.maxPredictionMs = 1000;
+    netcode::RemotePredictionSystem remotePrediction(config);
+
+    auto entity = std::make_shared<MockPredictionEntity>(2);
+
+    // A state 100ms old with the player holding +x: about 6 steps to catch up
+    auto receiveTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(100);
+    remotePrediction.recordServerState(2, {0.0f, 0.0f, 0.0f}, {}, false, {1.0f, 0.0f, 0.0f}, receiveTime);
+    remotePrediction.updateEntity(entity);
+
+    EXPECT_GE(entity->getPosition().x, 6.0f);
+    EXPECT_LE(entity->getPosition().x, 7.0f);
+    EXPECT_EQ(entity->getBlendCount(), 1);
+
+    // A fresh state rewinds the entity and re-simulates from it
+    remotePrediction.recordServerState(2, {10.0f, 0.0f, 0.0f}, {}, false, {0.0f, 0.0f, 0.0f},
+                                       std::chrono::steady_clock::now());
+    remotePrediction.updateEntity(entity);
+    EXPECT_FLOAT_EQ(entity->getPosition().x, 10.0f);
+    EXPECT_EQ(entity->getBlendCount(), 2);
+
+    auto stats = remotePrediction.getStats(2);
+    EXPECT_EQ(stats.serverUpdates, 2u);
+    EXPECT_EQ(stats.resimulations, 2u);
+    EXPECT_GE(stats.stepsSimulated, 6u);
+}
+
+TEST(RemotePredictionTest, CapsPredictionHorizon) {
+    netcode::RemotePredictionConfig config;
+    config.enabled = true;
+    config.simulationRate = 60.0f;
+    config.maxPredictionMs = 50;
+    netcode::RemotePredictionSystem remotePrediction(config);
+    remotePrediction.setLatencyEstimate(std::chrono::milliseconds(500));
+
+    auto entity = std::make_shared<MockPredictionEntity>(3);
+    remotePrediction.recordServerState(3, {0.0f, 0.0f, 0.0f}, {}, false, {1.0f, 0.0f, 0.0f},
+                                       std::chrono::steady_clock::now());
+    remotePrediction.updateEntity(entity);
+
+    // 50ms at 60Hz is at most 3 steps, regardless of the large latency
+    EXPECT_LE(entity->getPosition().x, 3.0f);
+}
+
+TEST(TimeDilationTest, KeepsServerBufferAtTargetDepth) {
+    netcode::TimeDilationConfig config;
+    config.targetDepth = 2.0f;
+    config.maxDilation = 0.05f;
+    netcode::TimeDilationController controller(config);
+    EXPECT_FLOAT_EQ(controller.getTimeScale(), 1.0f);
+
+    // A deep buffer adds latency, the input clock slows down but never by more than the limit
+    uint32_t tick = 0;
+    for (int i = 0; i < 100; ++i) {
+        controller.onInputAck(++tick, 8, 0, 0);
+    }
+    EXPECT_FLOAT_EQ(controller.getTimeScale(), 0.95f);
+
+    // On target the clock runs at normal speed
+    for (int i = 0; i < 200; ++i) {
+        controller.onInputAck(++tick, 2, 0, 0);
+    }
+    EXPECT_NEAR(controller.getTimeScale(), 1.0f, 0.001f);
+
+    // Underruns since the last acknowledgement speed it up, stale acknowledgements are ignored
+    controller.onInputAck(++tick, 0, 3, 0);
+    float scale = controller.getTimeScale();
+    EXPECT_GT(scale, 1.0f);
+    controller.onInputAck(tick - 1, 20, 3, 0);
+    EXPECT_FLOAT_EQ(controller.getTimeScale(), scale);
+
+    auto stats = controller.getStats();
+    EXPECT_EQ(stats.acks, 301u);
+    EXPECT_EQ(stats.underruns, 3u);
+}
+
+TEST(TimeDilationTest, InputClockSendsAtTheDilatedRateWhileInputIsHeld) {
+    netcode::InputClock clock(60.0f);
+    auto now = std::chrono::steady_clock::now();
+
+    // A held key is sent right away, then at 60 Hz times the scale whatever the frame rate
+    EXPECT_EQ(clock.advance(now, 1.05f), 1u);
+    uint32_t sent = 0;
+    for (int frame = 0; frame < 144; ++frame) {
+        now += std::chrono::microseconds(1000000 / 144);
+        sent += clock.advance(now, 1.05f);
+    }
+    EXPECT_NEAR(static_cast<double>(sent), 63.0, 1.0);
+
+    // Time without a held key is not owed once it is pressed again
+    clock.stop();
+    now += std::chrono::seconds(2);
+    EXPECT_EQ(clock.advance(now, 1.0f), 1u);
+    now += std::chrono::milliseconds(10);
+    EXPECT_EQ(clock.advance(now, 1.0f), 0u);
+
+    // A hitch sends a bounded burst
+    now += std::chrono::seconds(1);
+    EXPECT_EQ(clock.advance(now, 1.0f), netcode::InputClock::MAX_INPUTS_PER_FRAME);
+}
@@ -1,5 +1,13 @@
 #include "gtest/gtest.h"
 #include "netcode/server/server.hpp"
+#include "netcode/server/sharded_server.hpp"
+#include "netcode/server/outbound_pacer.hpp"
+#include "netcode/cluster/region_server.hpp"
+#include "netcode/relay/relay.hpp"
+#include "netcode/spectator/spectator_relay.hpp"
+#include "netcode/spectator/spectator_client.hpp"
+#include "netcode/physics/prop.hpp"
+#include "netcode/prediction/remote_prediction.hpp"
 #include "netcode/networked_entity.hpp"
 #include "netcode/settings.hpp"
 #include "netcode/packets/player_state_packet.hpp"
@@ -29,15 +37,17 @@ public:
     void update() override { }
     void jump() override { }
     void updateRenderPosition(float deltaTime) override { renderPosition_ = position_; /* Simplistic, or lerp if needed */ }
-    void snapSimulationState(const netcode::math::MyVec3& pos, bool isJumping = false, float velocityY = 0.0f) override {
+    void snapSimulationState(const netcode::math::MyVec3& pos, bool isJumping = false, const netcode::math::MyVec3& velocity = {}) override {
         position_ = pos;
-        velocity_.y = velocityY;
+        isJumping_ = isJumping;
+        velocity_ = velocity;
     }
     void initiateVisualBlend() override {}
     netcode::math::MyVec3 getPosition() const override { return position_; }
     netcode::math::MyVec3 getRenderPosition() const override { return renderPosition_; }
     void setPosition(const netcode::math::MyVec3& pos) override { position_ = pos; renderPosition_ = pos; }
     netcode::math::MyVec3 getVelocity() const override { return velocity_; }
+    bool isJumping() const override { return isJumping_; }
     uint32_t getId() const override { return id_; }
     float getMoveSpeed() const override { return 1.0f; } 
 
@@ -46,6 +56,7 @@ private:
     netcode::math::MyVec3 position_;
     netcode::math::MyVec3 renderPosition_;
     netcode::math::MyVec3 velocity_;
+    bool isJumping_ = false;
 };
 
 class ServerTest : public ::testing::Test {
@@ -203,7 +214,7 @@ TEST_F(ServerTest, UpdatePlayerStateAndBroadcast) {
     // Try to receive the specific packet for a short duration
     while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 200) {
         bytesReceived = recvfrom(client2SocketFd, buffer, sizeof(buffer), MSG_DONTWAIT, (struct sockaddr*)&sourceAddr, &sourceLen);
-        if (bytesReceived >= sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
             memcpy(&packet, buffer, sizeof(packet));
             if (packet.player_state.player_id == player1Id_ && packet.player_state.last_processed_input_sequence == 2) {
                 foundPacket = true;
@@ -291,7 +302,7 @@ TEST_F(ServerTest, SetPlayerPositionDirectly) {
     // Try to receive the specific packet for a short duration
     while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 200) {
         bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, (struct sockaddr*)&sourceAddr, &sourceLen);
-        if (bytesReceived >= sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
             memcpy(&packet, buffer, sizeof(packet));
             if (packet.player_state.player_id == player1Id_ &&
                 std::abs(packet.player_state.x - 10.0f) < 0.001f &&
@@ -314,3 +325,1083 @@ TEST_F(ServerTest, SetPlayerPositionDirectly) {
     server_->stop();
 }
 
+
+
+TEST_F(ServerTest, BroadcastCarriesKinematicState) {
+    server_->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int clientSockFd = createMockClientSocket(9006);
+    ASSERT_NE(clientSockFd, -1);
+
+    auto playerEntity = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server_->setPlayerReference(player1Id_, playerEntity);
+
+    // Register the client address
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, serverPort_, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Put the player mid-jump with a velocity
+    playerEntity->snapSimulationState({0.0f, 2.0f, 0.0f}, true, {0.2f, 1.3f, -0.2f});
+    server_->setPlayerPosition(player1Id_, 0.0f, 2.0f, 0.0f, false);
+
+    char buffer[1024];
+    sockaddr_in sourceAddr;
+    socklen_t sourceLen = sizeof(sourceAddr);
+    netcode::packets::TimestampedPlayerStatePacket packet;
+    bool foundPacket = false;
+    auto startTime = std::chrono::steady_clock::now();
+
+    while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 200) {
+        ssize_t bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, (struct sockaddr*)&sourceAddr, &sourceLen);
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+            memcpy(&packet, buffer, sizeof(packet));
+            if (packet.player_state.player_id == player1Id_ && packet.player_state.is_jumping) {
+                foundPacket = true;
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(foundPacket);
+    EXPECT_FLOAT_EQ(packet.player_state.velocity_x, 0.2f);
+    EXPECT_FLOAT_EQ(packet.player_state.velocity_y, 1.3f);
+    EXPECT_FLOAT_EQ(packet.player_state.velocity_z, -0.2f);
+
+    close(clientSockFd);
+    server_->stop();
+}
+TEST_F(ServerTest, AcknowledgedIdleEntitiesGoDormant) {
+    server_->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int clientSockFd = createMockClientSocket(9007);
+    ASSERT_NE(clientSockFd, -1);
+
+    auto playerEntity = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server_->setPlayerReference(player1Id_, playerEntity);
+
+    // Register the client address
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, serverPort_, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    server_->setPlayerPosition(player1Id_, 5.0f, 0.0f, 0.0f, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Collect state packets until the deadline, returning the highest state sequence seen
+    auto receiveStates = [&](int durationMs, int& count) {
+        char buffer[1024];
+        uint32_t highestSequence = 0;
+        count = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < durationMs) {
+            ssize_t bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            if (bytesReceived == static_cast<ssize_t>(sizeof(netcode::packets::TimestampedPlayerStatePacket))) {
+                netcode::packets::TimestampedPlayerStatePacket packet;
+                memcpy(&packet, buffer, sizeof(packet));
+                highestSequence = std::max(highestSequence, packet.player_state.state_sequence);
+                count++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return highestSequence;
+    };
+
+    int count = 0;
+    uint32_t sequence = receiveStates(50, count);
+    ASSERT_GT(sequence, 0u);
+
+    // Without an acknowledgement the state is resent
+    receiveStates(250, count);
+    EXPECT_GT(count, 0);
+
+    // Acknowledge the latest state
+    netcode::packets::TimestampedStateAckPacket ack{};
+    ack.timestamp = std::chrono::steady_clock::now();
+    ack.state_ack.player_id = player1Id_;
+    ack.state_ack.count = 1;
+    ack.state_ack.entries[0].entity_id = player1Id_;
+    ack.state_ack.entries[0].state_sequence = sequence;
+    sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(serverPort_);
+    inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
+    ASSERT_GT(sendto(clientSockFd, &ack, sizeof(ack), 0, (struct sockaddr*)&serverAddr, sizeof(serverAddr)), 0);
+    receiveStates(50, count);
+
+    // Setting the same state again does not wake the entity
+    server_->setPlayerPosition(player1Id_, 5.0f, 0.0f, 0.0f, false);
+    receiveStates(300, count);
+    EXPECT_EQ(count, 0);
+
+    // A change wakes it up immediately with a new state sequence
+    server_->setPlayerPosition(player1Id_, 6.0f, 0.0f, 0.0f, false);
+    EXPECT_GT(receiveStates(50, count), sequence);
+
+    close(clientSockFd);
+    server_->stop();
+}
+
+TEST_F(ServerTest, ShardedServerOwnsSessionsPerShard) {
+    netcode::ShardedServerConfig config;
+    config.shardCount = 2;
+    netcode::ShardedServer shardedServer(7010, config, settings_);
+
+    // Players 1 and 2 are owned by different shards
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    auto player2 = std::make_shared<MockNetworkedEntity>(player2Id_);
+    shardedServer.setPlayerReference(player1Id_, player1);
+    shardedServer.setPlayerReference(player2Id_, player2);
+    ASSERT_NE(shardedServer.shardForPlayer(player1Id_), shardedServer.shardForPlayer(player2Id_));
+
+    shardedServer.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int client1SockFd = createMockClientSocket(9010);
+    int client2SockFd = createMockClientSocket(9011);
+    ASSERT_NE(client1SockFd, -1);
+    ASSERT_NE(client2SockFd, -1);
+
+    sendMockMovementRequest(client1SockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7010, "127.0.0.1");
+    sendMockMovementRequest(client2SockFd, player2Id_, 0.f, 0.f, 0.f, false, 0, 7010, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Player 2 moves; client 1 is served by the other shard and must still see it
+    sendMockMovementRequest(client2SockFd, player2Id_, 3.f, 0.f, 0.f, false, 1, 7010, "127.0.0.1");
+
+    char buffer[1024];
+    bool sawPlayer2 = false;
+    auto startTime = std::chrono::steady_clock::now();
+    while (!sawPlayer2 &&
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 500) {
+        ssize_t bytesReceived = recvfrom(client1SockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+            netcode::packets::TimestampedPlayerStatePacket packet;
+            memcpy(&packet, buffer, sizeof(packet));
+            sawPlayer2 = packet.player_state.player_id == player2Id_ &&
+                         std::abs(packet.player_state.x - 3.0f) < 0.001f;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(sawPlayer2);
+
+    // The input was applied by the shard owning player 2
+    auto ownerStats = shardedServer.getShardStats(shardedServer.shardForPlayer(player2Id_));
+    EXPECT_EQ(ownerStats.inputsProcessed, 1u);
+    if (shardedServer.isKernelSteeringActive()) {
+        EXPECT_EQ(shardedServer.getShardStats(0).packetsForwarded, 0u);
+        EXPECT_EQ(shardedServer.getShardStats(1).packetsForwarded, 0u);
+    }
+
+    shardedServer.stop();
+    close(client1SockFd);
+    close(client2SockFd);
+}
+
+TEST_F(ServerTest, ShardedServerStopsResendingAcknowledgedStatesAndExpiresSessions) {
+    netcode::ShardedServerConfig config;
+    config.shardCount = 2;
+    config.sessionTimeoutMs = 600;
+    netcode::ShardedServer shardedServer(7011, config, settings_);
+    shardedServer.setPlayerReference(player1Id_, std::make_shared<MockNetworkedEntity>(player1Id_));
+    shardedServer.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int clientSockFd = createMockClientSocket(9012);
+    ASSERT_NE(clientSockFd, -1);
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7011, "127.0.0.1");
+    sendMockMovementRequest(clientSockFd, player1Id_, 3.f, 0.f, 0.f, false, 1, 7011, "127.0.0.1");
+
+    // Let the held input be released, so the state stops changing
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    auto receiveStates = [&](int durationMs, int& count) {
+        char buffer[1024];
+        uint32_t highestSequence = 0;
+        count = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < durationMs) {
+            ssize_t bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            if (bytesReceived == static_cast<ssize_t>(sizeof(netcode::packets::TimestampedPlayerStatePacket))) {
+                netcode::packets::TimestampedPlayerStatePacket packet;
+                memcpy(&packet, buffer, sizeof(packet));
+                highestSequence = std::max(highestSequence, packet.player_state.state_sequence);
+                count++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return highestSequence;
+    };
+
+    // Without an acknowledgement the latest state is resent
+    int count = 0;
+    uint32_t sequence = receiveStates(300, count);
+    ASSERT_GT(sequence, 0u);
+    EXPECT_GE(count, 2);
+
+    netcode::packets::TimestampedStateAckPacket ack{};
+    ack.timestamp = std::chrono::steady_clock::now();
+    ack.state_ack.player_id = player1Id_;
+    ack.state_ack.count = 1;
+    ack.state_ack.entries[0].entity_id = player1Id_;
+    ack.state_ack.entries[0].state_sequence = sequence;
+    sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(7011);
+    inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
+    ASSERT_GT(sendto(clientSockFd, &ack, sizeof(ack), 0, (struct sockaddr*)&serverAddr, sizeof(serverAddr)), 0);
+    receiveStates(50, count);
+
+    // The acknowledged entity is dormant, nothing until its heartbeat
+    receiveStates(400, count);
+    EXPECT_EQ(count, 0);
+
+    // The client stays silent past the session timeout
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_EQ(shardedServer.getShardStats(shardedServer.shardForPlayer(player1Id_)).sessionsExpired, 1u);
+
+    // Its next input registers it again and it gets the world
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 2, 7011, "127.0.0.1");
+    receiveStates(100, count);
+    EXPECT_GT(count, 0);
+
+    shardedServer.stop();
+    close(clientSockFd);
+}
+
+TEST_F(ServerTest, RegionHandoffRedirectsClientWithoutReconnect) {
+    netcode::ClusterConfig cluster;
+    cluster.regions.push_back({1, -100.0f, 0.0f, -1e9f, 1e9f, 7020, 7021});
+    cluster.regions.push_back({2, 0.0f, 100.0f, -1e9f, 1e9f, 7022, 7023});
+
+    netcode::RegionServer regionA(1, cluster, settings_);
+    netcode::RegionServer regionB(2, cluster, settings_);
+    std::shared_ptr<MockNetworkedEntity> takenOver;
+    regionB.setEntityFactory([&takenOver](uint32_t id) {
+        takenOver = std::make_shared<MockNetworkedEntity>(id);
+        return takenOver;
+    });
+
+    auto playerEntity = std::make_shared<MockNetworkedEntity>(player1Id_);
+    playerEntity->setPosition({-1.0f, 0.0f, 0.0f});
+    regionA.setPlayerReference(player1Id_, playerEntity);
+    auto farPlayer = std::make_shared<MockNetworkedEntity>(player2Id_);
+    farPlayer->setPosition({50.0f, 0.0f, 0.0f});
+    regionB.setPlayerReference(player2Id_, farPlayer);
+    EXPECT_EQ(regionA.regionForPosition({0.2f, 0.0f, 0.0f}, 1), 1u); // Within the hysteresis
+    EXPECT_EQ(regionA.regionForPosition({2.0f, 0.0f, 0.0f}, 1), 2u);
+
+    regionA.start();
+    regionB.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int clientSockFd = createMockClientSocket(9020);
+    ASSERT_NE(clientSockFd, -1);
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7020, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Near the border the player is mirrored to region B, crossing it hands the player off
+    sendMockMovementRequest(clientSockFd, player1Id_, 3.f, 0.f, 0.f, false, 1, 7020, "127.0.0.1");
+
+    // The new region sends the handed off client its entities, which region A never showed
+    char buffer[1024];
+    bool redirected = false;
+    bool sawFarPlayer = false;
+    auto startTime = std::chrono::steady_clock::now();
+    while (!(redirected && sawFarPlayer) &&
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 500) {
+        ssize_t bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesReceived == sizeof(netcode::packets::TimestampedRedirectPacket)) {
+            netcode::packets::TimestampedRedirectPacket redirect;
+            memcpy(&redirect, buffer, sizeof(redirect));
+            redirected = redirect.redirect.player_id == player1Id_ && redirect.redirect.server_port == 7022;
+        } else if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+            netcode::packets::TimestampedPlayerStatePacket state;
+            memcpy(&state, buffer, sizeof(state));
+            sawFarPlayer |= state.player_state.player_id == player2Id_;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(redirected);
+    EXPECT_TRUE(sawFarPlayer);
+    EXPECT_FALSE(regionA.ownsEntity(player1Id_));
+    EXPECT_TRUE(regionA.hasGhost(player1Id_));
+    ASSERT_TRUE(regionB.ownsEntity(player1Id_));
+    ASSERT_NE(takenOver, nullptr);
+
+    // An input still sent to the old region is forwarded, the next one goes to the new region directly
+    sendMockMovementRequest(clientSockFd, player1Id_, 1.f, 0.f, 0.f, false, 2, 7020, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sendMockMovementRequest(clientSockFd, player1Id_, 1.f, 0.f, 0.f, false, 3, 7022, "127.0.0.1");
+
+    // Once the inputs stop the new region no longer reports the input as held
+    bool released = false;
+    startTime = std::chrono::steady_clock::now();
+    while (!released &&
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 500) {
+        ssize_t bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+            netcode::packets::TimestampedPlayerStatePacket state;
+            memcpy(&state, buffer, sizeof(state));
+            released = state.player_state.player_id == player1Id_ &&
+                       state.player_state.last_processed_input_sequence == 3 && state.player_state.input_x == 0.0f;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(released);
+
+    regionA.stop();
+    regionB.stop();
+    EXPECT_FLOAT_EQ(takenOver->getPosition().x, 4.0f);
+    close(clientSockFd);
+}
+
+TEST_F(ServerTest, RelayFansOutServerPacketsToItsClients) {
+    netcode::Server server(7040, settings_);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    auto player2 = std::make_shared<MockNetworkedEntity>(player2Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.setPlayerReference(player2Id_, player2);
+    server.start();
+
+    netcode::RelayConfig relayConfig;
+    relayConfig.relayId = 1;
+    relayConfig.clientPort = 7041;
+    relayConfig.serverIp = "127.0.0.1";
+    relayConfig.serverPort = 7040;
+    netcode::Relay relay(relayConfig);
+    ASSERT_TRUE(relay.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int client1SockFd = createMockClientSocket(9030);
+    int client2SockFd = createMockClientSocket(9031);
+    ASSERT_NE(client1SockFd, -1);
+    ASSERT_NE(client2SockFd, -1);
+    sendMockMovementRequest(client1SockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7041, "127.0.0.1");
+    sendMockMovementRequest(client2SockFd, player2Id_, 0.f, 0.f, 0.f, false, 0, 7041, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sendMockMovementRequest(client1SockFd, player1Id_, 1.f, 0.f, 0.f, false, 1, 7041, "127.0.0.1");
+
+    // Both clients see player 1 move although the server only knows the relay's address
+    auto receivesMove = [](int sockFd, uint32_t playerId) {
+        char buffer[1024];
+        auto startTime = std::chrono::steady_clock::now();
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 500) {
+            ssize_t bytesReceived = recvfrom(sockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+                netcode::packets::TimestampedPlayerStatePacket state;
+                memcpy(&state, buffer, sizeof(state));
+                if (state.player_state.player_id == playerId && state.player_state.x == 1.0f) {
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    };
+    EXPECT_TRUE(receivesMove(client1SockFd, player1Id_));
+    EXPECT_TRUE(receivesMove(client2SockFd, player1Id_));
+
+    relay.stop();
+    server.stop();
+    auto stats = relay.getStats();
+    EXPECT_EQ(stats.inputsForwarded, 3u);
+    EXPECT_EQ(stats.sessionsOpened, 2u);
+    EXPECT_GT(stats.packetsFannedOut, 0u);
+    close(client1SockFd);
+    close(client2SockFd);
+}
+
+TEST_F(ServerTest, RelayRoutesSessionsAndResumesToTheirPlayer) {
+    netcode::Server server(7042, settings_);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    auto player2 = std::make_shared<MockNetworkedEntity>(player2Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.setPlayerReference(player2Id_, player2);
+    server.start();
+
+    netcode::RelayConfig relayConfig;
+    relayConfig.clientPort = 7043;
+    relayConfig.serverPort = 7042;
+    netcode::Relay relay(relayConfig);
+    ASSERT_TRUE(relay.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Receive packets of one size until a predicate accepts one
+    auto receive = [](int sockFd, size_t size, auto accept) {
+        char buffer[1024];
+        auto startTime = std::chrono::steady_clock::now();
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 300) {
+            ssize_t bytesReceived = recvfrom(sockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            if (bytesReceived == static_cast<ssize_t>(size) && accept(buffer)) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    };
+    auto sessionOf = [](uint32_t playerId, uint64_t* token = nullptr) {
+        return [playerId, token](const char* data) {
+            netcode::packets::TimestampedSessionPacket session;
+            memcpy(&session, data, sizeof(session));
+            if (token != nullptr && session.session.player_id == playerId) {
+                *token = session.session.token;
+            }
+            return session.session.player_id == playerId;
+        };
+    };
+    auto anyPacket = [](const char*) { return true; };
+
+    int client1SockFd = createMockClientSocket(9032);
+    int client2SockFd = createMockClientSocket(9033);
+    int movedSockFd = createMockClientSocket(9034);
+    ASSERT_NE(client1SockFd, -1);
+    ASSERT_NE(client2SockFd, -1);
+    ASSERT_NE(movedSockFd, -1);
+
+    // Each client gets its own token, and only its own
+    sendMockMovementRequest(client2SockFd, player2Id_, 0.f, 0.f, 0.f, false, 0, 7043, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sendMockMovementRequest(client1SockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7043, "127.0.0.1");
+    uint64_t token = 0;
+    ASSERT_TRUE(receive(client1SockFd, sizeof(netcode::packets::TimestampedSessionPacket), sessionOf(player1Id_, &token)));
+    ASSERT_NE(token, 0u);
+    EXPECT_FALSE(receive(client2SockFd, sizeof(netcode::packets::TimestampedSessionPacket), sessionOf(player1Id_)));
+
+    // A resume request from a new address travels up to the server, the answer and catch-up come back to that address only
+    netcode::packets::TimestampedResumeRequestPacket timestampedResume{};
+    timestampedResume.timestamp = std::chrono::steady_clock::now();
+    timestampedResume.resume_request.player_id = player1Id_;
+    timestampedResume.resume_request.token = token;
+    sockaddr_in relayAddr{};
+    relayAddr.sin_family = AF_INET;
+    relayAddr.sin_port = htons(7043);
+    inet_pton(AF_INET, "127.0.0.1", &relayAddr.sin_addr);
+    sendto(movedSockFd, &timestampedResume, sizeof(timestampedResume), 0, (struct sockaddr*)&relayAddr, sizeof(relayAddr));
+
+    EXPECT_TRUE(receive(movedSockFd, sizeof(netcode::packets::TimestampedSessionPacket), [&](const char* data) {
+        netcode::packets::TimestampedSessionPacket session;
+        memcpy(&session, data, sizeof(session));
+        return session.session.resumed && session.session.token == token;
+    }));
+    EXPECT_TRUE(receive(movedSockFd, sizeof(netcode::packets::TimestampedCatchUpPacket), anyPacket));
+    EXPECT_FALSE(receive(client2SockFd, sizeof(netcode::packets::TimestampedCatchUpPacket), anyPacket));
+    EXPECT_FALSE(receive(client1SockFd, sizeof(netcode::packets::TimestampedCatchUpPacket), anyPacket));
+
+    relay.stop();
+    server.stop();
+    close(client1SockFd);
+    close(client2SockFd);
+    close(movedSockFd);
+}
+
+TEST_F(ServerTest, RelaySessionIgnoresMovementFromAnotherAddress) {
+    netcode::Server server(7047, settings_);
+    netcode::InputBufferConfig bufferConfig;
+    bufferConfig.enabled = true;
+    server.setInputBuffering(bufferConfig);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.start();
+
+    netcode::RelayConfig relayConfig;
+    relayConfig.clientPort = 7048;
+    relayConfig.serverPort = 7047;
+    netcode::Relay relay(relayConfig);
+    ASSERT_TRUE(relay.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Receive input acks for player 1 until the timeout
+    auto receivesInputAck = [this](int sockFd) {
+        char buffer[1024];
+        auto startTime = std::chrono::steady_clock::now();
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 300) {
+            ssize_t bytesReceived = recvfrom(sockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            if (bytesReceived == static_cast<ssize_t>(sizeof(netcode::packets::TimestampedInputAckPacket))) {
+                netcode::packets::TimestampedInputAckPacket timestampedAck;
+                memcpy(&timestampedAck, buffer, sizeof(timestampedAck));
+                if (timestampedAck.input_ack.player_id == player1Id_) {
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    };
+
+    int clientSockFd = createMockClientSocket(9037);
+    int spooferSockFd = createMockClientSocket(9038);
+    ASSERT_NE(clientSockFd, -1);
+    ASSERT_NE(spooferSockFd, -1);
+
+    sendMockMovementRequest(clientSockFd, player1Id_, 1.f, 0.f, 0.f, false, 1, 7048, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // A movement naming player 1 from another address is not a resume, the session stays with its client
+    sendMockMovementRequest(spooferSockFd, player1Id_, 1.f, 0.f, 0.f, false, 2, 7048, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    server.updateEntities(1.0f / 60.0f);
+
+    EXPECT_TRUE(receivesInputAck(clientSockFd));
+    EXPECT_FALSE(receivesInputAck(spooferSockFd));
+
+    relay.stop();
+    server.stop();
+    close(clientSockFd);
+    close(spooferSockFd);
+}
+
+TEST_F(ServerTest, RelaySessionsFollowTheServerSessionLifecycle) {
+    netcode::Server server(7044, settings_);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.setSessionGracePeriod(300);
+    server.start();
+
+    netcode::RelayConfig relayConfig;
+    relayConfig.clientPort = 7045;
+    relayConfig.serverPort = 7044;
+    relayConfig.sessionTimeoutMs = 100;
+    netcode::Relay relay(relayConfig);
+    ASSERT_TRUE(relay.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int clientSockFd = createMockClientSocket(9035);
+    ASSERT_NE(clientSockFd, -1);
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7045, "127.0.0.1");
+
+    // The relay keeps the session past its own timeout while the server still holds it
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(relay.getStats().activeSessions, 1u);
+    EXPECT_EQ(server.getSessionCount(), 1u);
+
+    // Once the server expires it, the relay closes it too and the client is told to register again
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(server.getSessionCount(), 0u);
+    EXPECT_EQ(relay.getStats().activeSessions, 0u);
+    EXPECT_EQ(relay.getStats().sessionsClosed, 1u);
+
+    bool toldToRegister = false;
+    char buffer[1024];
+    ssize_t bytesReceived;
+    while ((bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr)) >= 0) {
+        if (bytesReceived == sizeof(netcode::packets::TimestampedSessionPacket)) {
+            netcode::packets::TimestampedSessionPacket session;
+            memcpy(&session, buffer, sizeof(session));
+            toldToRegister |= session.session.player_id == player1Id_ && session.session.token == 0;
+        }
+    }
+    EXPECT_TRUE(toldToRegister);
+
+    relay.stop();
+    server.stop();
+    close(clientSockFd);
+}
+
+TEST_F(ServerTest, StoppedPlayerIsNotPredictedAsMoving) {
+    netcode::Server server(7046, settings_);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int sockFd = createMockClientSocket(9036);
+    ASSERT_NE(sockFd, -1);
+    sendMockMovementRequest(sockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7046, "127.0.0.1");
+    sendMockMovementRequest(sockFd, player1Id_, 1.f, 0.f, 0.f, false, 1, 7046, "127.0.0.1");
+    sendMockMovementRequest(sockFd, player1Id_, 1.f, 0.f, 0.f, false, 2, 7046, "127.0.0.1");
+
+    // The player then releases its keys and the client sends nothing more
+    bool sawHeldInput = false;
+    netcode::packets::PlayerStatePacket latest{};
+    char buffer[1024];
+    auto startTime = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - startTime < std::chrono::milliseconds(400)) {
+        server.updateEntities(1.0f / 60.0f);
+        ssize_t bytesReceived;
+        while ((bytesReceived = recvfrom(sockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr)) >= 0) {
+            if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+                netcode::packets::TimestampedPlayerStatePacket state;
+                memcpy(&state, buffer, sizeof(state));
+                sawHeldInput |= state.player_state.input_x == 1.0f;
+                latest = state.player_state;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(sawHeldInput);
+    EXPECT_EQ(latest.input_x, 0.0f);
+    EXPECT_EQ(latest.velocity_x, 0.0f);
+    EXPECT_FLOAT_EQ(latest.x, 2.0f);
+
+    // Other clients predict the stopped player where it stands
+    netcode::RemotePredictionConfig config;
+    config.enabled = true;
+    netcode::RemotePredictionSystem remotePrediction(config);
+    auto remote = std::make_shared<MockNetworkedEntity>(player1Id_);
+    remotePrediction.recordServerState(player1Id_, {latest.x, latest.y, latest.z},
+                                       {latest.velocity_x, latest.velocity_y, latest.velocity_z}, latest.is_jumping,
+                                       {latest.input_x, latest.input_y, latest.input_z},
+                                       std::chrono::steady_clock::now() - std::chrono::milliseconds(200));
+    remotePrediction.updateEntity(remote);
+    EXPECT_FLOAT_EQ(remote->getPosition().x, 2.0f);
+
+    server.stop();
+    close(sockFd);
+}
+
+TEST(SpectatorStreamTest, EncodesDelayedKeyframesAndDeltas) {
+    netcode::SpectatorStreamConfig config;
+    config.delayMs = 100;
+    config.keyframeInterval = 3;
+    netcode::SpectatorStream stream(config);
+
+    std::vector<netcode::packets::PlayerStatePacket> states(30);
+    for (uint32_t i = 0; i < states.size(); ++i) {
+        states[i] = {};
+        states[i].player_id = i + 1;
+        states[i].state_sequence = 1;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    stream.capture(states, now);
+    states[4].x = 2.0f;
+    states[4].state_sequence = 2;
+    stream.capture(states, now + std::chrono::milliseconds(100));
+
+    // Nothing is released before the delay has passed
+    EXPECT_TRUE(stream.releaseFrames(now + std::chrono::milliseconds(50)).empty());
+
+    // The keyframe does not fit into one packet, the delta only carries the changed entity
+    auto frames = stream.releaseFrames(now + std::chrono::milliseconds(200));
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_TRUE(frames[0].keyframe);
+    EXPECT_EQ(frames[0].part_count, 2);
+    EXPECT_EQ(frames[0].count + frames[1].count, 30u);
+    EXPECT_FALSE(frames[2].keyframe);
+    EXPECT_EQ(frames[2].base_frame, 1u);
+    ASSERT_EQ(frames[2].count, 1u);
+    EXPECT_EQ(frames[2].entities[0].player_id, 5u);
+    EXPECT_EQ(stream.getCatchUpFrames().size(), 3u);
+
+    // A spectator that lost the delta waits for the next keyframe
+    netcode::SpectatorClient spectator({});
+    spectator.handleFrame(frames[0]);
+    spectator.handleFrame(frames[1]);
+    EXPECT_TRUE(spectator.isSynchronized());
+    stream.capture(states, now + std::chrono::milliseconds(200));
+    auto third = stream.releaseFrames(now + std::chrono::milliseconds(400));
+    ASSERT_EQ(third.size(), 1u);
+    spectator.handleFrame(third[0]);
+    EXPECT_FALSE(spectator.isSynchronized());
+    EXPECT_EQ(spectator.getStats().framesSkipped, 1u);
+
+    stream.capture(states, now + std::chrono::milliseconds(300));
+    auto keyframe = stream.releaseFrames(now + std::chrono::milliseconds(500));
+    ASSERT_EQ(keyframe.size(), 2u);
+    EXPECT_TRUE(keyframe[0].keyframe);
+    spectator.handleFrame(keyframe[0]);
+    spectator.handleFrame(keyframe[1]);
+    EXPECT_TRUE(spectator.isSynchronized());
+    EXPECT_FLOAT_EQ(spectator.getEntityStates()[5].x, 2.0f);
+}
+
+TEST_F(ServerTest, SpectatorsWatchDelayedStreamThroughRelay) {
+    netcode::Server server(7050, settings_);
+    auto player = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server.setPlayerReference(player1Id_, player);
+
+    netcode::SpectatorStreamConfig streamConfig;
+    streamConfig.port = 7051;
+    streamConfig.delayMs = 200;
+    streamConfig.frameRate = 20.0f;
+    server.enableSpectatorStream(streamConfig);
+    server.start();
+
+    netcode::SpectatorRelayConfig relayConfig;
+    relayConfig.port = 7052;
+    relayConfig.upstreamPort = 7051;
+    netcode::SpectatorRelay relay(relayConfig);
+    ASSERT_TRUE(relay.start());
+
+    netcode::SpectatorClientConfig spectatorConfig;
+    spectatorConfig.streamPort = 7052;
+    netcode::SpectatorClient spectator1(spectatorConfig);
+    spectatorConfig.spectatorId = 1;
+    netcode::SpectatorClient spectator2(spectatorConfig);
+    ASSERT_TRUE(spectator1.start());
+    ASSERT_TRUE(spectator2.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // The server only serves the relay, the relay serves both spectators
+    EXPECT_EQ(server.getSpectatorCount(), 1u);
+    EXPECT_EQ(relay.getSubscriberCount(), 2u);
+
+    int clientSockFd = createMockClientSocket(9040);
+    ASSERT_NE(clientSockFd, -1);
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7050, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sendMockMovementRequest(clientSockFd, player1Id_, 3.f, 0.f, 0.f, false, 1, 7050, "127.0.0.1");
+
+    // The move only shows up for spectators once the stream delay has passed
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FLOAT_EQ(spectator1.getEntityStates()[player1Id_].x, 0.0f);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_TRUE(spectator1.isSynchronized());
+    EXPECT_FLOAT_EQ(spectator1.getEntityStates()[player1Id_].x, 3.0f);
+    EXPECT_FLOAT_EQ(spectator2.getEntityStates()[player1Id_].x, 3.0f);
+    EXPECT_GT(spectator1.getStats().deltasApplied, 0u);
+
+    spectator1.stop();
+    spectator2.stop();
+    relay.stop();
+    server.stop();
+    close(clientSockFd);
+}
+
+TEST_F(ServerTest, SleepingPropsCostNoBandwidth) {
+    auto prop = std::make_shared<netcode::Prop>(100, netcode::math::MyVec3(0.0f, 3.0f, 0.0f));
+    server_->addProp(prop);
+    server_->start();
+
+    int clientSockFd = createMockClientSocket(9041);
+    ASSERT_NE(clientSockFd, -1);
+    sendMockMovementRequest(clientSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, serverPort_, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Simulate until the prop has fallen, bounced and come to rest
+    for (int i = 0; i < 600 && !prop->isSleeping(); ++i) {
+        server_->updateEntities(1.0f / 60.0f);
+    }
+    ASSERT_TRUE(prop->isSleeping());
+    server_->updateEntities(1.0f / 60.0f);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Acknowledge the resting state the client received last
+    char buffer[1024];
+    uint32_t latestSequence = 0;
+    float restingHeight = -1.0f;
+    ssize_t bytesReceived;
+    while ((bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr)) > 0) {
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+            netcode::packets::TimestampedPlayerStatePacket packet;
+            memcpy(&packet, buffer, sizeof(packet));
+            if (packet.player_state.player_id == 100 && packet.player_state.state_sequence >= latestSequence) {
+                latestSequence = packet.player_state.state_sequence;
+                restingHeight = packet.player_state.y;
+            }
+        }
+    }
+    ASSERT_GT(latestSequence, 0u);
+    EXPECT_FLOAT_EQ(restingHeight, prop->getConfig().radius);
+
+    netcode::packets::TimestampedStateAckPacket ack{};
+    ack.timestamp = std::chrono::steady_clock::now();
+    ack.state_ack.player_id = player1Id_;
+    ack.state_ack.count = 1;
+    ack.state_ack.entries[0].entity_id = 100;
+    ack.state_ack.entries[0].state_sequence = latestSequence;
+    sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(serverPort_);
+    inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
+    ASSERT_GT(sendto(clientSockFd, &ack, sizeof(ack), 0, (struct sockaddr*)&serverAddr, sizeof(serverAddr)), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    while (recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr) > 0) {
+    }
+
+    // Past the dormant heartbeat interval nothing is sent for the sleeping prop
+    int propStates = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 1300) {
+        server_->updateEntities(1.0f / 60.0f);
+        bytesReceived = recvfrom(clientSockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesReceived == sizeof(netcode::packets::TimestampedPlayerStatePacket)) {
+            netcode::packets::TimestampedPlayerStatePacket packet;
+            memcpy(&packet, buffer, sizeof(packet));
+            propStates += packet.player_state.player_id == 100 ? 1 : 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+    EXPECT_EQ(propStates, 0);
+    EXPECT_EQ(server_->getPropStats().awakeCount, 0u);
+
+    close(clientSockFd);
+    server_->stop();
+}
+
+TEST_F(ServerTest, ClientResumesSessionFromNewAddress) {
+    netcode::Server server(7060, settings_);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    auto player2 = std::make_shared<MockNetworkedEntity>(player2Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.setPlayerReference(player2Id_, player2);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Receive packets of one size until a predicate accepts one
+    auto receive = [](int sockFd, size_t size, auto accept) {
+        char buffer[1024];
+        auto startTime = std::chrono::steady_clock::now();
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() < 500) {
+            ssize_t bytesReceived = recvfrom(sockFd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            if (bytesReceived == static_cast<ssize_t>(size) && accept(buffer)) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    };
+    auto sendResume = [](int sockFd, uint32_t playerId, uint64_t token) {
+        netcode::packets::TimestampedResumeRequestPacket timestampedResume{};
+        timestampedResume.timestamp = std::chrono::steady_clock::now();
+        timestampedResume.resume_request.player_id = playerId;
+        timestampedResume.resume_request.token = token;
+        sockaddr_in serverAddr{};
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(7060);
+        inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
+        sendto(sockFd, &timestampedResume, sizeof(timestampedResume), 0, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+    };
+
+    int oldSockFd = createMockClientSocket(9050);
+    int newSockFd = createMockClientSocket(9051);
+    ASSERT_NE(oldSockFd, -1);
+    ASSERT_NE(newSockFd, -1);
+
+    // Registering hands out the resumption token
+    sendMockMovementRequest(oldSockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7060, "127.0.0.1");
+    uint64_t token = 0;
+    ASSERT_TRUE(receive(oldSockFd, sizeof(netcode::packets::TimestampedSessionPacket), [&](const char* data) {
+        netcode::packets::TimestampedSessionPacket session;
+        memcpy(&session, data, sizeof(session));
+        token = session.session.token;
+        return session.session.player_id == player1Id_ && !session.session.resumed;
+    }));
+    ASSERT_NE(token, 0u);
+    sendMockMovementRequest(oldSockFd, player1Id_, 2.f, 0.f, 0.f, false, 1, 7060, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // A forged token is rejected
+    sendResume(newSockFd, player1Id_, token + 1);
+    EXPECT_TRUE(receive(newSockFd, sizeof(netcode::packets::TimestampedSessionPacket), [](const char* data) {
+        netcode::packets::TimestampedSessionPacket session;
+        memcpy(&session, data, sizeof(session));
+        return session.session.token == 0 && !session.session.resumed;
+    }));
+
+    // The real token moves the session and brings the client up to date in one snapshot
+    sendResume(newSockFd, player1Id_, token);
+    EXPECT_TRUE(receive(newSockFd, sizeof(netcode::packets::TimestampedSessionPacket), [&](const char* data) {
+        netcode::packets::TimestampedSessionPacket session;
+        memcpy(&session, data, sizeof(session));
+        return session.session.resumed && session.session.token == token &&
+               session.session.last_processed_input_sequence == 1;
+    }));
+    EXPECT_TRUE(receive(newSockFd, sizeof(netcode::packets::TimestampedCatchUpPacket), [&](const char* data) {
+        netcode::packets::TimestampedCatchUpPacket catchUp;
+        memcpy(&catchUp, data, sizeof(catchUp));
+        bool movedPlayer = false;
+        for (uint32_t i = 0; i < catchUp.catch_up.count; ++i) {
+            movedPlayer |= catchUp.catch_up.entries[i].player_id == 1 && catchUp.catch_up.entries[i].x == 2.0f;
+        }
+        return catchUp.catch_up.part_count == 1 && catchUp.catch_up.count == 2 && movedPlayer;
+    }));
+
+    // Later states go to the new address only
+    while (recvfrom(oldSockFd, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr) >= 0) {
+    }
+    server.setPlayerPosition(player2Id_, 5.f, 0.f, 0.f, false);
+    auto receivesMove = [](const char* data) {
+        netcode::packets::TimestampedPlayerStatePacket state;
+        memcpy(&state, data, sizeof(state));
+        return state.player_state.player_id == 2 && state.player_state.x == 5.0f;
+    };
+    EXPECT_TRUE(receive(newSockFd, sizeof(netcode::packets::TimestampedPlayerStatePacket), receivesMove));
+    EXPECT_FALSE(receive(oldSockFd, sizeof(netcode::packets::TimestampedPlayerStatePacket), receivesMove));
+    EXPECT_EQ(server.getSessionCount(), 1u);
+
+    server.stop();
+    close(oldSockFd);
+    close(newSockFd);
+}
+
+TEST_F(ServerTest, SilentClientsExpireAfterGracePeriod) {
+    netcode::Server server(7061, settings_);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server.setPlayerReference(player1Id_, player1);
+    server.setSessionGracePeriod(200);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int sockFd = createMockClientSocket(9052);
+    ASSERT_NE(sockFd, -1);
+    sendMockMovementRequest(sockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7061, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(server.getSessionCount(), 1u);
+
+    // Silence beyond the grace period drops the client
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(server.getSessionCount(), 0u);
+
+    // Registering again opens a fresh session
+    sendMockMovementRequest(sockFd, player1Id_, 0.f, 0.f, 0.f, false, 0, 7061, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(server.getSessionCount(), 1u);
+
+    server.stop();
+    close(sockFd);
+}
+
+TEST_F(ServerTest, StateChangesArePublishedToSubscribers) {
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server_->setPlayerReference(player1Id_, player1);
+    auto recorder = server_->subscribeStateChanges();
+    auto metrics = server_->subscribeStateChanges();
+
+    server_->setPlayerPosition(player1Id_, 1.f, 0.f, 0.f, false);
+    server_->setPlayerPosition(player1Id_, 1.f, 0.f, 0.f, false);
+    server_->setPlayerPosition(player1Id_, 2.f, 0.f, 0.f, false);
+
+    // Unchanged states are not published, each subscriber reads the changes on its own
+    std::vector<float> recorded;
+    std::thread recording([&recorder, &recorded]() {
+        recorder.poll([&recorded](const netcode::packets::PlayerStatePacket& state) { recorded.push_back(state.x); });
+    });
+    recording.join();
+    EXPECT_EQ(recorded, (std::vector<float>{1.0f, 2.0f}));
+
+    netcode::packets::PlayerStatePacket state;
+    ASSERT_TRUE(metrics.try_read(state));
+    EXPECT_EQ(state.state_sequence, 1u);
+    ASSERT_TRUE(metrics.try_read(state));
+    EXPECT_EQ(state.state_sequence, 2u);
+    EXPECT_FALSE(metrics.try_read(state));
+}
+
+TEST(OutboundPacerTest, SpreadsBacklogAndCoalescesLatestState) {
+    netcode::OutboundPacerConfig config;
+    config.pacingWindowMs = 16;
+    netcode::OutboundPacer pacer(config);
+
+    sockaddr_in client1{};
+    client1.sin_family = AF_INET;
+    client1.sin_addr.s_addr = inet_addr("127.0.0.1");
+    client1.sin_port = htons(9080);
+    sockaddr_in client2 = client1;
+    client2.sin_port = htons(9081);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t entityId = 1; entityId <= 16; ++entityId) {
+        netcode::packets::PlayerStatePacket state{};
+        state.player_id = entityId;
+        state.x = 1.0f;
+        pacer.enqueue(client1, state, start);
+        pacer.enqueue(client2, state, start);
+    }
+
+    // A newer state of a waiting entity replaces it in place
+    netcode::packets::PlayerStatePacket newer{};
+    newer.player_id = 1;
+    newer.x = 2.0f;
+    pacer.enqueue(client1, newer, start);
+    EXPECT_EQ(pacer.getBacklog(), 32u);
+    EXPECT_EQ(pacer.getStats().coalesced, 1u);
+
+    // Nothing leaves in the same instant, then a quarter of the window releases a quarter of each queue
+    EXPECT_TRUE(pacer.release(start).empty());
+    auto released = pacer.release(start + std::chrono::milliseconds(4));
+    ASSERT_EQ(released.size(), 8u);
+    for (const auto& outgoing : released) {
+        if (outgoing.destination.sin_port == client1.sin_port && outgoing.state.player_id == 1) {
+            EXPECT_FLOAT_EQ(outgoing.state.x, 2.0f);
+        }
+    }
+    EXPECT_EQ(pacer.getBacklog(), 24u);
+
+    // Everything is out once the window has passed
+    released = pacer.release(start + std::chrono::milliseconds(16));
+    EXPECT_EQ(released.size(), 24u);
+    EXPECT_EQ(pacer.getBacklog(), 0u);
+    EXPECT_EQ(pacer.getStats().sent, 32u);
+    EXPECT_EQ(pacer.getStats().queued, 33u);
+    EXPECT_EQ(pacer.getStats().maxBacklog, 16u);
+
+    // A client about to get a packet that must follow its states can be drained at once
+    pacer.enqueue(client2, newer, start + std::chrono::milliseconds(20));
+    EXPECT_EQ(pacer.releaseAll(client2).size(), 1u);
+    EXPECT_EQ(pacer.getBacklog(), 0u);
+}
+
+TEST_F(ServerTest, BufferedInputsAreAppliedOnePerTick) {
+    netcode::InputBufferConfig bufferConfig;
+    bufferConfig.enabled = true;
+    bufferConfig.maxDepth = 4;
+    server_->setInputBuffering(bufferConfig);
+    auto player1 = std::make_shared<MockNetworkedEntity>(player1Id_);
+    server_->setPlayerReference(player1Id_, player1);
+    server_->start();
+
+    clientSocketFd_ = createMockClientSocket(9090);
+    ASSERT_NE(clientSocketFd_, -1);
+    for (uint32_t sequence = 1; sequence <= 3; ++sequence) {
+        sendMockMovementRequest(clientSocketFd_, player1Id_, 1.0f, 0.0f, 0.0f, false, sequence, serverPort_, "127.0.0.1");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Nothing is applied before the tick, then one input per tick
+    EXPECT_FLOAT_EQ(player1->getPosition().x, 0.0f);
+    server_->updateEntities(1.0f / 60.0f);
+    EXPECT_FLOAT_EQ(player1->getPosition().x, 1.0f);
+
+    // The client learns how many inputs still wait
+    netcode::packets::TimestampedInputAckPacket timestampedAck{};
+    char buffer[1024];
+    bool received = false;
+    auto start = std::chrono::steady_clock::now();
+    while (!received && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(200)) {
+        ssize_t bytes = recvfrom(clientSocketFd_, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytes == sizeof(timestampedAck)) {
+            memcpy(&timestampedAck, buffer, sizeof(timestampedAck));
+            received = true;
+        } else if (bytes < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    ASSERT_TRUE(received);
+    EXPECT_EQ(timestampedAck.input_ack.player_id, player1Id_);
+    EXPECT_EQ(timestampedAck.input_ack.last_processed_input_sequence, 1u);
+    EXPECT_EQ(timestampedAck.input_ack.buffer_depth, 2u);
+    EXPECT_EQ(timestampedAck.input_ack.underruns, 0u);
+
+    // Draining the buffer and ticking once more is not an underrun yet, the player may have stopped
+    server_->updateEntities(1.0f / 60.0f);
+    server_->updateEntities(1.0f / 60.0f);
+    server_->updateEntities(1.0f / 60.0f);
+    EXPECT_FLOAT_EQ(player1->getPosition().x, 3.0f);
+    EXPECT_EQ(server_->getInputBufferStats().underruns, 0u);
+
+    // The next input arriving shortly after shows the dry tick was waiting for it
+    sendMockMovementRequest(clientSocketFd_, player1Id_, 1.0f, 0.0f, 0.0f, false, 4, serverPort_, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    server_->updateEntities(1.0f / 60.0f);
+    EXPECT_EQ(server_->getInputBufferStats().underruns, 1u);
+
+    // Ticks while the player sends nothing at all are idle, not underruns
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    server_->updateEntities(1.0f / 60.0f);
+    server_->updateEntities(1.0f / 60.0f);
+    sendMockMovementRequest(clientSocketFd_, player1Id_, 1.0f, 0.0f, 0.0f, false, 5, serverPort_, "127.0.0.1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    server_->updateEntities(1.0f / 60.0f);
+
+    auto stats = server_->getInputBufferStats();
+    EXPECT_EQ(stats.inputsBuffered, 5u);
+    EXPECT_EQ(stats.inputsApplied, 5u);
+    EXPECT_EQ(stats.underruns, 1u);
+    EXPECT_EQ(stats.catchUpInputs, 0u);
+}
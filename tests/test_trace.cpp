@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include "netcode/trace/input_trace.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+netcode::InputTraceEvent makeEvent(uint64_t timeUs, uint32_t playerId, float x, float z, uint32_t sequence) {
+    netcode::InputTraceEvent event;
+    event.timeUs = timeUs;
+    event.input.player_id = playerId;
+    event.input.movement_x = x;
+    event.input.movement_z = z;
+    event.input.input_sequence_number = sequence;
+    return event;
+}
+
+// Player 1 walks along X, one input every 16 ms
+netcode::InputTrace makeWalk(size_t inputs) {
+    netcode::InputTrace trace;
+    for (size_t i = 0; i < inputs; ++i) {
+        trace.add(makeEvent(i * 16000, 1, 1.0f, 0.5f, static_cast<uint32_t>(i + 1)));
+    }
+    return trace;
+}
+
+} // namespace
+
+TEST(InputTraceTest, RecordedTraceSurvivesSaveAndLoad) {
+    netcode::InputTraceRecorder recorder;
+    for (uint32_t i = 1; i <= 20; ++i) {
+        auto event = makeEvent(0, 1 + i % 2, 0.25f * i, -1.0f, i);
+        event.input.is_jumping = i % 5 == 0;
+        recorder.record(event.input);
+    }
+    netcode::InputTrace recorded = recorder.getTrace();
+    ASSERT_EQ(recorded.getEvents().size(), 20u);
+    EXPECT_EQ(recorded.getEvents().front().timeUs, 0u);
+    EXPECT_EQ(recorded.getPlayerIds(), (std::vector<uint32_t>{1, 2}));
+
+    std::string path = testing::TempDir() + "input_trace_roundtrip.bin";
+    ASSERT_TRUE(recorded.save(path));
+    netcode::InputTrace loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(loaded.getEvents().size(), recorded.getEvents().size());
+    for (size_t i = 0; i < loaded.getEvents().size(); ++i) {
+        const auto& a = recorded.getEvents()[i];
+        const auto& b = loaded.getEvents()[i];
+        EXPECT_EQ(a.timeUs, b.timeUs);
+        EXPECT_EQ(a.input.player_id, b.input.player_id);
+        EXPECT_EQ(a.input.movement_x, b.input.movement_x);
+        EXPECT_EQ(a.input.movement_z, b.input.movement_z);
+        EXPECT_EQ(a.input.is_jumping, b.input.is_jumping);
+        EXPECT_EQ(a.input.input_sequence_number, b.input.input_sequence_number);
+    }
+
+    // A truncated file is rejected as a whole
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write("NTRC", 4);
+    }
+    EXPECT_FALSE(loaded.load(path));
+    EXPECT_TRUE(loaded.getEvents().empty());
+    std::remove(path.c_str());
+}
+
+TEST(InputTraceTest, TransformScalesMirrorsAndRemapsPlayers) {
+    netcode::TraceTransform transform;
+    transform.timeScale = 2.0f;
+    transform.startOffsetUs = 500;
+    transform.playerIdOffset = 100;
+    transform.mirrorX = true;
+    netcode::InputTrace bot = netcode::transformTrace(makeWalk(10), transform);
+
+    ASSERT_EQ(bot.getEvents().size(), 10u);
+    EXPECT_EQ(bot.getPlayerIds(), (std::vector<uint32_t>{101}));
+    EXPECT_EQ(bot.getEvents()[3].timeUs, 500u + 3 * 8000);
+    EXPECT_EQ(bot.getEvents()[3].input.movement_x, -1.0f);
+    EXPECT_EQ(bot.getEvents()[3].input.movement_z, 0.5f);
+    EXPECT_EQ(bot.getEvents()[3].input.input_sequence_number, 4u);
+}
+
+TEST(InputTraceTest, MixedTracesReplayInOrderOnVirtualClock) {
+    netcode::TraceTransform second;
+    second.playerIdOffset = 1;
+    second.startOffsetUs = 8000;
+    second.mirrorX = true;
+    second.mirrorZ = true;
+    netcode::InputTrace mixed = netcode::mixTraces({makeWalk(50), netcode::transformTrace(makeWalk(50), second)});
+    ASSERT_EQ(mixed.getEvents().size(), 100u);
+    EXPECT_EQ(mixed.getDurationUs(), 49u * 16000 + 8000);
+
+    // Step a virtual clock at 60 Hz, the bots interleave as in the original runs
+    netcode::TraceReplayer replayer(mixed);
+    std::vector<netcode::InputTraceEvent> replayed;
+    uint64_t nowUs = 0;
+    size_t steps = 0;
+    while (!replayer.isFinished()) {
+        for (const auto& event : replayer.advanceTo(nowUs)) {
+            EXPECT_LE(event.timeUs, nowUs);
+            replayed.push_back(event);
+        }
+        if (!replayer.isFinished()) {
+            EXPECT_GT(replayer.getNextEventTimeUs(), nowUs);
+        }
+        nowUs += 16667;
+        steps++;
+    }
+    ASSERT_EQ(replayed.size(), 100u);
+    EXPECT_LT(steps, 60u);
+    for (size_t i = 1; i < replayed.size(); ++i) {
+        EXPECT_LE(replayed[i - 1].timeUs, replayed[i].timeUs);
+    }
+    EXPECT_EQ(replayed[0].input.player_id, 1u);
+    EXPECT_EQ(replayed[1].input.player_id, 2u);
+    EXPECT_EQ(replayed[1].input.movement_x, -1.0f);
+    EXPECT_EQ(replayed[1].input.movement_z, -0.5f);
+
+    // The same trace plays again from the start
+    replayer.reset();
+    EXPECT_EQ(replayer.advanceTo(0).size(), 1u);
+}
@@ -0,0 +1,297 @@
+#include "gtest/gtest.h"
+#include "netcode/utils/spsc_queue.hpp"
+#include "netcode/utils/event_bus.hpp"
+#include "netcode/utils/tick_scheduler.hpp"
+#include "netcode/utils/logger.hpp"
+#include "netcode/utils/log_writer.hpp"
+#include "netcode/utils/secure_random.hpp"
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(SpscQueueTest, PushPopInOrder) {
+    netcode::utils::SpscQueue<int> queue(4);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_GE(queue.capacity(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(SpscQueueTest, RejectsPushWhenFull) {
+    netcode::utils::SpscQueue<int> queue(3);
+    size_t pushed = 0;
+    while (queue.try_push(static_cast<int>(pushed))) {
+        ++pushed;
+    }
+    EXPECT_EQ(pushed, queue.capacity());
+
+    int value = 0;
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_TRUE(queue.try_push(42));
+}
+
+TEST(SpscQueueTest, TransfersAcrossThreads) {
+    netcode::utils::SpscQueue<std::vector<int>> queue(16);
+    constexpr int COUNT = 20000;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < COUNT; ++i) {
+            std::vector<int> batch{i, i + 1};
+            while (!queue.try_push(std::move(batch))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<int> batch;
+    int expected = 0;
+    while (expected < COUNT) {
+        if (queue.try_pop(batch)) {
+            ASSERT_EQ(batch.size(), 2u);
+            ASSERT_EQ(batch[0], expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(EventBusTest, EverySubscriberReadsEveryEvent) {
+    netcode::utils::EventBus<int> bus(8);
+    auto early = bus.subscribe();
+    bus.publish(1);
+    auto late = bus.subscribe();
+    bus.publish(2);
+    bus.publish(3);
+
+    std::vector<int> earlyEvents;
+    early.poll([&earlyEvents](int event) { earlyEvents.push_back(event); });
+    EXPECT_EQ(earlyEvents, (std::vector<int>{1, 2, 3}));
+
+    int event = 0;
+    ASSERT_TRUE(late.try_read(event));
+    EXPECT_EQ(event, 2);
+    EXPECT_EQ(late.backlog(), 1u);
+    ASSERT_TRUE(late.try_read(event));
+    EXPECT_EQ(event, 3);
+    EXPECT_FALSE(late.try_read(event));
+}
+
+TEST(EventBusTest, LappedSubscriberSkipsToOldestEvent) {
+    netcode::utils::EventBus<int> bus(4);
+    auto subscriber = bus.subscribe();
+    for (int i = 1; i <= 10; ++i) {
+        bus.publish(i);
+    }
+
+    // The producer never waited, the subscriber lost what was overwritten
+    std::vector<int> events;
+    subscriber.poll([&events](int event) { events.push_back(event); });
+    EXPECT_EQ(events, (std::vector<int>{7, 8, 9, 10}));
+    EXPECT_EQ(subscriber.lost(), 6u);
+}
+
+TEST(EventBusTest, ConcurrentSubscribersNeverSeeTornEvents) {
+    struct Event {
+        uint64_t sequence;
+        uint64_t copies[7];
+    };
+    netcode::utils::EventBus<Event> bus(64);
+    static constexpr uint64_t COUNT = 200000;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> subscribed{0};
+    auto consume = [&bus, &done, &subscribed]() {
+        auto subscriber = bus.subscribe();
+        subscribed++;
+        uint64_t last = 0;
+        uint64_t read = 0;
+        bool consistent = true;
+        auto check = [&](const Event& event) {
+            for (uint64_t copy : event.copies) {
+                consistent &= copy == event.sequence;
+            }
+            consistent &= event.sequence > last;
+            last = event.sequence;
+            ++read;
+        };
+        while (!done) {
+            subscriber.poll(check);
+        }
+        subscriber.poll(check);
+        EXPECT_TRUE(consistent);
+        EXPECT_EQ(last, COUNT);
+        // The producer only starts once both subscribed, so every event was either read or lost
+        EXPECT_EQ(read + subscriber.lost(), COUNT);
+    };
+    std::thread first(consume);
+    std::thread second(consume);
+    while (subscribed < 2) {
+        std::this_thread::yield();
+    }
+
+    for (uint64_t i = 1; i <= COUNT; ++i) {
+        Event event{};
+        event.sequence = i;
+        for (uint64_t& copy : event.copies) {
+            copy = i;
+        }
+        bus.publish(event);
+    }
+    done = true;
+    first.join();
+    second.join();
+    EXPECT_EQ(bus.published(), COUNT);
+}
+
+TEST(TickSchedulerTest, DeadlinesDoNotDrift) {
+    netcode::utils::TickSchedulerConfig config;
+    config.tick_rate = 100.0;
+    config.spin_us = 200;
+    netcode::utils::TickScheduler scheduler(config);
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.start();
+    uint32_t ticks = 0;
+    while (ticks < 30) {
+        ticks += scheduler.wait_next_tick();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Oversleeping any single tick does not push back the thirtieth deadline
+    EXPECT_GE(elapsed, std::chrono::milliseconds(300));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(330));
+    EXPECT_EQ(scheduler.stats().ticks, 30u);
+    EXPECT_EQ(scheduler.stats().jitter.count() + scheduler.stats().overruns, 30u);
+}
+
+TEST(TickSchedulerTest, OverrunCatchesUpOrSkips) {
+    for (auto policy : {netcode::utils::OverrunPolicy::CATCH_UP, netcode::utils::OverrunPolicy::SKIP}) {
+        netcode::utils::TickSchedulerConfig config;
+        config.tick_rate = 50.0;
+        config.overrun_policy = policy;
+        netcode::utils::TickScheduler scheduler(config);
+
+        EXPECT_EQ(scheduler.wait_next_tick(), 1u);
+        // A 50 ms tick ends past the next two deadlines, at 40 and 60 ms
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        uint32_t due = scheduler.wait_next_tick();
+
+        const auto& stats = scheduler.stats();
+        EXPECT_EQ(stats.overruns, 1u);
+        EXPECT_EQ(stats.overrun.count(), 1u);
+        if (policy == netcode::utils::OverrunPolicy::CATCH_UP) {
+            EXPECT_EQ(due, 2u);
+            EXPECT_EQ(stats.skipped_ticks, 0u);
+        } else {
+            EXPECT_EQ(due, 1u);
+            EXPECT_EQ(stats.skipped_ticks, 1u);
+        }
+        // The grid continues from the last missed deadline
+        EXPECT_GT(scheduler.next_deadline(), std::chrono::steady_clock::now());
+    }
+}
+
+TEST(LoggerTest, CategoryLevelOverridesGlobalLevel) {
+    auto& logger = netcode::utils::Logger::get_instance();
+    netcode::utils::LogLevel previous = logger.category("LoggerTestProbe").level();
+    auto logged = std::make_shared<std::atomic<int>>(0);
+    logger.register_callback([logged](netcode::utils::LogLevel, const std::string& message) {
+        if (message.find("[LoggerTestVerbose]") != std::string::npos) {
+            (*logged)++;
+        }
+    });
+
+    logger.set_level(netcode::utils::LogLevel::WARNING);
+    ASSERT_TRUE(logger.set_category_levels("LoggerTestVerbose=debug"));
+    EXPECT_FALSE(logger.set_category_levels("LoggerTestQuiet=LOUD"));
+
+    // A disabled message is not even formatted
+    int formatted = 0;
+    auto message = [&formatted]() { formatted++; return std::string("message"); };
+    LOG_DEBUG(message(), "LoggerTestVerbose");
+    LOG_DEBUG(message(), "LoggerTestQuiet");
+    EXPECT_EQ(formatted, 1);
+    EXPECT_EQ(*logged, 1);
+
+    // The override survives a global level change until it is cleared
+    logger.set_level(netcode::utils::LogLevel::ERROR);
+    EXPECT_EQ(logger.category("LoggerTestVerbose").level(), netcode::utils::LogLevel::DEBUG);
+    logger.clear_category_level("LoggerTestVerbose");
+    LOG_WARNING(message(), "LoggerTestVerbose");
+    EXPECT_EQ(formatted, 1);
+
+    logger.set_level(previous);
+}
+
+TEST(LogWriterTest, RotatesAndStaysWithinDiskBudget) {
+    auto directory = std::filesystem::temp_directory_path() / "netcode_log_writer_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    netcode::utils::LogFileConfig config;
+    config.path = (directory / "server.log").string();
+    config.max_file_bytes = 1000;
+    config.disk_budget_bytes = 3000;
+    config.compress = false;
+    netcode::utils::LogWriter writer(config);
+    ASSERT_TRUE(writer.open());
+
+    // Files that merely share the log's name are not rotated files and stay
+    auto unrelated = directory / "server.log.backup";
+    std::ofstream(unrelated) << std::string(5000, 'x');
+
+    for (int i = 0; i < 200; ++i) {
+        writer.write("line " + std::to_string(i) + std::string(40, 'x'));
+    }
+    writer.flush();
+
+    auto stats = writer.stats();
+    EXPECT_EQ(stats.lines_written, 200u);
+    EXPECT_GE(stats.rotations, 5u);
+    EXPECT_GT(stats.files_deleted, 0u);
+
+    // The budget holds after every rotation, the active file grows by at most one file until the next
+    EXPECT_TRUE(std::filesystem::exists(unrelated));
+    uint64_t total = 0;
+    size_t rotated = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path() == unrelated) {
+            continue;
+        }
+        total += entry.file_size();
+        rotated += entry.path().filename() != "server.log";
+    }
+    EXPECT_GT(rotated, 0u);
+    EXPECT_LE(total, config.disk_budget_bytes + config.max_file_bytes);
+
+    writer.close();
+    std::filesystem::remove_all(directory);
+}
+
+TEST(SecureRandomTest, FillsBuffersAndComparesSecrets) {
+    uint64_t first = 0;
+    uint64_t second = 0;
+    ASSERT_TRUE(netcode::utils::fill_secure_random(&first, sizeof(first)));
+    ASSERT_TRUE(netcode::utils::fill_secure_random(&second, sizeof(second)));
+    EXPECT_NE(first, second);
+
+    uint64_t copy = first;
+    EXPECT_TRUE(netcode::utils::constant_time_equals(&first, &copy, sizeof(first)));
+    copy ^= 1ull << 63;
+    EXPECT_FALSE(netcode::utils::constant_time_equals(&first, &copy, sizeof(first)));
+}